@@ -0,0 +1,84 @@
+// Measures AssimpImporter::readModel (Assimp parse + mesh conversion) on every model under
+// assets/models, or under the directory given as the first argument.
+//
+//     import_bench [models dir] [iterations]
+//
+// Reports the best of the iterations per model, in triangles per second. Not part of ctest,
+// build it with `cmake --build <build dir> --target import_bench`.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <assimp/Importer.hpp>
+
+#include "object/AssimpImporter.hpp"
+
+namespace fs = std::filesystem;
+
+int main(int argc, char** argv) {
+    fs::path modelsDir = argc > 1 ? fs::path(argv[1]) : fs::path(SANDBOX_ASSETS_DIR) / "models";
+    int iterations = argc > 2 ? std::max(1, std::atoi(argv[2])) : 5;
+
+    std::error_code error;
+    if (!fs::is_directory(modelsDir, error)) {
+        std::fprintf(stderr, "import_bench: %s is not a directory\n", modelsDir.string().c_str());
+        return 1;
+    }
+
+    Assimp::Importer formats;
+    std::vector<fs::path> models;
+    for (const fs::directory_entry& entry : fs::recursive_directory_iterator(modelsDir, error)) {
+        if (!entry.is_regular_file()) continue;
+        std::string extension = entry.path().extension().string();
+        if (extension == ".mtl" || !formats.IsExtensionSupported(extension)) continue;
+        models.push_back(entry.path());
+    }
+    std::sort(models.begin(), models.end());
+
+    double totalTriangles = 0.0;
+    double totalSeconds = 0.0;
+    std::printf("%-40s %8s %12s %10s %14s\n", "model", "meshes", "triangles", "best ms", "tris/s");
+    for (const fs::path& model : models) {
+        size_t meshCount = 0;
+        size_t triangles = 0;
+        double best = 0.0;
+        bool failed = false;
+
+        for (int i = 0; i < iterations; i++) {
+            ImportedModel imported;
+            std::string readError;
+            auto start = std::chrono::steady_clock::now();
+            bool succeeded = AssimpImporter::readModel(model.string(), imported, readError);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (!succeeded) {
+                std::printf("%-40s failed: %s\n", model.filename().string().c_str(), readError.c_str());
+                failed = true;
+                break;
+            }
+
+            meshCount = imported.meshes.size();
+            triangles = 0;
+            for (const ImportedMesh& mesh : imported.meshes) {
+                // the source's triangles, not the generated levels of detail after them
+                triangles += (mesh.lods.empty() ? mesh.indices.size() : mesh.lods[0].indexCount) / 3;
+            }
+            if (i == 0 || seconds < best) best = seconds;
+        }
+        if (failed) continue;
+
+        totalTriangles += (double)triangles;
+        totalSeconds += best;
+        std::printf("%-40s %8zu %12zu %10.2f %14.0f\n", model.filename().string().c_str(), meshCount, triangles,
+                    best * 1000.0, best > 0.0 ? triangles / best : 0.0);
+    }
+
+    if (totalSeconds > 0.0) {
+        std::printf("%-40s %8s %12.0f %10.2f %14.0f\n", "total", "", totalTriangles, totalSeconds * 1000.0, totalTriangles / totalSeconds);
+    }
+    return 0;
+}
@@ -4,13 +4,11 @@ layout (location=1) in vec3 aNorm;
 layout (location=2) in vec2 aTexCoord;
 layout (location=3) in vec4 aColor;
 
-uniform mat4 projection;
-uniform mat4 view;
-uniform mat4 model;
+#include "transform.glsl"
 
 out vec2 TexCoord;
 
 void main() {
-    gl_Position = projection*view*model * vec4(aPos, 1.0f);
+    gl_Position = localToClip(aPos);
     TexCoord = aTexCoord;
 }
\ No newline at end of file
@@ -0,0 +1,35 @@
+#version 460 core
+layout (location=0) in vec3 aPos;
+layout (location=2) in vec2 aTexCoord;
+layout (location=3) in vec4 aColor;
+layout (location=4) in vec3 aInstance;
+layout (location=5) in mat3 aInstanceBasis;
+layout (location=8) in vec4 aInstanceCustom;
+
+layout(std140) uniform SceneBlock {
+    mat4 projection;
+    mat4 view;
+};
+
+// filled by the renderer per draw, lets meshes sharing a material be drawn together
+struct DrawData {
+    mat4 model;
+    int lodLevel;
+};
+layout(std430) readonly buffer DrawBlock {
+    DrawData draws[];
+};
+
+out vec2 TexCoord;
+out vec4 fragColor;
+
+
+void main() {
+    vec4 worldPos = draws[gl_DrawID].model * vec4(aInstanceBasis * aPos, 1.0);
+    worldPos.xyz += aInstance;
+
+    gl_Position = projection * view * worldPos;
+
+    TexCoord = aTexCoord;
+    fragColor = aColor * aInstanceCustom;
+}
@@ -3,23 +3,23 @@ layout (location=0) in vec3 aPos;
 layout (location=2) in vec2 aTexCoord;
 layout (location=3) in vec4 aColor;
 layout (location=4) in vec3 aInstance;
+layout (location=5) in mat3 aInstanceBasis;
+layout (location=8) in vec4 aInstanceCustom;
 
 
-uniform mat4 projection;
-uniform mat4 view;
-uniform mat4 model;
+#include "transform.glsl"
 
 out vec2 TexCoord;
 out vec4 fragColor;
 
 
 void main() {
-    vec4 worldPos = model * vec4(aPos, 1.0);
+    vec4 worldPos = model * vec4(aInstanceBasis * aPos, 1.0);
     worldPos.xyz += aInstance;
 
-    gl_Position = projection * view * worldPos;
+    gl_Position = worldToClip(worldPos);
     
     TexCoord = aTexCoord;
-    fragColor = aColor;
+    fragColor = aColor * aInstanceCustom;
 
 }
@@ -9,6 +9,9 @@ out vec4 FragColor;
 void main() {
 
     FragColor = texture(base, TexCoord);
+#ifdef VARIANT_CUTOUT
+    if (FragColor.a < 0.5) discard;
+#endif
 }
 
 
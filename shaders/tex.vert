@@ -4,16 +4,14 @@ layout (location=2) in vec2 aTexCoord;
 layout (location=3) in vec4 aColor;
 
 
-uniform mat4 projection;
-uniform mat4 view;
-uniform mat4 model;
+#include "transform.glsl"
 
 out vec2 TexCoord;
 out vec4 fragColor;
 
 
 void main() {
-    gl_Position = projection*view*model * vec4(aPos, 1.0f);
+    gl_Position = localToClip(aPos);
     TexCoord = aTexCoord;
     fragColor = aColor;
 
@@ -0,0 +1,14 @@
+#pragma once
+
+// camera and model transforms shared by the forward vertex shaders
+uniform mat4 projection;
+uniform mat4 view;
+uniform mat4 model;
+
+vec4 worldToClip(vec4 worldPos) {
+    return projection * view * worldPos;
+}
+
+vec4 localToClip(vec3 localPos) {
+    return worldToClip(model * vec4(localPos, 1.0));
+}
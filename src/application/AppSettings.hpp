@@ -13,6 +13,13 @@ struct SettingsKeybind {
     const u8 trigger;
 };
 
+// how the renderer hides primitives behind others, see Renderer::cullPrimitives
+enum class OcclusionMode : u8 {
+    Off,
+    HiZ,     // depth pyramid from the previous frame, falls back to Queries without the GL targets
+    Queries  // GL occlusion queries against bounding boxes
+};
+
 struct AppSettings {
     std::filesystem::path userConfigDir;
     std::filesystem::path settingsPath;
@@ -57,4 +64,10 @@ struct AppSettings {
 
     // Graphics
     bool vsyncEnabled = false;
+    bool optimizeImportedMeshes = true; // MeshOptimizer pass on import, see AssimpImporter
+    bool frustumCulling = true;         // Renderer skips meshes outside the camera, see Renderer::cullPrimitives
+    OcclusionMode occlusionMode = OcclusionMode::Off;
+    bool levelOfDetail = true;          // Renderer picks reduced meshes by screen size, see Renderer::selectLODs
+    float lodPixelError = 1.0f;         // on-screen error a level may add, in pixels
+    bool batchDraws = true;             // multi-draw indirect for DrawBlock programs, GL 4.6, see Renderer::flushBatches
 };
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "application/Application.hpp"
 #include "platform/Platform.hpp"
 #include "core/ShaderRegistry.hpp"
+#include "engine/ShaderPreprocessor.hpp"
 #include <iostream>
 #include "core/InspectorEngine.hpp"
 #include "core/ui/InspectorUI.hpp"
@@ -62,7 +63,10 @@ void Application::addSubscriptions(AppContext& ctx) {
             std::string originalName = sourcePath.filename().string();
             std::string newFileName = findNextFileNumber(ctx.project.projectShadersDir, originalName);
             std::filesystem::path destPath = ctx.project.projectShadersDir / newFileName;
-            std::filesystem::copy(sourcePath, destPath);
+            std::string error;
+            if (!ShaderPreprocessor::copyWithIncludes(sourcePath, destPath, error)) {
+                ctx.logger.addLog(LogLevel::WARNING, "CloneFile", "Clone of " + originalName + " is incomplete", error);
+            }
             ctx.file_registry.reloadMap(); 
             return true;
         }
@@ -74,11 +78,8 @@ void Application::addSubscriptions(AppContext& ctx) {
     });
     ctx.events.Subscribe(EventType::LoadModel, [&ctx](const EventPayload& payload) -> bool {
         if (const auto* data = std::get_if<LoadModelPayload>(&payload)) {
-            unsigned int newModelID = ctx.assimp_importer.importModel(data->filePath); 
-            if (newModelID != INVALID_MODEL_ID) {
-                ctx.logger.addLog(LogLevel::INFO, "InspectorObject", "Successfully loaded model: " + data->filePath);
-                ctx.inspector_engine.refreshUniforms();
-            } else {
+            // the model is committed by AssimpImporter::update once the worker has read it
+            if (ctx.assimp_importer.importModelAsync(data->filePath) == AssimpImporter::INVALID_IMPORT) {
                 ctx.logger.addLog(LogLevel::LOG_ERROR, "Application", "Failed to import model: " + data->filePath); 
             }
             return true; 
@@ -222,7 +223,7 @@ bool Application::initialize(AppContext& ctx) {
         ctx.logger.addLog(LogLevel::CRITICAL, "Application Initialization", "Material Cache was not initialized successfully.");
         return false;
     }
-    if (!ctx.texture_cache.initialize(&ctx.logger)) {
+    if (!ctx.texture_cache.initialize(&ctx.logger, ctx.project.projectRoot / ".cache" / "textures")) {
         ctx.logger.addLog(LogLevel::CRITICAL, "Application Initialization", "Texture Cache was not initialized successfully.");
         return false;
     }
@@ -234,7 +235,7 @@ bool Application::initialize(AppContext& ctx) {
         ctx.logger.addLog(LogLevel::CRITICAL, "Application Initialization", "Model Importer was not initialized successfully.");
         return false;
     }
-    if (!ctx.hot_reloader.initialize(&ctx.logger, &ctx.events, &ctx.shader_registry, &ctx.model_cache, &ctx.editor_engine, &ctx.inspector_engine, &ctx.ctx_manager)) {
+    if (!ctx.hot_reloader.initialize(&ctx.logger, &ctx.events, &ctx.shader_registry, &ctx.model_cache, &ctx.editor_engine, &ctx.inspector_engine, &ctx.ctx_manager, &ctx.project)) {
         ctx.logger.addLog(LogLevel::CRITICAL, "Application Initialization", "Hot Reloader was not initialized successfully.");
         return false;
     }
@@ -272,7 +273,7 @@ bool Application::initialize(AppContext& ctx) {
         ctx.logger.addLog(LogLevel::CRITICAL, "Application Initialization", "Inspector UI was not initialized successfully.");
         return false;
     }
-    if (!ctx.renderer.initialize(&ctx.logger, &ctx.events, &ctx.model_cache, &ctx.material_cache, &ctx.texture_cache, &ctx.shader_registry, &ctx.uniform_registry, &ctx.inspector_engine)) {
+    if (!ctx.renderer.initialize(&ctx.logger, &ctx.events, &ctx.model_cache, &ctx.material_cache, &ctx.texture_cache, &ctx.shader_registry, &ctx.uniform_registry, &ctx.inspector_engine, &ctx.settings)) {
         ctx.logger.addLog(LogLevel::CRITICAL, "Application Initialization", "Renderer was not initialized successfully.");
         return false;
     }
@@ -285,7 +286,7 @@ bool Application::initialize(AppContext& ctx) {
         ctx.logger.addLog(LogLevel::CRITICAL, "Application Initialization", "Default actions were not bound correctly.");
         return false;
     }
-    if (!ctx.assimp_importer.initialize(&ctx.logger, &ctx.model_cache, &ctx.material_cache, &ctx.shader_registry, &ctx.inspector_engine, &ctx.project)) {
+    if (!ctx.assimp_importer.initialize(&ctx.logger, &ctx.model_cache, &ctx.material_cache, &ctx.shader_registry, &ctx.inspector_engine, &ctx.project, &ctx.settings)) {
         ctx.logger.addLog(LogLevel::CRITICAL, "Application Initialization", "Model Cache was not initialized successfully.");
         return false;
     }
@@ -308,8 +309,11 @@ void Application::runLoop(AppContext& ctx) {
         ctx.viewport_ui.getCamera()->reset();
         ctx.platform.pollEvents();
         ctx.platform.processInput();
+        ctx.shader_registry.update();
         ctx.hot_reloader.update();
         ctx.events.ProcessQueue();
+        ctx.assimp_importer.update();
+        ctx.texture_cache.processUploads();
         Application::renderUI(ctx);
         ctx.platform.swapBuffers();
     }
@@ -349,6 +353,9 @@ void Application::shutdown(AppContext& ctx) {
     ctx.settings.fontIdx = ctx.fonts.getFontIndex();
     if (initialized) ctx.project.consoleSettings = ctx.console_engine.getToggles();
 
+    ctx.assimp_importer.shutdown();
+    ctx.texture_cache.shutdown(); // drain decode workers while the GL context still exists
+    ctx.renderer.shutdown();
     ctx.platform.terminate();
 
     // UI Shutdown
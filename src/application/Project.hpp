@@ -7,6 +7,7 @@
 #include "object/MeshProperties.hpp"
 #include "object/Vertex.hpp"
 #include "object/InstanceData.hpp"
+#include "object/InstanceGenerator.hpp"
 #include "object/MaterialProperties.hpp"
 #include "object/MaterialType.hpp"
 #include "object/ModelType.hpp"
@@ -29,10 +30,12 @@ struct ModelEntry {
     bool isSkybox;
 
     std::vector<unsigned int> meshMaterialIDs;
-    std::vector<InstanceData> instanceData; //struct
+    std::vector<InstanceData> instanceData; //struct, empty when instanceGenerator is set
+    InstanceGeneratorParams instanceGenerator;
     glm::vec3 position;
     glm::vec3 scale;
     glm::vec3 rotation;
+    int lodOverride = -1; // see Model::setLODOverride
 };
 
 
@@ -29,7 +29,8 @@ enum class EventType {
     MaterialValidated,
     MaterialsInvalidated,
     MaterialTypeChange,
-    ProgramDeleted
+    ProgramDeleted,
+    ProgramReplaced
 };
 
 struct SaveActiveShaderFilePayload { std::string filePath; unsigned int modelID; };
@@ -47,6 +48,7 @@ struct MaterialValidatedPayload { unsigned int materialID; };
 struct MaterialsInvalidatedPayload { std::vector<unsigned int> invalidMaterialIDs; };
 struct MaterialTypeChangePayload { unsigned int materialID; MaterialType newType; };
 struct ProgramDeletedPayload { unsigned int programID; };
+struct ProgramReplacedPayload { unsigned int programID; };
 
 using EventPayload = std::variant<
     std::monostate,
@@ -64,7 +66,8 @@ using EventPayload = std::variant<
     MaterialValidatedPayload,
     MaterialsInvalidatedPayload,
     MaterialTypeChangePayload,
-    ProgramDeletedPayload
+    ProgramDeletedPayload,
+    ProgramReplacedPayload
 >;
 
 struct Event {
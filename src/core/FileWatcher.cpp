@@ -0,0 +1,229 @@
+#include "FileWatcher.hpp"
+
+#include <algorithm>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+    std::string canonicalString(const fs::path& path) {
+        std::error_code error;
+        fs::path canonical = fs::weakly_canonical(path, error);
+        return error ? path.string() : canonical.string();
+    }
+
+    template <typename Fn>
+    void forEachFile(const std::string& directory, Fn fn) {
+        std::error_code error;
+        for (fs::directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+            std::error_code typeError;
+            if (it->is_regular_file(typeError)) fn(it->path().string());
+        }
+    }
+}
+
+
+FileWatcher::Stamp FileWatcher::stampOf(const fs::path& path) {
+    Stamp stamp;
+    std::error_code error;
+    uint64_t size = fs::file_size(path, error);
+    if (error) return stamp;
+    auto modified = fs::last_write_time(path, error);
+    if (error) return stamp;
+    stamp.exists = true;
+    stamp.size = size;
+    stamp.modified = (int64_t)modified.time_since_epoch().count();
+    return stamp;
+}
+
+
+FileWatcher::FileWatcher(Backend preferred) {
+#ifdef __linux__
+    if (preferred == Backend::Native) {
+        inotifyFD = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotifyFD >= 0) backend = Backend::Native;
+    }
+#else
+    (void)preferred;
+#endif
+}
+
+
+FileWatcher::~FileWatcher() {
+    clear();
+    pending.clear();
+#ifdef __linux__
+    if (inotifyFD >= 0) close(inotifyFD);
+#endif
+    inotifyFD = -1;
+}
+
+
+bool FileWatcher::watchDirectory(const fs::path& directory) {
+    std::string path = canonicalString(directory);
+    std::error_code error;
+    if (!fs::is_directory(path, error)) return false;
+
+    if (backend == Backend::Native && !addNativeWatch(path)) return false;
+    directories.insert(path);
+    if (backend == Backend::Polling) {
+        forEachFile(path, [this](const std::string& file) { stamps[file] = stampOf(file); });
+    }
+    return true;
+}
+
+
+// the file may not exist yet, creating it counts as a change
+bool FileWatcher::watchFile(const fs::path& file) {
+    std::string path = canonicalString(file);
+    std::string directory = fs::path(path).parent_path().string();
+
+    if (backend == Backend::Native && !addNativeWatch(directory)) return false;
+    // watching it again must not forget what polling saw last
+    if (files.insert(path).second && backend == Backend::Polling && !stamps.contains(path)) stamps[path] = stampOf(path);
+    return true;
+}
+
+
+void FileWatcher::unwatchFile(const fs::path& file) {
+    std::string path = canonicalString(file);
+    if (files.erase(path) == 0) return;
+
+    std::string directory = fs::path(path).parent_path().string();
+    if (directories.contains(directory)) return; // still reported through its directory
+    stamps.erase(path);
+
+    for (const std::string& other : files) {
+        if (fs::path(other).parent_path() == directory) return;
+    }
+    auto watched = descriptorByDirectory.find(directory);
+    if (watched == descriptorByDirectory.end()) return;
+#ifdef __linux__
+    inotify_rm_watch(inotifyFD, watched->second);
+#endif
+    watchedByDescriptor.erase(watched->second);
+    descriptorByDirectory.erase(watched);
+}
+
+
+void FileWatcher::clear() {
+#ifdef __linux__
+    for (auto& [descriptor, directory] : watchedByDescriptor) {
+        inotify_rm_watch(inotifyFD, descriptor);
+    }
+#endif
+    watchedByDescriptor.clear();
+    descriptorByDirectory.clear();
+    directories.clear();
+    files.clear();
+    stamps.clear();
+}
+
+
+std::vector<fs::path> FileWatcher::poll(Clock::time_point now) {
+    if (backend == Backend::Native) {
+        readNativeEvents(now);
+    }
+    else if (now - lastScan >= POLL_INTERVAL) {
+        scan(now);
+        lastScan = now;
+    }
+
+    // polling only knows a file went quiet once a later scan found it unchanged
+    std::vector<fs::path> changed;
+    for (auto it = pending.begin(); it != pending.end();) {
+        bool settled = now - it->second >= DEBOUNCE && (backend == Backend::Native || lastScan > it->second);
+        if (settled) {
+            changed.push_back(it->first);
+            it = pending.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+    std::sort(changed.begin(), changed.end());
+    return changed;
+}
+
+
+bool FileWatcher::addNativeWatch(const std::string& directory) {
+#ifdef __linux__
+    if (descriptorByDirectory.contains(directory)) return true;
+    int descriptor = inotify_add_watch(inotifyFD, directory.c_str(), IN_CLOSE_WRITE | IN_MODIFY | IN_MOVED_TO | IN_CREATE | IN_DELETE);
+    if (descriptor < 0) return false;
+    watchedByDescriptor[descriptor] = directory;
+    descriptorByDirectory[directory] = descriptor;
+    return true;
+#else
+    (void)directory;
+    return false;
+#endif
+}
+
+
+bool FileWatcher::isWatched(const std::string& directory, const std::string& file) const {
+    return directories.contains(directory) || files.contains(file);
+}
+
+
+void FileWatcher::readNativeEvents(Clock::time_point now) {
+#ifdef __linux__
+    alignas(inotify_event) char buffer[4096];
+    while (true) {
+        ssize_t length = read(inotifyFD, buffer, sizeof(buffer));
+        if (length <= 0) break; // EAGAIN once the queue is empty
+
+        for (char* cursor = buffer; cursor < buffer + length;) {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(cursor);
+            cursor += sizeof(inotify_event) + event->len;
+
+            // the kernel dropped events, anything watched may have changed
+            if (event->mask & IN_Q_OVERFLOW) {
+                for (const std::string& file : files) markChanged(file, now);
+                for (const std::string& directory : directories) {
+                    forEachFile(directory, [this, now](const std::string& file) { markChanged(file, now); });
+                }
+                continue;
+            }
+            if (event->len == 0 || (event->mask & IN_ISDIR)) continue;
+
+            auto watched = watchedByDescriptor.find(event->wd);
+            if (watched == watchedByDescriptor.end()) continue;
+            std::string file = (fs::path(watched->second) / event->name).string();
+            if (isWatched(watched->second, file)) markChanged(file, now);
+        }
+    }
+#else
+    (void)now;
+#endif
+}
+
+
+// compares every watched file with the last scan, new and deleted files count as changed
+void FileWatcher::scan(Clock::time_point now) {
+    std::unordered_map<std::string, Stamp> current;
+    for (const std::string& directory : directories) {
+        forEachFile(directory, [&current](const std::string& file) { current[file] = stampOf(file); });
+    }
+    for (const std::string& file : files) {
+        if (!current.contains(file)) current[file] = stampOf(file);
+    }
+
+    for (auto& [file, stamp] : current) {
+        auto previous = stamps.find(file);
+        if (previous == stamps.end() ? stamp.exists : previous->second != stamp) markChanged(file, now);
+    }
+    for (auto& [file, stamp] : stamps) {
+        if (stamp.exists && !current.contains(file)) markChanged(file, now);
+    }
+    stamps = std::move(current);
+}
+
+
+void FileWatcher::markChanged(const std::string& file, Clock::time_point now) {
+    pending[file] = now;
+}
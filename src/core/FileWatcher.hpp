@@ -0,0 +1,81 @@
+// DESCRIPTION
+/*
+FileWatcher reports files that changed on disk, for the HotReloader. It watches whole directories
+(every file directly inside, not recursive) and single files (only that file, its directory is
+watched underneath).
+
+On Linux it uses inotify. Elsewhere, or when inotify can't be set up, it polls: every
+POLL_INTERVAL each watched file's modification time and size are compared with the last scan.
+
+Editors rarely write a file in one go: truncate and write, write a temp file and rename it, touch
+it again to save metadata. Every event only marks its file pending, and a file is reported once
+nothing has happened to it for DEBOUNCE, so one save is one report.
+
+Paths come back as watched: weakly canonical, so they can be compared with other canonical paths.
+Nothing runs in the background, all the work happens in poll().
+*/
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class FileWatcher {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::chrono::milliseconds DEBOUNCE{ 100 };
+    static constexpr std::chrono::milliseconds POLL_INTERVAL{ 250 };
+
+    enum class Backend {
+        Native, // inotify, falls back to Polling where it isn't available
+        Polling
+    };
+
+    // what polling compares, also how the HotReloader tells its own saves from new ones
+    struct Stamp {
+        bool exists = false;
+        int64_t modified = 0;
+        uint64_t size = 0;
+
+        bool operator==(const Stamp& other) const = default;
+    };
+    static Stamp stampOf(const std::filesystem::path& path);
+
+    explicit FileWatcher(Backend preferred = Backend::Native);
+    ~FileWatcher();
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    Backend getBackend() const { return backend; }
+
+    bool watchDirectory(const std::filesystem::path& directory);
+    bool watchFile(const std::filesystem::path& file);
+    void unwatchFile(const std::filesystem::path& file); // its directory stays watched if anything else needs it
+    void clear(); // drops every watch, changes already seen stay pending
+
+    // files whose last change is at least DEBOUNCE old, each reported once per burst
+    std::vector<std::filesystem::path> poll(Clock::time_point now = Clock::now());
+
+private:
+    Backend backend = Backend::Polling;
+    int inotifyFD = -1;
+    std::unordered_map<int, std::string> watchedByDescriptor; // inotify watch -> directory
+    std::unordered_map<std::string, int> descriptorByDirectory;
+
+    std::unordered_set<std::string> directories; // every file inside is reported
+    std::unordered_set<std::string> files;       // only these are reported from their directory
+    std::unordered_map<std::string, Stamp> stamps; // polling's last scan
+    Clock::time_point lastScan{};
+    std::unordered_map<std::string, Clock::time_point> pending; // file -> its latest event
+
+    bool addNativeWatch(const std::string& directory);
+    bool isWatched(const std::string& directory, const std::string& file) const;
+    void readNativeEvents(Clock::time_point now);
+    void scan(Clock::time_point now);
+    void markChanged(const std::string& file, Clock::time_point now);
+};
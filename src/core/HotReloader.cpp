@@ -12,6 +12,16 @@
 #include "core/InspectorEngine.hpp"
 #include <filesystem>
 #include "core/input/ContextManager.hpp"
+#include "application/Project.hpp"
+
+namespace {
+    std::string canonicalPath(const std::filesystem::path& path) {
+        if (path.empty()) return "";
+        std::error_code error;
+        std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+        return error ? path.string() : canonical.string();
+    }
+}
 
 HotReloader::HotReloader() {
     initialized = false;
@@ -23,7 +33,7 @@ HotReloader::HotReloader() {
     inspectorEngPtr = nullptr;
 }
 
-bool HotReloader::initialize(Logger* _loggerPtr, EventDispatcher* _eventsPtr, ShaderRegistry* _shaderRegPtr, ModelCache* _modelCachePtr, EditorEngine* _editorEngPtr, InspectorEngine* _inspectorEngPtr, ContextManager* _contextManagerPtr) {
+bool HotReloader::initialize(Logger* _loggerPtr, EventDispatcher* _eventsPtr, ShaderRegistry* _shaderRegPtr, ModelCache* _modelCachePtr, EditorEngine* _editorEngPtr, InspectorEngine* _inspectorEngPtr, ContextManager* _contextManagerPtr, Project* _projectPtr) {
     if (initialized) {
         loggerPtr->addLog(LogLevel::WARNING, "Hot Reloader Initialization", "Hot Reloader was already initialized.");
         return false;
@@ -35,6 +45,7 @@ bool HotReloader::initialize(Logger* _loggerPtr, EventDispatcher* _eventsPtr, Sh
     editorEngPtr = _editorEngPtr;
     inspectorEngPtr = _inspectorEngPtr;
     contextManagerPtr = _contextManagerPtr;
+    projectPtr = _projectPtr;
 
     eventsPtr->Subscribe(EventType::SaveActiveShaderFile, [this](const EventPayload& payload) -> bool {
         int activeIdx = editorEngPtr->activeEditor;
@@ -51,20 +62,8 @@ bool HotReloader::initialize(Logger* _loggerPtr, EventDispatcher* _eventsPtr, Sh
                 out.close();
             }
 
-            std::string absSavedPath = std::filesystem::weakly_canonical(active->filePath).string();
-
-            bool updatedOneProgram = false;
-            for (auto const& [ID, prog] : shaderRegPtr->getPrograms()) {
-                if (std::filesystem::weakly_canonical(prog->vertPath).string() == absSavedPath ||
-                    std::filesystem::weakly_canonical(prog->fragPath).string() == absSavedPath) {
-                    if (!prog->name.empty()) {
-                        updatedOneProgram = true;
-                        this->compile(active->filePath, prog->name, ID);
-                    }
-                }
-            }
-
-            if (!updatedOneProgram) {
+            refreshIndex();
+            if (!reloadFile(canonicalPath(active->filePath))) {
                 loggerPtr->addLog(LogLevel::WARNING, "HotReloader", "Saved file not associated with any program.");
             }
 
@@ -72,6 +71,18 @@ bool HotReloader::initialize(Logger* _loggerPtr, EventDispatcher* _eventsPtr, Sh
         }
     );
 
+    eventsPtr->Subscribe(EventType::ProgramReplaced, [this](const EventPayload& payload) -> bool {
+        if (const auto* data = std::get_if<ProgramReplacedPayload>(&payload)) {
+            inspectorEngPtr->refreshUniforms();
+            loggerPtr->addLog(LogLevel::INFO, "HotReloader", "Successfully hot-reloaded: " + shaderRegPtr->getProgramName(data->programID));
+        }
+        return false;
+    });
+
+    if (watcher.getBackend() == FileWatcher::Backend::Polling) {
+        loggerPtr->addLog(LogLevel::INFO, "Hot Reloader Initialization", "No native file watching here, polling shader files instead.");
+    }
+
     initialized = true;
     return true;
 }
@@ -84,11 +95,29 @@ void HotReloader::shutdown() {
     modelCachePtr = nullptr;
     editorEngPtr = nullptr;
     inspectorEngPtr = nullptr;
+    projectPtr = nullptr;
+    watcher.clear();
+    programsByPath.clear();
+    indexedPrograms.clear();
+    compiledStamps.clear();
+    indexDirty = true;
     initialized = false;
 }
 
+// recompiles the programs reading each file changed on disk, once its writes have settled
 void HotReloader::update() {
-    
+    if (!initialized) return;
+    refreshIndex();
+
+    for (const std::filesystem::path& changed : watcher.poll()) {
+        std::string path = changed.string();
+        FileWatcher::Stamp stamp = FileWatcher::stampOf(path);
+        if (!stamp.exists) continue; // deleted, or mid-rename, the program keeps what it has
+
+        auto compiled = compiledStamps.find(path);
+        if (compiled != compiledStamps.end() && compiled->second == stamp) continue; // saved from the editor, already compiled
+        reloadFile(path);
+    }
 }
 
 bool HotReloader::compile(const std::string &filepath, const std::string &programName, const unsigned int progID) {
@@ -149,20 +178,93 @@ bool HotReloader::attemptCompile(const std::string &shaderPath, const std::strin
         fPath = normalizedTriggerPath;
     }
 
-    if (inspectorEngPtr->handleEditShaderProgram(vPath, fPath, programName)) {
-        ShaderProgram* updatedProg = shaderRegPtr->getProgram(progID);
-        if (updatedProg) {
-            updatedProg->vertPath = vPath;
-            updatedProg->fragPath = fPath;
+    // the replacement carries vPath and fPath, ProgramReplaced reports when it's in use
+    return inspectorEngPtr->handleEditShaderProgram(vPath, fPath, programName);
+}
+
+// maps every file a program reads to the program, and watches them. Only programs that were added,
+// deleted or now read other files are touched, tearing every watch down would drop changes
+// already queued, like a second file saved while the first one was reloading
+void HotReloader::refreshIndex() {
+    bool shadersDirChanged = projectPtr->projectShadersDir != watchedShadersDir;
+    if (!indexDirty && !shadersDirChanged && shaderRegPtr->getRevision() == indexedRevision) return;
+
+    if (indexDirty || shadersDirChanged) {
+        programsByPath.clear();
+        indexedPrograms.clear();
+        watcher.clear();
+        watchedShadersDir = projectPtr->projectShadersDir;
+        if (!watcher.watchDirectory(watchedShadersDir) && shadersDirChanged) {
+            loggerPtr->addLog(LogLevel::WARNING, "HotReloader::refreshIndex()", "Could not watch shaders directory: " + watchedShadersDir.string());
+        }
+    }
+
+    const auto& programs = shaderRegPtr->getPrograms();
+    for (auto it = indexedPrograms.begin(); it != indexedPrograms.end();) {
+        auto program = programs.find(it->first);
+        if (program != programs.end() && !program->second->name.empty()) {
+            ++it;
+            continue;
         }
+        unindexProgram(it->first, it->second);
+        it = indexedPrograms.erase(it);
+    }
 
-        inspectorEngPtr->refreshUniforms();
-        loggerPtr->addLog(LogLevel::INFO, "HotReloader", "Successfully hot-reloaded: " + programName);
-        return true;
+    for (auto const& [ID, prog] : programs) {
+        if (prog->name.empty()) continue;
+
+        // the program's own dependency graph, as its ShaderPreprocessor resolved it
+        IndexedProgram current{ prog->vertPath, prog->fragPath, prog->getSourceFiles() };
+        auto indexed = indexedPrograms.find(ID);
+        if (indexed != indexedPrograms.end()) {
+            if (indexed->second == current) continue;
+            unindexProgram(ID, indexed->second);
+        }
+        indexProgram(ID, current);
+        indexedPrograms[ID] = std::move(current);
     }
-    return false;
+
+    indexedRevision = shaderRegPtr->getRevision();
+    indexDirty = false;
 }
 
-void HotReloader::scanSourceFiles(const std::string &sourceCode) {
 
+void HotReloader::indexProgram(unsigned int programID, const IndexedProgram& program) {
+    std::string vertPath = canonicalPath(program.vertPath);
+    std::string fragPath = canonicalPath(program.fragPath);
+    for (const std::string& path : program.files) {
+        std::vector<ProgramUse>& uses = programsByPath[path];
+        if (uses.empty()) watcher.watchFile(path);
+        uses.push_back({ programID, path == vertPath || path == fragPath });
+    }
+}
+
+
+void HotReloader::unindexProgram(unsigned int programID, const IndexedProgram& program) {
+    for (const std::string& path : program.files) {
+        auto found = programsByPath.find(path);
+        if (found == programsByPath.end()) continue;
+        std::erase_if(found->second, [programID](const ProgramUse& use) { return use.programID == programID; });
+        if (!found->second.empty()) continue;
+        programsByPath.erase(found);
+        watcher.unwatchFile(path);
+    }
+}
+
+// false if no program reads the file
+bool HotReloader::reloadFile(const std::string &path) {
+    auto found = programsByPath.find(path);
+    if (found == programsByPath.end()) return false;
+
+    compiledStamps[path] = FileWatcher::stampOf(path);
+    std::vector<ProgramUse> uses = found->second;
+    for (const ProgramUse& use : uses) {
+        ShaderProgram* prog = shaderRegPtr->getProgram(use.programID);
+        if (!prog || prog->name.empty()) continue;
+
+        // an included file isn't a stage, recompile from the program's own vertex shader
+        loggerPtr->addLog(LogLevel::INFO, "HotReloader", "Reloading " + prog->name + " for " + path);
+        compile(use.isStage ? path : prog->vertPath, prog->name, use.programID);
+    }
+    return true;
 }
@@ -1,7 +1,13 @@
 #ifndef HOTRELOADER_HPP
 #define HOTRELOADER_HPP
 
+#include <cstdint>
+#include <filesystem>
 #include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/FileWatcher.hpp"
 
 class Logger;
 class EventDispatcher;
@@ -10,11 +16,12 @@ class ModelCache;
 class EditorEngine;
 class InspectorEngine;
 class ContextManager;
+struct Project;
 
 class HotReloader{
 public:
     HotReloader();
-    bool initialize(Logger* _loggerPtr, EventDispatcher* _eventsPtr, ShaderRegistry* _shaderRegPtr, ModelCache* _modelCachePtr, EditorEngine* _editorEngPtr, InspectorEngine* _inspectorEngPtr, ContextManager* _contextManagerPtr);
+    bool initialize(Logger* _loggerPtr, EventDispatcher* _eventsPtr, ShaderRegistry* _shaderRegPtr, ModelCache* _modelCachePtr, EditorEngine* _editorEngPtr, InspectorEngine* _inspectorEngPtr, ContextManager* _contextManagerPtr, Project* _projectPtr);
     void shutdown();
     void update();
     bool compile(const std::string &filepath, const std::string &programName, const unsigned int progID);
@@ -28,10 +35,36 @@ private:
     EditorEngine* editorEngPtr = nullptr;
     InspectorEngine* inspectorEngPtr = nullptr;
     ContextManager* contextManagerPtr = nullptr;
+    Project* projectPtr = nullptr;
+
+    // a program reading a file, as one of its stages or through an #include
+    struct ProgramUse {
+        unsigned int programID;
+        bool isStage;
+    };
+
+    // what a program was indexed with, a hot reload reading the same files changes nothing
+    struct IndexedProgram {
+        std::string vertPath;
+        std::string fragPath;
+        std::vector<std::string> files;
+
+        bool operator==(const IndexedProgram& other) const = default;
+    };
 
+    FileWatcher watcher;
+    std::filesystem::path watchedShadersDir;
+    uint64_t indexedRevision = UINT64_MAX;
+    bool indexDirty = true;
+    std::unordered_map<std::string, std::vector<ProgramUse>> programsByPath; // canonical path -> programs reading it
+    std::unordered_map<unsigned int, IndexedProgram> indexedPrograms;         // program ID -> what programsByPath has for it
+    std::unordered_map<std::string, FileWatcher::Stamp> compiledStamps;      // each file as last compiled, so a save isn't compiled twice
 
     std::string readSourceFile(const std::string &filepath);
-    void scanSourceFiles(const std::string &sourceCode);
+    void refreshIndex();
+    void indexProgram(unsigned int programID, const IndexedProgram& program);
+    void unindexProgram(unsigned int programID, const IndexedProgram& program);
+    bool reloadFile(const std::string &canonicalPath);
     bool attemptCompile(const std::string &fragShaderPath, const std::string &programName, const unsigned int progID);
 };
 
@@ -20,6 +20,7 @@
 #include "core/logging/Logger.hpp"
 #include "core/ShaderRegistry.hpp"
 #include "core/UniformRegistry.hpp"
+#include "engine/LODUniform.hpp"
 #include "object/ModelCache.hpp"
 #include "platform/Platform.hpp"
 
@@ -60,6 +61,14 @@ void InspectorEngine::shutdown() {
     initialized = false;
 }
 
+const InspectorEngine::UniformUploadStats& InspectorEngine::getUniformUploadStats() const {
+    return uploadStats;
+}
+
+void InspectorEngine::resetUniformUploadStats() {
+    uploadStats = UniformUploadStats{};
+}
+
 void InspectorEngine::refreshUniforms() {
     const auto& programs = shaderRegPtr->getPrograms();
     
@@ -91,6 +100,7 @@ void InspectorEngine::refreshUniforms() {
     namesToAvoid->insert("model");
     namesToAvoid->insert("view");
     namesToAvoid->insert("projection");
+    namesToAvoid->insert(LOD_UNIFORM_NAME); // set per draw by the Renderer
 
     UniformParser parser(loggerPtr);
 
@@ -148,13 +158,12 @@ bool InspectorEngine::handleEditShaderProgram(const std::string& vertexPath, con
         return true;
     }
 
-    // Otherwise, we need to go through this mess.
-    auto newProgram = std::make_unique<ShaderProgram>(vertexPath.c_str(), fragmentPath.c_str(), programName.c_str(), oldProgram->ID, loggerPtr);
-    if (!newProgram->isCompiled()) return false;
+    // Otherwise compile in the background, the registry swaps it in once it links and
+    // ProgramReplaced follows. A compile error is only logged then, the old program stays.
+    auto newProgram = std::make_unique<ShaderProgram>(vertexPath.c_str(), fragmentPath.c_str(), programName.c_str(), oldProgram->ID, loggerPtr, ShaderProgram::CompileMode::Deferred, shaderRegPtr->getBuildCaches());
+    if (!newProgram->isPending() && !newProgram->isCompiled()) return false;
 
     shaderRegPtr->replaceProgram(oldProgram->ID, std::move(newProgram));
-
-    InspectorEngine::refreshUniforms();
     return true;
 }
 
@@ -232,15 +241,13 @@ void InspectorEngine::setUniform(unsigned int materialID, const std::string& uni
 }
 
 void InspectorEngine::applyAllUniformsForMaterial(unsigned int materialID) {
-    const auto objectUniforms = uniformRegPtr->tryReadMaterialUniforms(materialID);
-
-    if (objectUniforms == nullptr) {
+    if (!uniformRegPtr->containsMaterial(materialID)) {
         // ERRLOG.logEntry(EL_WARNING, "applyAllUniformsForMaterial", "object not found in uniform registry: ", modelID.c_str());
         loggerPtr->addLog(LogLevel::WARNING, "applyAllUniformsForMaterial", "material not found in uniform registry: ", std::to_string(materialID)); 
         return;
     }
 
-    for (auto& [uniformName, uniform] : *objectUniforms) {
+    for (const Uniform& uniform : uniformRegPtr->readMaterialUniforms(materialID)) {
         applyUniform(materialID, uniform);
     }
 }
@@ -262,12 +269,16 @@ void InspectorEngine::applyUniform(unsigned int materialID, const Uniform& unifo
         return;
     }
 
+    // called from the UI between (or, via resetFunctionTree, during) draws, so leave the bound program as it was
+    GLint previousProgram = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+    matProgram->use();
     applyUniform(*matProgram, uniform);
+    glUseProgram((GLuint)previousProgram);
 }
 
+// expects program to be bound
 void InspectorEngine::applyUniform(ShaderProgram& program, const Uniform& uniform) {
-    program.use();
-
     // at some point, we're going to want a memo so we don't redo linked list traversals.
     if (uniform.isFunction) {
         const InspectorReference* function = std::get_if<InspectorReference>(&uniform.value);
@@ -286,11 +297,15 @@ void InspectorEngine::applyUniform(ShaderProgram& program, const Uniform& unifor
     }
 
     // this stops us from getting an error every frame. instead, we'll show it in the UI
-    if (!program.hasUniform(uniform.name.c_str())) {
-        Uniform copy = uniform;
-        copy.hasLocation = false;
-        if (!uniformRegPtr->updateUniform(copy.ID, copy)) {
-            loggerPtr->addLog(LogLevel::LOG_ERROR, "applyUniform", "uniform with ID: " + std::to_string(copy.ID) + " does not exist!");
+    const UniformHandle handle = program.getUniformHandle(uniform.ID, uniform.name);
+    if (!handle.isValid()) {
+        // only write back on the transition, otherwise this copies the uniform every draw
+        if (uniform.hasLocation) {
+            Uniform copy = uniform;
+            copy.hasLocation = false;
+            if (!uniformRegPtr->updateUniform(copy.ID, copy)) {
+                loggerPtr->addLog(LogLevel::LOG_ERROR, "applyUniform", "uniform with ID: " + std::to_string(copy.ID) + " does not exist!");
+            }
         }
 
         return;
@@ -305,35 +320,45 @@ void InspectorEngine::applyUniform(ShaderProgram& program, const Uniform& unifor
         
     }
 
+    if (program.isUniformCurrent(handle, uniform.ID, uniform.generation)) {
+        uploadStats.skipped++;
+        return;
+    }
+
+    bool issued = false;
     switch (uniform.type)
     {
     case UniformType::Int:
-        program.setUniform_int(uniform.name.c_str(), std::get<int>(uniform.value));
+        issued = program.setUniform_int(handle, std::get<int>(uniform.value));
         break;
     case UniformType::Float:
-        program.setUniform_float(uniform.name.c_str(), std::get<float>(uniform.value));
+        issued = program.setUniform_float(handle, std::get<float>(uniform.value));
         break;
     case UniformType::Vec3:
-        program.setUniform_vec3float(uniform.name.c_str(), std::get<glm::vec3>(uniform.value));
+        issued = program.setUniform_vec3float(handle, std::get<glm::vec3>(uniform.value));
         break;
     case UniformType::Vec4:
-        program.setUniform_vec4float(uniform.name.c_str(), std::get<glm::vec4>(uniform.value));
+        issued = program.setUniform_vec4float(handle, std::get<glm::vec4>(uniform.value));
         break;
     case UniformType::Mat4:
-        program.setUniform_mat4float(uniform.name.c_str(), std::get<glm::mat4>(uniform.value));
+        issued = program.setUniform_mat4float(handle, std::get<glm::mat4>(uniform.value));
         break;
     case UniformType::Sampler2D: {
         const InspectorSampler2D& sampler = std::get<InspectorSampler2D>(uniform.value);
-        program.setUniform_int(uniform.name.c_str(), sampler.textureUnit);
+        issued = program.setUniform_int(handle, sampler.textureUnit);
         break;
     }
     case UniformType::SamplerCube: {
-        break; // don't do anything yet;
+        return; // don't do anything yet;
     }
     default:
         loggerPtr->addLog(LogLevel::WARNING, "applyUniform", "Invalid Uniform Type: "); 
-        break;
+        return;
     }
+
+    if (issued) uploadStats.issued++;
+    else uploadStats.skipped++;
+    program.stampUniform(handle, uniform.ID, uniform.generation);
     return;
 }
 
@@ -488,6 +513,8 @@ void InspectorEngine::applyFunction(ShaderProgram& program, const Uniform& unifo
         finalValue.value = getDefaultValue(finalValue.type);
     }
 
+    // the resolved value can change without the function uniform's generation moving, so only the value shadow applies
+    finalValue.generation = 0;
     applyUniform(program, finalValue);
 }
 
@@ -514,6 +541,7 @@ void InspectorEngine::reloadUniforms(unsigned int materialID) {
     namesToAvoid->insert("model");
     namesToAvoid->insert("view");
     namesToAvoid->insert("projection");
+    namesToAvoid->insert(LOD_UNIFORM_NAME); // set per draw by the Renderer
 
     UniformParser parser(loggerPtr);
     auto newUniforms = parser.parseUniforms(*matProgram, namesToAvoid.get());
@@ -535,7 +563,6 @@ void InspectorEngine::reloadUniforms(unsigned int materialID) {
             }
 
             uniformRegPtr->registerMaterialUniformMap(matID, newUniforms);
-            matProgram->use();
             applyAllUniformsForMaterial(matID);
         }
     }
@@ -554,51 +581,40 @@ void InspectorEngine::applyAllUniformsForPrimitive(unsigned int modelID, unsigne
         //loggerPtr->addLog(LogLevel::WARNING, "reloadUniforms", "material " + std::to_string(materialID) + " has no shader! or is not compiled");
         return;
     }
-    matProgram->use();
+    // the Renderer has already bound matProgram through its state cache
 
-    applySceneUniforms(*matProgram);
-    applyModelUniforms(*matProgram, modelID);
-    applyMaterialUniforms(*matProgram, modelID, materialID);
+    applyAllUniformsForPrimitive(*matProgram, modelID, materialID);
+}
+
+
+// expects program to be bound
+void InspectorEngine::applyAllUniformsForPrimitive(ShaderProgram& program, unsigned int modelID, unsigned int materialID) {
+    applySceneUniforms(program);
+    applyModelUniforms(program, modelID);
+    applyMaterialUniforms(program, modelID, materialID);
 }
 
 
 void InspectorEngine::applySceneUniforms(ShaderProgram& program) {
-    const auto sceneUniforms = uniformRegPtr->tryReadSceneUniforms();
-    if (sceneUniforms == nullptr) {
-        // ERRLOG.logEntry(EL_WARNING, "applyAllUniformsForMaterial", "object not found in uniform registry: ", modelID.c_str());
-        // Logger::addLog(LogLevel::WARNING, "applyAllUniformsForMaterial", "object not found in uniform registry: ", std::to_string(modelID)); 
-        return;
-    }
+    // these programs read projection/view from the scene buffer the Renderer fills once per frame
+    if (program.usesSceneBlock()) return;
 
-    for (auto& [uniformName, uniform] : *sceneUniforms) {
+    // runs per draw, so walk the registry's storage in place rather than copying it
+    for (const Uniform& uniform : uniformRegPtr->readSceneUniforms()) {
         applyUniform(program, uniform);
     }
 }
 
 
 void InspectorEngine::applyModelUniforms(ShaderProgram& program, unsigned int modelID) {
-    const auto modelUniforms = uniformRegPtr->tryReadModelUniforms(modelID);
-    if (modelUniforms == nullptr) {
-        // ERRLOG.logEntry(EL_WARNING, "applyAllUniformsForMaterial", "object not found in uniform registry: ", modelID.c_str());
-        // Logger::addLog(LogLevel::WARNING, "applyAllUniformsForMaterial", "object not found in uniform registry: ", std::to_string(modelID)); 
-        return;
-    }
-
-    for (auto& [uniformName, uniform] : *modelUniforms) {
+    for (const Uniform& uniform : uniformRegPtr->readModelUniforms(modelID)) {
         applyUniform(program, uniform);
     }
 }
 
 
 void InspectorEngine::applyMaterialUniforms(ShaderProgram& program, unsigned int modelID, unsigned int materialID) {
-    const auto materialUniforms = uniformRegPtr->tryReadMaterialUniforms(materialID);
-    if (materialUniforms == nullptr) {
-        // ERRLOG.logEntry(EL_WARNING, "applyAllUniformsForMaterial", "object not found in uniform registry: ", modelID.c_str());
-        // Logger::addLog(LogLevel::WARNING, "applyAllUniformsForMaterial", "object not found in uniform registry: ", std::to_string(modelID)); 
-        return;
-    }
-
-    for (auto& [uniformName, uniform] : *materialUniforms) {
+    for (const Uniform& uniform : uniformRegPtr->readMaterialUniforms(materialID)) {
         applyUniform(program, uniform);
     }
 }
@@ -660,15 +676,16 @@ const std::optional<InspectorEngine::MatChoices*> InspectorEngine::getMatChoices
 }
 
 const std::optional<std::vector<const char*>> InspectorEngine::getUniformChoices(unsigned int materialID, UniformType returnType) {
-    const auto uniforms = uniformRegPtr->tryReadMaterialUniforms(materialID);
-    if (uniforms == nullptr) {
+    if (!uniformRegPtr->containsMaterial(materialID)) {
         return std::nullopt;
     }
 
+    // names point into the registry's storage, so they outlive this call (unlike a tryRead copy)
+    const UniformView uniforms = uniformRegPtr->readMaterialUniforms(materialID);
     std::vector<const char*> uniformChoices{""};
-    uniformChoices.reserve(uniforms->size() + 1);
-    for (const auto& [name, uniform] : *uniforms) {
-        if (uniform.type == returnType) uniformChoices.push_back(name.c_str());
+    uniformChoices.reserve(uniforms.size() + 1);
+    for (const Uniform& uniform : uniforms) {
+        if (uniform.type == returnType) uniformChoices.push_back(uniform.name.c_str());
     }
 
     return uniformChoices;
@@ -27,6 +27,11 @@ public:
         std::vector<const char*> cstrings;
         std::vector<unsigned int> ids;
     };
+    // glUniform calls made vs. avoided because the program already held the value
+    struct UniformUploadStats {
+        unsigned int issued = 0;
+        unsigned int skipped = 0;
+    };
 
     InspectorEngine();
     bool initialize(Logger* _loggerPtr, ShaderRegistry* _shaderRegPtr, UniformRegistry* _uniformRegPtr, ModelCache* _modelCachePtr, ViewportUI* _viewportUIPtr, MaterialCache* _materialCachePtr, Platform* _platform);
@@ -41,6 +46,7 @@ public:
     UniformValue getDefaultValue(UniformType type);
 
     void applyAllUniformsForPrimitive(unsigned int modelID, unsigned int meshID, unsigned int materialID);
+    void applyAllUniformsForPrimitive(ShaderProgram& program, unsigned int modelID, unsigned int materialID); // program may be a variant
     void applySceneUniforms(ShaderProgram& program);
     void applyModelUniforms(ShaderProgram& program, unsigned int modelID);
     void applyMaterialUniforms(ShaderProgram& program, unsigned int modelID, unsigned int materialID);
@@ -48,6 +54,8 @@ public:
     const ModelChoices& getModelChoices();
     const std::optional<MatChoices*> getMatChoices(unsigned int modelID);
     const std::optional<std::vector<const char*>> getUniformChoices(unsigned int materialID, UniformType returnType);
+    const UniformUploadStats& getUniformUploadStats() const;
+    void resetUniformUploadStats();
 
 private:
     void applyFunction(ShaderProgram& program, const Uniform& uniform, const InspectorReference& function);
@@ -63,6 +71,8 @@ private:
     void applyUniform(ShaderProgram& program, const Uniform& uniform);
     void resetFunctionTree(const Uniform& uni);
 
+    UniformUploadStats uploadStats;
+
     bool mustUpdateChoices = true; // for now we can just set this to true every frame
     ModelChoices modelChoices;
     std::unordered_map<unsigned int, MatChoices> matChoices;
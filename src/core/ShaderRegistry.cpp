@@ -8,8 +8,8 @@
 ShaderRegistry::ShaderRegistry() {
     initialized = false;
     loggerPtr = nullptr;
-    factory_ = [](const char* v, const char* f, const char* n, const unsigned int d, Logger* l) {
-        return new ShaderProgram(v, f, n, d, l);
+    factory_ = [this](const char* v, const char* f, const char* n, const unsigned int d, Logger* l) {
+        return new ShaderProgram(v, f, n, d, l, ShaderProgram::CompileMode::Blocking, getBuildCaches());
     };
 }
 
@@ -24,6 +24,10 @@ bool ShaderRegistry::initialize(Logger* _loggerPtr, EventDispatcher* _eventsPtr,
     project = _project;
     project->programs.clear();
 
+    if (!project->projectRoot.empty() && !binaryCache.initialize(project->projectRoot / ".cache" / "programs")) {
+        loggerPtr->addLog(LogLevel::WARNING, "Shader Registry", "Could not create the program binary cache, every shader compiles from source.");
+    }
+
     // if (registerDefaults) { //TEMPADD
     //     if (!registerProgram(project->projectShadersDir / "tex.vert", project->projectShadersDir / "tex.frag", "tex")) return false;
     //     if (!registerProgram(project->projectShadersDir / "color.vert", project->projectShadersDir / "color.frag", "color")) return false;
@@ -39,6 +43,10 @@ bool ShaderRegistry::initialize(Logger* _loggerPtr, EventDispatcher* _eventsPtr,
 
 void ShaderRegistry::shutdown() {
     if (!initialized) return;
+    variantLookup.clear();
+    variants.clear();
+    pendingPrograms.clear();
+    preprocessor.clear();
     project->programs.clear();
     loggerPtr = nullptr;
     eventsPtr = nullptr;
@@ -62,6 +70,7 @@ bool ShaderRegistry::registerProgram(const std::filesystem::path& vertex_file, c
     unsigned int currID = nextID++;
 
     nameToIDMap.emplace(programName, currID);
+    revision++;
 
     project->programs.emplace(
         currID,
@@ -80,7 +89,10 @@ void ShaderRegistry::deleteProgram(const unsigned int ID) {
         return;
     }
     nameToIDMap.erase(prog->name);
+    pendingPrograms.erase(ID);
+    dropVariants(ID);
     project->programs.erase(ID);
+    revision++;
     eventsPtr->TriggerEvent(Event {EventType::ProgramDeleted, false, ProgramDeletedPayload { ID }});
 }
 
@@ -91,8 +103,12 @@ void ShaderRegistry::deleteProgram(const std::string& name) {
         return;
     }
     nameToIDMap.erase(prog->name);
-    project->programs.erase(prog->ID);
-    eventsPtr->TriggerEvent(Event {EventType::ProgramDeleted, false, ProgramDeletedPayload { prog->ID }});
+    unsigned int deletedID = prog->ID;
+    pendingPrograms.erase(deletedID);
+    dropVariants(deletedID);
+    project->programs.erase(deletedID);
+    revision++;
+    eventsPtr->TriggerEvent(Event {EventType::ProgramDeleted, false, ProgramDeletedPayload { deletedID }});
 }
 
 ShaderProgram* ShaderRegistry::getProgram(const unsigned int ID) const {
@@ -127,7 +143,118 @@ std::string ShaderRegistry::getProgramName(const unsigned int ID) const {
 void ShaderRegistry::replaceProgram(const unsigned int ID, std::unique_ptr<ShaderProgram> newProgram) {
     if (!newProgram) return;
 
+    if (newProgram->isPending()) {
+        logBlockingLinks();
+        pendingPrograms[ID] = std::move(newProgram);
+        return;
+    }
+    pendingPrograms.erase(ID);
+    dropVariants(ID);
     project->programs[ID] = std::move(newProgram);
+    revision++;
+    eventsPtr->TriggerEvent(Event {EventType::ProgramReplaced, false, ProgramReplacedPayload { ID }});
+}
+
+
+void ShaderRegistry::update() {
+    frame++;
+    pollVariants();
+
+    for (auto it = pendingPrograms.begin(); it != pendingPrograms.end();) {
+        if (!it->second->pollCompile()) {
+            ++it;
+            continue;
+        }
+
+        std::unique_ptr<ShaderProgram> finished = std::move(it->second);
+        unsigned int ID = it->first;
+        it = pendingPrograms.erase(it);
+        if (!finished->isCompiled()) {
+            loggerPtr->addLog(LogLevel::WARNING, "SHADERREGISTRY::update", "Keeping the previous version of " + finished->name + ", the new one did not compile");
+            continue;
+        }
+        if (!project->programs.contains(ID)) continue;
+
+        dropVariants(ID);
+        project->programs[ID] = std::move(finished);
+        revision++;
+        eventsPtr->TriggerEvent(Event {EventType::ProgramReplaced, false, ProgramReplacedPayload { ID }});
+    }
+}
+
+
+bool ShaderRegistry::isReplacementPending(const unsigned int ID) const {
+    return pendingPrograms.contains(ID);
+}
+
+
+ShaderProgram* ShaderRegistry::getVariant(const unsigned int ID, uint32_t features) {
+    ShaderProgram* base = getProgram(ID);
+    if (base == nullptr || !base->isCompiled()) return base;
+    features &= base->getVariantMask();
+    if (features == base->getVariant()) return base;
+
+    uint64_t key = ((uint64_t)ID << 32) | features;
+    auto found = variantLookup.find(key);
+    if (found == variantLookup.end()) {
+        auto program = std::make_unique<ShaderProgram>(base->vertPath.c_str(), base->fragPath.c_str(), base->name.c_str(), ID, loggerPtr,
+                                                       ShaderProgram::CompileMode::Deferred, getBuildCaches(), features);
+        if (program->isPending()) logBlockingLinks();
+        variants.push_front(Variant{ key, std::move(program), frame });
+        found = variantLookup.emplace(key, variants.begin()).first;
+        evictVariants();
+    }
+    else if (found->second != variants.begin()) {
+        variants.splice(variants.begin(), variants, found->second);
+    }
+    found->second->lastUsedFrame = frame;
+
+    // a fresh one is never polled here, that would link it in the middle of drawing
+    ShaderProgram* variant = found->second->program.get();
+    if (variant->isPending() || !variant->isCompiled()) return base;
+    return variant;
+}
+
+
+// Without the extension nothing can ask the driver whether a link is done, so update() finishes it
+// and the frame it happens in waits for it. Said once, so a hitch after saving a shader has a reason.
+void ShaderRegistry::logBlockingLinks() {
+    if (blockingLinkLogged || ShaderProgram::supportsParallelCompile()) return;
+    blockingLinkLogged = true;
+    loggerPtr->addLog(LogLevel::INFO, "SHADERREGISTRY", "GL_KHR_parallel_shader_compile is not available, reloaded shaders and variants link on the main thread a frame after they're submitted, which can stall that frame");
+}
+
+
+void ShaderRegistry::pollVariants() {
+    bool parallel = ShaderProgram::supportsParallelCompile();
+    for (Variant& variant : variants) {
+        if (!variant.program->isPending()) continue;
+        if (variant.program->pollCompile() && !parallel) break; // that was a blocking link, the rest wait a frame
+    }
+}
+
+
+void ShaderRegistry::evictVariants() {
+    while (variants.size() > MAX_VARIANTS && variants.back().lastUsedFrame != frame) {
+        variantLookup.erase(variants.back().key);
+        variants.pop_back();
+    }
+    if (variants.size() > MAX_VARIANTS && !variantLimitWarned) {
+        variantLimitWarned = true;
+        loggerPtr->addLog(LogLevel::WARNING, "SHADERREGISTRY::getVariant", "More than " + std::to_string(MAX_VARIANTS) + " shader variants are drawn in one frame, keeping all of them");
+    }
+}
+
+
+void ShaderRegistry::dropVariants(const unsigned int ID) {
+    for (auto it = variants.begin(); it != variants.end();) {
+        if ((it->key >> 32) != ID) {
+            ++it;
+            continue;
+        }
+        variantLookup.erase(it->key);
+        it = variants.erase(it);
+    }
 }
 // void ShaderRegistry::replaceProgram(const std::string& vertex_file, const std::string& fragment_file, const std::string& programName) {
 //     auto s = std::unique_ptr<ShaderProgram>(
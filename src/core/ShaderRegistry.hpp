@@ -5,9 +5,13 @@
 #include <iostream>
 #include <memory>
 #include <filesystem>
+#include <cstdint>
+#include <list>
 
 #include "application/Project.hpp"
 #include "engine/ShaderProgram.hpp"
+#include "engine/ProgramBinaryCache.hpp"
+#include "engine/ShaderPreprocessor.hpp"
 
 class Logger;
 class EventDispatcher;
@@ -25,15 +29,52 @@ public:
     ShaderProgram* getProgram(const unsigned int ID) const;
     ShaderProgram* getProgram(const std::string& name) const;
     std::string getProgramName(const unsigned int ID) const;
+    // A program still compiling (ShaderProgram::CompileMode::Deferred) waits until update() finds it
+    // linked, the old one keeps rendering until then. A newer replacement for the same ID wins.
     void replaceProgram(const unsigned int ID, std::unique_ptr<ShaderProgram> newProgram);
+    void update(); // swaps in finished replacements, once per frame
+
+    // The program compiled with the features (see engine/ShaderVariant.hpp) it reads. Variants start
+    // compiling on first use and update() picks them up on a later frame, the base program stands in
+    // until then or if one fails. Without GL_KHR_parallel_shader_compile finishing one is a link on the
+    // main thread, so update() finishes at most one of those per frame.
+    // The MAX_VARIANTS least recently used are kept, but a variant drawn with this frame is never
+    // evicted, a scene using more goes over the limit instead of recompiling every frame.
+    // Replacing or deleting a program drops its variants.
+    static constexpr size_t MAX_VARIANTS = 64;
+    ShaderProgram* getVariant(const unsigned int ID, uint32_t features);
+    size_t getNumberOfVariants() const { return variants.size(); }
+    bool isReplacementPending(const unsigned int ID) const;
     // void replaceProgram(const std::string& vertex_file, const std::string& fragment_file, const std::string& programName);
     const std::unordered_map<unsigned int, std::unique_ptr<ShaderProgram>>& getPrograms() const;
     size_t getNumberOfPrograms() const;
     void setFactory(ShaderFactoryFn fn);
     unsigned int getAndUpdateNextID();
+    ShaderBuildCaches getBuildCaches() { return ShaderBuildCaches{ &preprocessor, &binaryCache }; }
+    uint64_t getRevision() const { return revision; } // changes whenever a program is added, replaced or deleted
 private:
     unsigned int nextID = 0;
+    uint64_t revision = 0;
+    uint64_t frame = 0; // counted by update()
     std::unordered_map<std::string, unsigned int> nameToIDMap;
+    ProgramBinaryCache binaryCache; // <project>/.cache/programs
+    ShaderPreprocessor preprocessor;
+
+    struct Variant {
+        uint64_t key; // [program ID] << 32 | features
+        std::unique_ptr<ShaderProgram> program;
+        uint64_t lastUsedFrame;
+    };
+    std::list<Variant> variants; // most recently used first
+    std::unordered_map<uint64_t, std::list<Variant>::iterator> variantLookup;
+    bool variantLimitWarned = false;
+    bool blockingLinkLogged = false;
+
+    void logBlockingLinks();
+    void pollVariants();
+    void evictVariants();
+    void dropVariants(const unsigned int ID);
+    std::unordered_map<unsigned int, std::unique_ptr<ShaderProgram>> pendingPrograms; // [program ID] <-> its compiling replacement
     bool initialized = false;
     Logger* loggerPtr = nullptr;
     EventDispatcher* eventsPtr = nullptr;
@@ -2,6 +2,7 @@
 #include "core/UniformTypes.hpp"
 #include "core/logging/LogSink.hpp"
 #include "core/logging/Logger.hpp"
+#include "engine/SceneBlock.hpp"
 #include <sys/stat.h>
 #include <unordered_map>
 #include <unordered_set>
@@ -26,6 +27,7 @@ std::unordered_map<std::string, Uniform> UniformParser::parseUniforms(const Shad
     std::unordered_map<std::string, std::string> defineMap;
     std::string currentStructName;
     std::string typeName;
+    std::unordered_set<std::string> seenBlocks;
     
     LastTokenWas lastTokenWas = LastTokenWas::IgnoreLastToken;
     ParseState state = ParseState::Default;
@@ -33,7 +35,11 @@ std::unordered_map<std::string, Uniform> UniformParser::parseUniforms(const Shad
         std::string& token = tokens[i];
         switch (lastTokenWas) {
             case LastTokenWas::IgnoreLastToken: {
-                if (token == "uniform") {
+                if (token == "uniform" && isUniformBlock(tokens, i, structDefinitions)) {
+                    // interface block members can't be set with glUniform, so they never become inspector uniforms
+                    i = skipUniformBlock(tokens, i, seenBlocks);
+                }
+                else if (token == "uniform") {
                     lastTokenWas = LastTokenWas::Uniform;
                     state = ParseState::UniformDeclaration;
                 }
@@ -316,6 +322,55 @@ void UniformParser::handleUniformName(
     return;
 }
 
+// uniform <BlockName> { ... } as opposed to uniform <type> <name>
+bool UniformParser::isUniformBlock(
+    const std::vector<std::string>& tokens,
+    int uniformIndex,
+    const std::unordered_map<std::string, std::vector<UniformInStruct>>& structDefinitions
+) {
+    if (uniformIndex + 2 >= (int)tokens.size()) return false;
+    const std::string& name = tokens[uniformIndex + 1];
+    if (glslTypeMap.contains(name) || structDefinitions.contains(name)) return false;
+    return tokens[uniformIndex + 2] == "{";
+}
+
+// returns the index of the ';' that closes the block declaration
+int UniformParser::skipUniformBlock(const std::vector<std::string>& tokens, int uniformIndex, std::unordered_set<std::string>& seenBlocks) {
+    const std::string& blockName = tokens[uniformIndex + 1];
+
+    // the layout qualifier comes before "uniform": layout ( std140 ) uniform Name {
+    bool isStd140 = false;
+    if (uniformIndex > 0 && tokens[uniformIndex - 1] == ")") {
+        for (int i = uniformIndex - 2; i >= 0 && tokens[i] != "("; i--) {
+            if (tokens[i] == "std140") isStd140 = true;
+        }
+    }
+
+    // vert and frag are parsed as one source, only report each block once
+    if (!seenBlocks.contains(blockName)) {
+        seenBlocks.insert(blockName);
+        if (blockName == SCENE_BLOCK_NAME && !isStd140) {
+            loggerPtr->addLog(LogLevel::WARNING, "UniformParser::parseUniforms", "SceneBlock should be declared layout(std140) to match the scene buffer");
+        }
+        else if (blockName != SCENE_BLOCK_NAME) {
+            loggerPtr->addLog(LogLevel::INFO, "UniformParser::parseUniforms", "uniform block " + blockName + " is not filled by the sandbox, its members won't show in the inspector");
+        }
+    }
+
+    int depth = 0;
+    int i = uniformIndex + 2;
+    for (; i < (int)tokens.size(); i++) {
+        if (tokens[i] == "{") depth++;
+        else if (tokens[i] == "}") {
+            depth--;
+            if (depth == 0) break;
+        }
+    }
+    // optional instance name (and array size) follow the closing brace
+    while (i < (int)tokens.size() && tokens[i] != ";") i++;
+    return i;
+}
+
 // return a new vector of tokens
 std::vector<std::string>  UniformParser::processDefines(const std::vector<std::string>& tokens) {
     std::unordered_map<std::string, std::vector<std::string>> defines; 
@@ -30,6 +30,12 @@ private:
         int tokenIndex,
         const std::string& structName = ""   // optional: "" at top level, parent name when recursing
     );
+    bool isUniformBlock(
+        const std::vector<std::string>& tokens,
+        int uniformIndex,
+        const std::unordered_map<std::string, std::vector<UniformInStruct>>& structDefinitions
+    );
+    int skipUniformBlock(const std::vector<std::string>& tokens, int uniformIndex, std::unordered_set<std::string>& seenBlocks);
     void addUniform(
         std::unordered_map<std::string, Uniform>& programUniforms,
         const std::string& uniformName,
@@ -2,11 +2,25 @@
 #include "core/logging/Logger.hpp"
 #include "application/Project.hpp"
 
+#include <type_traits>
+
+// Whether uploading b over a would be a no-op. Reference values resolve at apply time, so they always count as changed.
+static bool isSameValue(const UniformValue& a, const UniformValue& b) {
+    if (a.index() != b.index()) return false;
+    return std::visit([&b](const auto& lhs) -> bool {
+        using T = std::decay_t<decltype(lhs)>;
+        const T& rhs = std::get<T>(b);
+        if constexpr (std::is_same_v<T, InspectorSampler2D>) return lhs.textureUnit == rhs.textureUnit;
+        else if constexpr (std::is_same_v<T, InspectorReference>) return false;
+        else return lhs == rhs;
+    }, a);
+}
+
 
 UniformRegistry::UniformRegistry() {
     initialized = false;
     materialUniforms.clear();
-    sceneUniforms.clear();
+    sceneUniforms = UniformScope{};
     modelUniforms.clear();
 
     project = nullptr;
@@ -21,7 +35,7 @@ bool UniformRegistry::initialize(Logger* _loggerPtr, Project* _project) {
     loggerPtr = _loggerPtr;
     project = _project;
     materialUniforms.clear();
-    sceneUniforms.clear();
+    sceneUniforms = UniformScope{};
     modelUniforms.clear();
     initialized = true;
     return true;
@@ -31,7 +45,7 @@ void UniformRegistry::shutdown() {
     loggerPtr = nullptr;
     project = nullptr;
     materialUniforms.clear();
-    sceneUniforms.clear();
+    sceneUniforms = UniformScope{};
     modelUniforms.clear();
     initialized = false;
 }
@@ -75,11 +89,43 @@ bool UniformRegistry::updateUniform(unsigned int id, Uniform uniform) {
         return false;;
     }
     else {
-        project->uniforms[id] = uniform;
+        Uniform& stored = project->uniforms[id];
+        uniform.generation = isSameValue(stored.value, uniform.value) ? stored.generation : stored.generation + 1;
+        stored = uniform;
         return true;
     }
 }
 
+// Assigns the uniform its ID (reusing the one already registered under its name) and stores it.
+// New uniforms are appended to the scope's contiguous list so render code can walk them without lookups.
+void UniformRegistry::storeInScope(UniformScope& scope, Uniform& uniform) {
+    const auto namePair = scope.nameToID.find(uniform.name);
+    if (namePair != scope.nameToID.end()) {
+        uniform.ID = namePair->second;
+        Uniform& stored = project->uniforms[uniform.ID];
+        // renderAll re-registers the camera and model matrices every frame, most of the time unchanged
+        uniform.generation = isSameValue(stored.value, uniform.value) ? stored.generation : stored.generation + 1;
+        stored = uniform;
+        return;
+    }
+
+    uniform.ID = nextID;
+    nextID++;
+    uniform.generation = 1;
+    scope.nameToID[uniform.name] = uniform.ID;
+    // unordered_map nodes never move, so this pointer stays valid until the uniform is erased
+    const auto [uniformPair, inserted] = project->uniforms.insert_or_assign(uniform.ID, uniform);
+    scope.uniforms.push_back(&uniformPair->second);
+}
+
+void UniformRegistry::eraseFromScope(UniformScope& scope, unsigned int uniformID) {
+    const auto uniformPair = project->uniforms.find(uniformID);
+    if (uniformPair == project->uniforms.end()) return;
+
+    std::erase(scope.uniforms, &uniformPair->second);
+    project->uniforms.erase(uniformPair);
+}
+
 // returns nullptr if uniform doesn't exist
 const Uniform* UniformRegistry::tryReadMaterialUniform(unsigned int materialID, const std::string& uniformName) const {
     const auto& programPair = materialUniforms.find(materialID);
@@ -89,7 +135,7 @@ const Uniform* UniformRegistry::tryReadMaterialUniform(unsigned int materialID,
         return nullptr;
     }
 
-    auto& programUniforms = programPair->second;
+    auto& programUniforms = programPair->second.nameToID;
     
     if (!programUniforms.contains(uniformName)) {
         // see previous comment
@@ -113,7 +159,7 @@ bool UniformRegistry::containsMaterialUniform(unsigned int matID, const std::str
         return false;
     }
 
-    auto& programUniforms = programPair->second;
+    auto& programUniforms = programPair->second.nameToID;
     
     const auto uniformPair = programUniforms.find(uniformName);
     if (uniformPair == programUniforms.end()) {
@@ -125,106 +171,88 @@ bool UniformRegistry::containsMaterialUniform(unsigned int matID, const std::str
 
 void UniformRegistry::eraseMaterialUniform(unsigned int matID, const std::string& uniformName) {
     if (!materialUniforms.contains(matID)) return;
-    if (!materialUniforms.at(matID).contains(uniformName)) return;
-    unsigned int id = materialUniforms.at(matID).at(uniformName);
+    UniformScope& scope = materialUniforms.at(matID);
+    if (!scope.nameToID.contains(uniformName)) return;
+    unsigned int id = scope.nameToID.at(uniformName);
     if (!project->uniforms.contains(id)) return;
-    project->uniforms.erase(id);
-    materialUniforms.at(matID).erase(uniformName);
+    eraseFromScope(scope, id);
+    scope.nameToID.erase(uniformName);
 
 }
 
 void UniformRegistry::registerMaterialUniformMap(unsigned int matID, std::unordered_map<std::string, Uniform>& map) {
-    if (!materialUniforms.contains(matID)) materialUniforms[matID]; 
+    UniformScope& scope = materialUniforms[matID];
 
     for (auto& [name, uniformRef] : map) {
-        if (materialUniforms.at(matID).contains(name)) {
-            unsigned int prevId = materialUniforms.at(matID).at(name);
-            uniformRef.ID = prevId;
-        }
-        else {
-            uniformRef.ID = nextID;
-            nextID++;
-        }
         uniformRef.materialID = matID;
-        project->uniforms[uniformRef.ID] = uniformRef;
-        materialUniforms[matID][name] = uniformRef.ID;
+        storeInScope(scope, uniformRef);
     }
 }
 
 void UniformRegistry::registerMaterialUniform(unsigned int materialID, Uniform uniform) {
-    if (materialUniforms.contains(materialID) && materialUniforms.at(materialID).contains(uniform.name)) {
-        unsigned int prevId = materialUniforms.at(materialID).at(uniform.name);
-        uniform.ID = prevId;
-    }
-    else {
-        uniform.ID = nextID;
-        nextID++;
-        materialUniforms[materialID][uniform.name] = uniform.ID;
-    }
     uniform.materialID = materialID;
-    project->uniforms[uniform.ID] = uniform;
+    storeInScope(materialUniforms[materialID], uniform);
 }
 
 
 void UniformRegistry::registerSceneUniform(Uniform uniform) {
-    if (sceneUniforms.contains(uniform.name)) {
-        unsigned int prevId = sceneUniforms.at(uniform.name);
-        uniform.ID = prevId;
-    }
-    else {
-        uniform.ID = nextID;
-        nextID++;
-        sceneUniforms[uniform.name] = uniform.ID;
-    }
-    project->uniforms[uniform.ID] = uniform;
+    storeInScope(sceneUniforms, uniform);
 }
 
 
 void UniformRegistry::registerModelUniform(unsigned int modelID, Uniform uniform) {
-    if (modelUniforms.contains(modelID) && modelUniforms.at(modelID).contains(uniform.name)) {
-        unsigned int prevId = modelUniforms.at(modelID).at(uniform.name);
-        uniform.ID = prevId;
-    }
-    else {
-        uniform.ID = nextID;
-        nextID++;
-        modelUniforms[modelID][uniform.name] = uniform.ID;
-    }
-    project->uniforms[uniform.ID] = uniform;
+    storeInScope(modelUniforms[modelID], uniform);
 }
 
 
 
 size_t UniformRegistry::getSceneUniformsSize() {
-    return sceneUniforms.size();
+    return sceneUniforms.nameToID.size();
 }
 size_t UniformRegistry::getModelUniformsSize(unsigned int modelID) {
     if (!modelUniforms.contains(modelID)) return 0;
-    return modelUniforms[modelID].size();
+    return modelUniforms[modelID].nameToID.size();
 }
 size_t UniformRegistry::getMaterialUniformsSize(unsigned int matID) {
     if (!materialUniforms.contains(matID)) return 0;
-    return materialUniforms[matID].size();
+    return materialUniforms[matID].nameToID.size();
 }
 
-const std::unique_ptr<std::unordered_map<std::string, Uniform>> UniformRegistry::tryReadSceneUniforms() const {
-    if (sceneUniforms.size() <= 0) {
-        // Errorlog::getInstance().logEntry(EL_WARNING, "tryReadUniforms", "No object found in Uniform Registry with ID");
-        return nullptr;
-    }
+UniformView UniformRegistry::readSceneUniforms() const {
+    return UniformView(sceneUniforms.uniforms);
+}
 
-    //std::unique_ptr<std::unordered_map<std::string, Uniform>> programUniforms = &uniforms[modelID];
+UniformView UniformRegistry::readModelUniforms(unsigned int modelID) const {
+    const auto modelPair = modelUniforms.find(modelID);
+    if (modelPair == modelUniforms.end()) return UniformView();
+    return UniformView(modelPair->second.uniforms);
+}
+
+UniformView UniformRegistry::readMaterialUniforms(unsigned int materialID) const {
+    const auto materialPair = materialUniforms.find(materialID);
+    if (materialPair == materialUniforms.end()) return UniformView();
+    return UniformView(materialPair->second.uniforms);
+}
+
+std::unique_ptr<std::unordered_map<std::string, Uniform>> UniformRegistry::copyScope(const UniformScope& scope) const {
     std::unique_ptr<std::unordered_map<std::string, Uniform>> unis = std::make_unique<std::unordered_map<std::string, Uniform>>();
-    for (auto& [name, id] : sceneUniforms) {
-        if (!project->uniforms.contains(id)) {
-            loggerPtr->addLog(LogLevel::LOG_ERROR, "ReadSceneproject->uniforms", "uniform doesn't exist when it should!");
-        }
-        (*unis.get())[name] = project->uniforms.at(id);
+    unis->reserve(scope.uniforms.size());
+    for (const Uniform* uniform : scope.uniforms) {
+        (*unis.get())[uniform->name] = *uniform;
     }
 
     return unis;
 }
 
+const std::unique_ptr<std::unordered_map<std::string, Uniform>> UniformRegistry::tryReadSceneUniforms() const {
+    if (sceneUniforms.nameToID.size() <= 0) {
+        // Errorlog::getInstance().logEntry(EL_WARNING, "tryReadUniforms", "No object found in Uniform Registry with ID");
+        return nullptr;
+    }
+
+    return copyScope(sceneUniforms);
+}
+
 
 const std::unique_ptr<std::unordered_map<std::string, Uniform>> UniformRegistry::tryReadModelUniforms(unsigned int modelID) const {
     if (modelUniforms.count(modelID) <= 0) {
@@ -232,16 +260,7 @@ const std::unique_ptr<std::unordered_map<std::string, Uniform>> UniformRegistry:
         return nullptr;
     }
 
-    //std::unique_ptr<std::unordered_map<std::string, Uniform>> programUniforms = &uniforms[modelID];
-    std::unique_ptr<std::unordered_map<std::string, Uniform>> unis = std::make_unique<std::unordered_map<std::string, Uniform>>();
-    for (auto& [name, id] : modelUniforms.at(modelID)) {
-        if (!project->uniforms.contains(id)) {
-            loggerPtr->addLog(LogLevel::LOG_ERROR, "ReadSceneproject->uniforms", "uniform doesn't exist when it should!");
-        }
-        (*unis.get())[name] = project->uniforms.at(id);
-    }
-
-    return unis;
+    return copyScope(modelUniforms.at(modelID));
 }
 
 
@@ -251,22 +270,13 @@ const std::unique_ptr<std::unordered_map<std::string, Uniform>> UniformRegistry:
         return nullptr;
     }
 
-    //std::unique_ptr<std::unordered_map<std::string, Uniform>> programUniforms = &uniforms[modelID];
-    std::unique_ptr<std::unordered_map<std::string, Uniform>> unis = std::make_unique<std::unordered_map<std::string, Uniform>>();
-    for (auto& [name, id] : (materialUniforms.at(materialID))) {
-        if (!project->uniforms.contains(id)) {
-            loggerPtr->addLog(LogLevel::LOG_ERROR, "ReadSceneproject->uniforms", "uniform doesn't exist when it should!");
-        }
-        (*unis.get())[name] = project->uniforms.at(id);
-    }
-
-    return unis;
+    return copyScope(materialUniforms.at(materialID));
 }
 
 void UniformRegistry::eraseMaterial(unsigned int matID) {
     if (!materialUniforms.contains(matID)) return;
 
-    for (const auto& [name, uniformID] : materialUniforms.at(matID)) {
+    for (const auto& [name, uniformID] : materialUniforms.at(matID).nameToID) {
         project->uniforms.erase(uniformID);
     }
 
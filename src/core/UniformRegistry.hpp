@@ -3,10 +3,50 @@
 #include <unordered_map>
 #include <string>
 #include <memory>
+#include <vector>
+#include <span>
+#include <iterator>
 
 class Logger;
 struct Project;
 
+// Non-owning view over the uniforms of one scope (scene, a model or a material).
+// Iterating hands out references straight into the project's uniform storage, nothing is copied.
+// A view is invalidated when uniforms are registered into or erased from its scope.
+class UniformView {
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = Uniform;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const Uniform*;
+        using reference         = const Uniform&;
+
+        Iterator() = default;
+        explicit Iterator(const Uniform* const* _current) : current(_current) {}
+        reference operator*() const { return **current; }
+        pointer operator->() const { return *current; }
+        Iterator& operator++() { ++current; return *this; }
+        Iterator operator++(int) { Iterator prev = *this; ++current; return prev; }
+        bool operator==(const Iterator& other) const = default;
+
+    private:
+        const Uniform* const* current = nullptr;
+    };
+
+    UniformView() = default;
+    explicit UniformView(std::span<const Uniform* const> _uniforms) : uniforms(_uniforms) {}
+
+    Iterator begin() const { return Iterator(uniforms.data()); }
+    Iterator end() const { return Iterator(uniforms.data() + uniforms.size()); }
+    size_t size() const { return uniforms.size(); }
+    bool empty() const { return uniforms.empty(); }
+
+private:
+    std::span<const Uniform* const> uniforms;
+};
+
 class UniformRegistry {
     public:
     UniformRegistry();
@@ -23,6 +63,12 @@ class UniformRegistry {
     const std::unique_ptr<std::unordered_map<std::string, Uniform>> tryReadModelUniforms(unsigned int modelID) const;
     const std::unique_ptr<std::unordered_map<std::string, Uniform>> tryReadMaterialUniforms(unsigned int materialID) const;
 
+    // Allocation free alternatives to the tryRead*Uniforms copies, used by the render path.
+    // An unknown model or material returns an empty view.
+    UniformView readSceneUniforms() const;
+    UniformView readModelUniforms(unsigned int modelID) const;
+    UniformView readMaterialUniforms(unsigned int materialID) const;
+
     size_t getSceneUniformsSize();
     size_t getModelUniformsSize(unsigned int modelID);
     size_t getMaterialUniformsSize(unsigned int matID);
@@ -38,11 +84,20 @@ class UniformRegistry {
     void eraseMaterial(unsigned int matID);
 
     private:
+    struct UniformScope {
+        std::unordered_map<std::string, unsigned int> nameToID;
+        std::vector<const Uniform*> uniforms; // points into project->uniforms, one entry per ID in nameToID
+    };
+
+    void storeInScope(UniformScope& scope, Uniform& uniform);
+    void eraseFromScope(UniformScope& scope, unsigned int uniformID);
+    std::unique_ptr<std::unordered_map<std::string, Uniform>> copyScope(const UniformScope& scope) const;
+
     unsigned int nextID = 0;
     bool initialized = false;
     Logger* loggerPtr = nullptr;
     Project* project = nullptr;
-    std::unordered_map<std::string, unsigned int> sceneUniforms; // Uniforms global to the scene
-    std::unordered_map<unsigned int, std::unordered_map<std::string, unsigned int>> modelUniforms; // uniforms that apply to every material in the model
-    std::unordered_map<unsigned int, std::unordered_map<std::string, unsigned int>> materialUniforms;
+    UniformScope sceneUniforms; // Uniforms global to the scene
+    std::unordered_map<unsigned int, UniformScope> modelUniforms; // uniforms that apply to every material in the model
+    std::unordered_map<unsigned int, UniformScope> materialUniforms;
 };
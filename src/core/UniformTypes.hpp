@@ -1,6 +1,7 @@
 // UniformTypes.hpp
 #pragma once
 
+#include <cstdint>
 #include <optional>
 #include <string>
 #include <variant>
@@ -93,6 +94,7 @@ struct Uniform {
     bool useAlternateEditor = false; // This setting is for the color picker, etc.
     bool invisible = false;
     bool hasLocation = true;
+    uint64_t generation = 0; // bumped by the registry whenever the stored value changes. 0 = never stored
 };
 
 inline std::optional<std::vector<std::string>> getObjectData(UniformType type) {
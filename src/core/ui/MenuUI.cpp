@@ -3,6 +3,11 @@
 #include <glad/glad.h>
 #include <stb_image.h>
 
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
 #include "application/AppContext.hpp"
 #include "core/EventDispatcher.hpp"
 #include "core/input/Keybinds.hpp"
@@ -164,6 +169,31 @@ static void DrawAppIcon(unsigned int iconTex, float barH)
     ImGui::SameLine(0.0f, style.ItemSpacing.x);
 }
 
+void MenuUI::drawImportStatus()
+{
+    std::vector<AssimpImporter::ImportStatus> imports = appctx->assimp_importer.getActiveImports();
+    for (const AssimpImporter::ImportStatus& import : imports)
+    {
+        ImGui::PushID((int)import.ticket);
+        ImGui::SameLine();
+
+        std::string fileName = std::filesystem::path(import.path).filename().string();
+        ImGui::TextDisabled("%s", fileName.c_str());
+        ImGui::SameLine();
+
+        char overlay[32];
+        snprintf(overlay, sizeof(overlay), import.cancelling ? "cancelling" : "%d%%", (int)(import.progress * 100.0f));
+        ImGui::ProgressBar(import.progress, ImVec2(120.0f, 0.0f), overlay);
+
+        if (!import.cancelling)
+        {
+            ImGui::SameLine();
+            if (ImGui::SmallButton("Cancel")) appctx->assimp_importer.cancelImport(import.ticket);
+        }
+        ImGui::PopID();
+    }
+}
+
 void MenuUI::drawMenuBar()
 {
     ImGuiIO& io = ImGui::GetIO();
@@ -197,6 +227,7 @@ void MenuUI::drawMenuBar()
             PopMenuPopupStyle();
 
             ImGui::Text(appctx->project.projectTitle.c_str());
+            drawImportStatus();
             
             // ---- Right-side window buttons ----
             const ImGuiStyle& style = ImGui::GetStyle();
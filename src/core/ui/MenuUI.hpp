@@ -34,5 +34,6 @@ private:
     int prevMousePosX = 0;
     int prevMousePosY = 0;
     void drawMenuBar();
+    void drawImportStatus(); // progress and cancel for models still importing in the background
     void drawMenuItem(const MenuItem& item);
 };
@@ -17,9 +17,26 @@
 #include "core/ui/modals/ModalManager.hpp"
 #include "core/ui/Fonts.hpp"
 #include <glm/glm.hpp>
+#include <algorithm>
+#include <cstdio>
 #include <string>
 #include <vector>
 
+namespace {
+    std::string formatBytes(size_t bytes) {
+        const char* units[] = { "B", "KB", "MB", "GB" };
+        double value = (double)bytes;
+        int unit = 0;
+        while (value >= 1024.0 && unit < 3) {
+            value /= 1024.0;
+            unit++;
+        }
+        char text[32];
+        std::snprintf(text, sizeof(text), unit == 0 ? "%.0f %s" : "%.1f %s", value, units[unit]);
+        return text;
+    }
+}
+
 bool ObjectsInspectorUI::drawCompactHeader(const std::string& label) {
     ImGui::PushStyleColor(ImGuiCol_Header, theme.headerColor);
     ImGui::PushStyleColor(ImGuiCol_HeaderHovered, theme.headerColorHovered);
@@ -206,6 +223,7 @@ void ObjectsInspectorUI::draw(Logger* loggerPtr, InspectorEngine* inspectorEngPt
                     }
                     drawMeshesMenu(model, materialCachePtr, modelCachePtr, loggerPtr);
                     drawInstancesMenu(model, modelCachePtr, loggerPtr);
+                    drawMemoryMenu(model);
                     drawAdditionalMenu(model, modelCachePtr, loggerPtr);
                     ImGui::Unindent(theme.indentSize);
 
@@ -341,30 +359,151 @@ bool ObjectsInspectorUI::drawInstancesMenu(Model* model, ModelCache* modelCacheP
     ImGui::Text("Number of Instances:");
     ImGui::SameLine();
 
-    ImGui::SetNextItemWidth(40.0f);
+    ImGui::SetNextItemWidth(80.0f);
     ImGui::InputInt("##InstanceCount", &numOfInstances, 0, 0);
     if (ImGui::IsItemDeactivatedAfterEdit()) {
         if (numOfInstances > 0) {
             model->setInstanceCount(numOfInstances);
         }
     }
+    drawInstanceGeneratorMenu(model, modelCachePtr);
 
+    // instance counts can reach the tens of thousands, only build widgets for the visible rows
     const std::vector<InstanceData>& instanceData = model->getInstanceData();
-    for (unsigned int idx = 0; idx < model->getInstanceCount(); idx++) {
-        ImGui::PushID(idx);
+    ImGuiListClipper clipper;
+    clipper.Begin((int)model->getInstanceCount());
+    while (clipper.Step()) {
+        for (int idx = clipper.DisplayStart; idx < clipper.DisplayEnd; idx++) {
+            ImGui::PushID(idx);
+
+            InstanceData currInstanceData = instanceData[idx];
+            bool changed = false;
+            ImGui::Text("%s", ("Instance " + std::to_string(idx + 1)).c_str());
+            ImGui::SameLine();
+            ImGui::SetNextItemWidth(140.0f);
+            ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, theme.dragFloatPadding);
+            changed |= ImGui::DragFloat3("##Position##xx", &currInstanceData.pos.x, .05f);
+            ImGui::SameLine();
+            changed |= ImGui::ColorEdit4("##Custom", &currInstanceData.custom.x, ImGuiColorEditFlags_NoInputs | ImGuiColorEditFlags_Float);
 
-        InstanceData currInstanceData = instanceData[idx];
-        ImGui::Text("%s", ("Instance " + std::to_string(idx + 1)).c_str());
-        ImGui::SameLine();
-        ImGui::SetNextItemWidth(140.0f);
-        ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, theme.dragFloatPadding);
-        if (ImGui::DragFloat3("##Position##xx", &currInstanceData.pos.x, .05f)) {
-            model->setInstancePosition(idx, currInstanceData.pos);
+            ImGui::Text("  Rot");
+            ImGui::SameLine();
+            ImGui::SetNextItemWidth(140.0f);
+            changed |= ImGui::DragFloat3("##Rotation", &currInstanceData.rotation.x, .5f);
+            ImGui::SameLine();
+            ImGui::Text("Scale");
+            ImGui::SameLine();
+            ImGui::SetNextItemWidth(140.0f);
+            changed |= ImGui::DragFloat3("##Scale", &currInstanceData.scale.x, .01f);
+            ImGui::PopStyleVar();
+
+            if (changed) {
+                model->setInstance(idx, currInstanceData);
+            }
+            ImGui::PopID();
         }
-        ImGui::PopStyleVar();
-        
-        ImGui::PopID();
     }
+    clipper.End();
+    ImGui::Unindent(theme.indentSize);
+    return true;
+}
+
+void ObjectsInspectorUI::drawInstanceGeneratorMenu(Model* model, ModelCache* modelCachePtr) {
+    if (!ImGui::TreeNode("Generate")) return;
+
+    auto [menuIter, inserted] = instanceGeneratorMenus.try_emplace(model->ID, model->getInstanceGenerator());
+    InstanceGeneratorParams& params = menuIter->second;
+    if (params.type == InstanceGeneratorType::None) params.type = InstanceGeneratorType::Grid;
+
+    const char* typeNames[] = { "Grid", "Scatter", "Spiral", "Mesh vertices" };
+    int typeIdx = static_cast<int>(params.type) - 1;
+    ImGui::SetNextItemWidth(140.0f);
+    if (ImGui::Combo("Type", &typeIdx, typeNames, IM_ARRAYSIZE(typeNames))) {
+        params.type = static_cast<InstanceGeneratorType>(typeIdx + 1);
+    }
+
+    ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, theme.dragFloatPadding);
+    ImGui::SetNextItemWidth(140.0f);
+    switch (params.type) {
+        case InstanceGeneratorType::Grid: {
+            int counts[3] = { (int)params.gridCount.x, (int)params.gridCount.y, (int)params.gridCount.z };
+            if (ImGui::DragInt3("Count", counts, 1.0f, 1, 1024)) {
+                params.gridCount = glm::uvec3(glm::max(glm::ivec3(counts[0], counts[1], counts[2]), glm::ivec3(1)));
+            }
+            ImGui::SetNextItemWidth(140.0f);
+            ImGui::DragFloat3("Spacing", &params.spacing.x, 0.05f);
+            break;
+        }
+        case InstanceGeneratorType::Scatter: {
+            int count = (int)params.count;
+            if (ImGui::DragInt("Count", &count, 10.0f, 1, (int)Model::MAX_INSTANCES)) params.count = (unsigned int)std::max(count, 1);
+            ImGui::SetNextItemWidth(140.0f);
+            ImGui::DragFloat3("Box min", &params.boxMin.x, 0.1f);
+            ImGui::SetNextItemWidth(140.0f);
+            ImGui::DragFloat3("Box max", &params.boxMax.x, 0.1f);
+            ImGui::Checkbox("Even spread", &params.stratify);
+            break;
+        }
+        case InstanceGeneratorType::Spiral: {
+            int count = (int)params.count;
+            if (ImGui::DragInt("Count", &count, 10.0f, 1, (int)Model::MAX_INSTANCES)) params.count = (unsigned int)std::max(count, 1);
+            ImGui::SetNextItemWidth(140.0f);
+            ImGui::DragFloat("Radius step", &params.radiusStep, 0.005f);
+            ImGui::SetNextItemWidth(140.0f);
+            ImGui::DragFloat("Angle step", &params.angleStep, 0.01f);
+            ImGui::SetNextItemWidth(140.0f);
+            ImGui::DragFloat("Height step", &params.heightStep, 0.005f);
+            break;
+        }
+        case InstanceGeneratorType::MeshVertices: {
+            int sourceModelID = params.sourceModelID == UINT32_MAX ? -1 : (int)params.sourceModelID;
+            if (ImGui::InputInt("Source model ID", &sourceModelID)) params.sourceModelID = sourceModelID < 0 ? UINT32_MAX : (unsigned int)sourceModelID;
+            int sourceMeshIdx = (int)params.sourceMeshIdx;
+            ImGui::SetNextItemWidth(140.0f);
+            if (ImGui::InputInt("Source mesh", &sourceMeshIdx)) params.sourceMeshIdx = (unsigned int)std::max(sourceMeshIdx, 0);
+            break;
+        }
+        case InstanceGeneratorType::None:
+            break;
+    }
+
+    ImGui::SetNextItemWidth(140.0f);
+    ImGui::DragFloat("Random yaw", &params.randomYaw, 1.0f, 0.0f, 360.0f);
+    ImGui::SetNextItemWidth(140.0f);
+    ImGui::DragFloat2("Scale range", &params.scaleRange.x, 0.01f, 0.0f, 100.0f);
+    int seed = (int)params.seed;
+    ImGui::SetNextItemWidth(140.0f);
+    if (ImGui::InputInt("Seed", &seed)) params.seed = (uint32_t)seed;
+    ImGui::PopStyleVar();
+
+    if (ImGui::Button("Generate")) {
+        modelCachePtr->generateInstances(model->ID, params);
+    }
+    ImGui::TreePop();
+}
+
+bool ObjectsInspectorUI::drawMemoryMenu(Model* currModel) {
+    bool isOpen = ImGui::CollapsingHeader("Memory");
+    if (!isOpen) return false;
+
+    ImGui::Indent(theme.indentSize);
+
+    MeshMemory memory = currModel->getMemoryUsage();
+    ImGui::Text("CPU: %s", formatBytes(memory.cpuBytes).c_str());
+    if (memory.mappedBytes > 0) {
+        ImGui::SameLine();
+        ImGui::TextDisabled("(+ %s mapped)", formatBytes(memory.mappedBytes).c_str());
+    }
+    ImGui::Text("GPU: %s", formatBytes(memory.gpuBytes).c_str());
+
+    bool keepCPUCopy = currModel->getMeshRetention() == MeshRetention::KeepCPUCopy;
+    if (ImGui::Checkbox("Keep CPU copy", &keepCPUCopy)) {
+        currModel->setMeshRetention(keepCPUCopy ? MeshRetention::KeepCPUCopy : MeshRetention::ReleaseAfterUpload);
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Released meshes are reloaded from the mesh cache or the source file when needed");
+    }
+
     ImGui::Unindent(theme.indentSize);
     return true;
 }
@@ -381,6 +520,18 @@ bool ObjectsInspectorUI::drawAdditionalMenu(Model* currModel, ModelCache* modelC
             modelCachePtr->toggleAsSkybox(currModel->ID);
         }
     }
+
+    size_t levels = 1;
+    for (unsigned int meshIdx = 0; meshIdx < currModel->getNumberOfMeshes(); meshIdx++) {
+        levels = std::max(levels, currModel->getMeshLODs(meshIdx).size());
+    }
+    int lodOverride = currModel->getLODOverride();
+    if (ImGui::SliderInt("Level of detail", &lodOverride, -1, (int)levels - 1, lodOverride < 0 ? "Auto" : "%d", ImGuiSliderFlags_AlwaysClamp)) {
+        currModel->setLODOverride(lodOverride);
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("%zu levels. Auto picks one per mesh from its size on screen", levels);
+    }
     ImGui::Unindent(theme.indentSize);
     return true;
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "object/MaterialCache.hpp"
+#include "object/InstanceGenerator.hpp"
 #include <imgui/imgui.h>
 #include <imgui/imgui_impl_glfw.h>
 #include <imgui/imgui_impl_opengl3.h>
@@ -55,6 +56,7 @@ private:
     std::unordered_map<unsigned int, ModelTextureMenu> modelTextureMenus;
     SettingsStyles* styles = nullptr;
     unsigned int renamingModelID = std::numeric_limits<unsigned int>::max(); 
+    std::unordered_map<unsigned int, InstanceGeneratorParams> instanceGeneratorMenus; // [model ID] <-> params being edited
     char renameBuffer[256] = ""; 
 
     //void drawAddObjectMenu(Logger* loggerPtr, InspectorEngine* inspectorEngPtr, ShaderRegistry* shaderRegPtr, ModelCache* modelCachePtr);
@@ -64,6 +66,8 @@ private:
     // bool drawShaderProgramMenu(MaterialShaderMenu& menu, const std::vector<const char*>& shaderChoices, ShaderRegistry* shaderRegPtr, MaterialCache* materialCachePtr, InspectorEngine* inspectorEngPtr, Logger* logger);
     bool drawMeshesMenu(Model* currModel, MaterialCache* materialCachePtr, ModelCache* modelCachePtr, Logger* loggerPtr);
     bool drawInstancesMenu(Model* currModel, ModelCache* modelCachePtr, Logger* loggerPtr);
+    void drawInstanceGeneratorMenu(Model* currModel, ModelCache* modelCachePtr);
+    bool drawMemoryMenu(Model* currModel); // CPU vs GPU bytes of the model's meshes
     bool drawAdditionalMenu(Model* currModel, ModelCache* modelCachePtr, Logger* loggerPtr);
     // bool drawTextureMenu(ModelTextureMenu& menu, Logger* loggerPtr, TextureRegistry* textureRegPtr);
     bool drawTextInput(std::string* value, const char* label);
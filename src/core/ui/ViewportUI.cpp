@@ -5,6 +5,7 @@
 #include "engine/Errorlog.hpp"
 #include "engine/AppTimer.hpp"
 #include "object/Renderer.hpp"
+#include <cstdio>
 #include <string>
 #include <glm/gtc/matrix_transform.hpp>
 #include "platform/Platform.hpp"
@@ -19,7 +20,7 @@ ViewportUI::ViewportUI() {
     initialized = false;
     initPos = true;
     fbo = 0;
-    rbo = 0;
+    depthTex = 0;
     viewportTex = 0;
     dimensions = ImVec2(0, 0);
     prevDimensions = ImVec2(0, 0);
@@ -75,20 +76,29 @@ bool ViewportUI::initialize(Logger* _loggerPtr, Platform* _platformPtr, Renderer
         0
     );
 
-    glGenRenderbuffers(1, &rbo);
-    glBindRenderbuffer(GL_RENDERBUFFER, rbo);
-    glRenderbufferStorage(
-        GL_RENDERBUFFER,
+    glGenTextures(1, &depthTex);
+    glBindTexture(GL_TEXTURE_2D, depthTex);
+    glTexImage2D(
+        GL_TEXTURE_2D,
+        0,
         GL_DEPTH24_STENCIL8,
         dimensions.x,
-        dimensions.y
+        dimensions.y,
+        0,
+        GL_DEPTH_STENCIL,
+        GL_UNSIGNED_INT_24_8,
+        nullptr
     );
 
-    glFramebufferRenderbuffer(
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glFramebufferTexture2D(
         GL_FRAMEBUFFER,
         GL_DEPTH_STENCIL_ATTACHMENT,
-        GL_RENDERBUFFER,
-        rbo
+        GL_TEXTURE_2D,
+        depthTex,
+        0
     );
 
     assert(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
@@ -119,8 +129,9 @@ void ViewportUI::render() {
     glm::mat4 perspective = glm::perspective(glm::radians(45.0f), ViewportUI::getAspect(), 0.1f, 100.0f);
     glm::mat4 view = camPtr->GetViewMatrix();
     // modelCachePtr->renderAll(perspective, view, camPtr->Position);
-    rendererPtr->renderAll(perspective, view, camPtr->Position);
-
+    rendererPtr->setViewportSize((int)dimensions.x, (int)dimensions.y);
+    rendererPtr->setDepthTexture(depthTex);
+    rendererPtr->renderAll(perspective, view, camPtr->Position, (float)platformPtr->getTime());
 
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
     ViewportUI::draw();
@@ -134,10 +145,10 @@ Camera* ViewportUI::getCamera() {
 
 ViewportUI::~ViewportUI() {
     glDeleteFramebuffers(1, &fbo);
-    glDeleteRenderbuffers(1, &rbo);
+    glDeleteTextures(1, &depthTex);
     glDeleteTextures(1, &viewportTex);
     fbo = 0;
-    rbo = 0;
+    depthTex = 0;
     viewportTex = 0;
 }
 
@@ -202,6 +213,59 @@ void ViewportUI::draw() {
         fps.c_str()
     );
 
+    const Renderer::RenderStats& stats = rendererPtr->getStats();
+    std::string uniformCalls = "Uniform calls: " + std::to_string(stats.uniformCallsIssued) 
+                             + " issued / " + std::to_string(stats.uniformCallsSkipped) + " skipped";
+    ImGui::GetWindowDrawList()->AddText(
+        ImVec2(pos.x + 20, pos.y + 60),
+        IM_COL32(255, 255, 255, 255),
+        uniformCalls.c_str()
+    );
+
+    const GLStateCache::Counters& stateChanges = stats.stateChanges;
+    std::string stateCalls = "State changes: " + std::to_string(stateChanges.programBinds) + " program / "
+                           + std::to_string(stateChanges.textureBinds) + " texture / "
+                           + std::to_string(stateChanges.vertexArrayBinds) + " vao, "
+                           + std::to_string(stateChanges.skipped) + " skipped";
+    ImGui::GetWindowDrawList()->AddText(
+        ImVec2(pos.x + 20, pos.y + 80),
+        IM_COL32(255, 255, 255, 255),
+        stateCalls.c_str()
+    );
+
+    std::string culling = "Primitives: " + std::to_string(stats.primitivesDrawn) + " drawn / "
+                        + std::to_string(stats.primitivesCulled) + " culled / "
+                        + std::to_string(stats.primitivesOccluded) + " occluded";
+    ImGui::GetWindowDrawList()->AddText(
+        ImVec2(pos.x + 20, pos.y + 100),
+        IM_COL32(255, 255, 255, 255),
+        culling.c_str()
+    );
+
+    char cullTime[64];
+    std::snprintf(cullTime, sizeof(cullTime), "Culling: %.3f ms", stats.cullMilliseconds);
+    ImGui::GetWindowDrawList()->AddText(
+        ImVec2(pos.x + 20, pos.y + 120),
+        IM_COL32(255, 255, 255, 255),
+        cullTime
+    );
+
+    std::string detail = "Triangles: " + std::to_string(stats.trianglesDrawn) + ", "
+                       + std::to_string(stats.primitivesReduced) + " primitives at reduced detail";
+    ImGui::GetWindowDrawList()->AddText(
+        ImVec2(pos.x + 20, pos.y + 140),
+        IM_COL32(255, 255, 255, 255),
+        detail.c_str()
+    );
+
+    std::string draws = "Draw calls: " + std::to_string(stats.drawCalls) + ", "
+                      + std::to_string(stats.primitivesBatched) + " primitives batched";
+    ImGui::GetWindowDrawList()->AddText(
+        ImVec2(pos.x + 20, pos.y + 160),
+        IM_COL32(255, 255, 255, 255),
+        draws.c_str()
+    );
+
     ImGui::End();
     // ImGui::PopStyleVar();
 }
@@ -224,12 +288,17 @@ void ViewportUI::reformat() {
         nullptr
     );
 
-    glBindRenderbuffer(GL_RENDERBUFFER, rbo);
-    glRenderbufferStorage(
-        GL_RENDERBUFFER, 
+    glBindTexture(GL_TEXTURE_2D, depthTex);
+    glTexImage2D(
+        GL_TEXTURE_2D,
+        0,
         GL_DEPTH24_STENCIL8,
         dimensions.x,
-        dimensions.y
+        dimensions.y,
+        0,
+        GL_DEPTH_STENCIL,
+        GL_UNSIGNED_INT_24_8,
+        nullptr
     );
 
     prevDimensions = dimensions;
@@ -22,7 +22,7 @@ public:
 private:
     bool initialized = false;
     bool initPos = true;
-    GLuint fbo = 0, rbo = 0, viewportTex = 0;
+    GLuint fbo = 0, depthTex = 0, viewportTex = 0; // depth is a texture so the renderer can build its Hi-Z from it
     ImVec2 dimensions = ImVec2(0, 0);
     ImVec2 prevDimensions = ImVec2(0, 0);
     ImVec2 pos = ImVec2(0, 0);
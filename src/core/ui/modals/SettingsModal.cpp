@@ -629,6 +629,33 @@ void SettingsModal::drawGraphicsPage() {
     }
 
     ImGui::TextDisabled("Prevents tearing but caps FPS to monitor refresh rate.");
+
+    ImGui::Spacing();
+    ImGui::Checkbox("Optimize imported meshes", &settingsPtr->optimizeImportedMeshes);
+    ImGui::TextDisabled("Welds vertices and reorders triangles for the GPU. Applies to models imported or reloaded afterwards.");
+
+    ImGui::Spacing();
+    ImGui::Checkbox("Frustum culling", &settingsPtr->frustumCulling);
+    ImGui::TextDisabled("Skips meshes outside the camera. Turn off for shaders that move vertices past their mesh bounds.");
+
+    ImGui::Spacing();
+    int occlusionMode = (int)settingsPtr->occlusionMode;
+    const char* occlusionModes[] = { "Off", "Hi-Z depth", "Occlusion queries" };
+    if (ImGui::Combo("Occlusion culling", &occlusionMode, occlusionModes, IM_ARRAYSIZE(occlusionModes))) {
+        settingsPtr->occlusionMode = (OcclusionMode)occlusionMode;
+    }
+    ImGui::TextDisabled("Skips meshes hidden behind others using the previous frame's depth. Helps dense scenes, can show a mesh a frame late.");
+
+    ImGui::Spacing();
+    ImGui::Checkbox("Level of detail", &settingsPtr->levelOfDetail);
+    ImGui::BeginDisabled(!settingsPtr->levelOfDetail);
+    ImGui::SliderFloat("LOD pixel error", &settingsPtr->lodPixelError, 0.25f, 16.0f, "%.2f px", ImGuiSliderFlags_AlwaysClamp);
+    ImGui::EndDisabled();
+    ImGui::TextDisabled("Draws imported meshes with fewer triangles when small on screen. Shaders can read the level from int lodLevel.");
+
+    ImGui::Spacing();
+    ImGui::Checkbox("Batch draws", &settingsPtr->batchDraws);
+    ImGui::TextDisabled("Draws meshes sharing a material in one call when their shader declares DrawBlock (see shaders/batched.vert). Needs OpenGL 4.6.");
 }
 
 void SettingsModal::drawFoldersPage() {
@@ -0,0 +1,99 @@
+#include "DepthPyramid.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+
+// same reduction as the GPU chain: each texel covers 2x2 of the level above, the last
+// row and column also take the leftover one when a size is odd
+void DepthPyramid::build(int width, int height, std::vector<float> depths, const glm::mat4& _viewProjection, glm::ivec2 _viewportSize) {
+    levels.clear();
+    if (width <= 0 || height <= 0 || depths.size() != (size_t)width * height) return;
+
+    viewProjection = _viewProjection;
+    viewportSize = glm::max(_viewportSize, glm::ivec2(width, height));
+    levels.push_back(Level{ width, height, std::move(depths) });
+    while (levels.back().width > 1 || levels.back().height > 1) {
+        const Level& source = levels.back();
+        Level next;
+        next.width = std::max(1, source.width / 2);
+        next.height = std::max(1, source.height / 2);
+        next.depth.resize((size_t)next.width * next.height);
+        for (int y = 0; y < next.height; y++) {
+            int y0 = 2 * y;
+            int y1 = (y == next.height - 1) ? source.height - 1 : std::min(2 * y + 1, source.height - 1);
+            for (int x = 0; x < next.width; x++) {
+                int x0 = 2 * x;
+                int x1 = (x == next.width - 1) ? source.width - 1 : std::min(2 * x + 1, source.width - 1);
+                next.depth[(size_t)y * next.width + x] = farthest(source, x0, y0, x1, y1);
+            }
+        }
+        levels.push_back(std::move(next));
+    }
+}
+
+
+void DepthPyramid::clear() {
+    levels.clear();
+}
+
+
+float DepthPyramid::farthest(const Level& level, int x0, int y0, int x1, int y1) const {
+    float result = 0.0f;
+    for (int y = y0; y <= y1; y++) {
+        const float* row = level.depth.data() + (size_t)y * level.width;
+        for (int x = x0; x <= x1; x++) {
+            result = std::max(result, row[x]);
+        }
+    }
+    return result;
+}
+
+
+// the viewport pixel under ndc, carried down to levelSize the way the levels were reduced. Scaling
+// ndc by levelSize directly would disagree once an odd size folded a leftover texel into the last one
+int DepthPyramid::toTexel(float ndc, int viewportSize, int levelSize) {
+    int texel = (int)std::floor((std::clamp(ndc, -1.0f, 1.0f) * 0.5f + 0.5f) * viewportSize);
+    texel = std::clamp(texel, 0, viewportSize - 1);
+    for (int size = viewportSize; size > levelSize;) {
+        size = std::max(1, size / 2);
+        texel = std::min(texel / 2, size - 1);
+    }
+    return std::min(texel, levelSize - 1);
+}
+
+
+bool DepthPyramid::isOccluded(const glm::vec3& center, const glm::vec3& extent) const {
+    if (levels.empty()) return false;
+
+    glm::vec2 ndcMin(FLT_MAX), ndcMax(-FLT_MAX);
+    float nearestDepth = 1.0f;
+    for (int corner = 0; corner < 8; corner++) {
+        glm::vec3 sign((corner & 1) ? 1.0f : -1.0f, (corner & 2) ? 1.0f : -1.0f, (corner & 4) ? 1.0f : -1.0f);
+        glm::vec4 clip = viewProjection * glm::vec4(center + sign * extent, 1.0f);
+        if (clip.w <= 1e-5f) return false; // reaches behind the camera, its projection isn't bounded
+        glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        ndcMin = glm::min(ndcMin, glm::vec2(ndc));
+        ndcMax = glm::max(ndcMax, glm::vec2(ndc));
+        nearestDepth = std::min(nearestDepth, ndc.z * 0.5f + 0.5f);
+    }
+    if (nearestDepth <= 0.0f) return false;
+    if (ndcMax.x < -1.0f || ndcMin.x > 1.0f || ndcMax.y < -1.0f || ndcMin.y > 1.0f) return false; // frustum culling's job
+
+    const Level& base = levels[0];
+    int x0 = toTexel(ndcMin.x, viewportSize.x, base.width), x1 = toTexel(ndcMax.x, viewportSize.x, base.width);
+    int y0 = toTexel(ndcMin.y, viewportSize.y, base.height), y1 = toTexel(ndcMax.y, viewportSize.y, base.height);
+
+    size_t levelIdx = 0;
+    while (levelIdx + 1 < levels.size() && (x1 - x0 >= MAX_TEST_TEXELS || y1 - y0 >= MAX_TEST_TEXELS)) {
+        const Level& next = levels[levelIdx + 1];
+        x0 = std::min(x0 / 2, next.width - 1);
+        x1 = std::min(x1 / 2, next.width - 1);
+        y0 = std::min(y0 / 2, next.height - 1);
+        y1 = std::min(y1 / 2, next.height - 1);
+        levelIdx++;
+    }
+
+    return nearestDepth > farthest(levels[levelIdx], x0, y0, x1, y1);
+}
@@ -0,0 +1,49 @@
+// DESCRIPTION
+/*
+DepthPyramid is the CPU side of the occlusion culler's hierarchical depth (Hi-Z): a coarse
+level of the GPU max-depth chain read back from the viewport (see OcclusionCuller), reduced
+further here until it is a single texel. Every texel holds the farthest window depth [0, 1]
+of the pixels below it, so a box whose nearest point is farther than that is hidden.
+
+It belongs to the frame it was read back from and tests boxes with that frame's view projection.
+The renderer uses it one or two frames late, so a camera move can show a primitive a frame late,
+never hide a visible one against depth that was actually there.
+
+Boxes reaching behind the camera, off screen or into pixels nothing was drawn to (depth 1) are
+always visible.
+*/
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+
+class DepthPyramid {
+public:
+    // depths is width * height window depths, rows bottom to top like glReadPixels returns them.
+    // viewportSize is the pixel size they were reduced from, by the same halving as build's
+    void build(int width, int height, std::vector<float> depths, const glm::mat4& viewProjection, glm::ivec2 viewportSize);
+    void clear();
+    bool isEmpty() const { return levels.empty(); }
+
+    bool isOccluded(const glm::vec3& center, const glm::vec3& extent) const;
+
+    int getWidth() const { return levels.empty() ? 0 : levels[0].width; }
+    int getHeight() const { return levels.empty() ? 0 : levels[0].height; }
+
+private:
+    struct Level {
+        int width = 0;
+        int height = 0;
+        std::vector<float> depth;
+    };
+
+    // a box is tested on the finest level where it covers at most this many texels per side
+    static constexpr int MAX_TEST_TEXELS = 4;
+
+    std::vector<Level> levels;
+    glm::mat4 viewProjection = glm::mat4(1.0f);
+    glm::ivec2 viewportSize = glm::ivec2(0);
+
+    float farthest(const Level& level, int x0, int y0, int x1, int y1) const;
+    static int toTexel(float ndc, int viewportSize, int levelSize);
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "platform/GL.hpp"
+#include <glm/glm.hpp>
+
+// Per-draw values of batched draws, one entry per mesh in a glMultiDrawElementsIndirect call.
+// Programs opt into batching by declaring the block (GLSL 460 for gl_DrawID):
+//
+//     struct DrawData {
+//         mat4 model;
+//         int lodLevel;
+//     };
+//     layout(std430) readonly buffer DrawBlock {
+//         DrawData draws[];
+//     };
+//
+//     mat4 model = draws[gl_DrawID].model;
+//
+// Those programs read model and lodLevel from here, see Renderer::flushBatches. Meshes that can't
+// be batched (instanced models, batching turned off) are still drawn one at a time, with their
+// entry at draws[0] where gl_DrawID is 0. gl_DrawID needs GL 4.6 (ARB_shader_draw_parameters before
+// it), so batching is only turned on there, see MeshArena::isSupported(). Elsewhere the model and
+// lodLevel uniforms are the only way in.
+inline constexpr const char* DRAW_BLOCK_NAME = "DrawBlock";
+inline constexpr GLuint DRAW_BLOCK_BINDING = 0;
+
+// std430 mirror of DrawData above
+struct DrawBlockData {
+    glm::mat4 model;
+    int lodLevel;
+    int padding[3]; // std430 rounds a struct up to its largest member alignment, 16 for mat4
+};
+static_assert(sizeof(DrawBlockData) == 80, "DrawBlockData must match the std430 layout of DrawData");
+
+// GL's DrawElementsIndirectCommand, what the indirect buffer holds per draw
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
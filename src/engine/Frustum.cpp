@@ -0,0 +1,86 @@
+#include "Frustum.hpp"
+
+#include <cmath>
+
+
+void PackedBounds::resize(size_t count) {
+    centerX.resize(count);
+    centerY.resize(count);
+    centerZ.resize(count);
+    extentX.resize(count);
+    extentY.resize(count);
+    extentZ.resize(count);
+}
+
+
+void PackedBounds::set(size_t index, const glm::vec3& center, const glm::vec3& extent) {
+    centerX[index] = center.x;
+    centerY[index] = center.y;
+    centerZ[index] = center.z;
+    extentX[index] = extent.x;
+    extentY[index] = extent.y;
+    extentZ[index] = extent.z;
+}
+
+
+// Gribb/Hartmann: each plane is the last row of the matrix plus or minus one of the others
+Frustum Frustum::fromViewProjection(const glm::mat4& m) {
+    glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    Frustum frustum;
+    frustum.planes = {
+        row3 + row0, // left
+        row3 - row0, // right
+        row3 + row1, // bottom
+        row3 - row1, // top
+        row3 + row2, // near
+        row3 - row2  // far
+    };
+    for (glm::vec4& plane : frustum.planes) {
+        float length = glm::length(glm::vec3(plane));
+        if (length > 0.0f) plane /= length;
+    }
+    return frustum;
+}
+
+
+bool Frustum::intersects(const glm::vec3& center, const glm::vec3& extent) const {
+    for (const glm::vec4& plane : planes) {
+        glm::vec3 normal(plane);
+        float distance = glm::dot(normal, center) + plane.w;
+        float reach = glm::dot(glm::abs(normal), extent);
+        if (distance + reach < 0.0f) return false;
+    }
+    return true;
+}
+
+
+size_t Frustum::cullBoxes(const PackedBounds& bounds, std::vector<uint8_t>& visible) const {
+    const size_t count = bounds.size();
+    visible.assign(count, 1);
+
+    const float* cx = bounds.centerX.data();
+    const float* cy = bounds.centerY.data();
+    const float* cz = bounds.centerZ.data();
+    const float* ex = bounds.extentX.data();
+    const float* ey = bounds.extentY.data();
+    const float* ez = bounds.extentZ.data();
+    uint8_t* out = visible.data();
+
+    for (const glm::vec4& plane : planes) {
+        const float nx = plane.x, ny = plane.y, nz = plane.z, w = plane.w;
+        const float ax = std::abs(nx), ay = std::abs(ny), az = std::abs(nz);
+        for (size_t i = 0; i < count; i++) {
+            float distance = nx * cx[i] + ny * cy[i] + nz * cz[i] + w;
+            float reach = ax * ex[i] + ay * ey[i] + az * ez[i];
+            out[i] &= (uint8_t)(distance + reach >= 0.0f);
+        }
+    }
+
+    size_t visibleCount = 0;
+    for (size_t i = 0; i < count; i++) visibleCount += out[i];
+    return visibleCount;
+}
@@ -0,0 +1,38 @@
+// DESCRIPTION
+/*
+Frustum holds the six planes of a view projection matrix, normals pointing inward, and tests
+boxes against them for culling.
+
+Boxes are tested in bulk from PackedBounds, centers and extents in separate float arrays. The
+test loop runs plane by plane over every box without branches, so the compiler vectorizes it
+on whatever SIMD the build targets instead of the code carrying its own intrinsics.
+
+A box is only culled when it lies fully behind one plane. Boxes near a frustum corner can pass
+while being outside, which only costs a draw.
+*/
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+struct PackedBounds {
+    std::vector<float> centerX, centerY, centerZ;
+    std::vector<float> extentX, extentY, extentZ; // half sizes
+
+    size_t size() const { return centerX.size(); }
+    void resize(size_t count);
+    void set(size_t index, const glm::vec3& center, const glm::vec3& extent);
+};
+
+struct Frustum {
+    std::array<glm::vec4, 6> planes; // xyz normal, w distance: inside when dot(normal, p) + w >= 0
+
+    static Frustum fromViewProjection(const glm::mat4& viewProjection);
+
+    bool intersects(const glm::vec3& center, const glm::vec3& extent) const;
+    // visible[i] is 1 when box i intersects the frustum, returns how many do
+    size_t cullBoxes(const PackedBounds& bounds, std::vector<uint8_t>& visible) const;
+};
@@ -0,0 +1,69 @@
+#include "GLStateCache.hpp"
+
+
+GLStateCache::GLStateCache() {
+    invalidate();
+}
+
+
+void GLStateCache::invalidate() {
+    programKnown = false;
+    currentProgram = 0;
+    vertexArrayKnown = false;
+    currentVertexArray = 0;
+    textureUnits.fill(UNKNOWN_TEXTURE);
+}
+
+
+void GLStateCache::resetCounters() {
+    counters = Counters{};
+}
+
+
+const GLStateCache::Counters& GLStateCache::getCounters() const {
+    return counters;
+}
+
+
+void GLStateCache::useProgram(GLuint programID) {
+    // same as ShaderProgram::use, a program that failed to link is never bound
+    if (programID == 0) return;
+    if (programKnown && currentProgram == programID) {
+        counters.skipped++;
+        return;
+    }
+
+    glUseProgram(programID);
+    currentProgram = programID;
+    programKnown = true;
+    counters.programBinds++;
+}
+
+
+void GLStateCache::bindVertexArray(GLuint vao) {
+    if (vertexArrayKnown && currentVertexArray == vao) {
+        counters.skipped++;
+        return;
+    }
+
+    glBindVertexArray(vao);
+    currentVertexArray = vao;
+    vertexArrayKnown = true;
+    counters.vertexArrayBinds++;
+}
+
+
+bool GLStateCache::isTextureBound(unsigned int texUnit, unsigned int textureID) {
+    if (texUnit >= MAX_TEXTURE_UNITS || textureID == UNKNOWN_TEXTURE) return false;
+    if (textureUnits[texUnit] != textureID) return false;
+
+    counters.skipped++;
+    return true;
+}
+
+
+void GLStateCache::textureBound(unsigned int texUnit, unsigned int textureID) {
+    if (texUnit >= MAX_TEXTURE_UNITS) return;
+    textureUnits[texUnit] = textureID;
+    counters.textureBinds++;
+}
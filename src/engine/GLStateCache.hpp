@@ -0,0 +1,48 @@
+// DESCRIPTION
+/*
+GLStateCache remembers which program, textures and vertex array the renderer last bound
+so repeated binds between primitives that share state are skipped.
+
+It only knows about binds made through it. Call invalidate() at the start of every frame,
+anything else (ImGui, texture uploads, the inspector) may have touched GL state in between.
+Textures are tracked by TextureCache ID rather than GL name, since TextureCache owns the binding.
+*/
+#pragma once
+
+#include "platform/GL.hpp"
+#include <array>
+#include <limits>
+
+class GLStateCache {
+public:
+    // state changes issued vs. skipped since the last resetCounters()
+    struct Counters {
+        unsigned int programBinds     = 0;
+        unsigned int textureBinds     = 0;
+        unsigned int vertexArrayBinds = 0;
+        unsigned int skipped          = 0;
+    };
+
+    static constexpr unsigned int MAX_TEXTURE_UNITS = 32;
+    static constexpr unsigned int UNKNOWN_TEXTURE   = std::numeric_limits<unsigned int>::max();
+    static constexpr unsigned int DEFAULT_TEXTURE   = UNKNOWN_TEXTURE - 1; // TextureCache's missing texture
+
+    GLStateCache();
+    void invalidate();
+    void resetCounters();
+    const Counters& getCounters() const;
+
+    void useProgram(GLuint programID);
+    void bindVertexArray(GLuint vao);
+    // true if texUnit may already hold textureID, otherwise the caller binds it and reports back with textureBound
+    bool isTextureBound(unsigned int texUnit, unsigned int textureID);
+    void textureBound(unsigned int texUnit, unsigned int textureID);
+
+private:
+    bool programKnown = false;
+    GLuint currentProgram = 0;
+    bool vertexArrayKnown = false;
+    GLuint currentVertexArray = 0;
+    std::array<unsigned int, MAX_TEXTURE_UNITS> textureUnits;
+    Counters counters;
+};
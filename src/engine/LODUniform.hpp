@@ -0,0 +1,9 @@
+#pragma once
+
+// The level of detail a primitive is drawn at, set per draw by the Renderer (see LODSelector in
+// object/MeshLOD.hpp). Shaders read it by declaring:
+//
+//     uniform int lodLevel;
+//
+// Programs batched through DrawBlock get it from their DrawData entry instead, see DrawBlock.hpp.
+inline constexpr const char* LOD_UNIFORM_NAME = "lodLevel";
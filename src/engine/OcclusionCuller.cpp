@@ -0,0 +1,405 @@
+#include "OcclusionCuller.hpp"
+
+#include "core/logging/Logger.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace {
+    const char* FULLSCREEN_VERT = R"(#version 330 core
+void main() {
+    vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+    // one texel of the target level is the farthest depth of the 2x2 source texels below it,
+    // the last row and column also cover the leftover source texel of an odd size
+    const char* REDUCE_FRAG = R"(#version 330 core
+uniform sampler2D uSource;
+uniform ivec2 uSourceSize;
+uniform ivec2 uTargetSize;
+out float farthestDepth;
+
+void main() {
+    ivec2 target = ivec2(gl_FragCoord.xy);
+    ivec2 first = target * 2;
+    ivec2 last = min(first + 1, uSourceSize - 1);
+    if (target.x == uTargetSize.x - 1) last.x = uSourceSize.x - 1;
+    if (target.y == uTargetSize.y - 1) last.y = uSourceSize.y - 1;
+
+    float depth = 0.0;
+    for (int y = first.y; y <= last.y; y++) {
+        for (int x = first.x; x <= last.x; x++) {
+            depth = max(depth, texelFetch(uSource, ivec2(x, y), 0).r);
+        }
+    }
+    farthestDepth = depth;
+}
+)";
+
+    const char* BOX_VERT = R"(#version 330 core
+layout (location=0) in vec3 aPos;
+uniform mat4 uTransform;
+void main() {
+    gl_Position = uTransform * vec4(aPos, 1.0);
+}
+)";
+
+    const char* BOX_FRAG = R"(#version 330 core
+out vec4 color;
+void main() {
+    color = vec4(1.0);
+}
+)";
+
+    // unit cube around the origin, scaled to a box's extent
+    const float BOX_VERTICES[] = {
+        -1, -1, -1,   1, -1, -1,   1,  1, -1,  -1,  1, -1,
+        -1, -1,  1,   1, -1,  1,   1,  1,  1,  -1,  1,  1
+    };
+    const GLubyte BOX_INDICES[] = {
+        0, 2, 1,  0, 3, 2,   4, 5, 6,  4, 6, 7,
+        0, 1, 5,  0, 5, 4,   3, 6, 2,  3, 7, 6,
+        0, 4, 7,  0, 7, 3,   1, 2, 6,  1, 6, 5
+    };
+
+    // a camera this close to a box would have the proxy's near faces clipped
+    constexpr float CAMERA_MARGIN = 0.5f;
+}
+
+
+bool OcclusionCuller::initialize(Logger* _loggerPtr) {
+    if (initialized) return true;
+    loggerPtr = _loggerPtr;
+
+    glGenVertexArrays(1, &emptyVAO);
+    reduceProgram = buildProgram(FULLSCREEN_VERT, REDUCE_FRAG, "hi-z reduce");
+    if (reduceProgram != 0) {
+        reduceSourceLoc = glGetUniformLocation(reduceProgram, "uSource");
+        reduceSourceSizeLoc = glGetUniformLocation(reduceProgram, "uSourceSize");
+        reduceTargetSizeLoc = glGetUniformLocation(reduceProgram, "uTargetSize");
+    }
+
+    boxProgram = buildProgram(BOX_VERT, BOX_FRAG, "occlusion box");
+    if (boxProgram != 0) boxTransformLoc = glGetUniformLocation(boxProgram, "uTransform");
+
+    glGenVertexArrays(1, &boxVAO);
+    glBindVertexArray(boxVAO);
+    glGenBuffers(1, &boxVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, boxVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(BOX_VERTICES), BOX_VERTICES, GL_STATIC_DRAW);
+    glGenBuffers(1, &boxEBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, boxEBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(BOX_INDICES), BOX_INDICES, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    glBindVertexArray(0);
+
+    for (Readback& readback : readbacks) {
+        glGenBuffers(1, &readback.pbo);
+    }
+
+    // checked once on a small target, allocateHiZ checks again whenever the size changes
+    hiZAvailable = reduceProgram != 0 && allocateHiZ(2, 2);
+    if (!hiZAvailable) {
+        loggerPtr->addLog(LogLevel::WARNING, "OCCLUSION_CULLER::initialize()", "Hi-Z targets unavailable, occlusion culling falls back to occlusion queries");
+    }
+    initialized = true;
+    return boxProgram != 0;
+}
+
+
+void OcclusionCuller::shutdown() {
+    if (!initialized) return;
+
+    discardResults();
+    releaseHiZ();
+    for (Readback& readback : readbacks) {
+        glDeleteBuffers(1, &readback.pbo);
+        readback = Readback();
+    }
+
+    glDeleteVertexArrays(1, &emptyVAO);
+    glDeleteVertexArrays(1, &boxVAO);
+    glDeleteBuffers(1, &boxVBO);
+    glDeleteBuffers(1, &boxEBO);
+    glDeleteProgram(reduceProgram);
+    glDeleteProgram(boxProgram);
+    emptyVAO = boxVAO = boxVBO = boxEBO = 0;
+    reduceProgram = boxProgram = 0;
+    hiZAvailable = false;
+    initialized = false;
+}
+
+
+void OcclusionCuller::discardResults() {
+    for (Readback& readback : readbacks) {
+        if (readback.fence != nullptr) glDeleteSync(readback.fence);
+        readback.fence = nullptr;
+    }
+    for (auto& [key, entry] : queries) {
+        if (entry.query != 0) glDeleteQueries(1, &entry.query);
+    }
+    queries.clear();
+    pyramid.clear();
+}
+
+
+GLuint OcclusionCuller::buildProgram(const char* vertexSource, const char* fragmentSource, const char* name) {
+    auto compile = [this, name](GLenum stage, const char* source) -> GLuint {
+        GLuint shader = glCreateShader(stage);
+        glShaderSource(shader, 1, &source, nullptr);
+        glCompileShader(shader);
+        GLint success;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (!success) {
+            char infoLog[512];
+            glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+            loggerPtr->addLog(LogLevel::LOG_ERROR, "OCCLUSION_CULLER::buildProgram()", std::string(name) + " failed to compile:\n" + infoLog);
+            glDeleteShader(shader);
+            return 0;
+        }
+        return shader;
+    };
+
+    GLuint vertexShader = compile(GL_VERTEX_SHADER, vertexSource);
+    GLuint fragmentShader = compile(GL_FRAGMENT_SHADER, fragmentSource);
+    GLuint program = 0;
+    if (vertexShader != 0 && fragmentShader != 0) {
+        program = glCreateProgram();
+        glAttachShader(program, vertexShader);
+        glAttachShader(program, fragmentShader);
+        glLinkProgram(program);
+        GLint success;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success) {
+            char infoLog[512];
+            glGetProgramInfoLog(program, 512, nullptr, infoLog);
+            loggerPtr->addLog(LogLevel::LOG_ERROR, "OCCLUSION_CULLER::buildProgram()", std::string(name) + " failed to link:\n" + infoLog);
+            glDeleteProgram(program);
+            program = 0;
+        }
+    }
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+    return program;
+}
+
+
+// levels from half the viewport down to the first one at most READBACK_WIDTH wide,
+// nothing below that is needed on the GPU
+bool OcclusionCuller::allocateHiZ(int width, int height) {
+    releaseHiZ();
+
+    hiZWidth = width;
+    hiZHeight = height;
+    glm::ivec2 size(std::max(1, width / 2), std::max(1, height / 2));
+    hiZLevelSizes.push_back(size);
+    while (size.x > READBACK_WIDTH) {
+        size = glm::max(size / 2, glm::ivec2(1));
+        hiZLevelSizes.push_back(size);
+    }
+
+    glGenTextures(1, &hiZTexture);
+    glBindTexture(GL_TEXTURE_2D, hiZTexture);
+    for (size_t level = 0; level < hiZLevelSizes.size(); level++) {
+        glTexImage2D(GL_TEXTURE_2D, (GLint)level, GL_R32F, hiZLevelSizes[level].x, hiZLevelSizes[level].y, 0, GL_RED, GL_FLOAT, nullptr);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)hiZLevelSizes.size() - 1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, &hiZFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, hiZFramebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, hiZTexture, 0);
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (!complete) releaseHiZ();
+    return complete;
+}
+
+
+void OcclusionCuller::releaseHiZ() {
+    if (hiZFramebuffer != 0) glDeleteFramebuffers(1, &hiZFramebuffer);
+    if (hiZTexture != 0) glDeleteTextures(1, &hiZTexture);
+    hiZFramebuffer = 0;
+    hiZTexture = 0;
+    hiZWidth = hiZHeight = 0;
+    hiZLevelSizes.clear();
+}
+
+
+void OcclusionCuller::buildHiZ(GLuint depthTexture, int width, int height, const glm::mat4& viewProjection) {
+    if (!hiZAvailable || depthTexture == 0 || width <= 0 || height <= 0) return;
+    if (width != hiZWidth || height != hiZHeight) {
+        if (!allocateHiZ(width, height)) {
+            hiZAvailable = false;
+            loggerPtr->addLog(LogLevel::WARNING, "OCCLUSION_CULLER::buildHiZ()", "Hi-Z targets unavailable, occlusion culling falls back to occlusion queries");
+            return;
+        }
+    }
+
+    // the slot about to be reused hasn't been picked up yet, its frame is dropped
+    Readback& readback = readbacks[nextReadback];
+    if (readback.fence != nullptr) {
+        glDeleteSync(readback.fence);
+        readback.fence = nullptr;
+    }
+
+    // runs mid-frame, the caller's target is bound again afterwards
+    GLint previousDrawFramebuffer = 0, previousReadFramebuffer = 0;
+    GLint previousViewport[4];
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousDrawFramebuffer);
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousReadFramebuffer);
+    glGetIntegerv(GL_VIEWPORT, previousViewport);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, hiZFramebuffer);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+    glUseProgram(reduceProgram);
+    glBindVertexArray(emptyVAO);
+    glActiveTexture(GL_TEXTURE0);
+    glUniform1i(reduceSourceLoc, 0);
+
+    glm::ivec2 sourceSize(width, height);
+    for (size_t level = 0; level < hiZLevelSizes.size(); level++) {
+        // the source level is the only one the texture exposes, so it never overlaps the one being written
+        if (level == 0) {
+            glBindTexture(GL_TEXTURE_2D, depthTexture);
+        }
+        else {
+            glBindTexture(GL_TEXTURE_2D, hiZTexture);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, (GLint)level - 1);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)level - 1);
+        }
+        glm::ivec2 targetSize = hiZLevelSizes[level];
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, hiZTexture, (GLint)level);
+        glViewport(0, 0, targetSize.x, targetSize.y);
+        glUniform2i(reduceSourceSizeLoc, sourceSize.x, sourceSize.y);
+        glUniform2i(reduceTargetSizeLoc, targetSize.x, targetSize.y);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        sourceSize = targetSize;
+    }
+    glBindTexture(GL_TEXTURE_2D, hiZTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)hiZLevelSizes.size() - 1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // the last level is still attached, read it into the pixel buffer without waiting for it
+    glm::ivec2 readSize = hiZLevelSizes.back();
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pbo);
+    glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)readSize.x * readSize.y * sizeof(float), nullptr, GL_STREAM_READ);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, readSize.x, readSize.y, GL_RED, GL_FLOAT, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    readback.width = readSize.x;
+    readback.height = readSize.y;
+    readback.viewportSize = glm::ivec2(width, height);
+    readback.viewProjection = viewProjection;
+    nextReadback = (nextReadback + 1) % readbacks.size();
+
+    glBindVertexArray(0);
+    glUseProgram(0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, (GLuint)previousDrawFramebuffer);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, (GLuint)previousReadFramebuffer);
+    glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+    glEnable(GL_DEPTH_TEST);
+}
+
+
+const DepthPyramid* OcclusionCuller::latestDepth() {
+    // oldest first, so a newer finished readback overwrites an older one
+    for (unsigned int i = 0; i < readbacks.size(); i++) {
+        Readback& readback = readbacks[(nextReadback + i) % readbacks.size()];
+        if (readback.fence == nullptr) continue;
+
+        GLenum status = glClientWaitSync(readback.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) continue;
+        glDeleteSync(readback.fence);
+        readback.fence = nullptr;
+
+        size_t count = (size_t)readback.width * readback.height;
+        std::vector<float> depths(count);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pbo);
+        const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)(count * sizeof(float)), GL_MAP_READ_BIT);
+        if (mapped != nullptr) {
+            std::memcpy(depths.data(), mapped, count * sizeof(float));
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            pyramid.build(readback.width, readback.height, std::move(depths), readback.viewProjection, readback.viewportSize);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+    return pyramid.isEmpty() ? nullptr : &pyramid;
+}
+
+
+void OcclusionCuller::collectQueries() {
+    queryFrame++;
+    for (auto it = queries.begin(); it != queries.end();) {
+        QueryEntry& entry = it->second;
+        if (entry.pending) {
+            GLuint available = 0;
+            glGetQueryObjectuiv(entry.query, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available) {
+                GLuint samplesPassed = 0;
+                glGetQueryObjectuiv(entry.query, GL_QUERY_RESULT, &samplesPassed);
+                entry.visible = samplesPassed != 0;
+                entry.pending = false;
+            }
+        }
+        if (!entry.pending && queryFrame - entry.lastFrame > QUERY_EXPIRY_FRAMES) {
+            if (entry.query != 0) glDeleteQueries(1, &entry.query);
+            it = queries.erase(it);
+        }
+        else {
+            it++;
+        }
+    }
+}
+
+
+bool OcclusionCuller::isQueryVisible(uint64_t key) const {
+    auto it = queries.find(key);
+    return it == queries.end() || it->second.visible;
+}
+
+
+void OcclusionCuller::queryBoxes(const std::vector<QueryBox>& boxes, const glm::mat4& viewProjection, const glm::vec3& cameraPosition) {
+    if (boxProgram == 0 || boxes.empty()) return;
+
+    glUseProgram(boxProgram);
+    glBindVertexArray(boxVAO);
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthMask(GL_FALSE);
+
+    for (const QueryBox& box : boxes) {
+        QueryEntry& entry = queries[box.key];
+        entry.lastFrame = queryFrame;
+
+        glm::vec3 offset = glm::abs(cameraPosition - box.center);
+        if (glm::all(glm::lessThanEqual(offset, box.extent + glm::vec3(CAMERA_MARGIN)))) {
+            entry.visible = true;
+            continue;
+        }
+        if (entry.pending) continue; // the last one hasn't come back yet
+
+        if (entry.query == 0) glGenQueries(1, &entry.query);
+        glm::mat4 transform = glm::scale(glm::translate(viewProjection, box.center), box.extent);
+        glUniformMatrix4fv(boxTransformLoc, 1, GL_FALSE, &transform[0][0]);
+        glBeginQuery(GL_ANY_SAMPLES_PASSED, entry.query);
+        glDrawElements(GL_TRIANGLES, sizeof(BOX_INDICES), GL_UNSIGNED_BYTE, nullptr);
+        glEndQuery(GL_ANY_SAMPLES_PASSED);
+        entry.pending = true;
+    }
+
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glDepthMask(GL_TRUE);
+    glBindVertexArray(0);
+    glUseProgram(0);
+}
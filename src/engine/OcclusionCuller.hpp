@@ -0,0 +1,110 @@
+// DESCRIPTION
+/*
+OcclusionCuller owns the GL side of the renderer's occlusion culling. Two methods:
+
+Hi-Z: once the opaque and cutout primitives of a frame are drawn, the viewport's depth texture is reduced on the GPU into a chain of
+max-depth levels (fragment passes, GL 3.3 has no compute) down to a level at most
+READBACK_WIDTH wide. That level is read into a pixel buffer behind a fence and picked up by a
+later frame once the fence has passed, without stalling, and becomes a DepthPyramid the renderer
+tests primitive bounds against on the CPU.
+
+Occlusion queries, the fallback when the Hi-Z targets can't be created: each frame the bounds of
+every primitive in the frustum are drawn as invisible boxes against the opaque depth, one
+GL_ANY_SAMPLES_PASSED query each. A result is read once the driver has it, a frame or more later,
+and decides whether the primitive is drawn until the next result comes in.
+
+Either way results are at least a frame old, so a primitive coming into view can show up a frame
+late. Boxes around the camera are never queried, their proxy would be clipped away.
+*/
+#pragma once
+
+#include "platform/GL.hpp"
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "DepthPyramid.hpp"
+
+class Logger;
+
+class OcclusionCuller {
+public:
+    static constexpr int READBACK_WIDTH = 128;
+
+    struct QueryBox {
+        uint64_t key; // stable per primitive, e.g. its PrimitiveStore handle
+        glm::vec3 center;
+        glm::vec3 extent;
+    };
+
+    OcclusionCuller() = default;
+    OcclusionCuller(const OcclusionCuller&) = delete;
+    OcclusionCuller& operator=(const OcclusionCuller&) = delete;
+
+    bool initialize(Logger* _loggerPtr);
+    void shutdown(); // while the context still exists, destruction does no GL work
+    bool hasHiZ() const { return hiZAvailable; }
+    void discardResults(); // readbacks in flight and query results, when the mode changes
+
+    // HI-Z
+    // reduces depthTexture (the viewport's, level 0, nearest filtering) and starts its readback.
+    // Called mid-frame, before anything translucent writes depth, and rebinds the caller's target
+    void buildHiZ(GLuint depthTexture, int width, int height, const glm::mat4& viewProjection);
+    // the newest pyramid whose readback has finished, null before the first one
+    const DepthPyramid* latestDepth();
+
+    // OCCLUSION QUERIES
+    void collectQueries();                 // reads every result that is available, never waits
+    bool isQueryVisible(uint64_t key) const; // unknown keys are visible
+    // binds its own program and vertex array, the caller's state cache must be invalidated after
+    void queryBoxes(const std::vector<QueryBox>& boxes, const glm::mat4& viewProjection, const glm::vec3& cameraPosition);
+
+private:
+    struct Readback {
+        GLuint pbo = 0;
+        GLsync fence = nullptr;
+        int width = 0;
+        int height = 0;
+        glm::ivec2 viewportSize = glm::ivec2(0); // what the read level was reduced from
+        glm::mat4 viewProjection = glm::mat4(1.0f);
+    };
+
+    struct QueryEntry {
+        GLuint query = 0;
+        bool pending = false;
+        bool visible = true;
+        uint64_t lastFrame = 0;
+    };
+
+    // entries whose primitive hasn't been in the frustum for this many frames give their query back
+    static constexpr uint64_t QUERY_EXPIRY_FRAMES = 120;
+
+    Logger* loggerPtr = nullptr;
+    bool initialized = false;
+    bool hiZAvailable = false;
+
+    GLuint emptyVAO = 0;        // fullscreen passes generate their triangle from gl_VertexID
+    GLuint reduceProgram = 0;
+    GLint reduceSourceLoc = -1, reduceSourceSizeLoc = -1, reduceTargetSizeLoc = -1;
+
+    GLuint hiZTexture = 0;      // R32F, level 0 is half the viewport
+    GLuint hiZFramebuffer = 0;
+    int hiZWidth = 0, hiZHeight = 0;
+    std::vector<glm::ivec2> hiZLevelSizes;
+
+    std::array<Readback, 2> readbacks;
+    unsigned int nextReadback = 0;
+    DepthPyramid pyramid;
+
+    GLuint boxProgram = 0;
+    GLint boxTransformLoc = -1;
+    GLuint boxVAO = 0, boxVBO = 0, boxEBO = 0;
+    std::unordered_map<uint64_t, QueryEntry> queries;
+    uint64_t queryFrame = 0;
+
+    bool allocateHiZ(int width, int height);
+    void releaseHiZ();
+    GLuint buildProgram(const char* vertexSource, const char* fragmentSource, const char* name);
+};
@@ -0,0 +1,183 @@
+#include "ProgramBinaryCache.hpp"
+#include "platform/DiskCacheFile.hpp"
+#include "engine/ThreadPool.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr char BLOB_MAGIC[4] = { 'P', 'P', 'B', 'C' };
+    constexpr uint32_t BLOB_VERSION = 1;
+    constexpr uint64_t MAX_BINARY_SIZE = 64ull << 20;
+    constexpr const char* BLOB_EXTENSION = ".program";
+
+    struct BlobHeader {
+        char magic[4];
+        uint32_t version;
+        uint64_t key;
+        uint32_t format;
+        uint32_t padding;
+        uint64_t size;
+    };
+}
+
+
+ProgramBinaryCache::ProgramBinaryCache() = default;
+ProgramBinaryCache::~ProgramBinaryCache() = default;
+
+
+bool ProgramBinaryCache::initialize(const fs::path& cacheDir, uint64_t _maxTotalSize) {
+    std::error_code error;
+    fs::create_directories(cacheDir, error);
+    if (error) {
+        directory.clear();
+        return false;
+    }
+    directory = cacheDir;
+    maxTotalSize = _maxTotalSize;
+    if (!writePool) writePool = std::make_unique<ThreadPool>(1);
+    return true;
+}
+
+
+bool ProgramBinaryCache::isEnabled() const {
+    return !directory.empty();
+}
+
+
+// the lengths keep "ab" + "c" and "a" + "bc" apart
+uint64_t ProgramBinaryCache::keyFor(const std::string& vertSource, const std::string& fragSource, const std::string& driver) {
+    uint64_t key = DiskCacheFile::hashBytes(driver.data(), driver.size());
+    for (const std::string* source : { &vertSource, &fragSource }) {
+        uint64_t length = source->size();
+        key = DiskCacheFile::hashBytes(&length, sizeof(length), key);
+        key = DiskCacheFile::hashBytes(source->data(), source->size(), key);
+    }
+    return key;
+}
+
+
+uint64_t ProgramBinaryCache::slotFor(const std::string& vertPath, const std::string& fragPath, uint32_t variant) {
+    uint64_t slot = DiskCacheFile::hashBytes(&variant, sizeof(variant));
+    for (const std::string* path : { &vertPath, &fragPath }) {
+        uint64_t length = path->size();
+        slot = DiskCacheFile::hashBytes(&length, sizeof(length), slot);
+        slot = DiskCacheFile::hashBytes(path->data(), path->size(), slot);
+    }
+    return slot;
+}
+
+
+// <slot>_<key>.program, so the other blobs of a slot can be found by name
+fs::path ProgramBinaryCache::blobPath(uint64_t slot, uint64_t key) const {
+    return directory / (DiskCacheFile::hexName(slot) + '_' + DiskCacheFile::hexName(key) + BLOB_EXTENSION);
+}
+
+
+bool ProgramBinaryCache::load(uint64_t slot, uint64_t key, uint32_t& format, std::vector<unsigned char>& binary) const {
+    if (!isEnabled()) return false;
+
+    fs::path path = blobPath(slot, key);
+    std::ifstream blob(path, std::ios::binary);
+    if (!blob) {
+        misses++;
+        return false;
+    }
+
+    BlobHeader header;
+    blob.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!blob || std::memcmp(header.magic, BLOB_MAGIC, 4) != 0 || header.version != BLOB_VERSION
+        || header.key != key || header.size == 0 || header.size > MAX_BINARY_SIZE) {
+        misses++;
+        return false;
+    }
+
+    std::vector<unsigned char> loaded(header.size);
+    blob.read(reinterpret_cast<char*>(loaded.data()), loaded.size());
+    if (!blob) {
+        misses++;
+        return false;
+    }
+
+    format = header.format;
+    binary = std::move(loaded);
+    hits++;
+
+    std::error_code ignored; // a use, for prune()
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ignored);
+    return true;
+}
+
+
+bool ProgramBinaryCache::store(uint64_t slot, uint64_t key, uint32_t format, const void* binary, size_t size) const {
+    if (!isEnabled() || binary == nullptr || size == 0 || size > MAX_BINARY_SIZE) return false;
+
+    BlobHeader header{};
+    std::memcpy(header.magic, BLOB_MAGIC, 4);
+    header.version = BLOB_VERSION;
+    header.key = key;
+    header.format = format;
+    header.size = size;
+
+    fs::path finalPath = blobPath(slot, key);
+    bool written = DiskCacheFile::writeAtomically(finalPath, [&](std::ofstream& blob) {
+        blob.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        blob.write(static_cast<const char*>(binary), size);
+    });
+    if (!written) return false;
+    prune(finalPath);
+    return true;
+}
+
+
+// Nothing can report a failed write from a worker, the next open just compiles that program again.
+void ProgramBinaryCache::storeInBackground(uint64_t slot, uint64_t key, uint32_t format, std::vector<unsigned char> binary) {
+    if (!isEnabled() || !writePool) return;
+    writePool->submit([this, slot, key, format, binary = std::move(binary)]() {
+        store(slot, key, format, binary.data(), binary.size());
+    });
+}
+
+
+void ProgramBinaryCache::waitIdle() {
+    if (writePool) writePool->waitIdle();
+}
+
+
+// drops the rest of kept's slot, then the least recently used blobs past maxTotalSize
+void ProgramBinaryCache::prune(const fs::path& kept) const {
+    struct Blob {
+        fs::path path;
+        fs::file_time_type used;
+        uint64_t size;
+    };
+    std::string slotPrefix = kept.filename().string().substr(0, 17);
+    std::vector<Blob> blobs;
+    uint64_t totalSize = 0;
+
+    std::error_code error;
+    for (const fs::directory_entry& entry : fs::directory_iterator(directory, error)) {
+        const fs::path& path = entry.path();
+        if (path.extension() != BLOB_EXTENSION) continue;
+        if (path != kept && path.filename().string().compare(0, slotPrefix.size(), slotPrefix) == 0) {
+            fs::remove(path, error);
+            continue;
+        }
+        std::error_code timeError, sizeError;
+        Blob blob{ path, entry.last_write_time(timeError), entry.file_size(sizeError) };
+        if (timeError || sizeError) continue;
+        totalSize += blob.size;
+        blobs.push_back(std::move(blob));
+    }
+    if (totalSize <= maxTotalSize) return;
+
+    std::sort(blobs.begin(), blobs.end(), [](const Blob& a, const Blob& b) { return a.used < b.used; });
+    for (const Blob& blob : blobs) {
+        if (totalSize <= maxTotalSize) break;
+        if (blob.path == kept) continue;
+        if (fs::remove(blob.path, error)) totalSize -= blob.size;
+    }
+}
@@ -0,0 +1,61 @@
+// DESCRIPTION
+/*
+ProgramBinaryCache keeps linked programs next to the project (glGetProgramBinary), so reopening
+a project hands the driver its own binaries back (glProgramBinary) instead of compiling GLSL again.
+
+One blob per program, named after its key. The key hashes the exact source text given to the
+compiler, after includes are resolved and defines are prepended, together with the driver
+(vendor, renderer and version strings). A driver update or a different GPU simply misses. The
+driver can still reject a binary it wrote itself, so ShaderProgram compiles from source whenever
+glProgramBinary fails to link, and the fresh binary overwrites the blob.
+
+Every blob also belongs to a slot, the program's files and variant. Storing a blob removes the
+others in its slot, so saving a shader over and over replaces its binary instead of piling up
+one per edit. Past the size limit the least recently used blobs go, a hit counts as a use.
+
+Only files are handled here, nothing touches GL. Blobs are written through
+DiskCacheFile::writeAtomically, like the other caches. storeInBackground does that on the cache's own ThreadPool, so a
+hot reload doesn't wait on the disk.
+*/
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+class ProgramBinaryCache {
+public:
+    static constexpr uint64_t DEFAULT_MAX_TOTAL_SIZE = 256ull << 20;
+
+    ProgramBinaryCache();
+    ~ProgramBinaryCache();
+    bool initialize(const std::filesystem::path& cacheDir, uint64_t maxTotalSize = DEFAULT_MAX_TOTAL_SIZE);
+    bool isEnabled() const;
+
+    static uint64_t keyFor(const std::string& vertSource, const std::string& fragSource, const std::string& driver);
+    static uint64_t slotFor(const std::string& vertPath, const std::string& fragPath, uint32_t variant);
+
+    bool load(uint64_t slot, uint64_t key, uint32_t& format, std::vector<unsigned char>& binary) const;
+    bool store(uint64_t slot, uint64_t key, uint32_t format, const void* binary, size_t size) const;
+    void storeInBackground(uint64_t slot, uint64_t key, uint32_t format, std::vector<unsigned char> binary);
+    void waitIdle(); // for the background stores
+
+    unsigned int getHits() const { return hits; }
+    unsigned int getMisses() const { return misses; }
+
+private:
+    std::filesystem::path directory;
+    uint64_t maxTotalSize = DEFAULT_MAX_TOTAL_SIZE;
+    mutable std::atomic<unsigned int> hits = 0;
+    mutable std::atomic<unsigned int> misses = 0;
+
+    std::filesystem::path blobPath(uint64_t slot, uint64_t key) const;
+    void prune(const std::filesystem::path& kept) const;
+
+    std::unique_ptr<ThreadPool> writePool; // declared last so it stops before the rest goes
+};
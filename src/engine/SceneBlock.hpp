@@ -0,0 +1,28 @@
+#pragma once
+
+#include "platform/GL.hpp"
+#include <glm/glm.hpp>
+
+// Scene wide values shared by every program through one uniform buffer, updated once per frame.
+// Shaders opt in by declaring (members may be left off the end, not reordered):
+//
+//     layout(std140) uniform SceneBlock {
+//         mat4 projection;
+//         mat4 view;
+//         vec4 cameraPosition; // w unused
+//         float time;
+//     };
+//
+// Programs without the block keep receiving projection/view through glUniform.
+inline constexpr const char* SCENE_BLOCK_NAME = "SceneBlock";
+inline constexpr GLuint SCENE_BLOCK_BINDING = 0;
+
+// std140 mirror of the GLSL block above
+struct SceneBlockData {
+    glm::mat4 projection;
+    glm::mat4 view;
+    glm::vec4 cameraPosition;
+    float time;
+    float padding[3]; // std140 rounds the block size up to a multiple of 16
+};
+static_assert(sizeof(SceneBlockData) == 160, "SceneBlockData must match the std140 layout of SceneBlock");
@@ -0,0 +1,204 @@
+#include "ShaderPreprocessor.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string_view>
+
+namespace fs = std::filesystem;
+
+namespace {
+    std::string canonicalString(const fs::path& path) {
+        std::error_code error;
+        fs::path canonical = fs::weakly_canonical(path, error);
+        return error ? path.string() : canonical.string();
+    }
+
+    // the directive a line starts with ("include", "pragma"), and where its arguments begin
+    std::string_view directiveOf(std::string_view line, size_t& argumentsStart) {
+        size_t hash = line.find_first_not_of(" \t");
+        if (hash == std::string_view::npos || line[hash] != '#') return {};
+        size_t nameStart = line.find_first_not_of(" \t", hash + 1);
+        if (nameStart == std::string_view::npos) return {};
+        size_t nameEnd = line.find_first_of(" \t\"<\r", nameStart);
+        if (nameEnd == std::string_view::npos) nameEnd = line.size();
+        argumentsStart = nameEnd;
+        return line.substr(nameStart, nameEnd - nameStart);
+    }
+
+    std::string_view trimmed(std::string_view text) {
+        size_t start = text.find_first_not_of(" \t\r");
+        if (start == std::string_view::npos) return {};
+        size_t end = text.find_last_not_of(" \t\r");
+        return text.substr(start, end - start + 1);
+    }
+
+    // walks the line's /* */ comments, true if one is still open at its end
+    bool endsInComment(std::string_view line, bool inComment) {
+        for (size_t i = 0; i + 1 < line.size(); i++) {
+            if (inComment) {
+                if (line[i] == '*' && line[i + 1] == '/') { inComment = false; i++; }
+            }
+            else if (line[i] == '/' && line[i + 1] == '/') break;
+            else if (line[i] == '/' && line[i + 1] == '*') { inComment = true; i++; }
+        }
+        return inComment;
+    }
+
+    size_t indexOf(std::vector<std::string>& files, const std::string& path) {
+        auto found = std::find(files.begin(), files.end(), path);
+        if (found != files.end()) return (size_t)(found - files.begin());
+        files.push_back(path);
+        return files.size() - 1;
+    }
+}
+
+
+bool ShaderPreprocessor::resolve(const fs::path& shaderPath, Source& out) {
+    out = Source{};
+    std::vector<std::string> stack;
+    std::unordered_set<std::string> pastedOnce;
+    return append(canonicalString(shaderPath), out, stack, pastedOnce);
+}
+
+
+std::string ShaderPreprocessor::describeFiles(const Source& source) {
+    std::ostringstream description;
+    for (size_t i = 0; i < source.files.size(); i++) {
+        if (i > 0) description << ", ";
+        description << i << ": " << fs::path(source.files[i]).filename().string();
+    }
+    return description.str();
+}
+
+
+const ShaderPreprocessor::ParsedFile* ShaderPreprocessor::parse(const std::string& path) {
+    std::error_code error;
+    uint64_t size = fs::file_size(path, error);
+    if (error) return nullptr;
+    auto writeTime = fs::last_write_time(path, error);
+    if (error) return nullptr;
+    int64_t modified = (int64_t)writeTime.time_since_epoch().count();
+
+    auto cached = parsed.find(path);
+    if (cached != parsed.end() && cached->second.size == size && cached->second.modified == modified) return &cached->second;
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return nullptr;
+    std::stringstream contents;
+    contents << in.rdbuf();
+
+    ParsedFile file;
+    file.size = size;
+    file.modified = modified;
+    file.pieces.emplace_back();
+
+    std::string directory = fs::path(path).parent_path().string();
+    std::string line;
+    int lineNumber = 0;
+    bool inComment = false;
+    int disabledDepth = 0; // inside #if 0, counting the #ifs nested in it
+    while (std::getline(contents, line)) {
+        lineNumber++;
+        bool startsInComment = inComment;
+        inComment = endsInComment(line, inComment);
+
+        size_t arguments = 0;
+        std::string_view directive = startsInComment ? std::string_view{} : directiveOf(line, arguments);
+        std::string_view argument = directive.empty() ? std::string_view{} : trimmed(std::string_view(line).substr(arguments));
+
+        // lines the driver will skip are kept as they are, an #include there isn't pasted
+        if (disabledDepth > 0) {
+            if (directive == "if" || directive == "ifdef" || directive == "ifndef") disabledDepth++;
+            else if (directive == "endif") disabledDepth--;
+            else if (disabledDepth == 1 && (directive == "else" || (directive == "elif" && argument != "0"))) disabledDepth = 0;
+        }
+        else if (directive == "if" && argument == "0") {
+            disabledDepth = 1;
+        }
+        else if (directive == "include") {
+            size_t open = line.find('"', arguments);
+            size_t close = open == std::string::npos ? std::string::npos : line.find('"', open + 1);
+            if (close != std::string::npos) {
+                Piece& piece = file.pieces.back();
+                piece.include = canonicalString(fs::path(directory) / line.substr(open + 1, close - open - 1));
+                piece.lineAfter = lineNumber + 1;
+                file.pieces.emplace_back();
+                continue;
+            }
+        }
+        else if (directive == "pragma" && argument.substr(0, 4) == "once") {
+            file.pragmaOnce = true;
+            file.pieces.back().text += '\n'; // keeps the line count
+            continue;
+        }
+        file.pieces.back().text += line;
+        file.pieces.back().text += '\n';
+    }
+
+    return &(parsed[path] = std::move(file));
+}
+
+
+bool ShaderPreprocessor::append(const std::string& path, Source& out, std::vector<std::string>& stack, std::unordered_set<std::string>& pastedOnce) {
+    size_t fileIndex = indexOf(out.files, path);
+    if (std::find(stack.begin(), stack.end(), path) != stack.end()) {
+        out.error = "include cycle: " + stack.back() + " includes " + path;
+        return false;
+    }
+    // files on the stack are never parsed again, the pieces being walked stay put
+    const ParsedFile* file = parse(path);
+    if (file == nullptr) {
+        out.error = "could not read " + path;
+        if (!stack.empty()) out.error += " (included from " + stack.back() + ")";
+        return false;
+    }
+    if (file->pragmaOnce && !pastedOnce.insert(path).second) return true;
+
+    // the shader itself starts at line 1 of file 0 anyway, and its #version must stay first
+    if (!stack.empty()) out.code += "#line 1 " + std::to_string(fileIndex) + "\n";
+
+    stack.push_back(path);
+    for (const Piece& piece : file->pieces) {
+        out.code += piece.text;
+        if (piece.include.empty()) continue;
+        if (!append(piece.include, out, stack, pastedOnce)) return false;
+        out.code += "#line " + std::to_string(piece.lineAfter) + " " + std::to_string(fileIndex) + "\n";
+    }
+    stack.pop_back();
+    return true;
+}
+
+
+bool ShaderPreprocessor::copyWithIncludes(const fs::path& shaderPath, const fs::path& destPath, std::string& error) {
+    std::error_code copyError;
+    fs::copy_file(shaderPath, destPath, copyError);
+    if (copyError) {
+        error = "could not copy " + shaderPath.string() + ": " + copyError.message();
+        return false;
+    }
+
+    ShaderPreprocessor preprocessor;
+    Source source;
+    if (!preprocessor.resolve(shaderPath, source)) {
+        error = source.error;
+        return false;
+    }
+
+    fs::path sourceDir = fs::path(source.files[0]).parent_path();
+    fs::path destDir = destPath.parent_path();
+    for (size_t i = 1; i < source.files.size(); i++) {
+        fs::path relative = fs::path(source.files[i]).lexically_relative(sourceDir);
+        if (relative.empty() || *relative.begin() == "..") continue; // outside the shader's folder, left where it is
+        fs::path target = destDir / relative;
+        if (fs::exists(target)) continue; // the destination's own copy wins
+
+        fs::create_directories(target.parent_path(), copyError);
+        fs::copy_file(source.files[i], target, copyError);
+        if (copyError) {
+            error = "could not copy " + source.files[i] + ": " + copyError.message();
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,67 @@
+// DESCRIPTION
+/*
+ShaderPreprocessor expands #include "file" lines in GLSL before ShaderProgram hands the source
+to the driver, which has no idea what an include is.
+
+Paths are relative to the including file. A file containing #pragma once is pasted at most once
+per shader, ordinary #ifndef guards also work since the driver preprocesses the result. Including
+a file from itself, directly or not, is an error instead of endless recursion. An #include inside
+a block comment or an #if 0 block is left alone, like the driver would.
+
+Each pasted file is announced with #line so compile errors point at the right line. GLSL #line
+only takes a number for the file, the resolved source's files[number] is its path. Files are
+parsed once and kept until their size or modification time changes, so a chunk shared by many
+programs is read from disk once per edit.
+
+files also lists every file a shader was built from, which is what the HotReloader watches.
+*/
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class ShaderPreprocessor {
+public:
+    struct Source {
+        std::string code;
+        std::vector<std::string> files; // canonical, files[0] is the shader itself
+        std::string error;               // empty when every include resolved
+    };
+
+    // false on a missing file or an include cycle, code then holds what resolved so far
+    bool resolve(const std::filesystem::path& shaderPath, Source& out);
+
+    // file list for messages: "0: a.vert, 1: common.glsl"
+    static std::string describeFiles(const Source& source);
+
+    // copies a shader and the files it includes, keeping their paths relative to it, so a cloned
+    // preset still compiles. Includes already at the destination are not overwritten, and the
+    // shader itself is copied even when its includes don't resolve
+    static bool copyWithIncludes(const std::filesystem::path& shaderPath, const std::filesystem::path& destPath, std::string& error);
+
+    void clear() { parsed.clear(); }
+
+private:
+    // a run of verbatim lines, then optionally an include
+    struct Piece {
+        std::string text;
+        std::string include;  // canonical path, empty for the last piece
+        int lineAfter = 0;    // line number following the #include line
+    };
+
+    struct ParsedFile {
+        int64_t modified = 0;
+        uint64_t size = 0;
+        bool pragmaOnce = false;
+        std::vector<Piece> pieces;
+    };
+
+    std::unordered_map<std::string, ParsedFile> parsed; // [canonical path] <-> its last parse
+
+    const ParsedFile* parse(const std::string& path);
+    bool append(const std::string& path, Source& out, std::vector<std::string>& stack, std::unordered_set<std::string>& pastedOnce);
+};
@@ -1,23 +1,75 @@
 #include "ShaderProgram.hpp"
-#include "GetFileContents.hpp"
+#include "SceneBlock.hpp"
+#include "DrawBlock.hpp"
+#include "LODUniform.hpp"
+#include "ProgramBinaryCache.hpp"
+#include "ShaderPreprocessor.hpp"
+#include "ShaderVariant.hpp"
 #include "core/logging/LogSink.hpp"
 #include "core/logging/Logger.hpp"
 
+#include <algorithm>
+#include <cstring>
 
-ShaderProgram::ShaderProgram(const char *vertShader_path, const char *fragShader_path, const char *name, const unsigned int ID, Logger* _loggerPtr) : name(name), ID(ID), loggerPtr(_loggerPtr) {
+
+namespace {
+    // GL_COMPLETION_STATUS_KHR, the ARB extension uses the same value. glad here has no extensions.
+    constexpr GLenum COMPLETION_STATUS = 0x91B1;
+    typedef void (APIENTRYP MaxShaderCompilerThreadsFn)(GLuint count);
+
+    // program binaries are GL 4.1, and a driver may still support no formats at all
+    bool programBinariesSupported() {
+        static int supported = -1;
+        if (supported < 0) {
+            GLint formats = 0;
+            if (GLAD_GL_VERSION_4_1) glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+            supported = formats > 0;
+        }
+        return supported == 1;
+    }
+
+    // part of every binary cache key, a binary only loads on the driver that wrote it
+    const std::string& driverString() {
+        static std::string driver;
+        if (driver.empty()) {
+            for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+                const GLubyte* value = glGetString(name);
+                if (value != nullptr) driver += reinterpret_cast<const char*>(value);
+                driver += '|';
+            }
+        }
+        return driver;
+    }
+}
+
+
+ShaderProgram::ShaderProgram(const char *vertShader_path, const char *fragShader_path, const char *name, const unsigned int ID, Logger* _loggerPtr, CompileMode mode, const ShaderBuildCaches& caches, uint32_t _variant) : name(name), ID(ID), loggerPtr(_loggerPtr), binaryCache(caches.binaryCache) {
     this->vertPath = std::string(vertShader_path);
     this->fragPath = std::string(fragShader_path);
-    vertShader_code = getFileContents(vertShader_path);
-    fragShader_code = getFileContents(fragShader_path);
+
+    ShaderPreprocessor localPreprocessor;
+    ShaderPreprocessor& preprocessor = caches.preprocessor != nullptr ? *caches.preprocessor : localPreprocessor;
+    ShaderPreprocessor::Source vertSource;
+    ShaderPreprocessor::Source fragSource;
+    bool vertResolved = preprocessor.resolve(vertShader_path, vertSource);
+    bool fragResolved = preprocessor.resolve(fragShader_path, fragSource);
+    vertShader_code = std::move(vertSource.code);
+    fragShader_code = std::move(fragSource.code);
+    if (vertSource.files.size() > 1) vertFileTable = ShaderPreprocessor::describeFiles(vertSource);
+    if (fragSource.files.size() > 1) fragFileTable = ShaderPreprocessor::describeFiles(fragSource);
+    sourceFiles = std::move(vertSource.files);
+    for (std::string& file : fragSource.files) {
+        if (std::find(sourceFiles.begin(), sourceFiles.end(), file) == sourceFiles.end()) sourceFiles.push_back(std::move(file));
+    }
 
 
-    if (vertShader_code == "" || fragShader_code == "") {
-        if (vertShader_code == "") {
-            loggerPtr->addLog(LogLevel::CRITICAL, "VERTEX SHADER", "failed to get code from path:", vertShader_path);
+    if (!vertResolved || !fragResolved || vertShader_code == "" || fragShader_code == "") {
+        if (!vertResolved || vertShader_code == "") {
+            loggerPtr->addLog(LogLevel::CRITICAL, "VERTEX SHADER", "failed to get code from path:", vertSource.error.empty() ? vertShader_path : vertSource.error);
         }
 
-        if (fragShader_code == "") {
-            loggerPtr->addLog(LogLevel::CRITICAL, "FRAGMENT SHADER", "failed to get code from path:", fragShader_path);
+        if (!fragResolved || fragShader_code == "") {
+            loggerPtr->addLog(LogLevel::CRITICAL, "FRAGMENT SHADER", "failed to get code from path:", fragSource.error.empty() ? fragShader_path : fragSource.error);
         }
         return;
     }
@@ -25,63 +77,167 @@ ShaderProgram::ShaderProgram(const char *vertShader_path, const char *fragShader
         loggerPtr->addLog(LogLevel::CRITICAL, "ShaderProgram::ShaderProgram", "ShaderProgram created with empty name! Program will crash soon");
         return;
     }
+
+    // every variant gets the defines the source reads, the base one (variant 0) included
+    variantMask = ShaderVariant::featuresUsedBy(vertShader_code) | ShaderVariant::featuresUsedBy(fragShader_code);
+    variant = _variant & variantMask;
+    std::string defines = ShaderVariant::definesFor(variant, variantMask);
+    ShaderVariant::insertDefines(vertShader_code, defines);
+    ShaderVariant::insertDefines(fragShader_code, defines);
+
+    if (loadBinary()) return;
+    submitCompile();
+    if (mode == CompileMode::Blocking) finishCompile();
+}
+
+
+bool ShaderProgram::supportsParallelCompile() {
+    static int supported = -1;
+    if (supported < 0) {
+        supported = glfwExtensionSupported("GL_KHR_parallel_shader_compile") || glfwExtensionSupported("GL_ARB_parallel_shader_compile");
+        if (supported) {
+            auto maxThreads = (MaxShaderCompilerThreadsFn)glfwGetProcAddress("glMaxShaderCompilerThreadsKHR");
+            if (maxThreads == nullptr) maxThreads = (MaxShaderCompilerThreadsFn)glfwGetProcAddress("glMaxShaderCompilerThreadsARB");
+            if (maxThreads != nullptr) maxThreads(0xFFFFFFFF); // as many threads as the driver likes
+        }
+    }
+    return supported == 1;
+}
+
+
+// Without the extension the status query still waits, but only from the next frame on, which
+// drivers that compile on their own threads anyway often have used to finish.
+bool ShaderProgram::pollCompile() {
+    if (!m_pending) return true;
+    if (supportsParallelCompile()) {
+        GLint done = GL_FALSE;
+        glGetProgramiv(gpuID, COMPLETION_STATUS, &done);
+        if (done == GL_FALSE) return false;
+    }
+    finishCompile();
+    return true;
+}
+
+
+// Nothing here reads compile or link status, so the driver is free to do the work in the background.
+void ShaderProgram::submitCompile() {
     const char *vertShader_src = vertShader_code.c_str();
     const char *fragShader_src = fragShader_code.c_str();
-   
-    GLuint vertShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertShader, 1, &vertShader_src, NULL);
-    glCompileShader(vertShader);
 
-    GLuint fragShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragShader, 1, &fragShader_src, NULL);
-    glCompileShader(fragShader);
+    vertShaderID = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertShaderID, 1, &vertShader_src, NULL);
+    glCompileShader(vertShaderID);
+
+    fragShaderID = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fragShaderID, 1, &fragShader_src, NULL);
+    glCompileShader(fragShaderID);
+
+    // linking shaders that failed to compile just fails the link, finishCompile reports the real error
+    gpuID = glCreateProgram();
+    if (binaryKey != 0) glProgramParameteri(gpuID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glAttachShader(gpuID, vertShaderID);
+    glAttachShader(gpuID, fragShaderID);
+    glLinkProgram(gpuID);
+    m_pending = true;
+}
+
+
+void ShaderProgram::finishCompile() {
+    m_pending = false;
 
-    
     // Check for compilation errors
     GLint success;
-    glGetShaderiv(vertShader, GL_COMPILE_STATUS, &success);
+    glGetShaderiv(vertShaderID, GL_COMPILE_STATUS, &success);
     if (!success) {
         char infoLog[512];
-        glGetShaderInfoLog(vertShader, 512, NULL, infoLog);
-        loggerPtr->addLog(LogLevel::LOG_ERROR, "VERTEX SHADER", "Compilation error:\n", infoLog);
-        return;
+        glGetShaderInfoLog(vertShaderID, 512, NULL, infoLog);
+        loggerPtr->addLog(LogLevel::LOG_ERROR, "VERTEX SHADER", "Compilation error:\n", vertFileTable.empty() ? infoLog : std::string(infoLog) + "(files " + vertFileTable + ")");
     }
-
-    glGetShaderiv(fragShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(fragShader, 512, NULL, infoLog);
-        loggerPtr->addLog(LogLevel::LOG_ERROR, "FRAGMENT SHADER", "Compilation error:\n", infoLog);
-        return;
+    else {
+        glGetShaderiv(fragShaderID, GL_COMPILE_STATUS, &success);
+        if (!success) {
+            char infoLog[512];
+            glGetShaderInfoLog(fragShaderID, 512, NULL, infoLog);
+            loggerPtr->addLog(LogLevel::LOG_ERROR, "FRAGMENT SHADER", "Compilation error:\n", fragFileTable.empty() ? infoLog : std::string(infoLog) + "(files " + fragFileTable + ")");
+        }
     }
 
-    gpuID = glCreateProgram();
-    glAttachShader(gpuID, vertShader);
-    glAttachShader(gpuID, fragShader);
-    glLinkProgram(gpuID);
-
     // Check if link was successful
-    glGetProgramiv(gpuID, GL_LINK_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetProgramInfoLog(gpuID, 512, NULL, infoLog);
-        loggerPtr->addLog(LogLevel::LOG_ERROR, "SHADER LINK", infoLog);
-        return;
+    if (success) {
+        glGetProgramiv(gpuID, GL_LINK_STATUS, &success);
+        if (!success) {
+            char infoLog[512];
+            glGetProgramInfoLog(gpuID, 512, NULL, infoLog);
+            loggerPtr->addLog(LogLevel::LOG_ERROR, "SHADER LINK", infoLog);
+        }
     }
 
-    if (success){
-        this->m_compiled = true;
-    } else {
-        char infoLog[512];
-        glGetProgramInfoLog(gpuID, 512, NULL, infoLog);
-        loggerPtr->addLog(LogLevel::LOG_ERROR, "Shader Link Error:\n", infoLog);
+    glDeleteShader(vertShaderID);
+    glDeleteShader(fragShaderID);
+    vertShaderID = 0;
+    fragShaderID = 0;
+
+    if (!success) {
         glDeleteProgram(gpuID);
         this->gpuID = 0;
         this->m_compiled = false;
         return;
     }
-    glDeleteShader(vertShader);
-    glDeleteShader(fragShader);
+
+    storeBinary();
+    onLinked();
+}
+
+
+// A hit is linked on return, no compile at all. The driver may refuse a binary it wrote itself
+// (an update, other settings), then the program compiles from source like a miss.
+bool ShaderProgram::loadBinary() {
+    if (binaryCache == nullptr || !binaryCache->isEnabled() || !programBinariesSupported()) return false;
+    binarySlot = ProgramBinaryCache::slotFor(vertPath, fragPath, variant);
+    binaryKey = ProgramBinaryCache::keyFor(vertShader_code, fragShader_code, driverString());
+
+    uint32_t format = 0;
+    std::vector<unsigned char> binary;
+    if (!binaryCache->load(binarySlot, binaryKey, format, binary)) return false;
+
+    gpuID = glCreateProgram();
+    glProgramBinary(gpuID, (GLenum)format, binary.data(), (GLsizei)binary.size());
+    GLint success = GL_FALSE;
+    glGetProgramiv(gpuID, GL_LINK_STATUS, &success);
+    if (!success) {
+        glDeleteProgram(gpuID);
+        gpuID = 0;
+        return false;
+    }
+
+    onLinked();
+    return true;
+}
+
+
+// glGetProgramBinary needs this thread's context, the file write goes to the cache's worker
+void ShaderProgram::storeBinary() {
+    if (binaryKey == 0) return;
+
+    GLint length = 0;
+    glGetProgramiv(gpuID, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    std::vector<unsigned char> binary(length);
+    GLsizei written = 0;
+    GLenum format = 0;
+    glGetProgramBinary(gpuID, length, &written, &format, binary.data());
+    if (written <= 0) return;
+    binary.resize((size_t)written);
+    binaryCache->storeInBackground(binarySlot, binaryKey, format, std::move(binary));
+}
+
+
+void ShaderProgram::onLinked() {
+    this->m_compiled = true;
+    reflectUniforms();
+    bindSceneBlock();
+    bindDrawBlock();
 }
 
 
@@ -102,93 +258,93 @@ void ShaderProgram::kill() {
 
 void ShaderProgram::setUniform_int(const char *uniformName, int val) {
     if (gpuID == 0) return;
-    GLint loc = glGetUniformLocation(gpuID, uniformName);
-    if (loc == -1) {
+    UniformHandle handle = getUniformHandle(uniformName);
+    if (!handle.isValid()) {
         loggerPtr->addLog(LogLevel::WARNING, "SHADER UNIFORM: Int", "Location not found for:", uniformName);
         return;
     }
-    glUniform1i(loc, val);
+    setUniform_int(handle, val);
 }
 
 
 void ShaderProgram::setUniform_float(const char *uniformName, float val) {
     if (gpuID == 0) return;
-    GLint loc = glGetUniformLocation(gpuID, uniformName);
-    if (loc == -1) {
+    UniformHandle handle = getUniformHandle(uniformName);
+    if (!handle.isValid()) {
         loggerPtr->addLog(LogLevel::WARNING, "SHADER UNIFORM Float", "Location not found for:", uniformName);
         return;
     }
-    glUniform1f(loc, val);
+    setUniform_float(handle, val);
 }
 
 
 void ShaderProgram::setUniform_vec3int(const char *uniformName, int xVal, int yVal, int zVal) {
     if (gpuID == 0) return;
-    GLint loc = glGetUniformLocation(gpuID, uniformName);
-    if (loc == -1) {
+    UniformHandle handle = getUniformHandle(uniformName);
+    if (!handle.isValid()) {
         loggerPtr->addLog(LogLevel::WARNING, "SHADER UNIFORM: Vec3int", "Location not found for:", uniformName);
         return;
     }
-    glUniform3i(loc, xVal, yVal, zVal);
+    setUniform_vec3int(handle, glm::ivec3(xVal, yVal, zVal));
 }
 
 
 void ShaderProgram::setUniform_vec3int(const char *uniformName, glm::ivec3 vals) {
     if (gpuID == 0) return;
-    GLint loc = glGetUniformLocation(gpuID, uniformName);
-    if (loc == -1) {
+    UniformHandle handle = getUniformHandle(uniformName);
+    if (!handle.isValid()) {
         loggerPtr->addLog(LogLevel::WARNING, "SHADER UNIFORM: Vec3int", "Location not found for:", uniformName);
         return;
     }
-    glUniform3i(loc, vals.x, vals.y, vals.z);
+    setUniform_vec3int(handle, vals);
 }
 
 
 void ShaderProgram::setUniform_vec3float(const char *uniformName, float xVal, float yVal, float zVal) {
     if (gpuID == 0) return;
-    GLint loc = glGetUniformLocation(gpuID, uniformName);
-    if (loc == -1) {
+    UniformHandle handle = getUniformHandle(uniformName);
+    if (!handle.isValid()) {
         loggerPtr->addLog(LogLevel::WARNING, "SHADER UNIFORM: Vec3float", "Location not found for:", uniformName);
         return;
     }
-    glUniform3f(loc, xVal, yVal, zVal);
+    setUniform_vec3float(handle, glm::fvec3(xVal, yVal, zVal));
 }
 
 
 void ShaderProgram::setUniform_vec3float(const char *uniformName, glm::fvec3 vals) {
     if (gpuID == 0) return;
-    GLint loc = glGetUniformLocation(gpuID, uniformName);
-    if (loc == -1) {
+    UniformHandle handle = getUniformHandle(uniformName);
+    if (!handle.isValid()) {
         loggerPtr->addLog(LogLevel::WARNING, "SHADER UNIFORM: Vec3float", "Location not found for:", uniformName);
         return;
     }
-    glUniform3f(loc, vals.x, vals.y, vals.z);
+    setUniform_vec3float(handle, vals);
 }
 
 void ShaderProgram::setUniform_vec4float(const char *uniformName, glm::fvec4 vals) {
     if (gpuID == 0) return;
-    GLint loc = glGetUniformLocation(gpuID, uniformName);
-    if (loc == -1) {
+    UniformHandle handle = getUniformHandle(uniformName);
+    if (!handle.isValid()) {
         loggerPtr->addLog(LogLevel::WARNING, "SHADER UNIFORM: Vec4float", "Location not found for:", uniformName);
         return;
     }
-    glUniform4f(loc, vals.x, vals.y, vals.z, vals.w);
+    setUniform_vec4float(handle, vals);
 }
 
 
 void ShaderProgram::setUniform_mat4float(const char *uniformName, glm::fmat4 M) const {
     if (gpuID == 0) return;
-    GLint loc = glGetUniformLocation(gpuID, uniformName);
-    if (loc == -1) {
+    UniformHandle handle = getUniformHandle(uniformName);
+    if (!handle.isValid()) {
         loggerPtr->addLog(LogLevel::WARNING, "SHADER UNIFORM: mat4float", "Location not found for:", uniformName);
         return;
     }
-    glUniformMatrix4fv(loc, 1, GL_FALSE, &M[0][0]);
+    setUniform_mat4float(handle, M);
 }
 
 glm::vec3 ShaderProgram::getUniform_vec3float(const char* uniformName) {
     if (gpuID == 0) return glm::vec3(0);
-    GLint loc = glGetUniformLocation(gpuID, uniformName);
+    GLint loc = getLocation(uniformName);
     if (loc == -1) {
         loggerPtr->addLog(LogLevel::WARNING, "SHADER UNIFORM: Vec3float", "Location not found for:", uniformName);
         return glm::vec3(0);
@@ -201,7 +357,7 @@ glm::vec3 ShaderProgram::getUniform_vec3float(const char* uniformName) {
 
 glm::vec4 ShaderProgram::getUniform_vec4float(const char* uniformName) {
     if (gpuID == 0) return glm::vec4(0);
-    GLint loc = glGetUniformLocation(gpuID, uniformName);
+    GLint loc = getLocation(uniformName);
     if (loc == -1) {
         loggerPtr->addLog(LogLevel::WARNING, "SHADER UNIFORM: Vec4float", "Location not found for:", uniformName);
         return glm::vec4(0);
@@ -214,7 +370,7 @@ glm::vec4 ShaderProgram::getUniform_vec4float(const char* uniformName) {
 
 float ShaderProgram::getUniform_float(const char* uniformName) {
     if (gpuID == 0) return 0.0f;
-    GLint loc = glGetUniformLocation(gpuID, uniformName);
+    GLint loc = getLocation(uniformName);
     if (loc == -1) {
         loggerPtr->addLog(LogLevel::WARNING, "SHADER UNIFORM: Vec4float", "Location not found for:", uniformName);
         return 0;
@@ -227,7 +383,7 @@ float ShaderProgram::getUniform_float(const char* uniformName) {
 
 int ShaderProgram::getUniform_int(const char* uniformName) {
     if (gpuID == 0) return 0;
-    GLint loc = glGetUniformLocation(gpuID, uniformName);
+    GLint loc = getLocation(uniformName);
     if (loc == -1) {
         loggerPtr->addLog(LogLevel::WARNING, "SHADER UNIFORM: Vec4float", "Location not found for:", uniformName);
         return 0;
@@ -238,16 +394,271 @@ int ShaderProgram::getUniform_int(const char* uniformName) {
     return value[0];
 }
 
-bool ShaderProgram::hasUniform(const char* uniformName) {
+bool ShaderProgram::hasUniform(const char* uniformName) const {
     if (gpuID == 0) return false;
-    GLint loc = glGetUniformLocation(gpuID, uniformName);
-    if (loc == -1) {
-        return false;
+    return uniformLookup.contains(uniformName);
+}
+
+
+UniformHandle ShaderProgram::getUniformHandle(std::string_view uniformName) const {
+    auto it = uniformLookup.find(uniformName);
+    if (it == uniformLookup.end()) return UniformHandle{};
+    return UniformHandle{ it->second };
+}
+
+
+UniformHandle ShaderProgram::getUniformHandle(unsigned int uniformID, std::string_view uniformName) const {
+    ResolvedUniform& resolved = resolvedUniforms[uniformID];
+    if (resolved.name != uniformName) {
+        resolved.name = uniformName;
+        resolved.handle = getUniformHandle(uniformName);
+    }
+    return resolved.handle;
+}
+
+
+const UniformInfo* ShaderProgram::getUniformInfo(UniformHandle handle) const {
+    if (!handle.isValid() || handle.index >= (int)uniformTable.size()) return nullptr;
+    return &uniformTable[handle.index];
+}
+
+
+const std::vector<UniformInfo>& ShaderProgram::getActiveUniforms() const {
+    return uniformTable;
+}
+
+
+bool ShaderProgram::setUniform_int(UniformHandle handle, int val) {
+    GLint loc = getLocation(handle);
+    if (loc == -1) return false;
+    if (!updateShadow(handle, &val, sizeof(val))) return false;
+    glUniform1i(loc, val);
+    return true;
+}
+
+
+bool ShaderProgram::setUniform_float(UniformHandle handle, float val) {
+    GLint loc = getLocation(handle);
+    if (loc == -1) return false;
+    if (!updateShadow(handle, &val, sizeof(val))) return false;
+    glUniform1f(loc, val);
+    return true;
+}
+
+
+bool ShaderProgram::setUniform_vec3int(UniformHandle handle, glm::ivec3 vals) {
+    GLint loc = getLocation(handle);
+    if (loc == -1) return false;
+    if (!updateShadow(handle, &vals, sizeof(vals))) return false;
+    glUniform3i(loc, vals.x, vals.y, vals.z);
+    return true;
+}
+
+
+bool ShaderProgram::setUniform_vec3float(UniformHandle handle, glm::fvec3 vals) {
+    GLint loc = getLocation(handle);
+    if (loc == -1) return false;
+    if (!updateShadow(handle, &vals, sizeof(vals))) return false;
+    glUniform3f(loc, vals.x, vals.y, vals.z);
+    return true;
+}
+
+
+bool ShaderProgram::setUniform_vec4float(UniformHandle handle, glm::fvec4 vals) {
+    GLint loc = getLocation(handle);
+    if (loc == -1) return false;
+    if (!updateShadow(handle, &vals, sizeof(vals))) return false;
+    glUniform4f(loc, vals.x, vals.y, vals.z, vals.w);
+    return true;
+}
+
+
+bool ShaderProgram::setUniform_mat4float(UniformHandle handle, const glm::fmat4& M) const {
+    GLint loc = getLocation(handle);
+    if (loc == -1) return false;
+    if (!updateShadow(handle, &M[0][0], sizeof(M))) return false;
+    glUniformMatrix4fv(loc, 1, GL_FALSE, &M[0][0]);
+    return true;
+}
+
+
+bool ShaderProgram::isUniformCurrent(UniformHandle handle, unsigned int uniformID, uint64_t generation) const {
+    if (generation == 0 || getLocation(handle) == -1) return false;
+    const UniformShadow& shadow = uniformShadows[handle.index];
+    return shadow.generation == generation && shadow.uniformID == uniformID;
+}
+
+
+void ShaderProgram::stampUniform(UniformHandle handle, unsigned int uniformID, uint64_t generation) {
+    if (getLocation(handle) == -1) return;
+    UniformShadow& shadow = uniformShadows[handle.index];
+    shadow.uniformID = uniformID;
+    shadow.generation = generation;
+}
+
+
+glm::vec3 ShaderProgram::getUniform_vec3float(UniformHandle handle) {
+    GLint loc = getLocation(handle);
+    if (loc == -1) return glm::vec3(0);
+
+    GLfloat value[3];
+    glGetUniformfv(gpuID, loc, value);
+    return glm::vec3(value[0], value[1], value[2]);
+}
+
+
+glm::vec4 ShaderProgram::getUniform_vec4float(UniformHandle handle) {
+    GLint loc = getLocation(handle);
+    if (loc == -1) return glm::vec4(0);
+
+    GLfloat value[4];
+    glGetUniformfv(gpuID, loc, value);
+    return glm::vec4(value[0], value[1], value[2], value[3]);
+}
+
+
+float ShaderProgram::getUniform_float(UniformHandle handle) {
+    GLint loc = getLocation(handle);
+    if (loc == -1) return 0.0f;
+
+    GLfloat value[1];
+    glGetUniformfv(gpuID, loc, value);
+    return value[0];
+}
+
+
+int ShaderProgram::getUniform_int(UniformHandle handle) {
+    GLint loc = getLocation(handle);
+    if (loc == -1) return 0;
+
+    GLint value[1];
+    glGetUniformiv(gpuID, loc, value);
+    return value[0];
+}
+
+
+// Runs once after a successful link. Every later uniform access goes through this table
+// instead of asking the driver with glGetUniformLocation.
+void ShaderProgram::reflectUniforms() {
+    uniformTable.clear();
+    uniformLookup.clear();
+    resolvedUniforms.clear();
+    uniformShadows.clear();
+    lodHandle = UniformHandle{};
+    if (gpuID == 0) return;
+
+    GLint activeCount = 0;
+    GLint maxNameLength = 0;
+    glGetProgramiv(gpuID, GL_ACTIVE_UNIFORMS, &activeCount);
+    glGetProgramiv(gpuID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+    if (activeCount <= 0) return;
+
+    std::vector<GLchar> nameBuffer(std::max(maxNameLength, 1));
+    uniformTable.reserve(activeCount);
+
+    for (GLint idx = 0; idx < activeCount; idx++) {
+        GLsizei nameLength = 0;
+        GLint arraySize = 0;
+        GLenum glType = 0;
+        glGetActiveUniform(gpuID, (GLuint)idx, (GLsizei)nameBuffer.size(), &nameLength, &arraySize, &glType, nameBuffer.data());
+        std::string activeName(nameBuffer.data(), nameLength);
+
+        // uniforms inside uniform blocks have no location
+        GLint location = glGetUniformLocation(gpuID, activeName.c_str());
+        if (location == -1) continue;
+
+        // arrays are reported once as "name[0]", expand them so each element can be looked up directly
+        if (!activeName.ends_with("[0]")) {
+            uniformLookup.emplace(activeName, (int)uniformTable.size());
+            uniformTable.push_back(UniformInfo{ activeName, location, glType, arraySize });
+            continue;
+        }
+
+        std::string baseName = activeName.substr(0, activeName.size() - 3);
+        for (GLint element = 0; element < arraySize; element++) {
+            std::string elementName = baseName + "[" + std::to_string(element) + "]";
+            GLint elementLocation = element == 0 ? location : glGetUniformLocation(gpuID, elementName.c_str());
+            if (elementLocation == -1) continue;
+
+            uniformLookup.emplace(elementName, (int)uniformTable.size());
+            uniformTable.push_back(UniformInfo{ elementName, elementLocation, glType, arraySize });
+        }
+        // GL also accepts the bare array name as an alias for element 0
+        auto firstElement = uniformLookup.find(activeName);
+        if (firstElement != uniformLookup.end()) {
+            uniformLookup.emplace(baseName, firstElement->second);
+        }
     }
-    else return true;
 
+    uniformShadows.resize(uniformTable.size());
+    lodHandle = getUniformHandle(LOD_UNIFORM_NAME);
+}
+
+
+// GLSL 330 can't declare the binding point in the shader, so attach the block here once after linking.
+void ShaderProgram::bindSceneBlock() {
+    m_usesSceneBlock = false;
+    if (gpuID == 0) return;
+
+    GLuint blockIndex = glGetUniformBlockIndex(gpuID, SCENE_BLOCK_NAME);
+    if (blockIndex == GL_INVALID_INDEX) return;
+
+    GLint blockSize = 0;
+    glGetActiveUniformBlockiv(gpuID, blockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &blockSize);
+    if (blockSize > (GLint)sizeof(SceneBlockData)) {
+        loggerPtr->addLog(LogLevel::WARNING, "ShaderProgram::bindSceneBlock", name + ": SceneBlock is larger than the scene buffer, extra members will read garbage");
+    }
+
+    glUniformBlockBinding(gpuID, blockIndex, SCENE_BLOCK_BINDING);
+    m_usesSceneBlock = true;
+}
+
+
+// Shader storage blocks are GL 4.3, a program can only have one when the context does.
+void ShaderProgram::bindDrawBlock() {
+    m_usesDrawBlock = false;
+    if (gpuID == 0 || GLAD_GL_VERSION_4_3 == 0) return;
+
+    GLuint blockIndex = glGetProgramResourceIndex(gpuID, GL_SHADER_STORAGE_BLOCK, DRAW_BLOCK_NAME);
+    if (blockIndex == GL_INVALID_INDEX) return;
+
+    glShaderStorageBlockBinding(gpuID, blockIndex, DRAW_BLOCK_BINDING);
+    m_usesDrawBlock = true;
+}
+
+
+// Returns true if the value differs from what the location last received, and records it.
+// Compares raw bytes: a float going from 0.0 to -0.0 costs one redundant upload, which is fine.
+bool ShaderProgram::updateShadow(UniformHandle handle, const void* data, unsigned int size) const {
+    UniformShadow& shadow = uniformShadows[handle.index];
+    if (shadow.size == size && std::memcmp(shadow.bytes.data(), data, size) == 0) return false;
+
+    std::memcpy(shadow.bytes.data(), data, size);
+    shadow.size = size;
+    shadow.generation = 0;
+    return true;
+}
+
+
+GLint ShaderProgram::getLocation(const char* uniformName) const {
+    if (gpuID == 0) return -1;
+    auto it = uniformLookup.find(uniformName);
+    if (it == uniformLookup.end()) return -1;
+    return uniformTable[it->second].location;
+}
+
+
+GLint ShaderProgram::getLocation(UniformHandle handle) const {
+    if (gpuID == 0) return -1;
+    const UniformInfo* info = getUniformInfo(handle);
+    if (info == nullptr) return -1;
+    return info->location;
 }
 
 ShaderProgram::~ShaderProgram(){
+    if (m_pending) {
+        glDeleteShader(vertShaderID);
+        glDeleteShader(fragShaderID);
+    }
     this->kill();
 }
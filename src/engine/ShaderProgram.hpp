@@ -4,12 +4,48 @@
 #include "platform/GL.hpp"
 #include <glm/glm.hpp>
 #include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <array>
+#include <cstdint>
 
 class Logger;
+class ProgramBinaryCache;
+class ShaderPreprocessor;
+
+// One active uniform as reported by the driver after linking.
+// Array uniforms are expanded so every element ("arr[2]") gets its own entry.
+struct UniformInfo {
+    std::string name;
+    GLint location = -1;
+    GLenum glType = 0;
+    GLint arraySize = 1;
+};
+
+// Index into a program's reflected uniform table. Only valid for the program that produced it,
+// a hot reloaded program has a new table so handles must be looked up again.
+struct UniformHandle {
+    int index = -1;
+    bool isValid() const { return index >= 0; }
+};
+
+// Shared by every program the ShaderRegistry builds, either may be null.
+struct ShaderBuildCaches {
+    ShaderPreprocessor* preprocessor = nullptr; // parsed #include files
+    ProgramBinaryCache* binaryCache = nullptr;
+};
 
 class ShaderProgram {
 public: 
-    GLuint gpuID;
+    // Deferred submits the compile and link without asking the driver how they went, which would
+    // wait for them. The program can't be used until pollCompile() says it's done.
+    enum class CompileMode {
+        Blocking,
+        Deferred
+    };
+
+    GLuint gpuID = 0;
     std::string vertShader_code;
     std::string fragShader_code;
     std::string name;
@@ -18,7 +54,17 @@ public:
     std::string fragPath;
     Logger* loggerPtr = nullptr;
     
-    ShaderProgram(const char *vertshader_path, const char *fragshader_path, const char *name, const unsigned int id, Logger* _loggerPtr);
+    ShaderProgram(const char *vertshader_path, const char *fragshader_path, const char *name, const unsigned int id, Logger* _loggerPtr, CompileMode mode = CompileMode::Blocking, const ShaderBuildCaches& caches = {}, uint32_t _variant = 0);
+    // true once a deferred compile finished, successfully or not (see isCompiled)
+    bool pollCompile();
+    bool isPending() const { return m_pending; }
+    // canonical paths of both stages and everything they #include, even files that failed to resolve
+    const std::vector<std::string>& getSourceFiles() const { return sourceFiles; }
+    // see engine/ShaderVariant.hpp: the features compiled in, and the ones the source reads at all
+    uint32_t getVariant() const { return variant; }
+    uint32_t getVariantMask() const { return variantMask; }
+    // GL_KHR_parallel_shader_compile, lets pollCompile check on the driver's compile threads without waiting
+    static bool supportsParallelCompile();
     void use();
     void kill();
     void setUniform_int(const char *uniformName, int val);
@@ -33,10 +79,90 @@ public:
     glm::vec4 getUniform_vec4float(const char* uniformName);
     float getUniform_float(const char* uniformName);
     int getUniform_int(const char* uniformName);
-    bool hasUniform(const char* uniformName);
+    bool hasUniform(const char* uniformName) const;
+
+    // HANDLE BASED ACCESS (no driver string lookups)
+    // Setters return true when a glUniform call was issued, false when the location already held the value.
+    // Like the name based setters they expect this program to be bound.
+    UniformHandle getUniformHandle(std::string_view uniformName) const;
+    UniformHandle getUniformHandle(const char* uniformName) const { return getUniformHandle(std::string_view(uniformName)); }
+    // Same, remembered per registry uniform so a draw compares the name instead of hashing it.
+    // Forgotten when the program relinks, and looked up again when the uniform is renamed.
+    UniformHandle getUniformHandle(unsigned int uniformID, std::string_view uniformName) const;
+    UniformHandle getLodHandle() const { return lodHandle; } // LOD_UNIFORM_NAME, see LODUniform.hpp
+    const UniformInfo* getUniformInfo(UniformHandle handle) const;
+    const std::vector<UniformInfo>& getActiveUniforms() const;
+    bool setUniform_int(UniformHandle handle, int val);
+    bool setUniform_float(UniformHandle handle, float val);
+    bool setUniform_vec3int(UniformHandle handle, glm::ivec3 vals);
+    bool setUniform_vec3float(UniformHandle handle, glm::fvec3 vals);
+    bool setUniform_vec4float(UniformHandle handle, glm::fvec4 vals);
+    bool setUniform_mat4float(UniformHandle handle, const glm::fmat4& vals) const;
+
+    // Generation stamps let callers skip even the value compare: after uploading registry uniform
+    // (uniformID, generation) to a location, stamp it, and later check isUniformCurrent first.
+    // Any upload through a setter clears the stamp. Generation 0 means "untracked" and never matches.
+    bool isUniformCurrent(UniformHandle handle, unsigned int uniformID, uint64_t generation) const;
+    void stampUniform(UniformHandle handle, unsigned int uniformID, uint64_t generation);
+    glm::vec3 getUniform_vec3float(UniformHandle handle);
+    glm::vec4 getUniform_vec4float(UniformHandle handle);
+    float getUniform_float(UniformHandle handle);
+    int getUniform_int(UniformHandle handle);
+    bool usesSceneBlock() const { return m_usesSceneBlock; }
+    bool usesDrawBlock() const { return m_usesDrawBlock; } // see engine/DrawBlock.hpp
     bool m_compiled = false;
     bool isCompiled() const { return m_compiled; }
     virtual ~ShaderProgram();
+
+private:
+    // Last value uploaded to a location, so unchanged values never reach glUniform*.
+    struct UniformShadow {
+        std::array<unsigned char, sizeof(glm::fmat4)> bytes{};
+        unsigned int size = 0;      // 0 until the first upload
+        unsigned int uniformID = 0; // stamp, see stampUniform
+        uint64_t generation = 0;
+    };
+
+    // lets uniformLookup.find take a string_view without building a std::string
+    struct NameHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+    };
+    struct ResolvedUniform {
+        std::string name;
+        UniformHandle handle;
+    };
+
+    std::vector<UniformInfo> uniformTable;
+    std::unordered_map<std::string, int, NameHash, std::equal_to<>> uniformLookup; // [uniform name] <-> [index into uniformTable]
+    mutable std::unordered_map<unsigned int, ResolvedUniform> resolvedUniforms;    // [registry uniform ID] <-> its handle here
+    UniformHandle lodHandle;
+    mutable std::vector<UniformShadow> uniformShadows;  // parallel to uniformTable
+    bool m_usesSceneBlock = false;
+    bool m_usesDrawBlock = false;
+    bool m_pending = false;
+    GLuint vertShaderID = 0; // only while compiling
+    GLuint fragShaderID = 0;
+    ProgramBinaryCache* binaryCache = nullptr;
+    uint64_t binarySlot = 0;
+    uint64_t binaryKey = 0;
+    std::vector<std::string> sourceFiles;
+    uint32_t variant = 0;
+    uint32_t variantMask = 0;
+    std::string vertFileTable; // see ShaderPreprocessor::describeFiles, empty without includes
+    std::string fragFileTable;
+
+    bool loadBinary();
+    void storeBinary();
+    void submitCompile();
+    void finishCompile();
+    void onLinked();
+    void reflectUniforms();
+    void bindSceneBlock();
+    void bindDrawBlock();
+    bool updateShadow(UniformHandle handle, const void* data, unsigned int size) const;
+    GLint getLocation(const char* uniformName) const;
+    GLint getLocation(UniformHandle handle) const;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,68 @@
+#include "ShaderVariant.hpp"
+
+#include <algorithm>
+
+namespace {
+    struct FeatureMacro {
+        uint32_t feature;
+        const char* name;
+    };
+
+    constexpr FeatureMacro FEATURE_MACROS[] = {
+        { ShaderVariant::CUTOUT,        "VARIANT_CUTOUT" },
+        { ShaderVariant::TRANSLUCENT,   "VARIANT_TRANSLUCENT" },
+        { ShaderVariant::INSTANCED,     "VARIANT_INSTANCED" },
+        { ShaderVariant::NORMALS,       "VARIANT_NORMALS" },
+        { ShaderVariant::UVS,           "VARIANT_UVS" },
+        { ShaderVariant::COLORS,        "VARIANT_COLORS" },
+        { ShaderVariant::TEXTURE_COUNT, "VARIANT_TEXTURE_COUNT" }
+    };
+}
+
+
+uint32_t ShaderVariant::withTextureCount(uint32_t features, size_t textureCount) {
+    uint32_t count = (uint32_t)std::min<size_t>(textureCount, TEXTURE_COUNT >> TEXTURE_COUNT_SHIFT);
+    return (features & ~TEXTURE_COUNT) | (count << TEXTURE_COUNT_SHIFT);
+}
+
+
+uint32_t ShaderVariant::featuresUsedBy(const std::string& source) {
+    uint32_t used = 0;
+    for (const FeatureMacro& macro : FEATURE_MACROS) {
+        if (source.find(macro.name) != std::string::npos) used |= macro.feature;
+    }
+    return used;
+}
+
+
+std::string ShaderVariant::definesFor(uint32_t features, uint32_t used) {
+    std::string defines;
+    for (const FeatureMacro& macro : FEATURE_MACROS) {
+        if (macro.feature == TEXTURE_COUNT || (features & used & macro.feature) == 0) continue;
+        defines += "#define " + std::string(macro.name) + "\n";
+    }
+    if (used & TEXTURE_COUNT) {
+        defines += "#define VARIANT_TEXTURE_COUNT " + std::to_string((features & TEXTURE_COUNT) >> TEXTURE_COUNT_SHIFT) + "\n";
+    }
+    return defines;
+}
+
+
+void ShaderVariant::insertDefines(std::string& source, const std::string& defines) {
+    if (defines.empty()) return;
+
+    // #version has to be the first thing in a shader
+    size_t insertAt = 0;
+    int nextLine = 1;
+    size_t start = source.find_first_not_of(" \t\r\n");
+    if (start != std::string::npos && source.compare(start, 8, "#version") == 0) {
+        size_t lineEnd = source.find('\n', start);
+        if (lineEnd == std::string::npos) {
+            source += '\n';
+            lineEnd = source.size() - 1;
+        }
+        insertAt = lineEnd + 1;
+        nextLine = 1 + (int)std::count(source.begin(), source.begin() + insertAt, '\n');
+    }
+    source.insert(insertAt, defines + "#line " + std::to_string(nextLine) + " 0\n");
+}
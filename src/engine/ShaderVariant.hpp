@@ -0,0 +1,44 @@
+// DESCRIPTION
+/*
+Shader variants are one program compiled with different #defines, instead of a copy of its files
+per combination. The Renderer works out the features of each draw (material type, the mesh's
+attributes, instancing, texture count) and asks the ShaderRegistry for the variant with those.
+
+A feature only counts for programs whose source mentions its macro, so a shader that checks
+nothing but VARIANT_CUTOUT has two variants, and one that checks nothing is never recompiled.
+Defined macros, for a shader to #ifdef on:
+
+    VARIANT_CUTOUT, VARIANT_TRANSLUCENT   the material's type (Opaque defines neither)
+    VARIANT_INSTANCED                     the model draws more than one instance
+    VARIANT_NORMALS, VARIANT_UVS,         the mesh has these vertex attributes
+    VARIANT_COLORS
+    VARIANT_TEXTURE_COUNT                 always defined, to the material's texture count (0-15)
+*/
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace ShaderVariant {
+    enum Feature : uint32_t {
+        CUTOUT      = 1 << 0,
+        TRANSLUCENT = 1 << 1,
+        INSTANCED   = 1 << 2,
+        NORMALS     = 1 << 3,
+        UVS         = 1 << 4,
+        COLORS      = 1 << 5,
+        TEXTURE_COUNT = 0xFu << 8
+    };
+    constexpr uint32_t TEXTURE_COUNT_SHIFT = 8;
+
+    uint32_t withTextureCount(uint32_t features, size_t textureCount);
+
+    // the features source can tell apart, by the macros it mentions
+    uint32_t featuresUsedBy(const std::string& source);
+
+    // used is featuresUsedBy, VARIANT_TEXTURE_COUNT is defined even for 0 textures when it's read
+    std::string definesFor(uint32_t features, uint32_t used);
+
+    // after the #version line, with a #line so error lines still match the file
+    void insertDefines(std::string& source, const std::string& defines);
+}
@@ -0,0 +1,165 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace {
+    // Outlives the call when a helper job only starts after the caller returned, such a job
+    // finds no index left and never touches body.
+    struct ParallelLoop {
+        std::function<void(size_t)> body;
+        size_t count = 0;
+        std::atomic<size_t> next = 0;
+        std::atomic<bool> failed = false;
+        std::mutex mutex;
+        std::condition_variable helpersDone;
+        unsigned int activeHelpers = 0;
+        std::exception_ptr error;
+
+        bool exhausted() const { return next.load() >= count || failed.load(); }
+
+        void run() {
+            for (size_t i = next++; i < count && !failed.load(); i = next++) {
+                try {
+                    body(i);
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!error) error = std::current_exception();
+                    failed = true;
+                }
+            }
+        }
+
+        void help() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (exhausted()) return;
+                activeHelpers++;
+            }
+            run();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                activeHelpers--;
+            }
+            helpersDone.notify_all();
+        }
+    };
+}
+
+
+ThreadPool::ThreadPool(unsigned int threadCount) {
+    if (threadCount == 0) {
+        unsigned int hardwareThreads = std::thread::hardware_concurrency();
+        threadCount = std::max(1u, hardwareThreads > 1 ? hardwareThreads - 1 : 1u);
+    }
+
+    workers.reserve(threadCount);
+    for (unsigned int i = 0; i < threadCount; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+
+ThreadPool::~ThreadPool() {
+    shutdown();
+}
+
+
+bool ThreadPool::submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex);
+        if (stopping) return false;
+        jobs.push_back(std::move(job));
+    }
+    jobAvailable.notify_one();
+    return true;
+}
+
+
+void ThreadPool::waitIdle() {
+    std::unique_lock<std::mutex> lock(jobsMutex);
+    jobsFinished.wait(lock, [this]() { return jobs.empty() && runningJobs == 0; });
+}
+
+
+void ThreadPool::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex);
+        if (stopping && workers.empty()) return;
+        stopping = true;
+        jobs.clear();
+    }
+    jobAvailable.notify_all();
+
+    for (std::thread& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+    workers.clear();
+    jobsFinished.notify_all();
+}
+
+
+unsigned int ThreadPool::getThreadCount() const {
+    return (unsigned int)workers.size();
+}
+
+
+size_t ThreadPool::getPendingCount() {
+    std::lock_guard<std::mutex> lock(jobsMutex);
+    return jobs.size() + runningJobs;
+}
+
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(jobsMutex);
+            jobAvailable.wait(lock, [this]() { return stopping || !jobs.empty(); });
+            if (stopping) return;
+
+            job = std::move(jobs.front());
+            jobs.pop_front();
+            runningJobs++;
+        }
+
+        job();
+
+        {
+            std::lock_guard<std::mutex> lock(jobsMutex);
+            runningJobs--;
+        }
+        jobsFinished.notify_all();
+    }
+}
+
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+
+void ThreadPool::parallelFor(size_t count, size_t maxThreads, const std::function<void(size_t)>& body) {
+    if (count == 0) return;
+    size_t helpers = std::min({ maxThreads, count, (size_t)shared().getThreadCount() + 1 });
+    if (helpers <= 1) {
+        for (size_t i = 0; i < count; i++) body(i);
+        return;
+    }
+
+    auto loop = std::make_shared<ParallelLoop>();
+    loop->body = body;
+    loop->count = count;
+    for (size_t t = 1; t < helpers; t++) {
+        if (!shared().submit([loop]() { loop->help(); })) break;
+    }
+    loop->run();
+
+    std::unique_lock<std::mutex> lock(loop->mutex);
+    loop->helpersDone.wait(lock, [&loop]() { return loop->activeHelpers == 0; });
+    if (loop->error) std::rethrow_exception(loop->error);
+}
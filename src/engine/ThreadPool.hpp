@@ -0,0 +1,58 @@
+// DESCRIPTION
+/*
+ThreadPool runs submitted jobs on a fixed set of worker threads, first in first out.
+
+Jobs must not touch GL or any engine system that isn't thread safe. The pattern used
+throughout is: copy what the job needs into the lambda, have it write its result into
+something the owner guards with a mutex, and let the owner pick results up on the main
+thread (see TextureCache::processUploads).
+
+shutdown() drops jobs that haven't started and waits for running ones, so an owner
+destroying its result queue after shutdown() is safe.
+
+parallelFor splits a loop over shared(), one pool for every caller that just wants a loop done
+faster. The calling thread runs iterations too, so it also works from inside a pool job. An
+exception thrown by an iteration stops the rest from starting and is rethrown to the caller
+once every running iteration has returned.
+*/
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+    // 0 picks one less than the hardware thread count, leaving a core for the main thread
+    explicit ThreadPool(unsigned int threadCount = 0);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    bool submit(std::function<void()> job); // false after shutdown
+    void waitIdle();
+    void shutdown();
+
+    unsigned int getThreadCount() const;
+    size_t getPendingCount();
+
+    static ThreadPool& shared();
+    // body(i) for every i below count, on at most maxThreads threads counting the caller.
+    // Indices are handed out one at a time, so uneven iterations still balance
+    static void parallelFor(size_t count, size_t maxThreads, const std::function<void(size_t)>& body);
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::mutex jobsMutex;
+    std::condition_variable jobAvailable;
+    std::condition_variable jobsFinished;
+    unsigned int runningJobs = 0;
+    bool stopping = false;
+
+    void workerLoop();
+};
@@ -6,7 +6,9 @@
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
+#include <assimp/ProgressHandler.hpp>
 #include <algorithm>
+#include <filesystem>
 
 #include "core/logging/Logger.hpp"
 #include "ModelCache.hpp"
@@ -14,6 +16,10 @@
 #include "core/ShaderRegistry.hpp"
 #include "core/InspectorEngine.hpp"
 #include "application/Project.hpp"
+#include "engine/ThreadPool.hpp"
+#include "application/AppSettings.hpp"
+#include "MeshOptimizer.hpp"
+#include "MeshSimplifier.hpp"
 
 #include <iostream> //TEMPADD
 
@@ -34,23 +40,75 @@ static const aiTextureType TexMap[13] {
 };
 
 
+namespace {
+    // share of an import's progress given to Assimp's ReadFile, the rest is mesh conversion
+    constexpr float READ_SHARE = 0.8f;
+    // below this many vertices per thread, mesh conversion stays on fewer threads
+    constexpr size_t MIN_VERTICES_PER_THREAD = 65536;
+
+    // importOptions bit above the 32 aiPostProcessSteps bits
+    constexpr uint64_t OPTIMIZED_MESHES = 1ull << 32;
+
+    // forwards ReadFile progress to an import job and aborts the read once the job is cancelled
+    class JobProgressHandler : public Assimp::ProgressHandler {
+    public:
+        JobProgressHandler(std::atomic<float>& _progress, const std::atomic<bool>& _cancelRequested)
+            : progress(_progress), cancelRequested(_cancelRequested) {}
+
+        bool Update(float percentage) override {
+            if (percentage >= 0.0f) {
+                progress.store(std::min(percentage, 1.0f) * READ_SHARE, std::memory_order_relaxed);
+            }
+            return cancelRequested.load(std::memory_order_relaxed) == false;
+        }
+
+    private:
+        std::atomic<float>& progress;
+        const std::atomic<bool>& cancelRequested;
+    };
+}
+
+
+const unsigned int AssimpImporter::IMPORT_FLAGS = aiProcess_Triangulate | aiProcess_FlipUVs;
+
+
 AssimpImporter::AssimpImporter() {
 
 }
 
 
-bool AssimpImporter::initialize(Logger* _loggerPtr, ModelCache* _modelCachePtr, MaterialCache* _materialCachePtr, ShaderRegistry* _shaderRegPtr, InspectorEngine* _inspectorEngPtr, Project* projectData) {
+AssimpImporter::~AssimpImporter() {
+    shutdown();
+}
+
+
+bool AssimpImporter::initialize(Logger* _loggerPtr, ModelCache* _modelCachePtr, MaterialCache* _materialCachePtr, ShaderRegistry* _shaderRegPtr, InspectorEngine* _inspectorEngPtr, Project* projectData, const AppSettings* _settingsPtr) {
     loggerPtr        = _loggerPtr;
     modelCachePtr    = _modelCachePtr;
     materialCachePtr = _materialCachePtr;
     shaderRegPtr     = _shaderRegPtr;
     inspectorEngPtr  = _inspectorEngPtr; 
+    settingsPtr      = _settingsPtr;
+    // one worker, imports are memory heavy and run one after another
+    importPool = std::make_unique<ThreadPool>(1);
+    if (!meshCache.initialize(projectData->projectRoot / ".cache" / "meshes")) {
+        loggerPtr->addLog(LogLevel::WARNING, "ASSIMP_IMPORTER::initialize()", "mesh cache unavailable, imported models will be read from source on every load");
+    }
 
     loadAssetCachesFromSave(projectData->modelData, projectData->materialData);
     return true;
 }
 
 
+void AssimpImporter::shutdown() {
+    for (const std::shared_ptr<ImportJob>& job : activeImports) {
+        job->cancelRequested.store(true, std::memory_order_relaxed);
+    }
+    if (importPool) importPool->shutdown();
+    activeImports.clear();
+}
+
+
 bool AssimpImporter::loadAssetCachesFromSave(std::vector<ModelEntry>& modelEntries, std::vector<MaterialEntry>& materialEntries) {
     std::string feedback = "";
 
@@ -100,13 +158,25 @@ bool AssimpImporter::loadAssetCachesFromSave(std::vector<ModelEntry>& modelEntri
             modelCachePtr->addPresetMesh(ID, type);
         }
         else {
-            Assimp::Importer import;
-            const aiScene *scene = import.ReadFile(path.string(), aiProcess_Triangulate | aiProcess_FlipUVs);
-            if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
-                feedback += "Model failed to load: \"" + name + "\"" + "path not found " + path.string() + "\n";
-                continue;
+            MeshDiskCache::CachedModel cached;
+            if (meshCache.load(path.string(), importOptions(), cached)) {
+                Model* cachedModel = modelCachePtr->getModel(ID);
+                for (const MeshDiskCache::CachedMesh& mesh : cached.meshes) {
+                    cachedModel->addMeshByMapping(cached.file, mesh.vertices, mesh.layout, mesh.vertexCount, mesh.indices, 
+                                                    mesh.indexCount, mesh.shortIndices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, mesh.flags, mesh.bounds, mesh.lods);
+                }
             }
-            processNode(ID, scene->mRootNode, scene);
+            else {
+                ImportedModel imported;
+                std::string error;
+                if (readModel(path.string(), imported, error, optimizeMeshes()) == false) {
+                    feedback += "Model failed to load: \"" + name + "\"" + "path not found " + path.string() + "\n";
+                    continue;
+                }
+                meshCache.store(path.string(), importOptions(), imported.meshes);
+                commitMeshes(ID, imported.meshes);
+            }
+            attachMeshSource(ID, path.string(), importOptions());
         }
         Model* model = modelCachePtr->getModel(ID);
         model->finalizeMeshes();
@@ -130,13 +200,22 @@ bool AssimpImporter::loadAssetCachesFromSave(std::vector<ModelEntry>& modelEntri
         model->setPosition(position);
         model->setScale(scale);
         model->setRotation(rotation); 
-        model->setInstanceCount(instanceData.size());
-        model->loadInstanceData(instanceData);
+        model->setLODOverride(modelEntry.lodOverride);
+        model->loadInstanceData(std::move(instanceData));
         if (isSkybox) modelCachePtr->toggleAsSkybox(ID);
 
         modelCachePtr->updateRenderer(ID); //will not render anything since materials are invalid (no shaders)
 
     }
+
+    // after every model exists, a MeshVertices generator may read another model's mesh
+    for (const ModelEntry& modelEntry : modelEntries) {
+        if (modelEntry.instanceGenerator.type == InstanceGeneratorType::None) continue;
+        if (modelCachePtr->getModel(modelEntry.ID) == nullptr) continue;
+        if (modelCachePtr->generateInstances(modelEntry.ID, modelEntry.instanceGenerator) == false) {
+            feedback += "model \"" + modelEntry.name + "\" failed to regenerate its instances\n";
+        }
+    }
     if (!feedback.empty()) {
         loggerPtr->addLog(LogLevel::LOG_ERROR, "ASSIMPIMPORTER::loadAssetCachesFromSave()\n", feedback);
     }
@@ -149,75 +228,273 @@ bool AssimpImporter::loadAssetCachesFromSave(std::vector<ModelEntry>& modelEntri
 
 
 unsigned int AssimpImporter::importModel(std::string path) {
+    ImportedModel imported;
+    std::string error;
+    if (readModel(path, imported, error, optimizeMeshes()) == false) {
+        loggerPtr->addLog(LogLevel::WARNING, "ASSIMP_IMPORTER::importModel()", error);
+        return INVALID_MODEL_ID;
+    }
+    meshCache.store(path, importOptions(), imported.meshes);
+    return commitImport(imported, importOptions());
+}
+
+
+unsigned int AssimpImporter::importModelAsync(std::string path) {
+    auto job = std::make_shared<ImportJob>();
+    job->ticket = nextTicket++;
+    job->path = path;
+    job->importOptions = importOptions();
+
+    const MeshDiskCache* cache = &meshCache;
+    bool optimize = optimizeMeshes();
+    uint64_t options = job->importOptions;
+    bool submitted = importPool && importPool->submit([job, cache, optimize, options]() {
+        job->succeeded = readModel(job->path, job->model, job->error, optimize, job.get());
+        // written now so the next project load maps the meshes instead of reading the source again
+        if (job->succeeded) cache->store(job->path, options, job->model.meshes);
+        job->finished.store(true, std::memory_order_release);
+    });
+    if (!submitted) {
+        loggerPtr->addLog(LogLevel::LOG_ERROR, "ASSIMP_IMPORTER::importModelAsync()", "import worker is not running");
+        return INVALID_IMPORT;
+    }
+
+    activeImports.push_back(job);
+    return job->ticket;
+}
+
+
+bool AssimpImporter::cancelImport(unsigned int ticket) {
+    for (const std::shared_ptr<ImportJob>& job : activeImports) {
+        if (job->ticket != ticket) continue;
+        job->cancelRequested.store(true, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+
+void AssimpImporter::update() {
+    // at most one commit per frame, each one creates GL buffers and textures
+    for (auto it = activeImports.begin(); it != activeImports.end(); it++) {
+        ImportJob& job = **it;
+        if (job.finished.load(std::memory_order_acquire) == false) continue;
+
+        std::shared_ptr<ImportJob> finishedJob = *it;
+        activeImports.erase(it);
+
+        if (job.cancelRequested.load(std::memory_order_relaxed)) {
+            loggerPtr->addLog(LogLevel::INFO, "ASSIMP_IMPORTER::update()", "Import cancelled: " + job.path);
+        }
+        else if (job.succeeded == false) {
+            loggerPtr->addLog(LogLevel::LOG_ERROR, "ASSIMP_IMPORTER::update()", "Failed to import model: " + job.path + ". " + job.error);
+        }
+        else if (commitImport(job.model, job.importOptions) != INVALID_MODEL_ID) {
+            loggerPtr->addLog(LogLevel::INFO, "ASSIMP_IMPORTER::update()", "Successfully loaded model: " + job.path);
+            inspectorEngPtr->refreshUniforms();
+        }
+        return;
+    }
+}
+
+
+std::vector<AssimpImporter::ImportStatus> AssimpImporter::getActiveImports() const {
+    std::vector<ImportStatus> statuses;
+    statuses.reserve(activeImports.size());
+    for (const std::shared_ptr<ImportJob>& job : activeImports) {
+        statuses.push_back(ImportStatus{
+            job->ticket,
+            job->path,
+            job->progress.load(std::memory_order_relaxed),
+            job->cancelRequested.load(std::memory_order_relaxed)
+        });
+    }
+    return statuses;
+}
+
+
+bool AssimpImporter::readModel(const std::string& path, ImportedModel& model, std::string& error, bool optimizeMeshes, ImportProgress* progress) {
     Assimp::Importer import;
-    const aiScene *scene = import.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs);
+    if (progress) import.SetProgressHandler(new JobProgressHandler(progress->progress, progress->cancelRequested)); // importer takes ownership
+    const aiScene *scene = import.ReadFile(path, IMPORT_FLAGS);
+    if (progress && progress->cancelRequested.load(std::memory_order_relaxed)) {
+        error = "cancelled";
+        return false;
+    }
     if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
-        loggerPtr->addLog(LogLevel::WARNING, "ASSIMP_IMPORTER::importModel()", "Model not found");
-        return INVALID_MODEL_ID;
+        error = "Model not found";
+        return false;
     }
 
-    unsigned int modelID = modelCachePtr->createModelForImportSetup(path);
-    std::string directory = path.substr(0, path.find_last_of('\\'));
-    
+    model.path = path;
+    std::string directory = std::filesystem::path(path).parent_path().string();
+
     // GRAB MATERIALS -- starts as 1 to avoid creating an unused default mat from assimp
+    if (scene->mNumMaterials > 1) model.materials.resize(scene->mNumMaterials - 1);
     for (unsigned int i = 1; i < scene->mNumMaterials; i++) {
-        processMaterial(scene->mMaterials[i], directory);
+        processMaterial(scene->mMaterials[i], directory, model.materials[i - 1]);
     }
 
     // PROCESS MESHES
-    processNode(modelID, scene->mRootNode, scene);
+    std::vector<aiMesh*> meshOrder;
+    processNode(scene->mRootNode, scene, meshOrder);
+    try {
+        if (convertMeshes(meshOrder, model.meshes, optimizeMeshes, progress) == false) {
+            error = "cancelled";
+            return false;
+        }
+    }
+    catch (const std::exception& e) {
+        error = std::string("Could not convert the meshes: ") + e.what();
+        return false;
+    }
+    return true;
+}
+
+
+// One task per aiMesh, handed out one at a time so a scene with one huge mesh and many small
+// ones still keeps every thread busy. Each task writes only its own slot.
+bool AssimpImporter::convertMeshes(const std::vector<aiMesh*>& sources, std::vector<ImportedMesh>& meshes, bool optimizeMeshes, ImportProgress* progress) {
+    meshes.resize(sources.size());
+
+    // small scenes finish before a thread would have started
+    size_t totalVertices = 0;
+    for (const aiMesh* source : sources) {
+        totalVertices += source->mNumVertices;
+    }
+
+    std::atomic<size_t> convertedMeshes = 0;
+    ThreadPool::parallelFor(sources.size(), totalVertices / MIN_VERTICES_PER_THREAD + 1, [&](size_t i) {
+        if (progress && progress->cancelRequested.load(std::memory_order_relaxed)) return;
+        processMesh(sources[i], meshes[i], optimizeMeshes);
+        size_t converted = ++convertedMeshes;
+        if (progress) {
+            progress->progress.store(READ_SHARE + (1.0f - READ_SHARE) * (float)converted / (float)sources.size(), std::memory_order_relaxed);
+        }
+    });
+    return convertedMeshes == sources.size();
+}
+
+
+bool AssimpImporter::optimizeMeshes() const {
+    return settingsPtr == nullptr || settingsPtr->optimizeImportedMeshes;
+}
+
+
+uint64_t AssimpImporter::importOptions() const {
+    return (uint64_t)IMPORT_FLAGS | (optimizeMeshes() ? OPTIMIZED_MESHES : 0);
+}
+
+
+unsigned int AssimpImporter::commitImport(ImportedModel& imported, uint64_t options) {
+    unsigned int modelID = modelCachePtr->createModelForImportSetup(imported.path);
+    if (modelID == INVALID_MODEL_ID) return INVALID_MODEL_ID;
+
+    for (ImportedMaterial& importedMaterial : imported.materials) {
+        unsigned int materialID = materialCachePtr->createBlankMaterial();
+        Material* newMaterial = materialCachePtr->getMaterial(materialID);
+        newMaterial->setName("Imported_Mat");
+        // newMaterial->setProperties(importedMaterial.properties);
+        for (const std::string& texturePath : importedMaterial.texturePaths) {
+            materialCachePtr->addTexture2DToMaterial(materialID, texturePath);
+        }
+    }
+
+    commitMeshes(modelID, imported.meshes);
+    attachMeshSource(modelID, imported.path, options);
     modelCachePtr->getModel(modelID)->finalizeMeshes();
     modelCachePtr->updateRenderer(modelID);
     return modelID;
 }
 
 
-void AssimpImporter::processNode(unsigned int modelID, aiNode* node, const aiScene* scene) {
+void AssimpImporter::commitMeshes(unsigned int modelID, std::vector<ImportedMesh>& meshes) {
+    Model* importedModel = modelCachePtr->getModel(modelID);
+    for (ImportedMesh& mesh : meshes) {
+        importedModel->addMeshByAssimp(std::move(mesh.vertices), std::move(mesh.indices), mesh.flags.hasPositions, mesh.flags.hasNormals, mesh.flags.hasUVs, std::move(mesh.lods));
+    }
+}
+
+
+// Released meshes come back from the mesh cache when it still matches, otherwise the source is
+// read again with the options the model was imported with, so the data matches what was uploaded.
+void AssimpImporter::attachMeshSource(unsigned int modelID, const std::string& path, uint64_t options) {
+    Model* model = modelCachePtr->getModel(modelID);
+    if (model == nullptr) return;
+    model->setMeshDataSource([this, path, options](Model& target) {
+        return reloadMeshData(target, path, options);
+    });
+}
+
+
+bool AssimpImporter::reloadMeshData(Model& model, const std::string& path, uint64_t options) {
+    MeshDiskCache::CachedModel cached;
+    if (meshCache.load(path, options, cached) && cached.meshes.size() == model.getNumberOfMeshes()) {
+        bool restored = true;
+        for (unsigned int i = 0; i < cached.meshes.size(); i++) {
+            const MeshDiskCache::CachedMesh& mesh = cached.meshes[i];
+            restored &= model.restoreMeshData(i, cached.file, mesh.vertices, mesh.layout, mesh.vertexCount, mesh.indices, 
+                                                mesh.indexCount, mesh.shortIndices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT);
+        }
+        if (restored) return true;
+    }
+
+    ImportedModel imported;
+    std::string error;
+    if (readModel(path, imported, error, (options & OPTIMIZED_MESHES) != 0) == false) {
+        loggerPtr->addLog(LogLevel::WARNING, "ASSIMP_IMPORTER::reloadMeshData()", "could not reload meshes of " + path + ". " + error);
+        return false;
+    }
+    if (imported.meshes.size() != model.getNumberOfMeshes()) {
+        loggerPtr->addLog(LogLevel::WARNING, "ASSIMP_IMPORTER::reloadMeshData()", path + " changed since it was imported, reimport it to use its meshes");
+        return false;
+    }
+    meshCache.store(path, options, imported.meshes);
+
+    bool restored = true;
+    for (unsigned int i = 0; i < imported.meshes.size(); i++) {
+        restored &= model.restoreMeshData(i, std::move(imported.meshes[i].vertices), std::move(imported.meshes[i].indices));
+    }
+    if (!restored) {
+        loggerPtr->addLog(LogLevel::WARNING, "ASSIMP_IMPORTER::reloadMeshData()", path + " changed since it was imported, reimport it to use its meshes");
+    }
+    return restored;
+}
+
+
+void AssimpImporter::processNode(aiNode* node, const aiScene* scene, std::vector<aiMesh*>& meshOrder) {
     for (unsigned int i = 0; i < node->mNumMeshes; i++) {
-        
-        aiMesh *aimesh = scene->mMeshes[node->mMeshes[i]];
-        processMesh(modelID, aimesh);
+        meshOrder.push_back(scene->mMeshes[node->mMeshes[i]]);
     }
 
     for (unsigned int i = 0; i < node->mNumChildren; i++) {
-        processNode(modelID, node->mChildren[i], scene);
+        processNode(node->mChildren[i], scene, meshOrder);
     }
 }
 
 
-void AssimpImporter::processMesh(unsigned int modelID, aiMesh *aimesh) {
-    MeshProperties meshflags{
-        aimesh->HasPositions(),
-        aimesh->HasNormals(),
-        aimesh->HasTextureCoords(0)
-    };
+void AssimpImporter::processMesh(aiMesh *aimesh, ImportedMesh& mesh, bool optimizeMeshes) {
+    MeshProperties& meshflags = mesh.flags;
+    meshflags.hasPositions = aimesh->HasPositions();
+    meshflags.hasNormals   = aimesh->HasNormals();
+    meshflags.hasUVs       = aimesh->HasTextureCoords(0);
 
     // VERTICES
-    std::vector<Vertex> vertices;
+    std::vector<Vertex>& vertices = mesh.vertices;
+    vertices.resize(aimesh->mNumVertices);
     for (unsigned int i = 0; i < aimesh->mNumVertices; i++) {
-        Vertex vertex;
-        
+        Vertex& vertex = vertices[i];
+
         if (meshflags.hasPositions) {
-            glm::vec3 vector3;
-            vector3.x = aimesh->mVertices[i].x;
-            vector3.y = aimesh->mVertices[i].y;
-            vector3.z = aimesh->mVertices[i].z;
-            vertex.position = vector3;
+            vertex.position = glm::vec3(aimesh->mVertices[i].x, aimesh->mVertices[i].y, aimesh->mVertices[i].z);
         }
-        
+
         if (meshflags.hasNormals) {
-            glm::vec3 vector3;
-            vector3.x = aimesh->mNormals[i].x;
-            vector3.y = aimesh->mNormals[i].y;
-            vector3.z = aimesh->mNormals[i].z;
-            vertex.normal = vector3;
+            vertex.normal = glm::vec3(aimesh->mNormals[i].x, aimesh->mNormals[i].y, aimesh->mNormals[i].z);
         }
 
         if (meshflags.hasUVs) {
-            glm::vec2 vector2;
-            vector2.x = aimesh->mTextureCoords[0][i].x;
-            vector2.y = aimesh->mTextureCoords[0][i].y;
-            vertex.uv = vector2;
+            vertex.uv = glm::vec2(aimesh->mTextureCoords[0][i].x, aimesh->mTextureCoords[0][i].y);
         }
 
         // if (meshflags.hasColors) {
@@ -228,57 +505,58 @@ void AssimpImporter::processMesh(unsigned int modelID, aiMesh *aimesh) {
         //     vector4.a = aimesh->mColors[0][i].a;
         //     vertex.color = vector4;
         // }
-
-        vertices.push_back(vertex);
     }
 
     // INDICES
-    std::vector<unsigned int> indices;
-    for (unsigned int i = 0; i < aimesh->mNumFaces; i++) {
-        aiFace face = aimesh->mFaces[i];
-        for (unsigned int j = 0; j < face.mNumIndices; j++) {
-            indices.push_back(face.mIndices[j]);
+    std::vector<unsigned int>& indices = mesh.indices;
+    if (aimesh->mPrimitiveTypes == aiPrimitiveType_TRIANGLE) {
+        // the common case after aiProcess_Triangulate, every face is exactly three indices
+        indices.resize((size_t)aimesh->mNumFaces * 3);
+        for (unsigned int i = 0; i < aimesh->mNumFaces; i++) {
+            const unsigned int* face = aimesh->mFaces[i].mIndices;
+            indices[3 * (size_t)i + 0] = face[0];
+            indices[3 * (size_t)i + 1] = face[1];
+            indices[3 * (size_t)i + 2] = face[2];
         }
+        if (optimizeMeshes) MeshOptimizer::optimize(mesh);
+        MeshSimplifier::generateLODs(mesh, optimizeMeshes);
+        return;
+    }
+
+    // lines and points can still come through
+    size_t indexCount = 0;
+    for (unsigned int i = 0; i < aimesh->mNumFaces; i++) {
+        indexCount += aimesh->mFaces[i].mNumIndices;
+    }
+    indices.reserve(indexCount);
+    for (unsigned int i = 0; i < aimesh->mNumFaces; i++) {
+        const aiFace& face = aimesh->mFaces[i];
+        indices.insert(indices.end(), face.mIndices, face.mIndices + face.mNumIndices);
     }
-    
-    Model* importedModel = modelCachePtr->getModel(modelID);
-    importedModel->addMeshByAssimp(vertices, indices, meshflags.hasPositions, meshflags.hasNormals, meshflags.hasUVs);
 }
 
 
-void AssimpImporter::processMaterial(aiMaterial *aimat, std::string directory) {
+void AssimpImporter::processMaterial(aiMaterial *aimat, const std::string& directory, ImportedMaterial& material) {
 
-    MaterialProperties properties;
+    MaterialProperties& properties = material.properties;
     aimat->Get(AI_MATKEY_OPACITY, properties.opacity);
     aimat->Get(AI_MATKEY_SHININESS, properties.shininess);
     aimat->Get(AI_MATKEY_ROUGHNESS_FACTOR, properties.roughness);
     aimat->Get(AI_MATKEY_METALLIC_FACTOR, properties.metalness);
 
-
-    unsigned int materialID = materialCachePtr->createBlankMaterial();
-    Material* newMaterial = materialCachePtr->getMaterial(materialID);
-    newMaterial->setName("Imported_Mat");
-    // newMaterial->setProperties(properties);
-    getTextures(materialID, aimat, directory);
-}
-
-
-void AssimpImporter::getTextures(unsigned int materialID, aiMaterial *mat, std::string directory) {
-    
     for (unsigned int type = 0; type < 13; type++) {
 
         aiTextureType aiType = TexMap[type];
         if (aiType == aiTextureType_NONE) continue;
 
-        for (unsigned int idx = 0; idx < mat->GetTextureCount(aiType); idx++) {
+        for (unsigned int idx = 0; idx < aimat->GetTextureCount(aiType); idx++) {
             aiString aiTex;
-            if (mat->GetTexture(aiType, idx, &aiTex) != AI_SUCCESS) {
+            if (aimat->GetTexture(aiType, idx, &aiTex) != AI_SUCCESS) {
                 // Logger::addLog(LogLevel::ERROR, "ASSIMP_IMPORT", "Assimp failed to get texture");
                 continue;
             }
 
-            std::string filepath = directory + "\\" + aiTex.C_Str();
-            materialCachePtr->addTexture2DToMaterial(materialID, filepath);
+            material.texturePaths.push_back((std::filesystem::path(directory) / aiTex.C_Str()).string());
         }
     }
 }
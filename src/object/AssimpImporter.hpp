@@ -1,7 +1,12 @@
 #pragma once
 
+#include <atomic>
+#include <limits>
+#include <memory>
 #include <string>
 #include "application/Project.hpp"
+#include "ImportedModel.hpp"
+#include "MeshDiskCache.hpp"
 
 class aiScene;
 class aiNode;
@@ -10,27 +15,79 @@ class aiMaterial;
 
 class Logger;
 class ModelCache;
+class Model;
 class MaterialCache;
 class ShaderRegistry;
 class InspectorEngine;
+class ThreadPool;
+struct AppSettings;
 struct Project;
 
 struct ImportContext;
 
 class AssimpImporter {
 public:
+    static constexpr unsigned int INVALID_IMPORT = std::numeric_limits<unsigned int>::max();
+    // aiPostProcessSteps every import is read with, also part of the mesh cache's validation
+    static const unsigned int IMPORT_FLAGS;
+
+    // what the UI shows for an import that hasn't been committed yet
+    struct ImportStatus {
+        unsigned int ticket;
+        std::string path;
+        float progress; // 0..1
+        bool cancelling;
+    };
+
+    // progress of one readModel call, polled from another thread
+    struct ImportProgress {
+        std::atomic<float> progress{ 0.0f };
+        std::atomic<bool> cancelRequested{ false };
+    };
+
     AssimpImporter();
-    bool initialize(Logger* _loggerPtr, ModelCache* _modelCachePtr, MaterialCache* _materialCachePtr, ShaderRegistry* _shaderRegPtr, InspectorEngine* _inspectorEngPtr, Project* _projectData);
+    ~AssimpImporter();
+    bool initialize(Logger* _loggerPtr, ModelCache* _modelCachePtr, MaterialCache* _materialCachePtr, ShaderRegistry* _shaderRegPtr, InspectorEngine* _inspectorEngPtr, Project* _projectData, const AppSettings* _settingsPtr);
+    void shutdown();
     bool loadAssetCachesFromSave(std::vector<ModelEntry>& modelEntries, std::vector<MaterialEntry>& materialEntries);
+
+    // blocking, reads and commits on the calling thread
     unsigned int importModel(std::string model_path);
+    // reads on the import worker, the model shows up in a later update()
+    unsigned int importModelAsync(std::string model_path);
+    bool cancelImport(unsigned int ticket);
+    // commits finished imports, main thread only
+    void update();
+    std::vector<ImportStatus> getActiveImports() const;
 
-    
+    // reads and converts a file without touching any engine system, safe to call from any thread
+    static bool readModel(const std::string& path, ImportedModel& model, std::string& error, bool optimizeMeshes = true, ImportProgress* progress = nullptr);
 
 private:
-    void processNode(unsigned int modelID, aiNode* node, const aiScene* scene);
-    void processMesh(unsigned int modelID, aiMesh* aimesh);
-    void processMaterial(aiMaterial* aimat, std::string directory);
-    void getTextures(unsigned int materialID, aiMaterial* aimat, std::string directory);
+    // shared by the worker reading the file and the main thread watching it
+    struct ImportJob : ImportProgress {
+        unsigned int ticket = INVALID_IMPORT;
+        std::string path;
+        uint64_t importOptions = 0;
+        std::atomic<bool> finished{ false };
+        // written by the worker before finished is set, read by update() after
+        bool succeeded = false;
+        std::string error;
+        ImportedModel model;
+    };
+
+    static bool convertMeshes(const std::vector<aiMesh*>& sources, std::vector<ImportedMesh>& meshes, bool optimizeMeshes, ImportProgress* progress);
+    static void processNode(aiNode* node, const aiScene* scene, std::vector<aiMesh*>& meshOrder);
+    static void processMesh(aiMesh* aimesh, ImportedMesh& mesh, bool optimizeMeshes);
+    static void processMaterial(aiMaterial* aimat, const std::string& directory, ImportedMaterial& material);
+
+    bool optimizeMeshes() const;
+    uint64_t importOptions() const; // mesh cache key, see MeshDiskCache::load
+    unsigned int commitImport(ImportedModel& imported, uint64_t options);
+    void commitMeshes(unsigned int modelID, std::vector<ImportedMesh>& meshes);
+    // lets the model reload meshes it released after upload, see Model::ensureMeshData
+    void attachMeshSource(unsigned int modelID, const std::string& path, uint64_t options);
+    bool reloadMeshData(Model& model, const std::string& path, uint64_t options);
 
     //SYSTEM POINTERS
     Logger* loggerPtr                = nullptr;
@@ -38,5 +95,10 @@ private:
     MaterialCache* materialCachePtr  = nullptr;
     ShaderRegistry* shaderRegPtr     = nullptr;
     InspectorEngine* inspectorEngPtr = nullptr;
+    const AppSettings* settingsPtr   = nullptr;
 
-};
\ No newline at end of file
+    MeshDiskCache meshCache;
+    unsigned int nextTicket = 0;
+    std::vector<std::shared_ptr<ImportJob>> activeImports;
+    std::unique_ptr<ThreadPool> importPool; // declared last so it stops before the jobs it references
+};
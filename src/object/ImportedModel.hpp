@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Vertex.hpp"
+#include "MeshProperties.hpp"
+#include "MaterialProperties.hpp"
+#include "MeshLOD.hpp"
+
+// What AssimpImporter reads out of a model file before any engine system sees it.
+// Plain CPU data, so it can be built on a worker thread and handed to the main thread,
+// which turns it into a Model, its meshes and materials (AssimpImporter::commitImport).
+struct ImportedMesh {
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices; // every level of detail, one after the other
+    MeshProperties flags;
+    std::vector<MeshLOD> lods; // ranges of indices, see MeshSimplifier. Empty is one level over all of them
+};
+
+struct ImportedMaterial {
+    MaterialProperties properties;
+    std::vector<std::string> texturePaths; // 2D textures, already resolved against the model's directory
+};
+
+struct ImportedModel {
+    std::string path;
+    std::vector<ImportedMaterial> materials;
+    std::vector<ImportedMesh> meshes; // scene graph order, same as the old processNode walk
+};
@@ -1,7 +1,35 @@
 #pragma once
 
 #include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
 
+// editable per-instance values, kept on the Model and saved with the project
 struct InstanceData {
-    glm::vec3 pos = glm::vec3(0.0f);
-};
\ No newline at end of file
+    glm::vec3 pos      = glm::vec3(0.0f);
+    glm::vec3 rotation = glm::vec3(0.0f); // euler degrees, same convention as Model::setRotation
+    glm::vec3 scale    = glm::vec3(1.0f);
+    glm::vec4 custom   = glm::vec4(1.0f); // free for shaders, e.g. a per-instance tint
+};
+
+// What the instance VBO holds, one per instance. Attribute locations:
+//     4        vec3 position  (world space offset, same as before transforms were added)
+//     5, 6, 7  mat3 basis     (rotation * scale, applied in model space)
+//     8        vec4 custom
+// so a shader can declare:
+//     layout (location=4) in vec3 aInstance;
+//     layout (location=5) in mat3 aInstanceBasis;
+//     layout (location=8) in vec4 aInstanceCustom;
+struct InstanceGPUData {
+    glm::vec3 position;
+    glm::mat3 basis;
+    glm::vec4 custom;
+};
+static_assert(sizeof(InstanceGPUData) == 64, "InstanceGPUData is uploaded as is, keep it tightly packed");
+
+inline InstanceGPUData packInstance(const InstanceData& instance) {
+    glm::mat3 basis = glm::mat3_cast(glm::quat(glm::radians(instance.rotation)));
+    basis[0] *= instance.scale.x;
+    basis[1] *= instance.scale.y;
+    basis[2] *= instance.scale.z;
+    return InstanceGPUData{ instance.pos, basis, instance.custom };
+}
@@ -0,0 +1,142 @@
+#include "InstanceGenerator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "engine/ThreadPool.hpp"
+
+
+namespace {
+    // stateless hash of (seed, index, stream) to [0, 1), see the description in the header
+    float random01(uint32_t seed, uint32_t index, uint32_t stream) {
+        uint32_t x = seed * 0x9E3779B9u ^ index * 0x85EBCA6Bu ^ stream * 0xC2B2AE35u;
+        x ^= x >> 16;
+        x *= 0x7FEB352Du;
+        x ^= x >> 15;
+        x *= 0x846CA68Bu;
+        x ^= x >> 16;
+        return (x >> 8) * (1.0f / 16777216.0f);
+    }
+
+    glm::vec3 randomVec3(uint32_t seed, uint32_t index, uint32_t stream) {
+        return glm::vec3(random01(seed, index, stream), random01(seed, index, stream + 1), random01(seed, index, stream + 2));
+    }
+
+    // stratified scatter cells, worked out once per generate() call
+    struct ScatterCells {
+        glm::uvec3 perAxis = glm::uvec3(1);
+        uint64_t total = 1;
+        uint64_t stride = 1; // coprime with total, spreads a partly filled grid over the whole box
+    };
+
+    ScatterCells makeScatterCells(const InstanceGeneratorParams& params) {
+        ScatterCells cells;
+        glm::vec3 extent = params.boxMax - params.boxMin;
+
+        // only stratify along axes the box actually spans, a flat box gets a 2D grid of cells
+        glm::bvec3 spans = glm::greaterThan(glm::abs(extent), glm::vec3(1e-6f));
+        int dimensions = (int)spans.x + (int)spans.y + (int)spans.z;
+        if (dimensions == 0 || params.count == 0) return cells;
+
+        unsigned int perAxis = (unsigned int)std::ceil(std::pow((double)params.count, 1.0 / dimensions) - 1e-9);
+        perAxis = std::max(perAxis, 1u);
+        for (int axis = 0; axis < 3; axis++) {
+            if (spans[axis]) cells.perAxis[axis] = perAxis;
+        }
+        cells.total = (uint64_t)cells.perAxis.x * cells.perAxis.y * cells.perAxis.z;
+
+        cells.stride = std::max<uint64_t>(1, (uint64_t)(cells.total * 0.618034));
+        while (std::gcd(cells.stride, cells.total) != 1) cells.stride++;
+        return cells;
+    }
+
+    glm::vec3 scatterPosition(const InstanceGeneratorParams& params, const ScatterCells& cells, uint32_t index) {
+        glm::vec3 extent = params.boxMax - params.boxMin;
+        glm::vec3 jitter = randomVec3(params.seed, index, 0);
+        if (params.stratify == false) {
+            return params.boxMin + extent * jitter;
+        }
+
+        uint64_t cellIndex = (index * cells.stride) % cells.total;
+        glm::uvec3 cell(
+            cellIndex % cells.perAxis.x,
+            (cellIndex / cells.perAxis.x) % cells.perAxis.y,
+            cellIndex / ((uint64_t)cells.perAxis.x * cells.perAxis.y)
+        );
+        return params.boxMin + extent * ((glm::vec3(cell) + jitter) / glm::vec3(cells.perAxis));
+    }
+
+    InstanceData generateOne(const InstanceGeneratorParams& params, const ScatterCells& cells, 
+                             const std::vector<glm::vec3>* vertexPositions, uint32_t index) {
+        InstanceData instance;
+        switch (params.type) {
+            case InstanceGeneratorType::Grid: {
+                glm::uvec3 count = glm::max(params.gridCount, glm::uvec3(1));
+                glm::uvec3 cell(index % count.x, (index / count.x) % count.y, index / (count.x * count.y));
+                // centred on the model so resizing the grid doesn't move it sideways
+                glm::vec3 offset = (glm::vec3(count) - 1.0f) * 0.5f;
+                instance.pos = (glm::vec3(cell) - offset) * params.spacing;
+                break;
+            }
+            case InstanceGeneratorType::Scatter:
+                instance.pos = scatterPosition(params, cells, index);
+                break;
+            case InstanceGeneratorType::Spiral: {
+                float angle = params.angleStep * index;
+                float radius = params.radiusStep * index;
+                instance.pos = glm::vec3(std::cos(angle) * radius, params.heightStep * index, std::sin(angle) * radius);
+                break;
+            }
+            case InstanceGeneratorType::MeshVertices:
+                instance.pos = (*vertexPositions)[index];
+                break;
+            case InstanceGeneratorType::None:
+                break;
+        }
+
+        if (params.randomYaw != 0.0f) {
+            instance.rotation.y = params.randomYaw * random01(params.seed, index, 3);
+        }
+        if (params.scaleRange.x != 1.0f || params.scaleRange.y != 1.0f) {
+            float t = random01(params.seed, index, 4);
+            instance.scale = glm::vec3(params.scaleRange.x + (params.scaleRange.y - params.scaleRange.x) * t);
+        }
+        return instance;
+    }
+}
+
+
+size_t InstanceGenerator::countFor(const InstanceGeneratorParams& params, const std::vector<glm::vec3>* vertexPositions) {
+    switch (params.type) {
+        case InstanceGeneratorType::Grid: {
+            glm::uvec3 count = glm::max(params.gridCount, glm::uvec3(1));
+            return (size_t)count.x * count.y * count.z;
+        }
+        case InstanceGeneratorType::Scatter:
+        case InstanceGeneratorType::Spiral:
+            return params.count;
+        case InstanceGeneratorType::MeshVertices:
+            return vertexPositions == nullptr ? 0 : vertexPositions->size();
+        case InstanceGeneratorType::None:
+            return 0;
+    }
+    return 0;
+}
+
+
+std::vector<InstanceData> InstanceGenerator::generate(const InstanceGeneratorParams& params, const std::vector<glm::vec3>* vertexPositions) {
+    size_t total = countFor(params, vertexPositions);
+    std::vector<InstanceData> instances(total);
+    if (total == 0) return instances;
+
+    ScatterCells cells = makeScatterCells(params);
+    size_t chunkCount = (total + MIN_CHUNK - 1) / MIN_CHUNK;
+    ThreadPool::parallelFor(chunkCount, chunkCount, [&](size_t chunk) {
+        size_t end = std::min(total, (chunk + 1) * MIN_CHUNK);
+        for (size_t i = chunk * MIN_CHUNK; i < end; i++) {
+            instances[i] = generateOne(params, cells, vertexPositions, (uint32_t)i);
+        }
+    });
+    return instances;
+}
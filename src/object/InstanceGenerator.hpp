@@ -0,0 +1,65 @@
+// DESCRIPTION
+/*
+InstanceGenerator builds instance sets procedurally instead of one setInstancePosition call at a time.
+
+Every instance is computed from its index alone (random values come from hashing seed + index),
+so the work is split across worker threads in contiguous chunks and the output is identical
+no matter how many threads ran. The parameters are small and deterministic, which is what gets
+saved with the project instead of the generated instances.
+
+Scatter with stratify set places one instance per cell of a grid covering the box and jitters
+it inside the cell. That keeps instances from clumping the way pure random does, a cheap
+stand-in for Poisson disk sampling that still parallelises.
+*/
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "InstanceData.hpp"
+
+enum class InstanceGeneratorType : int {
+    None,          // instances were edited by hand, save them as they are
+    Grid,
+    Scatter,
+    Spiral,
+    MeshVertices
+};
+
+struct InstanceGeneratorParams {
+    InstanceGeneratorType type = InstanceGeneratorType::None;
+    uint32_t seed = 1;
+
+    // Grid
+    glm::uvec3 gridCount = glm::uvec3(10, 1, 10);
+    glm::vec3 spacing    = glm::vec3(2.0f);
+
+    // Scatter, inside [boxMin, boxMax]
+    unsigned int count = 1000; // also used by Spiral
+    glm::vec3 boxMin   = glm::vec3(-10.0f, 0.0f, -10.0f);
+    glm::vec3 boxMax   = glm::vec3(10.0f, 0.0f, 10.0f);
+    bool stratify      = true;
+
+    // Spiral, around the model origin in the XZ plane
+    float radiusStep = 0.1f;  // radius gained per instance
+    float angleStep  = 0.5f;  // radians per instance
+    float heightStep = 0.0f;
+
+    // MeshVertices, one instance per vertex of another model's mesh
+    unsigned int sourceModelID = UINT32_MAX;
+    unsigned int sourceMeshIdx = 0;
+
+    // applied to every generator
+    float randomYaw     = 0.0f; // max random rotation around Y, degrees
+    glm::vec2 scaleRange = glm::vec2(1.0f); // uniform scale picked in [x, y]
+};
+
+struct InstanceGenerator {
+    static constexpr unsigned int MIN_CHUNK = 4096; // below this threads cost more than they save
+
+    // vertexPositions is only read for MeshVertices, returns an empty vector for None
+    static std::vector<InstanceData> generate(const InstanceGeneratorParams& params, 
+                                              const std::vector<glm::vec3>* vertexPositions = nullptr);
+    static size_t countFor(const InstanceGeneratorParams& params, const std::vector<glm::vec3>* vertexPositions = nullptr);
+};
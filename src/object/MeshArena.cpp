@@ -0,0 +1,184 @@
+#include "MeshArena.hpp"
+#include "MeshAssimp.hpp"
+#include "VertexLayout.hpp"
+#include "engine/GLStateCache.hpp"
+
+#include <algorithm>
+
+
+namespace {
+    size_t indexSizeOf(GLenum indexType) {
+        return indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(unsigned int);
+    }
+
+    // a bigger buffer holding the first usedBytes of buffer, which is deleted
+    GLuint growBuffer(GLuint buffer, size_t usedBytes, size_t newBytes) {
+        GLuint grown = 0;
+        glGenBuffers(1, &grown);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+        glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)newBytes, nullptr, GL_STATIC_DRAW);
+        if (buffer != 0) {
+            if (usedBytes > 0) {
+                glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+                glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)usedBytes);
+            }
+            glDeleteBuffers(1, &buffer);
+        }
+        return grown;
+    }
+
+    void copyBuffer(GLuint source, GLuint target, size_t targetOffset, size_t bytes) {
+        if (bytes == 0) return;
+        glBindBuffer(GL_COPY_READ_BUFFER, source);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, target);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, (GLintptr)targetOffset, (GLsizeiptr)bytes);
+    }
+}
+
+
+bool MeshArena::isSupported() {
+    return GLAD_GL_VERSION_4_6 != 0;
+}
+
+
+void MeshArena::initialize(GLuint _instanceBuffer) {
+    instanceBuffer = _instanceBuffer;
+}
+
+
+void MeshArena::shutdown() {
+    for (Pool& pool : pools) {
+        glDeleteVertexArrays(1, &pool.vao);
+        glDeleteBuffers(1, &pool.vbo);
+        glDeleteBuffers(1, &pool.ebo);
+    }
+    pools.clear();
+    entries.clear();
+}
+
+
+const MeshArena::Entry* MeshArena::acquire(uint64_t key, const MeshA& mesh, GLStateCache& stateCache) {
+    if (mesh.isOnGPU() == false) return nullptr;
+
+    auto found = entries.find(key);
+    if (found != entries.end()) {
+        const Entry& entry = found->second;
+        if (entry.sourceBuffer == mesh.getVertexBuffer() && entry.vertexCount == mesh.getVertexCount()
+            && entry.indexCount == mesh.getIndexCount()) return &entry;
+        release(key);
+    }
+
+    uint32_t poolIndex = poolFor(mesh);
+    Pool& pool = pools[poolIndex];
+    size_t vertexCount = mesh.getVertexCount();
+    size_t indexCount = mesh.getIndexCount();
+    reserve(pool, vertexCount, indexCount, stateCache);
+
+    size_t indexSize = indexSizeOf(pool.indexType);
+    copyBuffer(mesh.getVertexBuffer(), pool.vbo, pool.vertexCount * pool.stride, vertexCount * pool.stride);
+    copyBuffer(mesh.getIndexBuffer(), pool.ebo, pool.indexCount * indexSize, indexCount * indexSize);
+
+    Entry entry{
+        .pool = poolIndex,
+        .baseVertex = (uint32_t)pool.vertexCount,
+        .firstIndex = (uint32_t)pool.indexCount,
+        .sourceBuffer = mesh.getVertexBuffer(),
+        .vertexCount = (uint32_t)vertexCount,
+        .indexCount = (uint32_t)indexCount
+    };
+    pool.vertexCount += vertexCount;
+    pool.indexCount += indexCount;
+    pool.liveVertices += vertexCount;
+    pool.liveIndices += indexCount;
+    return &(entries[key] = entry);
+}
+
+
+void MeshArena::release(uint64_t key) {
+    auto found = entries.find(key);
+    if (found == entries.end()) return;
+
+    Pool& pool = pools[found->second.pool];
+    pool.liveVertices -= found->second.vertexCount;
+    pool.liveIndices -= found->second.indexCount;
+    entries.erase(found);
+}
+
+
+void MeshArena::collectGarbage() {
+    for (uint32_t poolIndex = 0; poolIndex < pools.size(); poolIndex++) {
+        const Pool& pool = pools[poolIndex];
+        if (pool.vertexCount - pool.liveVertices > pool.liveVertices || pool.indexCount - pool.liveIndices > pool.liveIndices) {
+            emptyPool(poolIndex);
+        }
+    }
+}
+
+
+size_t MeshArena::getGPUBytes() const {
+    size_t bytes = 0;
+    for (const Pool& pool : pools) {
+        bytes += pool.vertexCapacity * pool.stride + pool.indexCapacity * indexSizeOf(pool.indexType);
+    }
+    return bytes;
+}
+
+
+uint32_t MeshArena::poolFor(const MeshA& mesh) {
+    uint32_t layout = mesh.getVertexLayout().encode();
+    for (uint32_t poolIndex = 0; poolIndex < pools.size(); poolIndex++) {
+        if (pools[poolIndex].layout == layout && pools[poolIndex].indexType == mesh.getIndexType()) return poolIndex;
+    }
+
+    Pool pool;
+    pool.layout = layout;
+    pool.stride = mesh.getVertexLayout().stride;
+    pool.indexType = mesh.getIndexType();
+    pools.push_back(pool);
+    return (uint32_t)pools.size() - 1;
+}
+
+
+// grows geometrically, copying what's there, then points the VAO at the new buffers
+void MeshArena::reserve(Pool& pool, size_t vertices, size_t indices, GLStateCache& stateCache) {
+    bool grown = false;
+    if (pool.vertexCount + vertices > pool.vertexCapacity) {
+        size_t capacity = std::max({ pool.vertexCount + vertices, pool.vertexCapacity * 2, MIN_POOL_VERTICES });
+        pool.vbo = growBuffer(pool.vbo, pool.vertexCount * pool.stride, capacity * pool.stride);
+        pool.vertexCapacity = capacity;
+        grown = true;
+    }
+    if (pool.indexCount + indices > pool.indexCapacity) {
+        size_t capacity = std::max({ pool.indexCount + indices, pool.indexCapacity * 2, MIN_POOL_INDICES });
+        size_t indexSize = indexSizeOf(pool.indexType);
+        pool.ebo = growBuffer(pool.ebo, pool.indexCount * indexSize, capacity * indexSize);
+        pool.indexCapacity = capacity;
+        grown = true;
+    }
+    if (grown) setupVertexArray(pool, stateCache);
+}
+
+
+void MeshArena::setupVertexArray(Pool& pool, GLStateCache& stateCache) {
+    if (pool.vao == 0) glGenVertexArrays(1, &pool.vao);
+    stateCache.bindVertexArray(pool.vao);
+
+    VertexLayout layout;
+    VertexLayout::decode(pool.layout, layout);
+    glBindBuffer(GL_ARRAY_BUFFER, pool.vbo);
+    MeshA::setVertexAttributes(layout);
+    MeshA::setInstanceAttributes(instanceBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, pool.ebo);
+}
+
+
+// the buffers stay allocated for whatever is copied in next
+void MeshArena::emptyPool(uint32_t poolIndex) {
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (it->second.pool == poolIndex) it = entries.erase(it);
+        else ++it;
+    }
+    Pool& pool = pools[poolIndex];
+    pool.vertexCount = pool.indexCount = 0;
+    pool.liveVertices = pool.liveIndices = 0;
+}
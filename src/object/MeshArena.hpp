@@ -0,0 +1,83 @@
+// DESCRIPTION
+/*
+MeshArena keeps copies of meshes in a few large buffers so the Renderer can draw many of them with
+one glMultiDrawElementsIndirect. Meshes are grouped into pools by vertex layout and index type. A
+pool is one VAO over one vertex buffer and one index buffer, and a mesh is a range of each. Its
+indices stay relative to its own first vertex, the draw command's baseVertex adds the offset, so
+16-bit meshes stay 16-bit.
+
+Meshes are copied buffer to buffer from their own VBO and EBO, which they keep for the GL 3.3 path,
+so the arena never needs their CPU copy. Instance attributes of every pool read the one buffer
+given to initialize(), the draw command's baseInstance picks the entry.
+
+Space is only appended. A released mesh leaves a hole, and once most of a pool is holes
+collectGarbage() empties it, the meshes still in it are copied back the next time they're acquired.
+
+Needs GL 4.6, the batched shaders index DrawBlock with gl_DrawID, see isSupported().
+*/
+#pragma once
+
+#include "platform/GL.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class MeshA;
+class GLStateCache;
+
+class MeshArena {
+public:
+    static constexpr size_t MIN_POOL_VERTICES = 1u << 16;
+    static constexpr size_t MIN_POOL_INDICES  = 3u << 16;
+
+    struct Entry {
+        uint32_t pool;
+        uint32_t baseVertex;
+        uint32_t firstIndex; // in the pool's index type
+        GLuint sourceBuffer; // the mesh's VBO when copied, a different one means the mesh was rebuilt
+        uint32_t vertexCount;
+        uint32_t indexCount;
+    };
+
+    static bool isSupported();
+
+    MeshArena() = default;
+    MeshArena(const MeshArena&) = delete;
+    MeshArena& operator=(const MeshArena&) = delete;
+
+    void initialize(GLuint _instanceBuffer);
+    void shutdown(); // while the context still exists, destruction does no GL work
+
+    // key is stable per drawn mesh, e.g. its PrimitiveStore handle. Copies the mesh in on first use,
+    // nullptr until the mesh has been uploaded by its own first draw
+    const Entry* acquire(uint64_t key, const MeshA& mesh, GLStateCache& stateCache);
+    void release(uint64_t key);
+    // empties pools that are mostly holes. Once per frame before any acquire, since it invalidates
+    // ranges handed out earlier
+    void collectGarbage();
+
+    GLuint getVertexArray(uint32_t pool) const { return pools[pool].vao; }
+    GLenum getIndexType(uint32_t pool) const { return pools[pool].indexType; }
+    size_t getGPUBytes() const;
+
+private:
+    struct Pool {
+        uint32_t layout;  // VertexLayout::encode()
+        uint32_t stride;
+        GLenum indexType;
+        GLuint vao = 0, vbo = 0, ebo = 0;
+        size_t vertexCapacity = 0, indexCapacity = 0;
+        size_t vertexCount = 0, indexCount = 0; // appended so far, holes included
+        size_t liveVertices = 0, liveIndices = 0;
+    };
+
+    GLuint instanceBuffer = 0;
+    std::vector<Pool> pools;
+    std::unordered_map<uint64_t, Entry> entries;
+
+    uint32_t poolFor(const MeshA& mesh);
+    void reserve(Pool& pool, size_t vertices, size_t indices, GLStateCache& stateCache);
+    void setupVertexArray(Pool& pool, GLStateCache& stateCache);
+    void emptyPool(uint32_t pool);
+};
@@ -2,21 +2,99 @@
 #include "../engine/Errorlog.hpp"
 #include "../texture/TextureType.hpp"
 #include "core/logging/Logger.hpp"
+#include "engine/GLStateCache.hpp"
+#include "MeshOptimizer.hpp"
 
+#include <algorithm>
+#include <cstddef>
+#include <utility>
 #include <iostream>
 
+namespace {
+    void setAttributePointer(GLuint location, const VertexLayout::Attribute& attribute, GLsizei stride) {
+        const void* offset = (const void*)(uintptr_t)attribute.offset;
+        switch (attribute.format) {
+            case VertexFormat::Float3:
+                glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, stride, offset);
+                break;
+            case VertexFormat::Float2:
+                glVertexAttribPointer(location, 2, GL_FLOAT, GL_FALSE, stride, offset);
+                break;
+            case VertexFormat::Snorm10x3:
+                // the 2 bit w is unused, the shader declares a vec3
+                glVertexAttribPointer(location, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, offset);
+                break;
+            case VertexFormat::Unorm16x2:
+                glVertexAttribPointer(location, 2, GL_UNSIGNED_SHORT, GL_TRUE, stride, offset);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
 MeshA::MeshA( unsigned int meshIdx, std::vector<Vertex> vertices, std::vector<unsigned int> indices, 
-    bool hasPos, bool hasNorms, bool hasUVs) : ID(meshIdx) {
+    bool hasPos, bool hasNorms, bool hasUVs, std::vector<MeshLOD> lods) : ID(meshIdx) {
 
-    this->vertices = vertices;
-    this->indices = indices;
-    this->meshflags.hasPositions = hasPos;
-    this->meshflags.hasNormals = hasNorms;
-    this->meshflags.hasUVs = hasUVs;
+    MeshProperties flags{ hasPos, hasNorms, hasUVs };
+    this->layout = VertexLayout::choose(vertices.data(), vertices.size(), flags);
+    this->bounds = MeshBounds::fromVertices(vertices.data(), vertices.size());
+    this->vertexCount = vertices.size();
+    this->indexCount = indices.size();
+    this->indexType = MeshOptimizer::useShortIndices(this->vertexCount) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    this->meshflags = flags;
+    setLODs(std::move(lods));
+    storeCPUData(vertices, std::move(indices));
+}
+
+
+MeshA::MeshA(unsigned int meshIdx, std::shared_ptr<const MappedFile> source, const unsigned char* vertices, const VertexLayout& layout, 
+    size_t vertexCount, const void* indices, size_t indexCount, GLenum indexType, MeshProperties flags, const MeshBounds& bounds,
+    std::vector<MeshLOD> lods) : ID(meshIdx) {
+
+    this->mappedSource = std::move(source);
+    this->mappedVertices = vertices;
+    this->layout = layout;
+    this->vertexCount = vertexCount;
+    this->mappedIndices = indices;
+    this->indexCount = indexCount;
+    this->indexType = indexType;
+    this->meshflags = flags;
+    this->bounds = bounds;
+    setLODs(std::move(lods));
 }
 
 
 MeshA::MeshA(unsigned int id) : ID(id) {
+    setLODs({});
+}
+
+
+MeshA::MeshA(MeshA&& other) noexcept
+    : ID(other.ID),
+      isLoadedInGPU(std::exchange(other.isLoadedInGPU, false)),
+      meshflags(other.meshflags),
+      vao(std::exchange(other.vao, 0)),
+      vbo(std::exchange(other.vbo, 0)),
+      ebo(std::exchange(other.ebo, 0)),
+      meshInstanceCount(other.meshInstanceCount),
+      instanceVBO(std::exchange(other.instanceVBO, 0)),
+      instanceCapacity(std::exchange(other.instanceCapacity, 0)),
+      layout(other.layout),
+      bounds(other.bounds),
+      lods(std::move(other.lods)),
+      vertexCount(other.vertexCount),
+      indexCount(other.indexCount),
+      keepCPUData(other.keepCPUData),
+      cpuDataReleased(other.cpuDataReleased),
+      vertexBytes(std::move(other.vertexBytes)),
+      indices(std::move(other.indices)),
+      shortIndices(std::move(other.shortIndices)),
+      indexType(other.indexType),
+      mappedSource(std::move(other.mappedSource)),
+      mappedVertices(other.mappedVertices),
+      mappedIndices(other.mappedIndices),
+      baseColor(other.baseColor) {
 
 }
 
@@ -27,9 +105,14 @@ MeshA::~MeshA() {
 }
 
 
-void MeshA::bind(std::vector<InstanceData>& instanceData) {
+void MeshA::bind(const std::vector<InstanceGPUData>& instanceData, GLStateCache* stateCache) {
     loadToGPU(instanceData);
-    glBindVertexArray(vao);
+    // also drops data restored on demand since the last draw
+    if (isLoadedInGPU && !keepCPUData) releaseCPUData();
+    if (stateCache != nullptr) stateCache->bindVertexArray(vao);
+    else glBindVertexArray(vao);
+    // a disabled array reads the current generic value, which isn't part of the VAO
+    if (!layout.has(VertexLayout::Color)) glVertexAttrib4fv(VertexLayout::Color, &baseColor[0]);
 }
 
 
@@ -38,8 +121,106 @@ void MeshA::unbind() {
 }
 
 
-void MeshA::loadToGPU(std::vector<InstanceData>& instanceData) {
-    if (isLoadedInGPU) return;
+const unsigned char* MeshA::getVertexData() const {
+    return mappedSource ? mappedVertices : vertexBytes.data();
+}
+
+
+size_t MeshA::getVertexCount() const {
+    return vertexCount;
+}
+
+
+const void* MeshA::getIndexData() const {
+    if (mappedSource) return mappedIndices;
+    if (indexType == GL_UNSIGNED_SHORT) return shortIndices.data();
+    return indices.data();
+}
+
+
+size_t MeshA::getIndexCount() const {
+    return indexCount;
+}
+
+
+MeshMemory MeshA::getMemoryUsage() const {
+    size_t indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(unsigned int);
+    MeshMemory memory;
+    memory.cpuBytes = vertexBytes.capacity() + indices.capacity() * sizeof(unsigned int) + shortIndices.capacity() * sizeof(uint16_t);
+    if (mappedSource) memory.mappedBytes = vertexCount * layout.stride + indexCount * indexSize;
+    if (isLoadedInGPU) {
+        memory.gpuBytes = vertexCount * layout.stride + indexCount * indexSize + instanceCapacity * sizeof(InstanceGPUData);
+    }
+    return memory;
+}
+
+
+void MeshA::releaseCPUData() {
+    if (cpuDataReleased) return;
+
+    // swapped with empty vectors, clear() would keep the capacity
+    std::vector<unsigned char>().swap(vertexBytes);
+    std::vector<unsigned int>().swap(indices);
+    std::vector<uint16_t>().swap(shortIndices);
+    mappedSource.reset();
+    mappedVertices = nullptr;
+    mappedIndices = nullptr;
+    cpuDataReleased = true;
+}
+
+
+bool MeshA::restoreCPUData(std::vector<Vertex> vertices, std::vector<unsigned int> indices) {
+    if (vertices.size() != vertexCount || indices.size() != indexCount) return false;
+    VertexLayout restoredLayout = VertexLayout::choose(vertices.data(), vertices.size(), meshflags);
+    if (restoredLayout.encode() != layout.encode()) return false;
+
+    releaseCPUData();
+    storeCPUData(vertices, std::move(indices));
+    return true;
+}
+
+
+bool MeshA::restoreCPUData(std::shared_ptr<const MappedFile> source, const unsigned char* vertices, const VertexLayout& layout, 
+    size_t vertexCount, const void* indices, size_t indexCount, GLenum indexType) {
+    if (vertexCount != this->vertexCount || indexCount != this->indexCount || indexType != this->indexType
+        || layout.encode() != this->layout.encode()) {
+        return false;
+    }
+
+    releaseCPUData();
+    mappedSource = std::move(source);
+    mappedVertices = vertices;
+    mappedIndices = indices;
+    cpuDataReleased = false;
+    return true;
+}
+
+
+// a range outside the index buffer would draw garbage, such a set falls back to one level over everything
+void MeshA::setLODs(std::vector<MeshLOD> newLODs) {
+    bool valid = !newLODs.empty() && newLODs.size() <= MAX_MESH_LODS;
+    for (const MeshLOD& lod : newLODs) {
+        valid &= lod.indexCount > 0 && (size_t)lod.firstIndex + lod.indexCount <= indexCount;
+    }
+    if (valid) lods = std::move(newLODs);
+    else lods = { MeshLOD{ 0, (uint32_t)indexCount, 0.0f } };
+}
+
+
+void MeshA::storeCPUData(const std::vector<Vertex>& vertices, std::vector<unsigned int> indices) {
+    vertexBytes = layout.pack(vertices.data(), vertices.size());
+    if (indexType == GL_UNSIGNED_SHORT) {
+        shortIndices = MeshOptimizer::narrowIndices(indices.data(), indices.size());
+    }
+    else {
+        this->indices = std::move(indices);
+    }
+    cpuDataReleased = false;
+}
+
+
+void MeshA::loadToGPU(const std::vector<InstanceGPUData>& instanceData) {
+    if (isLoadedInGPU || !hasCPUData()) return;
     
     // Logger::addLog(LogLevel::INFO, "MESH", "Loading mesh...");
     glGenVertexArrays(1, &vao);
@@ -47,38 +228,48 @@ void MeshA::loadToGPU(std::vector<InstanceData>& instanceData) {
 
     glGenBuffers(1, &vbo);
     glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, getVertexCount() * layout.stride, getVertexData(), GL_STATIC_DRAW);
 
     glGenBuffers(1, &ebo);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), 
-                    &indices[0], GL_STATIC_DRAW);
+    size_t indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(unsigned int);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, getIndexCount() * indexSize, 
+                    getIndexData(), GL_STATIC_DRAW);
     
-    if (meshflags.hasPositions) {
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-    }
-
-    if (meshflags.hasNormals) {
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
-    }
+    setVertexAttributes(layout);
+    resizeInstanceVBO(instanceData);
+    setInstanceAttributes(instanceVBO);
     
-    if (meshflags.hasUVs) {
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, uv));
+    isLoadedInGPU = true;
+}
+
+
+// see VertexLayout.hpp, missing attributes stay disabled and read their constant value
+void MeshA::setVertexAttributes(const VertexLayout& vertexLayout) {
+    for (GLuint location = 0; location < VertexLayout::LocationCount; location++) {
+        const VertexLayout::Attribute& attribute = vertexLayout.attributes[location];
+        if (attribute.format == VertexFormat::None) continue;
+        glEnableVertexAttribArray(location);
+        setAttributePointer(location, attribute, vertexLayout.stride);
     }
+}
 
-    glEnableVertexAttribArray(3);
-    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, color));
 
-    resizeInstanceVBO(instanceData);
-    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+// see InstanceData.hpp for the layout
+void MeshA::setInstanceAttributes(GLuint instanceBuffer) {
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
     glEnableVertexAttribArray(4);
-    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)0);
+    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceGPUData), (void*)offsetof(InstanceGPUData, position));
     glVertexAttribDivisor(4, 1);
-    
-    isLoadedInGPU = true;
+    for (unsigned int column = 0; column < 3; column++) {
+        glEnableVertexAttribArray(5 + column);
+        glVertexAttribPointer(5 + column, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceGPUData), 
+                                (void*)(offsetof(InstanceGPUData, basis) + column * sizeof(glm::vec3)));
+        glVertexAttribDivisor(5 + column, 1);
+    }
+    glEnableVertexAttribArray(8);
+    glVertexAttribPointer(8, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceGPUData), (void*)offsetof(InstanceGPUData, custom));
+    glVertexAttribDivisor(8, 1);
 }
 
 
@@ -89,26 +280,40 @@ void MeshA::unloadFromGPU() {
     glDeleteVertexArrays(1, &vao);
     glDeleteBuffers(1, &vbo);
     glDeleteBuffers(1, &ebo);
+    glDeleteBuffers(1, &instanceVBO);
     vao = 0;
     vbo = 0;
     ebo = 0;
+    instanceVBO = 0;
+    instanceCapacity = 0;
     
     isLoadedInGPU = false;
 }
 
 
-void MeshA::resizeInstanceVBO(std::vector<InstanceData>& instanceData) {
+// The buffer only grows, doubling when it runs out, so adding instances one at a time
+// doesn't reallocate every step. Otherwise the store is orphaned before the full upload,
+// the driver hands back fresh memory instead of waiting for draws still reading the old one.
+void MeshA::resizeInstanceVBO(const std::vector<InstanceGPUData>& instanceData) {
     if (instanceVBO == 0) {
         glGenBuffers(1, &instanceVBO);
     }
     glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
-    glBufferData(GL_ARRAY_BUFFER, instanceData.size() * sizeof(InstanceData), nullptr, GL_DYNAMIC_DRAW);
 
-    glBufferSubData(GL_ARRAY_BUFFER, 0, instanceData.size() * sizeof(InstanceData), instanceData.data());
+    size_t count = instanceData.size();
+    if (count > instanceCapacity) {
+        instanceCapacity = std::max({ count, instanceCapacity * 2, (size_t)16 });
+    }
+    glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(InstanceGPUData), nullptr, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(InstanceGPUData), instanceData.data());
 }
 
 
-void MeshA::updateInstanceData(std::vector<InstanceData>& instanceData) {
+void MeshA::updateInstanceData(const std::vector<InstanceGPUData>& instanceData, size_t first, size_t count) {
+    if (instanceVBO == 0 || first + count > instanceData.size() || first + count > instanceCapacity) {
+        resizeInstanceVBO(instanceData);
+        return;
+    }
     glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, instanceData.size()* sizeof(InstanceData), instanceData.data());
-}
\ No newline at end of file
+    glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(InstanceGPUData), count * sizeof(InstanceGPUData), instanceData.data() + first);
+}
@@ -5,22 +5,86 @@
 #include "InstanceData.hpp"
 // #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
+#include <algorithm>
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <memory>
 #include "Vertex.hpp"
 #include "MeshProperties.hpp"
+#include "VertexLayout.hpp"
+#include "MeshBounds.hpp"
+#include "MeshLOD.hpp"
+
+class GLStateCache;
+class MappedFile;
+
+// what a mesh does with its CPU side vertices and indices once they are on the GPU
+enum class MeshRetention {
+    ReleaseAfterUpload, // dropped after the upload, Model reloads them on demand (see Model::ensureMeshData)
+    KeepCPUCopy
+};
+
+struct MeshMemory {
+    size_t cpuBytes = 0;    // owned vertex and index copies
+    size_t mappedBytes = 0; // vertices and indices mapped from the mesh cache, paged in by the OS
+    size_t gpuBytes = 0;    // vertex, index and instance buffers
+
+    MeshMemory& operator+=(const MeshMemory& other) {
+        cpuBytes += other.cpuBytes;
+        mappedBytes += other.mappedBytes;
+        gpuBytes += other.gpuBytes;
+        return *this;
+    }
+};
 
 class MeshA {
     
     public:
         const unsigned int ID;
         MeshA(unsigned int meshID);
-        MeshA(unsigned int meshID, std::vector<Vertex> vertices, std::vector<unsigned int> indices, bool hasPos, bool hasNorms, bool hasUVs);
+        // lods are ranges of indices (see MeshSimplifier), empty means the whole buffer is the only level
+        MeshA(unsigned int meshID, std::vector<Vertex> vertices, std::vector<unsigned int> indices, bool hasPos, bool hasNorms, bool hasUVs,
+                std::vector<MeshLOD> lods = {});
+        // vertices (packed as layout describes) and indices point into source (a MeshDiskCache blob), which the mesh keeps alive
+        MeshA(unsigned int meshID, std::shared_ptr<const MappedFile> source, const unsigned char* vertices, const VertexLayout& layout, 
+                size_t vertexCount, const void* indices, size_t indexCount, GLenum indexType, MeshProperties flags, const MeshBounds& bounds,
+                std::vector<MeshLOD> lods = {});
+        MeshA(MeshA&& other) noexcept; // the moved-from mesh gives up its GL objects instead of deleting them
         ~MeshA();
 
-        void bind(std::vector<InstanceData>& instanceData);
+        void bind(const std::vector<InstanceGPUData>& instanceData, GLStateCache* stateCache = nullptr);
         void unbind();
+
+        // whichever storage the mesh was built from, owned vectors or a mapped cache blob.
+        // the data pointers are null once the CPU copy is released, counts, layout and bounds stay
+        const unsigned char* getVertexData() const; // getVertexCount() vertices, getVertexLayout().stride bytes apart
+        size_t getVertexCount() const;
+        const VertexLayout& getVertexLayout() const { return layout; }
+        const void* getIndexData() const;
+        size_t getIndexCount() const; // every level of detail together
+        const std::vector<MeshLOD>& getLODs() const { return lods; } // never empty, level 0 is the full mesh
+        const MeshLOD& getLOD(unsigned int level) const { return lods[std::min<size_t>(level, lods.size() - 1)]; }
+        GLenum getIndexType() const { return indexType; } // GL_UNSIGNED_SHORT under MeshOptimizer::SHORT_INDEX_VERTEX_LIMIT vertices
+        const MeshBounds& getBounds() const { return bounds; }
+        MeshMemory getMemoryUsage() const;
+        // GL objects, 0 until the first bind uploads the mesh. MeshArena copies from these
+        bool isOnGPU() const { return isLoadedInGPU; }
+        GLuint getVertexBuffer() const { return vbo; }
+        GLuint getIndexBuffer() const { return ebo; }
+        const glm::vec4& getBaseColor() const { return baseColor; }
+
+        // attribute setup of the bound vertex array, shared with MeshArena's pools
+        static void setVertexAttributes(const VertexLayout& vertexLayout); // from the bound GL_ARRAY_BUFFER
+        static void setInstanceAttributes(GLuint instanceBuffer);    // locations 4-8, one InstanceGPUData per instance
+
+        bool hasCPUData() const { return !cpuDataReleased; }
+        void setKeepCPUData(bool keep) { keepCPUData = keep; }
+        void releaseCPUData();
+        // both fail when the data doesn't match what was uploaded, e.g. the source changed on disk since
+        bool restoreCPUData(std::vector<Vertex> vertices, std::vector<unsigned int> indices);
+        bool restoreCPUData(std::shared_ptr<const MappedFile> source, const unsigned char* vertices, const VertexLayout& layout, 
+                size_t vertexCount, const void* indices, size_t indexCount, GLenum indexType);
     
     private:
         bool isLoadedInGPU = false;
@@ -29,15 +93,29 @@ class MeshA {
         GLuint vao = 0, vbo = 0, ebo = 0;
         unsigned int meshInstanceCount = 1;
         GLuint instanceVBO = 0;
-        std::vector<Vertex> vertices;
+        size_t instanceCapacity = 0; // instances the VBO has room for, grows geometrically
+        VertexLayout layout;
+        MeshBounds bounds;
+        std::vector<MeshLOD> lods;
+        size_t vertexCount = 0;
+        size_t indexCount = 0;
+        bool keepCPUData = false;
+        bool cpuDataReleased = false;
+        std::vector<unsigned char> vertexBytes;
         std::vector<unsigned int> indices;
-        glm::vec4 baseColor = glm::vec4(0.7f, 0.7f, 0.7f, 1.0f);
+        std::vector<uint16_t> shortIndices; // used instead of indices when indexType is GL_UNSIGNED_SHORT
+        GLenum indexType = GL_UNSIGNED_INT;
+        std::shared_ptr<const MappedFile> mappedSource;
+        const unsigned char* mappedVertices = nullptr;
+        const void* mappedIndices = nullptr;
+        glm::vec4 baseColor = glm::vec4(0.7f, 0.7f, 0.7f, 1.0f); // constant color attribute, colors are never stored per vertex
         
-        void loadToGPU(std::vector<InstanceData>& instanceData);
+        void setLODs(std::vector<MeshLOD> newLODs);
+        void storeCPUData(const std::vector<Vertex>& vertices, std::vector<unsigned int> indices); // packs with layout and indexType
+        void loadToGPU(const std::vector<InstanceGPUData>& instanceData);
         void unloadFromGPU();
-        void setInstanceVBO(unsigned int modelInstanceCount, std::vector<InstanceData> instanceData);
-        void resizeInstanceVBO(std::vector<InstanceData>& instanceData);
-        void updateInstanceData(std::vector<InstanceData>& instanceData);
+        void resizeInstanceVBO(const std::vector<InstanceGPUData>& instanceData);
+        void updateInstanceData(const std::vector<InstanceGPUData>& instanceData, size_t first, size_t count);
 
         friend class Model;
 };
\ No newline at end of file
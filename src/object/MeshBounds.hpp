@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <glm/glm.hpp>
+
+#include "Vertex.hpp"
+
+// axis aligned box around a mesh's positions in model space, min > max when the mesh has no vertices
+struct MeshBounds {
+    glm::vec3 min = glm::vec3(FLT_MAX);
+    glm::vec3 max = glm::vec3(-FLT_MAX);
+
+    bool isEmpty() const { return min.x > max.x; }
+    glm::vec3 center() const { return (min + max) * 0.5f; }
+    glm::vec3 extent() const { return (max - min) * 0.5f; }
+    float radius() const { return glm::length(extent()); } // of the bounding sphere around center()
+
+    void expand(const MeshBounds& other) {
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+    }
+
+    void expand(const glm::vec3& point, float pointRadius) {
+        min = glm::min(min, point - glm::vec3(pointRadius));
+        max = glm::max(max, point + glm::vec3(pointRadius));
+    }
+
+    // box around this one after linear * p + translation, still axis aligned so it can grow
+    MeshBounds transformed(const glm::mat3& linear, const glm::vec3& translation) const {
+        if (isEmpty()) return *this;
+        glm::vec3 newCenter = linear * center() + translation;
+        glm::vec3 oldExtent = extent();
+        glm::vec3 newExtent(0.0f);
+        for (int column = 0; column < 3; column++) {
+            for (int row = 0; row < 3; row++) {
+                newExtent[row] += std::abs(linear[column][row]) * oldExtent[column];
+            }
+        }
+        return MeshBounds{ newCenter - newExtent, newCenter + newExtent };
+    }
+
+    static MeshBounds fromVertices(const Vertex* vertices, size_t count) {
+        MeshBounds bounds;
+        for (size_t i = 0; i < count; i++) {
+            bounds.min = glm::min(bounds.min, vertices[i].position);
+            bounds.max = glm::max(bounds.max, vertices[i].position);
+        }
+        return bounds;
+    }
+};
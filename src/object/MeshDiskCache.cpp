@@ -0,0 +1,230 @@
+#include "MeshDiskCache.hpp"
+#include "platform/MappedFile.hpp"
+#include "platform/DiskCacheFile.hpp"
+#include "MeshOptimizer.hpp"
+#include "VertexLayout.hpp"
+
+#include <fstream>
+#include <cstring>
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr char BLOB_MAGIC[4] = { 'P', 'M', 'S', 'H' };
+    constexpr uint32_t BLOB_VERSION = 5;
+    constexpr uint64_t BLOB_ALIGNMENT = 16;
+
+    constexpr uint32_t FLAG_POSITIONS = 1;
+    constexpr uint32_t FLAG_NORMALS   = 2;
+    constexpr uint32_t FLAG_UVS       = 4;
+    constexpr uint32_t FLAG_SHORT_INDICES = 8;
+
+    struct BlobHeader {
+        char magic[4];
+        uint32_t version;
+        uint64_t sourceSize;
+        int64_t sourceMtime;
+        uint64_t contentHash;
+        uint64_t importOptions;
+        uint32_t meshCount;
+    };
+
+    struct BlobMesh {
+        uint64_t vertexOffset; // from the start of the blob
+        uint64_t indexOffset;
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t flags;
+        uint32_t layout; // VertexLayout::encode() of the packed vertices
+        float boundsMin[3];
+        float boundsMax[3];
+        uint32_t lodCount; // levels of detail, ranges of this mesh's indices
+        uint32_t lodFirstIndex[MAX_MESH_LODS];
+        uint32_t lodIndexCount[MAX_MESH_LODS];
+        float lodError[MAX_MESH_LODS];
+    };
+
+    uint64_t alignUp(uint64_t offset) {
+        return (offset + BLOB_ALIGNMENT - 1) & ~(BLOB_ALIGNMENT - 1);
+    }
+
+    bool inBounds(uint64_t offset, uint64_t bytes, uint64_t blobSize) {
+        return offset % BLOB_ALIGNMENT == 0 && offset <= blobSize && bytes <= blobSize - offset;
+    }
+}
+
+
+bool MeshDiskCache::initialize(const fs::path& cacheDir) {
+    std::error_code error;
+    fs::create_directories(cacheDir, error);
+    if (error) {
+        directory.clear();
+        return false;
+    }
+    directory = cacheDir;
+    return true;
+}
+
+
+bool MeshDiskCache::isEnabled() const {
+    return !directory.empty();
+}
+
+
+fs::path MeshDiskCache::blobPath(const std::string& sourcePath) const {
+    std::string key = DiskCacheFile::pathKey(sourcePath);
+    return directory / (DiskCacheFile::hexName(DiskCacheFile::hashBytes(key.data(), key.size())) + ".mesh");
+}
+
+
+bool MeshDiskCache::load(const std::string& sourcePath, uint64_t importOptions, CachedModel& model) const {
+    if (!isEnabled()) return false;
+
+    uint64_t sourceSize;
+    int64_t sourceMtime;
+    if (!DiskCacheFile::statFile(sourcePath, sourceSize, sourceMtime)) return false;
+
+    auto file = std::make_shared<MappedFile>();
+    if (!file->open(blobPath(sourcePath)) || file->size() < sizeof(BlobHeader)) {
+        misses++;
+        return false;
+    }
+
+    BlobHeader header;
+    std::memcpy(&header, file->data(), sizeof(header));
+    if (std::memcmp(header.magic, BLOB_MAGIC, 4) != 0 || header.version != BLOB_VERSION
+        || header.importOptions != importOptions
+        || header.sourceSize != sourceSize
+        || header.meshCount > (file->size() - sizeof(BlobHeader)) / sizeof(BlobMesh)) {
+        misses++;
+        return false;
+    }
+
+    if (header.sourceMtime != sourceMtime) {
+        uint64_t contentHash;
+        if (!DiskCacheFile::hashFile(sourcePath, contentHash) || contentHash != header.contentHash) {
+            misses++;
+            return false;
+        }
+    }
+
+    CachedModel loaded;
+    loaded.meshes.resize(header.meshCount);
+    for (uint32_t i = 0; i < header.meshCount; i++) {
+        BlobMesh blobMesh;
+        std::memcpy(&blobMesh, file->data() + sizeof(BlobHeader) + i * sizeof(BlobMesh), sizeof(BlobMesh));
+
+        bool shortIndices = (blobMesh.flags & FLAG_SHORT_INDICES) != 0;
+        uint64_t indexSize = shortIndices ? sizeof(uint16_t) : sizeof(unsigned int);
+        VertexLayout layout;
+        if (!VertexLayout::decode(blobMesh.layout, layout)
+            || !inBounds(blobMesh.vertexOffset, (uint64_t)blobMesh.vertexCount * layout.stride, file->size())
+            || !inBounds(blobMesh.indexOffset, (uint64_t)blobMesh.indexCount * indexSize, file->size())) {
+            misses++;
+            return false;
+        }
+
+        CachedMesh& mesh = loaded.meshes[i];
+        mesh.vertices = file->data() + blobMesh.vertexOffset;
+        mesh.layout = layout;
+        mesh.vertexCount = blobMesh.vertexCount;
+        mesh.indices = file->data() + blobMesh.indexOffset;
+        mesh.indexCount = blobMesh.indexCount;
+        mesh.shortIndices = shortIndices;
+        mesh.bounds.min = glm::vec3(blobMesh.boundsMin[0], blobMesh.boundsMin[1], blobMesh.boundsMin[2]);
+        mesh.bounds.max = glm::vec3(blobMesh.boundsMax[0], blobMesh.boundsMax[1], blobMesh.boundsMax[2]);
+        mesh.flags.hasPositions = (blobMesh.flags & FLAG_POSITIONS) != 0;
+        mesh.flags.hasNormals   = (blobMesh.flags & FLAG_NORMALS) != 0;
+        mesh.flags.hasUVs       = (blobMesh.flags & FLAG_UVS) != 0;
+
+        if (blobMesh.lodCount == 0 || blobMesh.lodCount > MAX_MESH_LODS) {
+            misses++;
+            return false;
+        }
+        for (uint32_t level = 0; level < blobMesh.lodCount; level++) {
+            MeshLOD lod{ blobMesh.lodFirstIndex[level], blobMesh.lodIndexCount[level], blobMesh.lodError[level] };
+            if ((uint64_t)lod.firstIndex + lod.indexCount > blobMesh.indexCount) {
+                misses++;
+                return false;
+            }
+            mesh.lods.push_back(lod);
+        }
+    }
+    loaded.file = std::move(file);
+
+    model = std::move(loaded);
+    hits++;
+    return true;
+}
+
+
+bool MeshDiskCache::store(const std::string& sourcePath, uint64_t importOptions, const std::vector<ImportedMesh>& meshes) const {
+    if (!isEnabled()) return false;
+
+    BlobHeader header{};
+    std::memcpy(header.magic, BLOB_MAGIC, 4);
+    header.version = BLOB_VERSION;
+    if (!DiskCacheFile::statFile(sourcePath, header.sourceSize, header.sourceMtime)) return false;
+    if (!DiskCacheFile::hashFile(sourcePath, header.contentHash)) return false;
+    header.importOptions = importOptions;
+    header.meshCount = (uint32_t)meshes.size();
+
+    // lay out the data after the table, every array starting on an aligned offset
+    std::vector<BlobMesh> table(meshes.size());
+    std::vector<std::vector<unsigned char>> packedVertices(meshes.size());
+    uint64_t offset = alignUp(sizeof(BlobHeader) + table.size() * sizeof(BlobMesh));
+    for (size_t i = 0; i < meshes.size(); i++) {
+        const ImportedMesh& mesh = meshes[i];
+        BlobMesh& blobMesh = table[i];
+        blobMesh.vertexCount = (uint32_t)mesh.vertices.size();
+        blobMesh.indexCount = (uint32_t)mesh.indices.size();
+        bool shortIndices = MeshOptimizer::useShortIndices(mesh.vertices.size());
+        blobMesh.flags = (mesh.flags.hasPositions ? FLAG_POSITIONS : 0)
+                       | (mesh.flags.hasNormals ? FLAG_NORMALS : 0)
+                       | (mesh.flags.hasUVs ? FLAG_UVS : 0)
+                       | (shortIndices ? FLAG_SHORT_INDICES : 0);
+        VertexLayout layout = VertexLayout::choose(mesh.vertices.data(), mesh.vertices.size(), mesh.flags);
+        blobMesh.layout = layout.encode();
+        packedVertices[i] = layout.pack(mesh.vertices.data(), mesh.vertices.size());
+        MeshBounds bounds = MeshBounds::fromVertices(mesh.vertices.data(), mesh.vertices.size());
+        for (int c = 0; c < 3; c++) {
+            blobMesh.boundsMin[c] = bounds.min[c];
+            blobMesh.boundsMax[c] = bounds.max[c];
+        }
+        std::vector<MeshLOD> lods = mesh.lods;
+        if (lods.empty() || lods.size() > MAX_MESH_LODS) lods = { MeshLOD{ 0, blobMesh.indexCount, 0.0f } };
+        blobMesh.lodCount = (uint32_t)lods.size();
+        for (size_t level = 0; level < lods.size(); level++) {
+            blobMesh.lodFirstIndex[level] = lods[level].firstIndex;
+            blobMesh.lodIndexCount[level] = lods[level].indexCount;
+            blobMesh.lodError[level] = lods[level].error;
+        }
+        blobMesh.vertexOffset = offset;
+        offset = alignUp(offset + packedVertices[i].size());
+        blobMesh.indexOffset = offset;
+        offset = alignUp(offset + mesh.indices.size() * (shortIndices ? sizeof(uint16_t) : sizeof(unsigned int)));
+    }
+
+    return DiskCacheFile::writeAtomically(blobPath(sourcePath), [&](std::ofstream& blob) {
+        const char zeros[BLOB_ALIGNMENT] = {};
+        auto padTo = [&blob, &zeros](uint64_t target) {
+            uint64_t position = (uint64_t)blob.tellp();
+            if (target > position) blob.write(zeros, (std::streamsize)(target - position));
+        };
+
+        blob.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        blob.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(BlobMesh));
+        for (size_t i = 0; i < meshes.size(); i++) {
+            padTo(table[i].vertexOffset);
+            blob.write(reinterpret_cast<const char*>(packedVertices[i].data()), packedVertices[i].size());
+            padTo(table[i].indexOffset);
+            if (table[i].flags & FLAG_SHORT_INDICES) {
+                std::vector<uint16_t> shortIndices = MeshOptimizer::narrowIndices(meshes[i].indices.data(), meshes[i].indices.size());
+                blob.write(reinterpret_cast<const char*>(shortIndices.data()), shortIndices.size() * sizeof(uint16_t));
+            }
+            else {
+                blob.write(reinterpret_cast<const char*>(meshes[i].indices.data()), meshes[i].indices.size() * sizeof(unsigned int));
+            }
+        }
+    });
+}
@@ -0,0 +1,69 @@
+// DESCRIPTION
+/*
+MeshDiskCache keeps the converted meshes of imported models next to the project, so reopening
+a project maps them straight from disk instead of parsing the source file through Assimp again.
+
+One blob per source file, named after a hash of the source path. A blob is a header, a mesh
+table, then every mesh's vertices and indices, tightly packed in the exact layout MeshA uploads.
+Loading maps the blob (see MappedFile) and hands out pointers into it, nothing is converted
+or copied on the CPU. The source is validated the same way as TextureDiskCache: size and mtime,
+falling back to a content hash when only the mtime moved (see DiskCacheFile).
+
+Each mesh records its VertexLayout and its levels of detail (ranges of its one index array, see
+MeshSimplifier); the blob also records the options the meshes were imported with, so changing
+the options makes every existing blob a miss instead of garbage. Indices are stored 16-bit when the
+mesh is small enough (MeshOptimizer::useShortIndices), the same width MeshA uploads.
+*/
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "MeshProperties.hpp"
+#include "VertexLayout.hpp"
+#include "MeshBounds.hpp"
+#include "ImportedModel.hpp"
+
+class MappedFile;
+
+class MeshDiskCache {
+public:
+    struct CachedMesh {
+        const unsigned char* vertices = nullptr; // packed as layout describes
+        VertexLayout layout;
+        size_t vertexCount = 0;
+        const void* indices = nullptr; // uint16_t when shortIndices, unsigned int otherwise
+        size_t indexCount = 0;
+        bool shortIndices = false;
+        MeshProperties flags;
+        MeshBounds bounds; // stored so a mapped mesh doesn't read every position to get them
+        std::vector<MeshLOD> lods; // ranges of indices, at least the full mesh
+    };
+
+    // the pointers in meshes stay valid as long as file does
+    struct CachedModel {
+        std::shared_ptr<const MappedFile> file;
+        std::vector<CachedMesh> meshes;
+    };
+
+    bool initialize(const std::filesystem::path& cacheDir);
+    bool isEnabled() const;
+
+    // importOptions is whatever changes the imported meshes (Assimp flags, optimization), a blob only matches the same value
+    bool load(const std::string& sourcePath, uint64_t importOptions, CachedModel& model) const;
+    bool store(const std::string& sourcePath, uint64_t importOptions, const std::vector<ImportedMesh>& meshes) const;
+
+    unsigned int getHits() const { return hits; }
+    unsigned int getMisses() const { return misses; }
+
+private:
+    std::filesystem::path directory;
+    mutable std::atomic<unsigned int> hits = 0;
+    mutable std::atomic<unsigned int> misses = 0;
+
+    std::filesystem::path blobPath(const std::string& sourcePath) const;
+};
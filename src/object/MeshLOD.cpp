@@ -0,0 +1,24 @@
+#include "MeshLOD.hpp"
+
+#include <algorithm>
+
+
+unsigned int LODSelector::select(const std::vector<MeshLOD>& lods, float pixelsPerUnit, float pixelError, unsigned int current) {
+    if (lods.size() <= 1) return 0;
+    current = std::min(current, (unsigned int)lods.size() - 1);
+
+    // level 0 has no error at any distance, even with the camera inside the mesh
+    auto projected = [&lods, pixelsPerUnit](unsigned int level) {
+        return lods[level].error == 0.0f ? 0.0f : lods[level].error * pixelsPerUnit;
+    };
+
+    if (projected(current) > pixelError * (1.0f + HYSTERESIS)) {
+        unsigned int level = current;
+        while (level > 0 && projected(level) > pixelError) level--;
+        return level;
+    }
+
+    unsigned int level = current;
+    while (level + 1 < lods.size() && projected(level + 1) <= pixelError * (1.0f - HYSTERESIS)) level++;
+    return level;
+}
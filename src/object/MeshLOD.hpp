@@ -0,0 +1,26 @@
+#pragma once
+
+#include "engine/LODUniform.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// one level of detail of a mesh: a range of its index buffer over the vertices every level shares
+// (see MeshSimplifier). Level 0 is the full mesh with error 0, a mesh without reduced levels has only that.
+struct MeshLOD {
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    float error = 0.0f; // how far the level's surface may be from the full mesh, in model units
+};
+
+inline constexpr unsigned int MAX_MESH_LODS = 5; // the full mesh and up to four reduced levels
+
+// Picks the coarsest level whose error covers at most pixelError pixels on screen. pixelsPerUnit is
+// how many pixels one model unit spans at the mesh's distance. Near the boundary between two levels
+// that would flip every frame, so a coarser level is only taken once its error is HYSTERESIS under
+// the limit, and the current one only left for a finer one once it is HYSTERESIS over.
+struct LODSelector {
+    static constexpr float HYSTERESIS = 0.25f;
+
+    static unsigned int select(const std::vector<MeshLOD>& lods, float pixelsPerUnit, float pixelError, unsigned int current);
+};
@@ -0,0 +1,289 @@
+#include "MeshOptimizer.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <string_view>
+#include <unordered_map>
+#include <glm/glm.hpp>
+
+namespace {
+    constexpr unsigned int UNUSED = std::numeric_limits<unsigned int>::max();
+
+    // FIFO post-transform cache, a vertex is cached while fewer than size misses happened since it was loaded
+    struct FifoCache {
+        std::vector<uint32_t> loadedAt;
+        uint32_t time;
+        uint32_t size;
+
+        FifoCache(size_t vertexCount, uint32_t cacheSize)
+            : loadedAt(vertexCount, 0), time(cacheSize + 1), size(cacheSize) {}
+
+        bool access(unsigned int vertex) {
+            if (time - loadedAt[vertex] <= size) return true;
+            loadedAt[vertex] = time++;
+            return false;
+        }
+
+        void flush() { time += size + 1; }
+    };
+}
+
+
+void MeshOptimizer::optimize(ImportedMesh& mesh) {
+    if (mesh.indices.empty() || mesh.indices.size() % 3 != 0) return;
+
+    weldVertices(mesh);
+    std::vector<size_t> hardBoundaries;
+    optimizeVertexCache(mesh.indices, mesh.vertices.size(), &hardBoundaries);
+    if (mesh.flags.hasPositions) {
+        optimizeOverdraw(mesh.indices, mesh.vertices, hardBoundaries);
+    }
+    optimizeVertexFetch(mesh);
+}
+
+
+size_t MeshOptimizer::weldVertices(ImportedMesh& mesh) {
+    const std::vector<Vertex>& vertices = mesh.vertices;
+
+    // keyed on the raw bytes, Vertex has no padding and processMesh zeroes missing attributes
+    std::unordered_map<std::string_view, unsigned int> unique;
+    unique.reserve(vertices.size());
+    std::vector<unsigned int> remap(vertices.size());
+    std::vector<Vertex> welded;
+    welded.reserve(vertices.size());
+
+    for (size_t v = 0; v < vertices.size(); v++) {
+        std::string_view key(reinterpret_cast<const char*>(&vertices[v]), sizeof(Vertex));
+        auto [it, inserted] = unique.try_emplace(key, (unsigned int)welded.size());
+        if (inserted) welded.push_back(vertices[v]);
+        remap[v] = it->second;
+    }
+
+    size_t removed = vertices.size() - welded.size();
+    if (removed == 0) return 0;
+
+    for (unsigned int& index : mesh.indices) {
+        index = remap[index];
+    }
+    mesh.vertices = std::move(welded);
+    return removed;
+}
+
+
+void MeshOptimizer::optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount, std::vector<size_t>* hardBoundaries) {
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || vertexCount == 0) return;
+    const int cacheSize = (int)CACHE_SIZE;
+
+    // vertex -> triangles using it
+    std::vector<unsigned int> adjacencyStart(vertexCount + 1, 0);
+    for (unsigned int index : indices) {
+        adjacencyStart[index + 1]++;
+    }
+    for (size_t v = 0; v < vertexCount; v++) {
+        adjacencyStart[v + 1] += adjacencyStart[v];
+    }
+    std::vector<unsigned int> adjacency(indices.size());
+    std::vector<unsigned int> fill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+    for (size_t t = 0; t < triangleCount; t++) {
+        for (size_t corner = 0; corner < 3; corner++) {
+            adjacency[fill[indices[3 * t + corner]]++] = (unsigned int)t;
+        }
+    }
+
+    std::vector<int> liveTriangles(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++) {
+        liveTriangles[v] = (int)(adjacencyStart[v + 1] - adjacencyStart[v]);
+    }
+
+    std::vector<int> cacheTime(vertexCount, 0);
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    std::vector<unsigned int> deadEnds;
+    std::vector<unsigned int> candidates;
+    std::vector<unsigned int> output;
+    output.reserve(indices.size());
+    int timestamp = cacheSize + 1;
+    size_t cursor = 0;
+
+    auto skipDeadEnd = [&]() -> long long {
+        while (!deadEnds.empty()) {
+            unsigned int vertex = deadEnds.back();
+            deadEnds.pop_back();
+            if (liveTriangles[vertex] > 0) return vertex;
+        }
+        while (cursor < vertexCount) {
+            if (liveTriangles[cursor] > 0) return (long long)cursor;
+            cursor++;
+        }
+        return -1;
+    };
+
+    long long fanVertex = skipDeadEnd();
+    while (fanVertex >= 0) {
+        // emit every remaining triangle around the fanning vertex
+        candidates.clear();
+        for (unsigned int a = adjacencyStart[fanVertex]; a < adjacencyStart[fanVertex + 1]; a++) {
+            unsigned int t = adjacency[a];
+            if (emitted[t]) continue;
+            for (size_t corner = 0; corner < 3; corner++) {
+                unsigned int vertex = indices[3 * t + corner];
+                output.push_back(vertex);
+                deadEnds.push_back(vertex);
+                candidates.push_back(vertex);
+                liveTriangles[vertex]--;
+                if (timestamp - cacheTime[vertex] > cacheSize) {
+                    cacheTime[vertex] = timestamp++;
+                }
+            }
+            emitted[t] = 1;
+        }
+
+        // next fan: the candidate that stays in cache longest after its own triangles are emitted
+        long long next = -1;
+        int bestPriority = -1;
+        for (unsigned int vertex : candidates) {
+            if (liveTriangles[vertex] <= 0) continue;
+            int priority = 0;
+            if (timestamp - cacheTime[vertex] + 2 * liveTriangles[vertex] <= cacheSize) {
+                priority = timestamp - cacheTime[vertex];
+            }
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                next = vertex;
+            }
+        }
+        if (next < 0) {
+            next = skipDeadEnd();
+            if (next >= 0 && hardBoundaries) hardBoundaries->push_back(output.size() / 3);
+        }
+        fanVertex = next;
+    }
+
+    indices = std::move(output);
+}
+
+
+void MeshOptimizer::optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices, const std::vector<size_t>& hardBoundaries) {
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2) return;
+
+    // split the hard clusters further wherever the cache order is already doing well, a break
+    // there only costs what the cluster has earned over the threshold
+    float threshold = averageCacheMissRatio(indices, vertices.size()) * OVERDRAW_THRESHOLD;
+    std::vector<size_t> hard = hardBoundaries;
+    hard.push_back(0);
+    hard.push_back(triangleCount);
+    std::sort(hard.begin(), hard.end());
+    hard.erase(std::unique(hard.begin(), hard.end()), hard.end());
+
+    std::vector<size_t> clusterStarts;
+    FifoCache cache(vertices.size(), CACHE_SIZE);
+    for (size_t h = 0; h + 1 < hard.size(); h++) {
+        size_t end = hard[h + 1];
+        clusterStarts.push_back(hard[h]);
+        cache.flush();
+        size_t misses = 0;
+        size_t triangles = 0;
+        for (size_t t = hard[h]; t < end; t++) {
+            for (size_t corner = 0; corner < 3; corner++) {
+                if (!cache.access(indices[3 * t + corner])) misses++;
+            }
+            triangles++;
+            if (t + 1 < end && (float)misses / (float)triangles <= threshold) {
+                clusterStarts.push_back(t + 1);
+                cache.flush();
+                misses = 0;
+                triangles = 0;
+            }
+        }
+    }
+    if (clusterStarts.size() < 2) return;
+
+    struct Cluster {
+        size_t start;
+        size_t end;
+        glm::vec3 centroid = glm::vec3(0.0f);
+        glm::vec3 normal = glm::vec3(0.0f); // area weighted
+        float sortKey = 0.0f;
+    };
+    std::vector<Cluster> clusters(clusterStarts.size());
+    glm::vec3 meshCentroid(0.0f);
+    float meshArea = 0.0f;
+    for (size_t c = 0; c < clusters.size(); c++) {
+        Cluster& cluster = clusters[c];
+        cluster.start = clusterStarts[c];
+        cluster.end = c + 1 < clusterStarts.size() ? clusterStarts[c + 1] : triangleCount;
+
+        float clusterArea = 0.0f;
+        for (size_t t = cluster.start; t < cluster.end; t++) {
+            const glm::vec3& a = vertices[indices[3 * t + 0]].position;
+            const glm::vec3& b = vertices[indices[3 * t + 1]].position;
+            const glm::vec3& p = vertices[indices[3 * t + 2]].position;
+            glm::vec3 cross = glm::cross(b - a, p - a);
+            float area = glm::length(cross);
+            cluster.centroid += (a + b + p) * (area / 3.0f);
+            cluster.normal += cross;
+            clusterArea += area;
+        }
+        meshCentroid += cluster.centroid;
+        meshArea += clusterArea;
+        if (clusterArea > 0.0f) cluster.centroid /= clusterArea;
+    }
+    if (meshArea > 0.0f) meshCentroid /= meshArea;
+
+    // clusters facing out from the centre are the likely occluders, draw them first
+    for (Cluster& cluster : clusters) {
+        float normalLength = glm::length(cluster.normal);
+        if (normalLength > 0.0f) {
+            cluster.sortKey = glm::dot(cluster.centroid - meshCentroid, cluster.normal / normalLength);
+        }
+    }
+    std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) {
+        return a.sortKey > b.sortKey;
+    });
+
+    std::vector<unsigned int> reordered;
+    reordered.reserve(indices.size());
+    for (const Cluster& cluster : clusters) {
+        reordered.insert(reordered.end(), indices.begin() + 3 * cluster.start, indices.begin() + 3 * cluster.end);
+    }
+    indices = std::move(reordered);
+}
+
+
+void MeshOptimizer::optimizeVertexFetch(ImportedMesh& mesh) {
+    std::vector<unsigned int> remap(mesh.vertices.size(), UNUSED);
+    std::vector<Vertex> reordered;
+    reordered.reserve(mesh.vertices.size());
+
+    for (unsigned int& index : mesh.indices) {
+        if (remap[index] == UNUSED) {
+            remap[index] = (unsigned int)reordered.size();
+            reordered.push_back(mesh.vertices[index]);
+        }
+        index = remap[index];
+    }
+    mesh.vertices = std::move(reordered);
+}
+
+
+float MeshOptimizer::averageCacheMissRatio(const std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize) {
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) return 0.0f;
+
+    FifoCache cache(vertexCount, cacheSize);
+    size_t misses = 0;
+    for (unsigned int index : indices) {
+        if (!cache.access(index)) misses++;
+    }
+    return (float)misses / (float)triangleCount;
+}
+
+
+std::vector<uint16_t> MeshOptimizer::narrowIndices(const unsigned int* indices, size_t count) {
+    std::vector<uint16_t> narrowed(count);
+    for (size_t i = 0; i < count; i++) {
+        narrowed[i] = (uint16_t)indices[i];
+    }
+    return narrowed;
+}
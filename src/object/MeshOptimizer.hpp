@@ -0,0 +1,46 @@
+// DESCRIPTION
+/*
+MeshOptimizer reorders an imported triangle mesh so the GPU does less work drawing the same
+triangles. optimize() runs every pass, in this order:
+
+    weldVertices         merges vertices that are bit-for-bit identical. Formats like OBJ come
+                         out of Assimp with three vertices per triangle, this is what makes the
+                         index buffer worth having.
+    optimizeVertexCache  Tipsify (Sander, Nehab, Barczak 2007). Fans around recently used
+                         vertices so the post-transform cache hits more often.
+    optimizeOverdraw     splits the cache-ordered triangles into clusters and draws the ones
+                         facing away from the mesh centre first, so they occlude the rest
+                         and fewer fragments get shaded twice. Clusters only break where the
+                         cache was going to miss anyway, the cache order mostly survives.
+    optimizeVertexFetch  renumbers vertices in the order the index buffer first uses them,
+                         so vertex fetch walks memory forwards. Unused vertices are dropped.
+
+The passes only change order (and the vertex count, for welding), never what is drawn.
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ImportedModel.hpp"
+
+struct MeshOptimizer {
+    static constexpr unsigned int CACHE_SIZE = 16; // FIFO entries assumed for the post-transform cache
+    static constexpr float OVERDRAW_THRESHOLD = 1.05f; // how much worse than the cache order a cluster may get
+
+    static void optimize(ImportedMesh& mesh);
+
+    static size_t weldVertices(ImportedMesh& mesh); // returns the number of vertices removed
+    static void optimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount, std::vector<size_t>* hardBoundaries = nullptr);
+    static void optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices, const std::vector<size_t>& hardBoundaries);
+    static void optimizeVertexFetch(ImportedMesh& mesh);
+
+    // misses per triangle on a FIFO cache, 0.5 is the best a regular grid can do, 3 the worst
+    static float averageCacheMissRatio(const std::vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize = CACHE_SIZE);
+
+    // meshes under this many vertices upload 16-bit indices
+    static constexpr size_t SHORT_INDEX_VERTEX_LIMIT = 65536;
+    static bool useShortIndices(size_t vertexCount) { return vertexCount < SHORT_INDEX_VERTEX_LIMIT; }
+    static std::vector<uint16_t> narrowIndices(const unsigned int* indices, size_t count);
+};
@@ -0,0 +1,241 @@
+#include "MeshSimplifier.hpp"
+#include "MeshOptimizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
+#include <glm/glm.hpp>
+
+namespace {
+    // sum of squared distances to a set of planes, as the symmetric 4x4 matrix of Garland and Heckbert
+    struct Quadric {
+        double a2 = 0, ab = 0, ac = 0, ad = 0;
+        double b2 = 0, bc = 0, bd = 0;
+        double c2 = 0, cd = 0;
+        double d2 = 0;
+        double weight = 0; // summed plane weights, so the error is a mean distance
+
+        void addPlane(const glm::dvec3& n, double d, double w) {
+            a2 += w * n.x * n.x; ab += w * n.x * n.y; ac += w * n.x * n.z; ad += w * n.x * d;
+            b2 += w * n.y * n.y; bc += w * n.y * n.z; bd += w * n.y * d;
+            c2 += w * n.z * n.z; cd += w * n.z * d;
+            d2 += w * d * d;
+            weight += w;
+        }
+
+        void add(const Quadric& other) {
+            a2 += other.a2; ab += other.ab; ac += other.ac; ad += other.ad;
+            b2 += other.b2; bc += other.bc; bd += other.bd;
+            c2 += other.c2; cd += other.cd;
+            d2 += other.d2;
+            weight += other.weight;
+        }
+
+        // distance from the planes at p, in model units
+        double error(const glm::dvec3& p) const {
+            if (weight <= 0.0) return 0.0;
+            double squared = a2 * p.x * p.x + b2 * p.y * p.y + c2 * p.z * p.z
+                           + 2.0 * (ab * p.x * p.y + ac * p.x * p.z + bc * p.y * p.z)
+                           + 2.0 * (ad * p.x + bd * p.y + cd * p.z) + d2;
+            return std::sqrt(std::max(0.0, squared / weight));
+        }
+    };
+
+    struct Collapse {
+        unsigned int from;
+        unsigned int to;
+        double cost;
+    };
+
+    glm::dvec3 triangleNormal(const glm::dvec3& a, const glm::dvec3& b, const glm::dvec3& c) {
+        return glm::cross(b - a, c - a);
+    }
+
+    // vertices that may not move: on an open or non-manifold edge, or sharing their position with another vertex
+    std::vector<uint8_t> findLockedVertices(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices) {
+        std::unordered_map<std::string_view, unsigned int> firstAtPosition;
+        firstAtPosition.reserve(vertices.size());
+        std::vector<unsigned int> positionID(vertices.size());
+        std::vector<unsigned int> verticesAtPosition(vertices.size(), 0);
+        for (size_t v = 0; v < vertices.size(); v++) {
+            std::string_view key(reinterpret_cast<const char*>(&vertices[v].position), sizeof(glm::vec3));
+            auto [it, inserted] = firstAtPosition.try_emplace(key, (unsigned int)v);
+            positionID[v] = it->second;
+            verticesAtPosition[it->second]++;
+        }
+
+        // edges between positions, so a seam doesn't look like two borders
+        std::unordered_map<uint64_t, unsigned int> edgeUses;
+        edgeUses.reserve(indices.size());
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            for (int corner = 0; corner < 3; corner++) {
+                uint64_t a = positionID[indices[i + corner]];
+                uint64_t b = positionID[indices[i + (corner + 1) % 3]];
+                edgeUses[a < b ? (a << 32 | b) : (b << 32 | a)]++;
+            }
+        }
+
+        std::vector<uint8_t> lockedPosition(vertices.size(), 0);
+        for (auto& [edge, uses] : edgeUses) {
+            if (uses == 2) continue;
+            lockedPosition[edge >> 32] = 1;
+            lockedPosition[edge & 0xFFFFFFFFu] = 1;
+        }
+
+        std::vector<uint8_t> locked(vertices.size());
+        for (size_t v = 0; v < vertices.size(); v++) {
+            locked[v] = lockedPosition[positionID[v]] || verticesAtPosition[positionID[v]] > 1;
+        }
+        return locked;
+    }
+}
+
+
+std::vector<unsigned int> MeshSimplifier::simplify(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+                                                    size_t targetIndexCount, float* error) {
+    std::vector<unsigned int> result = indices;
+    if (error) *error = 0.0f;
+    if (indices.size() % 3 != 0 || indices.size() <= targetIndexCount) return result;
+
+    size_t vertexCount = vertices.size();
+    std::vector<glm::dvec3> positions(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++) {
+        positions[v] = glm::dvec3(vertices[v].position);
+    }
+    std::vector<uint8_t> locked = findLockedVertices(vertices, indices);
+
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        const glm::dvec3& p0 = positions[indices[i]];
+        glm::dvec3 normal = triangleNormal(p0, positions[indices[i + 1]], positions[indices[i + 2]]);
+        double length = glm::length(normal);
+        if (length == 0.0) continue;
+        normal /= length;
+        double d = -glm::dot(normal, p0);
+        double area = length * 0.5;
+        for (int corner = 0; corner < 3; corner++) {
+            quadrics[indices[i + corner]].addPlane(normal, d, area);
+        }
+    }
+
+    double maxError = 0.0;
+    std::vector<unsigned int> triangleStart(vertexCount + 1);
+    std::vector<unsigned int> vertexTriangles;
+    std::vector<Collapse> collapses;
+    std::vector<uint8_t> touched(vertexCount);
+    std::vector<unsigned int> remap(vertexCount);
+    size_t targetTriangles = targetIndexCount / 3;
+
+    while (result.size() / 3 > targetTriangles) {
+        size_t triangleCount = result.size() / 3;
+
+        // triangles around each vertex, counted then filled in place
+        std::fill(triangleStart.begin(), triangleStart.end(), 0);
+        for (unsigned int index : result) triangleStart[index + 1]++;
+        for (size_t v = 0; v < vertexCount; v++) triangleStart[v + 1] += triangleStart[v];
+        vertexTriangles.resize(result.size());
+        std::vector<unsigned int> fill(triangleStart.begin(), triangleStart.end() - 1);
+        for (size_t t = 0; t < triangleCount; t++) {
+            for (int corner = 0; corner < 3; corner++) {
+                vertexTriangles[fill[result[3 * t + corner]]++] = (unsigned int)t;
+            }
+        }
+
+        collapses.clear();
+        for (size_t t = 0; t < triangleCount; t++) {
+            for (int corner = 0; corner < 3; corner++) {
+                unsigned int a = result[3 * t + corner];
+                unsigned int b = result[3 * t + (corner + 1) % 3];
+                if (!locked[a]) collapses.push_back(Collapse{ a, b, quadrics[a].error(positions[b]) });
+                if (!locked[b]) collapses.push_back(Collapse{ b, a, quadrics[b].error(positions[a]) });
+            }
+        }
+        if (collapses.empty()) break;
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) {
+            if (x.cost != y.cost) return x.cost < y.cost;
+            return x.from != y.from ? x.from < y.from : x.to < y.to;
+        });
+
+        // moving from onto to, would any triangle that keeps its area turn over
+        auto foldsOver = [&](unsigned int from, unsigned int to) {
+            for (unsigned int k = triangleStart[from]; k < triangleStart[from + 1]; k++) {
+                const unsigned int* triangle = &result[3 * (size_t)vertexTriangles[k]];
+                if (triangle[0] == to || triangle[1] == to || triangle[2] == to) continue; // collapses away
+                glm::dvec3 corners[3], moved[3];
+                for (int corner = 0; corner < 3; corner++) {
+                    corners[corner] = positions[triangle[corner]];
+                    moved[corner] = triangle[corner] == from ? positions[to] : corners[corner];
+                }
+                glm::dvec3 before = triangleNormal(corners[0], corners[1], corners[2]);
+                glm::dvec3 after = triangleNormal(moved[0], moved[1], moved[2]);
+                double afterLength = glm::length(after);
+                if (afterLength == 0.0) return true;
+                if (glm::dot(before, after) < 0.25 * glm::length(before) * afterLength) return true;
+            }
+            return false;
+        };
+
+        // a collapse removes the two triangles on its edge, only take about as many as needed
+        size_t trianglesToRemove = triangleCount - targetTriangles;
+        size_t removed = 0;
+        std::fill(touched.begin(), touched.end(), 0);
+        for (size_t v = 0; v < vertexCount; v++) remap[v] = (unsigned int)v;
+
+        for (const Collapse& collapse : collapses) {
+            if (removed >= trianglesToRemove) break;
+            if (touched[collapse.from] || touched[collapse.to]) continue;
+            if (foldsOver(collapse.from, collapse.to)) continue;
+
+            remap[collapse.from] = collapse.to;
+            touched[collapse.from] = 1;
+            touched[collapse.to] = 1;
+            quadrics[collapse.to].add(quadrics[collapse.from]);
+            maxError = std::max(maxError, collapse.cost);
+            for (unsigned int k = triangleStart[collapse.from]; k < triangleStart[collapse.from + 1]; k++) {
+                const unsigned int* triangle = &result[3 * (size_t)vertexTriangles[k]];
+                if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to) removed++;
+            }
+        }
+        if (removed == 0) break;
+
+        size_t kept = 0;
+        for (size_t t = 0; t < triangleCount; t++) {
+            unsigned int a = remap[result[3 * t]], b = remap[result[3 * t + 1]], c = remap[result[3 * t + 2]];
+            if (a == b || b == c || a == c) continue;
+            result[kept++] = a;
+            result[kept++] = b;
+            result[kept++] = c;
+        }
+        result.resize(kept);
+    }
+
+    if (error) *error = (float)maxError;
+    return result;
+}
+
+
+void MeshSimplifier::generateLODs(ImportedMesh& mesh, bool optimizeLevels) {
+    mesh.lods.clear();
+    mesh.lods.push_back(MeshLOD{ 0, (uint32_t)mesh.indices.size(), 0.0f });
+    if (!mesh.flags.hasPositions || mesh.indices.size() % 3 != 0 || mesh.indices.size() / 3 < MIN_LOD_TRIANGLES) return;
+
+    std::vector<unsigned int> previous = mesh.indices;
+    float error = 0.0f;
+    while (mesh.lods.size() < MAX_MESH_LODS) {
+        size_t targetIndexCount = (size_t)((float)(previous.size() / 3) * LOD_REDUCTION) * 3;
+        float levelError = 0.0f;
+        std::vector<unsigned int> level = simplify(mesh.vertices, previous, targetIndexCount, &levelError);
+        if (level.empty() || (float)level.size() > (float)previous.size() * MIN_LOD_GAIN) break;
+        if (optimizeLevels) MeshOptimizer::optimizeVertexCache(level, mesh.vertices.size());
+
+        // each level is measured against the one it came from, their sum bounds the distance to the full mesh
+        error += levelError;
+        mesh.lods.push_back(MeshLOD{ (uint32_t)mesh.indices.size(), (uint32_t)level.size(), error });
+        mesh.indices.insert(mesh.indices.end(), level.begin(), level.end());
+        if (level.size() / 3 < MIN_LOD_TRIANGLES) break;
+        previous = std::move(level);
+    }
+}
@@ -0,0 +1,40 @@
+// DESCRIPTION
+/*
+MeshSimplifier builds the level of detail chain of an imported mesh: index buffers with fewer
+triangles over the same vertices, so every level shares the mesh's vertex buffer and switching
+levels only draws a different range of the index buffer (see MeshLOD).
+
+simplify() is quadric error edge collapse (Garland, Heckbert 1997) limited to half-edge collapses:
+a vertex always moves onto a neighbour, no vertex is created. Each vertex sums the planes of its
+triangles weighted by area, and moving it costs the mean distance to those planes at the new
+position. Collapses run in passes. Every edge is costed, the list sorted and the cheapest taken,
+each vertex at most once per pass and never when a triangle would fold over.
+
+Vertices on an open border or an attribute seam (several vertices at one position, e.g. where UVs
+split) never move, so open meshes keep their outline and seams stay closed. Meshes with many seams
+reduce less because of it.
+
+generateLODs() runs after MeshOptimizer. It halves the triangles per level, each level simplified
+from the one before, and stops once a level gets too small or no longer shrinks enough. The levels
+are appended to the mesh's index buffer, so nothing after it may reorder or weld vertices.
+*/
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "ImportedModel.hpp"
+
+struct MeshSimplifier {
+    static constexpr size_t MIN_LOD_TRIANGLES = 128; // meshes or levels under this many triangles aren't reduced further
+    static constexpr float LOD_REDUCTION = 0.5f;     // share of the previous level's triangles a level aims for
+    static constexpr float MIN_LOD_GAIN = 0.8f;      // a level keeping more than this share ends the chain
+
+    // at most targetIndexCount indices unless borders and seams stop it first. error receives the
+    // largest distance a collapse moved the surface, in model units
+    static std::vector<unsigned int> simplify(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+                                                size_t targetIndexCount, float* error = nullptr);
+
+    // fills mesh.lods, level 0 is the indices as they are. optimizeLevels cache-orders every reduced level
+    static void generateLODs(ImportedMesh& mesh, bool optimizeLevels);
+};
@@ -1,25 +1,29 @@
 #include "Model.hpp"
 
+#include <algorithm>
 #include <iostream>
 
 
 Model::Model(const unsigned int ID, std::string model_path, ModelType type)
     : ID(ID), model_path(model_path), type(type) {
         instanceData.emplace_back(glm::vec3(0.0f, 0.0f, 0.0f)); //instace #1 value
+        gpuInstanceData.push_back(packInstance(instanceData.back()));
     }
 
 
-void Model::drawMesh(unsigned int meshID) {
+void Model::drawMesh(unsigned int meshID, GLStateCache* stateCache, unsigned int lod) {
     if (meshID >= meshes.size()) return;
     MeshA* mesh = &meshes[meshID];
-    // mesh->setInstanceVBO(modelInstanceCount, instanceData);
-    mesh->bind(instanceData);
+    mesh->bind(gpuInstanceData, stateCache);
 
+    const MeshLOD& range = mesh->getLOD(lod);
+    size_t indexSize = mesh->getIndexType() == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(unsigned int);
+    const void* offset = (const void*)(uintptr_t)(range.firstIndex * indexSize);
     if (modelInstanceCount > 1) {
-        glDrawElementsInstanced(GL_TRIANGLES, mesh->indices.size(), GL_UNSIGNED_INT, 0, modelInstanceCount);
+        glDrawElementsInstanced(GL_TRIANGLES, range.indexCount, mesh->getIndexType(), offset, modelInstanceCount);
     }
     else {
-        glDrawElements(GL_TRIANGLES, mesh->indices.size(), GL_UNSIGNED_INT, 0);
+        glDrawElements(GL_TRIANGLES, range.indexCount, mesh->getIndexType(), offset);
     }
 }
 
@@ -71,7 +75,8 @@ bool Model::addMeshByData(std::vector<float> raw_vertices, std::vector<unsigned
         vertices.push_back(vertex);
     }
 
-    meshes.emplace_back(MeshA(nextMeshIdx, vertices, indices, hasPos, hasNorm, hasUV));
+    meshes.emplace_back(nextMeshIdx, std::move(vertices), std::move(indices), hasPos, hasNorm, hasUV);
+    meshes.back().setKeepCPUData(meshRetention == MeshRetention::KeepCPUCopy);
     meshInstances.emplace_back(nextMeshIdx, UINT_MAX);
 
     status.meshes = ModelState::Building;
@@ -80,8 +85,9 @@ bool Model::addMeshByData(std::vector<float> raw_vertices, std::vector<unsigned
 }
 
 
-void Model::addMeshByAssimp(std::vector<Vertex> vertices, std::vector<unsigned int> indices, bool hasPos, bool hasNorms, bool hasUVs) {
-    meshes.push_back(MeshA(nextMeshIdx, vertices, indices, hasPos, hasNorms, hasUVs));
+void Model::addMeshByAssimp(std::vector<Vertex> vertices, std::vector<unsigned int> indices, bool hasPos, bool hasNorms, bool hasUVs, std::vector<MeshLOD> lods) {
+    meshes.emplace_back(nextMeshIdx, std::move(vertices), std::move(indices), hasPos, hasNorms, hasUVs, std::move(lods));
+    meshes.back().setKeepCPUData(meshRetention == MeshRetention::KeepCPUCopy);
     meshInstances.emplace_back(nextMeshIdx, UINT_MAX);
     
     // if (allMaterialReferences.contains(0)) {
@@ -96,6 +102,38 @@ void Model::addMeshByAssimp(std::vector<Vertex> vertices, std::vector<unsigned i
 }
 
 
+void Model::addMeshByMapping(std::shared_ptr<const MappedFile> source, const unsigned char* vertices, const VertexLayout& layout, 
+    size_t vertexCount, const void* indices, size_t indexCount, GLenum indexType, MeshProperties flags, const MeshBounds& bounds, std::vector<MeshLOD> lods) {
+    meshes.emplace_back(nextMeshIdx, std::move(source), vertices, layout, vertexCount, indices, indexCount, indexType, flags, bounds, std::move(lods));
+    meshes.back().setKeepCPUData(meshRetention == MeshRetention::KeepCPUCopy);
+    meshInstances.emplace_back(nextMeshIdx, UINT_MAX);
+
+    status.meshes = ModelState::Building;
+    nextMeshIdx++;
+}
+
+
+bool Model::restoreMeshData(unsigned int meshIdx, std::vector<Vertex> vertices, std::vector<unsigned int> indices) {
+    if (meshIdx >= meshes.size()) return false;
+    return meshes[meshIdx].restoreCPUData(std::move(vertices), std::move(indices));
+}
+
+
+bool Model::restoreMeshData(unsigned int meshIdx, std::shared_ptr<const MappedFile> source, const unsigned char* vertices, const VertexLayout& layout, 
+    size_t vertexCount, const void* indices, size_t indexCount, GLenum indexType) {
+    if (meshIdx >= meshes.size()) return false;
+    return meshes[meshIdx].restoreCPUData(std::move(source), vertices, layout, vertexCount, indices, indexCount, indexType);
+}
+
+
+bool Model::ensureMeshData() {
+    bool missing = std::any_of(meshes.begin(), meshes.end(), [](const MeshA& mesh) { return !mesh.hasCPUData(); });
+    if (!missing) return true;
+    if (!meshDataSource || !meshDataSource(*this)) return false;
+    return std::all_of(meshes.begin(), meshes.end(), [](const MeshA& mesh) { return mesh.hasCPUData(); });
+}
+
+
 // -----TRANSLATIONS
 void Model::translate(glm::vec3 vector) {
     position += vector;
@@ -162,11 +200,23 @@ void Model::setRotation(glm::vec3 rotation) {
 
 
 void Model::setInstancePosition(unsigned int instanceNum, glm::vec3 position) {
-    if (instanceNum > modelInstanceCount) return;
+    if (instanceNum >= modelInstanceCount) return;
     
-    instanceData[instanceNum].pos = position;
+    InstanceData instance = instanceData[instanceNum];
+    instance.pos = position;
+    setInstance(instanceNum, instance);
+}
+
+
+void Model::setInstance(unsigned int instanceNum, const InstanceData& instance) {
+    if (instanceNum >= modelInstanceCount) return;
+
+    instanceData[instanceNum] = instance;
+    gpuInstanceData[instanceNum] = packInstance(instance);
+    worldBoundsDirty = true;
+    instanceGenerator.type = InstanceGeneratorType::None;
     for (MeshA& mesh : meshes) {
-        mesh.updateInstanceData(instanceData);
+        mesh.updateInstanceData(gpuInstanceData, instanceNum, 1);
     }
 }
 
@@ -176,26 +226,20 @@ void Model::setInstanceCount(unsigned int newInstanceCount) {
 
     if (newInstanceCount < 1) {
         newInstanceCount = 1;
-    } else if (newInstanceCount > 100) {
-        newInstanceCount = 100;
+    } else if (newInstanceCount > MAX_INSTANCES) {
+        newInstanceCount = MAX_INSTANCES;
     }
 
     if (newInstanceCount == modelInstanceCount) return; 
 
-    if (newInstanceCount > modelInstanceCount) {
-        for (int i = modelInstanceCount; i < newInstanceCount; i++) {
-            instanceData.emplace_back(glm::vec3(1.0f * i, 0.0f, 0.0f));
-        }
-    }
-    else { //new count is less than model
-        for (int i = modelInstanceCount - 1; i > newInstanceCount; i--) {
-            instanceData.erase(instanceData.begin() + i);
-        }
+    instanceData.reserve(newInstanceCount);
+    for (unsigned int i = modelInstanceCount; i < newInstanceCount; i++) {
+        instanceData.emplace_back(glm::vec3(1.0f * i, 0.0f, 0.0f));
     }
+    instanceData.resize(newInstanceCount); // only shrinks, growth happened above
     modelInstanceCount = newInstanceCount;
-    for (MeshA& mesh : meshes) {
-        mesh.resizeInstanceVBO(instanceData);
-    }
+    instanceGenerator.type = InstanceGeneratorType::None;
+    uploadAllInstances();
 }
 
 
@@ -204,6 +248,18 @@ void Model::setName(std::string name) {
 }
 
 
+void Model::uploadAllInstances() {
+    gpuInstanceData.resize(instanceData.size());
+    for (size_t i = 0; i < instanceData.size(); i++) {
+        gpuInstanceData[i] = packInstance(instanceData[i]);
+    }
+    worldBoundsDirty = true;
+    for (MeshA& mesh : meshes) {
+        mesh.resizeInstanceVBO(gpuInstanceData);
+    }
+}
+
+
 void Model::setMeshMaterial(unsigned int meshIdx, unsigned int materialID, bool isMatValid) {
     if (meshIdx >= meshInstances.size()) {
         return;
@@ -246,6 +302,19 @@ void Model::setMeshMaterial(unsigned int meshIdx, unsigned int materialID, bool
 }
 
 
+void Model::setMeshRetention(MeshRetention retention) {
+    meshRetention = retention;
+    for (MeshA& mesh : meshes) {
+        mesh.setKeepCPUData(retention == MeshRetention::KeepCPUCopy);
+    }
+}
+
+
+void Model::setMeshDataSource(MeshDataSource source) {
+    meshDataSource = std::move(source);
+}
+
+
 void Model::setModelMaterial(unsigned int materialID, bool isMatValid) {
     allMaterialReferences.clear();
 
@@ -274,6 +343,12 @@ bool Model::finalizeMeshes() {
         return false;
     }
     status.meshes = ModelState::Ready;
+
+    localBounds = MeshBounds();
+    for (const MeshA& mesh : meshes) {
+        localBounds.expand(mesh.getBounds());
+    }
+    worldBoundsDirty = true;
     return true;
 }
 
@@ -289,9 +364,51 @@ void Model::calcModelM() {
     model *= glm::mat4_cast(orientation); 
     model = glm::scale(model, scale);
     this->modelM = model;
+    worldBoundsDirty = true;
+}
+
+
+// Matches instance.vert: world = model * (basis * p) + instance position. A single instance gets
+// each mesh's box transformed exactly. With more, every instance is taken as the bounding sphere
+// of the whole model, and all meshes share the box around those spheres, O(instances) per rebuild
+// instead of O(instances * meshes).
+void Model::updateWorldBounds() {
+    worldBounds.assign(meshes.size(), MeshBounds());
+    glm::mat3 linear(modelM);
+    glm::vec3 translation(modelM[3]);
+    // for rotation * scale matrices the longest column is the largest stretch
+    auto maxStretch = [](const glm::mat3& m) {
+        return std::max({ glm::length(m[0]), glm::length(m[1]), glm::length(m[2]) });
+    };
+
+    float instanceStretch = 0.0f;
+    for (const InstanceGPUData& instance : gpuInstanceData) {
+        instanceStretch = std::max(instanceStretch, maxStretch(instance.basis));
+    }
+    worldScale = maxStretch(linear) * instanceStretch;
+
+    if (gpuInstanceData.size() == 1) {
+        const InstanceGPUData& instance = gpuInstanceData[0];
+        for (size_t i = 0; i < meshes.size(); i++) {
+            worldBounds[i] = meshes[i].getBounds().transformed(linear * instance.basis, translation + instance.position);
+        }
+    }
+    else if (!localBounds.isEmpty()) {
+        glm::vec3 center = localBounds.center();
+        float radius = localBounds.radius() * maxStretch(linear);
+
+        MeshBounds combined;
+        for (const InstanceGPUData& instance : gpuInstanceData) {
+            glm::vec3 instanceCenter = linear * (instance.basis * center) + translation + instance.position;
+            combined.expand(instanceCenter, radius * maxStretch(instance.basis));
+        }
+        std::fill(worldBounds.begin(), worldBounds.end(), combined);
+    }
+    worldBoundsDirty = false;
 }
 
 void Model::loadInstanceData(std::vector<InstanceData> data) {
+    instanceGenerator.type = InstanceGeneratorType::None;
     instanceData = std::move(data);
     modelInstanceCount = static_cast<unsigned int>(instanceData.size());
 
@@ -299,10 +416,19 @@ void Model::loadInstanceData(std::vector<InstanceData> data) {
         instanceData.emplace_back(glm::vec3(0.0f, 0.0f, 0.0f));
         modelInstanceCount = 1;
     }
-
-    for (MeshA& mesh : meshes) {
-        mesh.resizeInstanceVBO(instanceData);
+    else if (modelInstanceCount > MAX_INSTANCES) {
+        instanceData.resize(MAX_INSTANCES);
+        modelInstanceCount = MAX_INSTANCES;
     }
+
+    uploadAllInstances();
+}
+
+
+// the generator is kept so the project saves its parameters instead of every instance
+void Model::loadGeneratedInstances(std::vector<InstanceData> data, const InstanceGeneratorParams& generator) {
+    loadInstanceData(std::move(data));
+    instanceGenerator = generator;
 }
 
 
@@ -325,6 +451,8 @@ glm::vec3 Model::getScale()       const {return scale;}
 glm::vec3 Model::getRotation()    const {return rotation;}
 unsigned int Model::getInstanceCount() const { return modelInstanceCount; }
 const std::vector<InstanceData>& Model::getInstanceData() const { return instanceData; }
+const std::vector<InstanceGPUData>& Model::getGPUInstanceData() const { return gpuInstanceData; }
+const InstanceGeneratorParams& Model::getInstanceGenerator() const { return instanceGenerator; }
 const std::vector<MeshInstance>& Model::getMeshInstances() const { return meshInstances; }
 std::unordered_set<unsigned int>& Model::getInvalidMaterialIDs() { return invalidMaterialIDs; }
 const std::unordered_map<unsigned int, unsigned int>& Model::getAllMaterialReferences() const { return allMaterialReferences; }
@@ -332,6 +460,73 @@ const std::unordered_map<unsigned int, unsigned int>& Model::getAllMaterialRefer
 
 unsigned int Model::getNumberOfMeshes() { return meshes.size(); }
 
+std::vector<glm::vec3> Model::getMeshVertexPositions(unsigned int meshIdx) {
+    std::vector<glm::vec3> positions;
+    if (meshIdx >= meshes.size() || !ensureMeshData()) return positions;
+
+    const MeshA& mesh = meshes[meshIdx];
+    const VertexLayout& layout = mesh.getVertexLayout();
+    const unsigned char* vertices = mesh.getVertexData();
+    positions.reserve(mesh.getVertexCount());
+    for (size_t i = 0; i < mesh.getVertexCount(); i++) {
+        positions.push_back(layout.unpackPosition(vertices + i * layout.stride));
+    }
+    return positions;
+}
+
+MeshBounds Model::getMeshBounds(unsigned int meshIdx) const {
+    if (meshIdx >= meshes.size()) return MeshBounds();
+    return meshes[meshIdx].getBounds();
+}
+
+
+const MeshBounds& Model::getWorldBounds(unsigned int meshIdx) {
+    if (worldBoundsDirty || worldBounds.size() != meshes.size()) updateWorldBounds();
+    static const MeshBounds noBounds;
+    if (meshIdx >= worldBounds.size()) return noBounds;
+    return worldBounds[meshIdx];
+}
+
+
+float Model::getWorldScale() {
+    if (worldBoundsDirty || worldBounds.size() != meshes.size()) updateWorldBounds();
+    return worldScale;
+}
+
+
+const std::vector<MeshLOD>& Model::getMeshLODs(unsigned int meshIdx) const {
+    static const std::vector<MeshLOD> noLODs;
+    if (meshIdx >= meshes.size()) return noLODs;
+    return meshes[meshIdx].getLODs();
+}
+
+
+const MeshA* Model::getMesh(unsigned int meshIdx) const {
+    if (meshIdx >= meshes.size()) return nullptr;
+    return &meshes[meshIdx];
+}
+
+
+void Model::setLODOverride(int level) {
+    lodOverride = std::clamp(level, -1, (int)MAX_MESH_LODS - 1);
+}
+
+
+int Model::getLODOverride() const { return lodOverride; }
+
+
+MeshRetention Model::getMeshRetention() const { return meshRetention; }
+
+
+MeshMemory Model::getMemoryUsage() const {
+    MeshMemory memory;
+    for (const MeshA& mesh : meshes) {
+        memory += mesh.getMemoryUsage();
+    }
+    return memory;
+}
+
+
 std::vector<unsigned int> Model::getAllMaterialIDsPerMesh() {
 
     std::vector<unsigned int> allMaterialIDsPerMesh;
@@ -6,10 +6,14 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 #include <unordered_set>
+#include <functional>
 
 #include "MeshAssimp.hpp"
 #include "ModelStatus.hpp"
 #include "ModelType.hpp"
+#include "InstanceGenerator.hpp"
+
+class GLStateCache;
 
 struct MeshInstance {
     unsigned int meshIdx;
@@ -18,6 +22,10 @@ struct MeshInstance {
 
 class Model {
 public:
+    static constexpr unsigned int MAX_INSTANCES = 1u << 20; // sanity bound, ~64MB of instance VBO per mesh
+    // restores the CPU copies of released meshes through restoreMeshData, set by whoever built the meshes
+    using MeshDataSource = std::function<bool(Model& model)>;
+
     const unsigned int ID;
     const std::string model_path;
     const ModelType type;
@@ -25,9 +33,17 @@ public:
     Model(const unsigned int ID, std::string model_path, ModelType type);
     virtual ~Model() = default;
 
-    void drawMesh(unsigned int meshIdx);
+    void drawMesh(unsigned int meshIdx, GLStateCache* stateCache = nullptr, unsigned int lod = 0); // lod past the mesh's last level draws the last
     bool addMeshByData(std::vector<float> raw_vertices, std::vector<unsigned int> indices, bool hasPos, bool hasNorm, bool hasUV);
-    void addMeshByAssimp(std::vector<Vertex> vertices, std::vector<unsigned int> indices, bool hasPos, bool hasNorms, bool hasUVs);
+    void addMeshByAssimp(std::vector<Vertex> vertices, std::vector<unsigned int> indices, bool hasPos, bool hasNorms, bool hasUVs, std::vector<MeshLOD> lods = {});
+    void addMeshByMapping(std::shared_ptr<const MappedFile> source, const unsigned char* vertices, const VertexLayout& layout, 
+                            size_t vertexCount, const void* indices, size_t indexCount, GLenum indexType, MeshProperties flags, const MeshBounds& bounds,
+                            std::vector<MeshLOD> lods = {});
+    bool restoreMeshData(unsigned int meshIdx, std::vector<Vertex> vertices, std::vector<unsigned int> indices);
+    bool restoreMeshData(unsigned int meshIdx, std::shared_ptr<const MappedFile> source, const unsigned char* vertices, const VertexLayout& layout, 
+                            size_t vertexCount, const void* indices, size_t indexCount, GLenum indexType);
+    // true once every mesh has its CPU copy, reloading released ones through the data source
+    bool ensureMeshData();
     //unloadMesh
 
     void translate(glm::vec3 position);
@@ -39,10 +55,14 @@ public:
     void setRotation(float angle, glm::vec3 axis);
     void setRotation(glm::vec3 rotation);
     void setInstancePosition(unsigned int instanceNum, glm::vec3 position);
+    void setInstance(unsigned int instanceNum, const InstanceData& instance);
     void setInstanceCount(unsigned int newInstanceCount);
     void setName(std::string name);
     void setMeshMaterial(unsigned int meshIdx, unsigned int materialID, bool isMatValid);
     void setModelMaterial(unsigned int materialID, bool isMatValid);
+    void setMeshRetention(MeshRetention retention);
+    void setMeshDataSource(MeshDataSource source);
+    void setLODOverride(int level); // -1 lets the renderer pick by screen size, otherwise every mesh draws this level
     bool eraseMaterial(unsigned int materialID);
 
     // GETTERS
@@ -56,12 +76,24 @@ public:
     glm::vec3 getRotation() const;
     unsigned int getInstanceCount() const;
     const std::vector<InstanceData>& getInstanceData() const;
+    const std::vector<InstanceGPUData>& getGPUInstanceData() const; // what the instance VBOs hold
+    const InstanceGeneratorParams& getInstanceGenerator() const;
+    std::vector<glm::vec3> getMeshVertexPositions(unsigned int meshIdx); // may reload the mesh, see ensureMeshData
+    MeshBounds getMeshBounds(unsigned int meshIdx) const;
+    const MeshBounds& getWorldBounds(unsigned int meshIdx); // model matrix and instances applied, see updateWorldBounds
+    float getWorldScale(); // largest stretch of a model unit in world space, over every instance
+    const std::vector<MeshLOD>& getMeshLODs(unsigned int meshIdx) const;
+    const MeshA* getMesh(unsigned int meshIdx) const; // nullptr past the last mesh
+    int getLODOverride() const;
+    MeshRetention getMeshRetention() const;
+    MeshMemory getMemoryUsage() const;
     const std::vector<MeshInstance>& getMeshInstances() const;
     std::unordered_set<unsigned int>& getInvalidMaterialIDs();
     const std::unordered_map<unsigned int, unsigned int>& getAllMaterialReferences() const;
 
     //LOADING
     void loadInstanceData(std::vector<InstanceData> instanceData);
+    void loadGeneratedInstances(std::vector<InstanceData> instanceData, const InstanceGeneratorParams& generator);
     void loadMeshMaterialIDs(std::vector<unsigned int> meshMaterialIDs);
     std::vector<unsigned int> getAllMaterialIDsPerMesh();
     bool finalizeMeshes();
@@ -74,15 +106,25 @@ public:
 
 private:
     void rebuildMaterialReferences();
+    void uploadAllInstances();
 
     std::string name = "model";
     unsigned int nextMeshIdx = 0;
     std::vector<MeshA> meshes;
+    MeshRetention meshRetention = MeshRetention::ReleaseAfterUpload;
+    MeshBounds localBounds;               // every mesh together, set by finalizeMeshes
+    std::vector<MeshBounds> worldBounds;  // per mesh, rebuilt lazily after a transform, instance or mesh change
+    bool worldBoundsDirty = true;
+    float worldScale = 1.0f;              // rebuilt with worldBounds
+    int lodOverride = -1;
+    MeshDataSource meshDataSource;
     std::unordered_map<unsigned int, unsigned int> allMaterialReferences; //[material id] <-> [# of meshes using material]
     std::unordered_set<unsigned int> invalidMaterialIDs; // so the modelcache can tell if the model is ready to be rendered
     std::vector<MeshInstance> meshInstances;
     unsigned int modelInstanceCount = 1;
     std::vector<InstanceData> instanceData;
+    std::vector<InstanceGPUData> gpuInstanceData; // packInstance(instanceData[i]), shared by every mesh's VBO
+    InstanceGeneratorParams instanceGenerator;    // type None once instances are edited by hand
     
 
     ModelStatus status;
@@ -93,4 +135,5 @@ private:
     glm::quat orientation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
 
     void calcModelM();
+    void updateWorldBounds();
 };
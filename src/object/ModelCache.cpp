@@ -184,6 +184,36 @@ void ModelCache::changeMeshMaterial(unsigned int modelID, unsigned int meshIdx,
 }
 
 
+bool ModelCache::generateInstances(unsigned int modelID, const InstanceGeneratorParams& params) {
+    Model* foundModel = getModel(modelID);
+    if (foundModel == nullptr) {
+        loggerPtr->addLog(LogLevel::LOG_ERROR, "MODELCACHE::generateInstances()", "model not found from ID " + std::to_string(modelID));
+        return false;
+    }
+
+    std::vector<glm::vec3> vertexPositions;
+    if (params.type == InstanceGeneratorType::MeshVertices) {
+        Model* sourceModel = getModel(params.sourceModelID);
+        if (sourceModel == nullptr || params.sourceMeshIdx >= sourceModel->getNumberOfMeshes()) {
+            loggerPtr->addLog(LogLevel::LOG_ERROR, "MODELCACHE::generateInstances()", 
+                "source mesh " + std::to_string(params.sourceMeshIdx) + " not found on model " + std::to_string(params.sourceModelID));
+            return false;
+        }
+        vertexPositions = sourceModel->getMeshVertexPositions(params.sourceMeshIdx);
+    }
+
+    size_t count = InstanceGenerator::countFor(params, &vertexPositions);
+    if (count == 0 || count > Model::MAX_INSTANCES) {
+        loggerPtr->addLog(LogLevel::LOG_ERROR, "MODELCACHE::generateInstances()", 
+            "generator would produce " + std::to_string(count) + " instances, expected 1 to " + std::to_string(Model::MAX_INSTANCES));
+        return false;
+    }
+
+    foundModel->loadGeneratedInstances(InstanceGenerator::generate(params, &vertexPositions), params);
+    return true;
+}
+
+
 void ModelCache::changeModelMaterial(unsigned int modelID, unsigned int materialID, bool isMatValid) {
     Model* foundModel = getModel(modelID);
     if (foundModel == nullptr) {
@@ -236,6 +266,8 @@ void ModelCache::addPresetMesh(unsigned int modelID, ModelType type) {
 
     MeshData presetData = presetsPtr->getPresetMesh(preset);
     Model* presetModel = getModel(modelID);
+    // a few hundred bytes, not worth a data source to reload them
+    presetModel->setMeshRetention(MeshRetention::KeepCPUCopy);
     presetModel->addMeshByData(presetData.verts, presetData.indices, true, false, true);
 }
 
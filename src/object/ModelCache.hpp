@@ -22,6 +22,7 @@ public:
     bool changeModelName(unsigned int modelID, std::string name);
     void changeMeshMaterial(unsigned int modelID, unsigned int meshIdx, unsigned int materialID, bool isMatValid);
     void changeModelMaterial(unsigned int modelID, unsigned int materialID, bool isMatValid);
+    bool generateInstances(unsigned int modelID, const InstanceGeneratorParams& params);
     void deleteModel(unsigned int modelID);
     void toggleAsSkybox(unsigned int modelID);
     
@@ -0,0 +1,128 @@
+#include "PrimitiveStore.hpp"
+
+
+PrimitiveStore::Handle PrimitiveStore::add(unsigned int modelID, unsigned int meshIdx, unsigned int materialID, QueueType queue) {
+    uint32_t index = size();
+    modelIDs.push_back(modelID);
+    meshIdxs.push_back(meshIdx);
+    materialIDs.push_back(materialID);
+    depths.push_back(0.0f);
+    lods.push_back(0);
+    queueTypes.push_back(queue);
+    valid.push_back(0);
+    queuePositions.push_back(NO_INDEX);
+
+    uint32_t slot;
+    if (freeSlot != NO_INDEX) {
+        slot = freeSlot;
+        freeSlot = slots[slot].index;
+    }
+    else {
+        slot = (uint32_t)slots.size();
+        slots.push_back(Slot{});
+    }
+    slots[slot].index = index;
+    slotOf.push_back(slot);
+
+    enterQueue(index, queue);
+    return Handle{ slot, slots[slot].generation };
+}
+
+
+bool PrimitiveStore::remove(Handle handle) {
+    uint32_t index = indexOf(handle);
+    if (index == NO_INDEX) return false;
+    removeAt(index);
+    return true;
+}
+
+
+void PrimitiveStore::clear() {
+    while (size() > 0) {
+        removeAt(size() - 1);
+    }
+}
+
+
+bool PrimitiveStore::contains(Handle handle) const {
+    return indexOf(handle) != NO_INDEX;
+}
+
+
+uint32_t PrimitiveStore::indexOf(Handle handle) const {
+    if (handle.slot >= slots.size()) return NO_INDEX;
+    const Slot& slot = slots[handle.slot];
+    if (slot.generation != handle.generation || slot.index >= size()) return NO_INDEX;
+    if (slotOf[slot.index] != handle.slot) return NO_INDEX; // slot is on the free list
+    return slot.index;
+}
+
+
+PrimitiveStore::Handle PrimitiveStore::handleAt(uint32_t index) const {
+    if (index >= size()) return Handle{};
+    uint32_t slot = slotOf[index];
+    return Handle{ slot, slots[slot].generation };
+}
+
+
+void PrimitiveStore::moveToQueue(uint32_t index, QueueType queue) {
+    if (index >= size() || queueTypes[index] == queue) return;
+    leaveQueue(index);
+    queueTypes[index] = queue;
+    enterQueue(index, queue);
+}
+
+
+void PrimitiveStore::enterQueue(uint32_t index, QueueType queue) {
+    queuePositions[index] = (uint32_t)queues[queue].size();
+    queues[queue].push_back(index);
+}
+
+
+void PrimitiveStore::leaveQueue(uint32_t index) {
+    std::vector<uint32_t>& members = queues[queueTypes[index]];
+    uint32_t pos = queuePositions[index];
+    uint32_t lastMember = members.back();
+    members[pos] = lastMember;
+    queuePositions[lastMember] = pos;
+    members.pop_back();
+    queuePositions[index] = NO_INDEX;
+}
+
+
+void PrimitiveStore::removeAt(uint32_t index) {
+    leaveQueue(index);
+
+    // retire the slot, bumping the generation invalidates every outstanding handle to it
+    uint32_t slot = slotOf[index];
+    slots[slot].generation++;
+    slots[slot].index = freeSlot;
+    freeSlot = slot;
+
+    uint32_t last = size() - 1;
+    if (index != last) {
+        modelIDs[index]    = modelIDs[last];
+        meshIdxs[index]    = meshIdxs[last];
+        materialIDs[index] = materialIDs[last];
+        depths[index]      = depths[last];
+        lods[index]        = lods[last];
+        queueTypes[index]  = queueTypes[last];
+        valid[index]       = valid[last];
+        queuePositions[index] = queuePositions[last];
+        slotOf[index]      = slotOf[last];
+
+        // the moved primitive keeps its slot and queue position, only its dense index changed
+        slots[slotOf[index]].index = index;
+        queues[queueTypes[index]][queuePositions[index]] = index;
+    }
+
+    modelIDs.pop_back();
+    meshIdxs.pop_back();
+    materialIDs.pop_back();
+    depths.pop_back();
+    lods.pop_back();
+    queueTypes.pop_back();
+    valid.pop_back();
+    queuePositions.pop_back();
+    slotOf.pop_back();
+}
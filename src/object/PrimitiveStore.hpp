@@ -0,0 +1,98 @@
+// DESCRIPTION
+/*
+PrimitiveStore holds the Renderer's primitives (one per drawn mesh instance) as parallel arrays
+indexed by a dense index, so the per-frame loops walk contiguous memory instead of a hash map.
+
+Removing a primitive moves the last one into its place (swap-and-pop), which changes that primitive's
+dense index. Anything that has to refer to a primitive across removals keeps a Handle instead:
+handles go through a small slot table and carry a generation, so a handle to a removed primitive is
+detected rather than silently pointing at whichever primitive reused the space.
+
+Each queue is a list of dense indices. Every primitive knows its position in its queue, so leaving a
+queue is O(1) as well. Queue order is only meaningful after sortQueue.
+*/
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <limits>
+
+class PrimitiveStore {
+public:
+    enum QueueType : uint8_t {
+        Opaque,
+        Cutout,
+        Translucent,
+        Skybox,
+        QueueCount
+    };
+
+    struct Handle {
+        uint32_t slot = std::numeric_limits<uint32_t>::max();
+        uint32_t generation = 0;
+    };
+
+    static constexpr uint32_t NO_INDEX = std::numeric_limits<uint32_t>::max();
+
+    Handle add(unsigned int modelID, unsigned int meshIdx, unsigned int materialID, QueueType queue);
+    bool remove(Handle handle);
+    void clear();
+
+    bool contains(Handle handle) const;
+    uint32_t indexOf(Handle handle) const; // NO_INDEX if the handle is stale
+    Handle handleAt(uint32_t index) const;
+    uint32_t size() const { return (uint32_t)modelIDs.size(); }
+
+    unsigned int getModelID(uint32_t index) const { return modelIDs[index]; }
+    unsigned int getMeshIdx(uint32_t index) const { return meshIdxs[index]; }
+    unsigned int getMaterialID(uint32_t index) const { return materialIDs[index]; }
+    QueueType getQueueType(uint32_t index) const { return queueTypes[index]; }
+    float getDepth(uint32_t index) const { return depths[index]; }
+    uint8_t getLOD(uint32_t index) const { return lods[index]; }
+    bool isValid(uint32_t index) const { return valid[index] != 0; }
+
+    void setMaterialID(uint32_t index, unsigned int materialID) { materialIDs[index] = materialID; }
+    void setDepth(uint32_t index, float depth) { depths[index] = depth; }
+    void setLOD(uint32_t index, uint8_t lod) { lods[index] = lod; }
+    void setValid(uint32_t index, bool isValid) { valid[index] = isValid ? 1 : 0; }
+    void moveToQueue(uint32_t index, QueueType queue);
+
+    const std::vector<uint32_t>& getQueue(QueueType queue) const { return queues[queue]; }
+
+    // reorder a queue, compare receives two dense indices
+    template <typename Compare>
+    void sortQueue(QueueType queue, Compare compare) {
+        std::vector<uint32_t>& members = queues[queue];
+        std::sort(members.begin(), members.end(), compare);
+        for (uint32_t pos = 0; pos < members.size(); pos++) {
+            queuePositions[members[pos]] = pos;
+        }
+    }
+
+private:
+    struct Slot {
+        uint32_t index = NO_INDEX; // dense index while alive, next free slot while free
+        uint32_t generation = 0;
+    };
+
+    // dense, one entry per primitive
+    std::vector<unsigned int> modelIDs;
+    std::vector<unsigned int> meshIdxs;
+    std::vector<unsigned int> materialIDs;
+    std::vector<float> depths;
+    std::vector<uint8_t> lods;           // level of detail drawn last frame, see Renderer::selectLODs
+    std::vector<QueueType> queueTypes;
+    std::vector<uint8_t> valid;          // result of the last validation, see Renderer::validatePrimitive
+    std::vector<uint32_t> queuePositions;
+    std::vector<uint32_t> slotOf;        // dense index -> slot
+
+    std::vector<Slot> slots;
+    uint32_t freeSlot = NO_INDEX;
+    std::array<std::vector<uint32_t>, QueueCount> queues;
+
+    void enterQueue(uint32_t index, QueueType queue);
+    void leaveQueue(uint32_t index);
+    void removeAt(uint32_t index);
+};
@@ -8,19 +8,83 @@
 #include "core/ShaderRegistry.hpp"
 #include "core/UniformRegistry.hpp"
 #include "core/InspectorEngine.hpp"
+#include "engine/SceneBlock.hpp"
+#include "engine/ShaderVariant.hpp"
+#include "application/AppSettings.hpp"
+#include "MeshLOD.hpp"
 
 #include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <chrono>
+#include <numeric>
 
 #include <iostream>
 
 
+namespace {
+    // VISIBILITY, the values of Renderer::visible
+    constexpr uint8_t OUTSIDE_FRUSTUM = 0;
+    constexpr uint8_t VISIBLE         = 1;
+    constexpr uint8_t OCCLUDED        = 2;
+
+    // stable per primitive for as long as it exists, keys its occlusion query and arena entry
+    uint64_t primitiveKey(PrimitiveStore::Handle handle) {
+        return ((uint64_t)handle.slot << 32) | handle.generation;
+    }
+
+    // orphans the old store, like MeshA::resizeInstanceVBO, growing it geometrically
+    void uploadStream(GLenum target, GLuint buffer, size_t& capacity, const void* data, size_t bytes) {
+        glBindBuffer(target, buffer);
+        if (bytes > capacity) capacity = std::max(bytes, capacity * 2);
+        glBufferData(target, (GLsizeiptr)capacity, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(target, 0, (GLsizeiptr)bytes, data);
+    }
+
+    // what a draw asks of its program's variants, see engine/ShaderVariant.hpp
+    uint32_t variantFeaturesFor(Material& material, const VertexLayout& layout, unsigned int instanceCount) {
+        uint32_t features = 0;
+        switch (material.getMaterialType()) {
+            case MaterialType::Cutout:      features |= ShaderVariant::CUTOUT;      break;
+            case MaterialType::Translucent: features |= ShaderVariant::TRANSLUCENT; break;
+            default: break;
+        }
+        if (instanceCount > 1) features |= ShaderVariant::INSTANCED;
+        if (layout.has(VertexLayout::Normal)) features |= ShaderVariant::NORMALS;
+        if (layout.has(VertexLayout::UV)) features |= ShaderVariant::UVS;
+        if (layout.has(VertexLayout::Color)) features |= ShaderVariant::COLORS;
+        return ShaderVariant::withTextureCount(features, material.getMaterialTextureIDs().size());
+    }
+}
+
+
 Renderer::Renderer() {}
 
 
+Renderer::~Renderer() {}
+
+
+void Renderer::shutdown() {
+    occlusion.shutdown();
+    if (sceneUBO != 0) {
+        glDeleteBuffers(1, &sceneUBO);
+        sceneUBO = 0;
+    }
+    if (batchingSupported) {
+        arena.shutdown();
+        GLuint buffers[] = { indirectBuffer, drawBlockBuffer, singleDrawBuffer, instanceStream };
+        glDeleteBuffers(4, buffers);
+        indirectBuffer = drawBlockBuffer = singleDrawBuffer = instanceStream = 0;
+        indirectCapacity = drawBlockCapacity = instanceStreamCapacity = 0;
+        batchingSupported = false;
+    }
+}
+
+
 bool Renderer::initialize(
     Logger* _loggerPtr, EventDispatcher* _eventsPtr, ModelCache* _modelCachePtr, 
     MaterialCache* _materialCachePtr, TextureCache* _textureCachePtr, ShaderRegistry* _shaderRegPtr,
-    UniformRegistry* _uniformRegPtr, InspectorEngine* _inspectorEngPtr
+    UniformRegistry* _uniformRegPtr, InspectorEngine* _inspectorEngPtr, const AppSettings* _settingsPtr
 ) {
     loggerPtr        = _loggerPtr;
     eventsPtr        = _eventsPtr;
@@ -30,45 +94,52 @@ bool Renderer::initialize(
     shaderRegPtr     = _shaderRegPtr;
     uniformRegPtr    = _uniformRegPtr;
     inspectorEngPtr  = _inspectorEngPtr;
+    settingsPtr      = _settingsPtr;
+
+    // bound once for the lifetime of the renderer, programs that declare SceneBlock point at this binding
+    glGenBuffers(1, &sceneUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, sceneUBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(SceneBlockData), nullptr, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, SCENE_BLOCK_BINDING, sceneUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    occlusion.initialize(loggerPtr);
+
+    // without GL 4.6 every primitive takes the one draw per mesh path
+    batchingSupported = MeshArena::isSupported();
+    if (batchingSupported) {
+        glGenBuffers(1, &indirectBuffer);
+        glGenBuffers(1, &drawBlockBuffer);
+        glGenBuffers(1, &singleDrawBuffer);
+        glGenBuffers(1, &instanceStream);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, singleDrawBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(DrawBlockData), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        uploadStream(GL_ARRAY_BUFFER, instanceStream, instanceStreamCapacity, nullptr, 0);
+        glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storageAlignment);
+        arena.initialize(instanceStream);
+    }
+    else {
+        loggerPtr->addLog(LogLevel::INFO, "RENDERER::initialize()", "GL 4.6 not available, draws are not batched");
+    }
 
     eventsPtr->Subscribe(EventType::UploadToRenderer, [this](const EventPayload& payload) -> bool {
         if (const auto* data = std::get_if<UploadToRendererPayload>(&payload)) {
             
             Model* newModel = modelCachePtr->getModel(data->modelID);
-            for (const MeshInstance& meshInstance : newModel->getMeshInstances()) {
-                if (validateNextID() == false) {
-                    loggerPtr->addLog(LogLevel::LOG_ERROR, "RENDERER::Event", "failed to validate next primitive ID on model creation");
-                    break;
-                }
+            if (newModel == nullptr) {
+                loggerPtr->addLog(LogLevel::LOG_ERROR, "RENDERER::Event", "model not found on upload with ID " + std::to_string(data->modelID));
+                return true;
+            }
 
-                QueueType queueType;
-                if (data->isSkybox == true) {
-                    queueType = Skybox;
-                }
-                else {
-                    MaterialType materialType = materialCachePtr->getMaterial(meshInstance.materialID)->getMaterialType();
-                    switch (materialType) {
-                        case MaterialType::Opaque:      queueType = Opaque;      break;
-                        case MaterialType::Cutout:      queueType = Cutout;      break;
-                        case MaterialType::Translucent: queueType = Translucent; break;
-                    }   
-                }
-                
-                primitiveIDMap.emplace(
-                    nextPrimitiveID, 
-                    Primitive{
-                        .modelID = data->modelID, 
-                        .meshIdx = meshInstance.meshIdx, 
-                        .materialID = meshInstance.materialID, 
-                        .depth = 0,
-                        .queuetype = queueType
-                    });
-                
-                placeInQueue(nextPrimitiveID, queueType);
-
-                nextPrimitiveID++;
+            std::vector<PrimitiveStore::Handle>& handles = modelPrimitives[data->modelID];
+            for (const MeshInstance& meshInstance : newModel->getMeshInstances()) {
+                QueueType queueType = queueTypeFor(meshInstance.materialID, data->isSkybox);
+                PrimitiveStore::Handle handle = primitives.add(data->modelID, meshInstance.meshIdx, meshInstance.materialID, queueType);
+                validatePrimitive(primitives.indexOf(handle));
+                handles.push_back(handle);
             }
-            modelCachePtr->getModel(data->modelID)->getModelStatus().uploadedToRenderer = true;
+            newModel->getModelStatus().uploadedToRenderer = true;
             return true;
         }
         return false;
@@ -77,17 +148,17 @@ bool Renderer::initialize(
     eventsPtr->Subscribe(EventType::DeleteFromRenderer, [this](const EventPayload& payload) -> bool {
         if (const auto* data = std::get_if<DeleteFromRendererPayload>(&payload)) {
             
-            for (auto iter = primitiveIDMap.begin(); iter != primitiveIDMap.end(); ) {
-                if (iter->second.modelID == data->modelID) {
-                    removeFromQueue(iter->first, iter->second.queuetype);
-                    iter = primitiveIDMap.erase(iter);
-                }
-                else {
-                    iter++;
+            auto modelPair = modelPrimitives.find(data->modelID);
+            if (modelPair != modelPrimitives.end()) {
+                for (PrimitiveStore::Handle handle : modelPair->second) {
+                    if (batchingSupported) arena.release(primitiveKey(handle));
+                    primitives.remove(handle);
                 }
-            
+                modelPrimitives.erase(modelPair);
             }
-            modelCachePtr->getModel(data->modelID)->getModelStatus().uploadedToRenderer = false;
+
+            Model* foundModel = modelCachePtr->getModel(data->modelID);
+            if (foundModel != nullptr) foundModel->getModelStatus().uploadedToRenderer = false;
             return true;
         }
         return false;
@@ -96,23 +167,17 @@ bool Renderer::initialize(
     eventsPtr->Subscribe(EventType::MaterialTypeChange, [this](const EventPayload& payload) -> bool {
         if (const auto* data = std::get_if<MaterialTypeChangePayload>(&payload)) {
 
-            for (auto iter = primitiveIDMap.begin(); iter != primitiveIDMap.end(); ) {
-                if (iter->second.materialID == data->materialID) {
-                    
-                    QueueType newHostQueueType;
-                    switch (data->newType) {
-                        case MaterialType::Opaque:      newHostQueueType = Opaque;      break;
-                        case MaterialType::Cutout:      newHostQueueType = Cutout;      break;
-                        case MaterialType::Translucent: newHostQueueType = Translucent; break;
-                    }
-                    unsigned int primitiveID = iter->first;
-                    QueueType oldHostQueueType = iter->second.queuetype;
-                    iter->second.queuetype = newHostQueueType;
-
-                    removeFromQueue(primitiveID, oldHostQueueType);
-                    placeInQueue(primitiveID, newHostQueueType);
-                }
-                iter++;
+            QueueType newHostQueueType;
+            switch (data->newType) {
+                case MaterialType::Cutout:      newHostQueueType = Cutout;      break;
+                case MaterialType::Translucent: newHostQueueType = Translucent; break;
+                default:                        newHostQueueType = Opaque;      break;
+            }
+
+            for (uint32_t index = 0; index < primitives.size(); index++) {
+                if (primitives.getMaterialID(index) != data->materialID) continue;
+                if (primitives.getQueueType(index) == Skybox) continue;
+                primitives.moveToQueue(index, newHostQueueType);
             }
             return true;
         }
@@ -123,7 +188,15 @@ bool Renderer::initialize(
 }
 
 
-void Renderer::renderAll(glm::mat4 perspective, glm::mat4 view, glm::vec3 camPos) {
+void Renderer::renderAll(glm::mat4 perspective, glm::mat4 view, glm::vec3 camPos, float time) {
+    inspectorEngPtr->resetUniformUploadStats();
+    // ImGui and the inspector bind things between frames
+    stateCache.invalidate();
+    stateCache.resetCounters();
+    updateSceneBlock(perspective, view, camPos, time);
+
+    // still registered for programs that don't declare SceneBlock
+
     uniformRegPtr->registerSceneUniform(Uniform{
         .name = "projection", .type = UniformType::Mat4, .value = perspective, .invisible = true
     });
@@ -137,239 +210,565 @@ void Renderer::renderAll(glm::mat4 perspective, glm::mat4 view, glm::vec3 camPos
         uniformRegPtr->registerModelUniform(model->ID, {"model", UniformType::Mat4, model->getModelMatrix(), 0, 0, false, false, false, true});
     }
     
+    stats.primitivesDrawn    = 0;
+    stats.primitivesCulled   = 0;
+    stats.primitivesOccluded = 0;
+    stats.primitivesReduced  = 0;
+    stats.trianglesDrawn     = 0;
+    stats.drawCalls          = 0;
+    stats.primitivesBatched  = 0;
+    translucentDrawn         = false;
+    if (batchingSupported) arena.collectGarbage();
+    auto cullStart = std::chrono::steady_clock::now();
+    cullPrimitives(perspective * view);
+    stats.cullMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - cullStart).count();
+    selectLODs(perspective, camPos);
+    sortByState(Opaque);
+    sortByState(Cutout);
+
     renderSkybox();
-    renderOpaquePrimitives();
-    renderCutoutPrimitives();
+    renderQueue(Opaque);
+    renderQueue(Cutout);
+    recordOcclusion(camPos);
     reorderTranslucentPrimitives(view);
     renderTranslucentPrimitives();
+
+    const InspectorEngine::UniformUploadStats& uploadStats = inspectorEngPtr->getUniformUploadStats();
+    stats.uniformCallsIssued  = uploadStats.issued;
+    stats.uniformCallsSkipped = uploadStats.skipped;
+    stats.stateChanges        = stateCache.getCounters();
 }
 
 
-void Renderer::renderSkybox() {
-    if (skyboxPrimID == UINT_MAX) return;
+void Renderer::updateSceneBlock(const glm::mat4& perspective, const glm::mat4& view, const glm::vec3& camPos, float time) {
+    SceneBlockData block{
+        .projection = perspective,
+        .view = view,
+        .cameraPosition = glm::vec4(camPos, 1.0f),
+        .time = time,
+        .padding = {}
+    };
+    glBindBuffer(GL_UNIFORM_BUFFER, sceneUBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(SceneBlockData), &block);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+
+const Renderer::RenderStats& Renderer::getStats() const {
+    return stats;
+}
+
 
-    if (validatePrimitive(skyboxPrimID) == false) {
-        // primitiveIDMap.erase(skyboxPrimID);
-        skyboxPrimID = UINT_MAX;
+void Renderer::setViewportSize(int width, int height) {
+    viewportWidth = std::max(width, 1);
+    viewportHeight = std::max(height, 1);
+}
+
+
+void Renderer::setDepthTexture(GLuint _depthTexture) {
+    depthTexture = _depthTexture;
+}
+
+
+// Hi-Z without its GL targets runs as queries, OcclusionCuller has already warned about it
+OcclusionMode Renderer::activeOcclusionMode() const {
+    if (settingsPtr == nullptr) return OcclusionMode::Off;
+    if (settingsPtr->occlusionMode == OcclusionMode::HiZ && occlusion.hasHiZ() == false) return OcclusionMode::Queries;
+    return settingsPtr->occlusionMode;
+}
+
+
+// fills the packed world bounds of every primitive and tests them all at once, then against
+// the occlusion results if a mode is on. renderQueue skips what's outside or occluded.
+// The skybox surrounds the camera and is never culled.
+void Renderer::cullPrimitives(const glm::mat4& viewProjection) {
+    lastViewProjection = viewProjection;
+    OcclusionMode occlusionMode = activeOcclusionMode();
+    if (occlusionMode != lastOcclusionMode) {
+        occlusion.discardResults(); // they were made by the other mode, or before it was off
+        lastOcclusionMode = occlusionMode;
+    }
+
+    bool frustumCulling = settingsPtr == nullptr || settingsPtr->frustumCulling;
+    if (frustumCulling == false && occlusionMode == OcclusionMode::Off) {
+        visible.assign(primitives.size(), VISIBLE);
         return;
     }
-    
-    Primitive* skyboxPrimitive = &primitiveIDMap.at(skyboxPrimID);
-    glDepthFunc(GL_LEQUAL);
-    glDepthMask(GL_FALSE);
-    bindProgram(skyboxPrimitive->materialID);
-    inspectorEngPtr->applyAllUniformsForPrimitive(skyboxPrimitive->modelID, skyboxPrimitive->meshIdx, skyboxPrimitive->materialID);
-    bindTextures(skyboxPrimitive->materialID);
-    drawMesh(skyboxPrimitive->modelID, skyboxPrimitive->meshIdx);
-    glDepthMask(GL_TRUE);
-    glDepthFunc(GL_LESS);
+
+    primitiveBounds.resize(primitives.size());
+    for (auto& [modelID, handles] : modelPrimitives) {
+        Model* model = modelCachePtr->getModel(modelID);
+        if (model == nullptr) continue; // drawPrimitive skips these anyway
+        for (PrimitiveStore::Handle handle : handles) {
+            uint32_t index = primitives.indexOf(handle);
+            if (index == PrimitiveStore::NO_INDEX) continue;
+            const MeshBounds& bounds = model->getWorldBounds(primitives.getMeshIdx(index));
+            if (bounds.isEmpty()) primitiveBounds.set(index, glm::vec3(0.0f), glm::vec3(-1.0f)); // nothing to draw
+            else primitiveBounds.set(index, bounds.center(), bounds.extent());
+        }
+    }
+
+    if (frustumCulling) Frustum::fromViewProjection(viewProjection).cullBoxes(primitiveBounds, visible);
+    else visible.assign(primitives.size(), VISIBLE);
+    for (uint32_t index : primitives.getQueue(Skybox)) {
+        visible[index] = VISIBLE;
+    }
+
+    if (occlusionMode != OcclusionMode::Off) cullOccludedPrimitives(occlusionMode);
 }
 
 
-void Renderer::renderOpaquePrimitives() {
-    for (unsigned int primitiveID : opaquePrimIDs) {
-        
-        if (validatePrimitive(primitiveID) == false) {
-            // removeFromQueue(primitiveID, QueueType::Opaque);
-            continue;
+// marks primitives the last results say are hidden, they skip their uniforms and draw
+void Renderer::cullOccludedPrimitives(OcclusionMode mode) {
+    const DepthPyramid* depth = nullptr;
+    if (mode == OcclusionMode::HiZ) {
+        depth = occlusion.latestDepth();
+        if (depth == nullptr) return; // no readback has finished yet
+    }
+    else {
+        occlusion.collectQueries();
+    }
+
+    for (uint32_t index = 0; index < primitives.size(); index++) {
+        if (visible[index] != VISIBLE || primitives.getQueueType(index) == Skybox) continue;
+        glm::vec3 extent(primitiveBounds.extentX[index], primitiveBounds.extentY[index], primitiveBounds.extentZ[index]);
+        if (extent.x < 0.0f) continue; // empty mesh, nothing to test
+
+        bool occluded;
+        if (depth != nullptr) {
+            glm::vec3 center(primitiveBounds.centerX[index], primitiveBounds.centerY[index], primitiveBounds.centerZ[index]);
+            occluded = depth->isOccluded(center, extent);
         }
+        else {
+            occluded = occlusion.isQueryVisible(primitiveKey(primitives.handleAt(index))) == false;
+        }
+        if (occluded) visible[index] = OCCLUDED;
+    }
+}
+
 
-        Primitive* currPrimitive = &primitiveIDMap.at(primitiveID);
-        bindProgram(currPrimitive->materialID);
-        inspectorEngPtr->applyAllUniformsForPrimitive(currPrimitive->modelID, currPrimitive->meshIdx, currPrimitive->materialID);
-        bindTextures(currPrimitive->materialID);
-        drawMesh(currPrimitive->modelID, currPrimitive->meshIdx);
+// after the opaque and cutout queues and before the translucent one. Translucent primitives
+// write depth too, an occluder made of them would hide what shows through it next frame.
+void Renderer::recordOcclusion(const glm::vec3& camPos) {
+    assert(translucentDrawn == false && "occlusion recorded after the translucent queue");
+    switch (activeOcclusionMode()) {
+        case OcclusionMode::HiZ:
+            occlusion.buildHiZ(depthTexture, viewportWidth, viewportHeight, lastViewProjection);
+            stateCache.invalidate();
+            break;
+        case OcclusionMode::Queries:
+            queryOcclusion(camPos);
+            break;
+        default:
+            break;
     }
 }
 
 
-void Renderer::renderCutoutPrimitives() {
-    for (unsigned int primitiveID : cutoutPrimIDs) {
+// the boxes are tested against the opaque and cutout depth. Occluded primitives are queried
+// too, that's how they come back into view.
+void Renderer::queryOcclusion(const glm::vec3& camPos) {
+    queryBoxes.clear();
+    for (uint32_t index = 0; index < primitives.size(); index++) {
+        if (visible[index] == OUTSIDE_FRUSTUM || primitives.getQueueType(index) == Skybox) continue;
+        if (primitives.isValid(index) == false || primitiveBounds.extentX[index] < 0.0f) continue;
+        queryBoxes.push_back(OcclusionCuller::QueryBox{
+            .key = primitiveKey(primitives.handleAt(index)),
+            .center = glm::vec3(primitiveBounds.centerX[index], primitiveBounds.centerY[index], primitiveBounds.centerZ[index]),
+            .extent = glm::vec3(primitiveBounds.extentX[index], primitiveBounds.extentY[index], primitiveBounds.extentZ[index])
+        });
+    }
+    occlusion.queryBoxes(queryBoxes, lastViewProjection, camPos);
+    stateCache.invalidate();
+}
 
-        if (validatePrimitive(primitiveID) == false) {
-            // removeFromQueue(primitiveID, QueueType::Cutout);
-            continue;
+
+// picks the level each visible primitive draws at. A model's override wins, otherwise the level
+// comes from how many pixels a model unit covers at the nearest point of the primitive's bounds.
+// Hidden primitives keep their level, so coming back into view doesn't restart the hysteresis.
+void Renderer::selectLODs(const glm::mat4& perspective, const glm::vec3& camPos) {
+    bool automatic = settingsPtr == nullptr || settingsPtr->levelOfDetail;
+    float pixelError = settingsPtr != nullptr ? settingsPtr->lodPixelError : 1.0f;
+    float pixelsAtUnitDistance = perspective[1][1] * 0.5f * (float)viewportHeight;
+
+    for (auto& [modelID, handles] : modelPrimitives) {
+        Model* model = modelCachePtr->getModel(modelID);
+        if (model == nullptr) continue;
+        int lodOverride = model->getLODOverride();
+        float worldScale = model->getWorldScale();
+
+        for (PrimitiveStore::Handle handle : handles) {
+            uint32_t index = primitives.indexOf(handle);
+            if (index == PrimitiveStore::NO_INDEX || visible[index] != VISIBLE) continue;
+            unsigned int meshIdx = primitives.getMeshIdx(index);
+            const std::vector<MeshLOD>& lods = model->getMeshLODs(meshIdx);
+            if (lods.empty()) continue; // no such mesh, drawMesh skips it
+
+            unsigned int level = 0;
+            if (lodOverride >= 0) {
+                level = std::min((unsigned int)lodOverride, (unsigned int)lods.size() - 1);
+            }
+            else if (automatic && lods.size() > 1 && primitives.getQueueType(index) != Skybox) {
+                const MeshBounds& bounds = model->getWorldBounds(meshIdx);
+                float pixelsPerUnit = FLT_MAX; // camera inside the bounds
+                if (bounds.isEmpty() == false) {
+                    float distance = glm::length(camPos - glm::clamp(camPos, bounds.min, bounds.max));
+                    if (distance > 0.0f) pixelsPerUnit = worldScale * pixelsAtUnitDistance / distance;
+                }
+                level = LODSelector::select(lods, pixelsPerUnit, pixelError, primitives.getLOD(index));
+            }
+            primitives.setLOD(index, (uint8_t)level);
         }
+    }
+}
+
+
+void Renderer::renderSkybox() {
+    if (primitives.getQueue(Skybox).empty()) return;
+
+    glDepthFunc(GL_LEQUAL);
+    glDepthMask(GL_FALSE);
+    renderQueue(Skybox);
+    glDepthMask(GL_TRUE);
+    glDepthFunc(GL_LESS);
+}
+
 
-        Primitive* currPrimitive = &primitiveIDMap.at(primitiveID);
-        bindProgram(currPrimitive->materialID);
-        inspectorEngPtr->applyAllUniformsForPrimitive(currPrimitive->modelID, currPrimitive->meshIdx, currPrimitive->materialID);
-        bindTextures(currPrimitive->materialID);
-        drawMesh(currPrimitive->modelID, currPrimitive->meshIdx);
+// opaque and cutout primitives of DrawBlock programs are gathered into multi-draws, drawn at the
+// end of the queue. Their order doesn't affect the image, the skybox's and translucent order does.
+void Renderer::renderQueue(QueueType queueType) {
+    bool batching = (queueType == Opaque || queueType == Cutout) && batchingActive();
+    for (uint32_t index : primitives.getQueue(queueType)) {
+        if (primitives.isValid(index) == false) continue;
+        if (visible[index] == OUTSIDE_FRUSTUM) {
+            stats.primitivesCulled++;
+            continue;
+        }
+        if (visible[index] == OCCLUDED) {
+            stats.primitivesOccluded++;
+            continue;
+        }
+        stats.primitivesDrawn++;
+        if (batching && addToBatch(index)) continue;
+        drawPrimitive(index);
     }
+    if (batching) flushBatches();
 }
 
 
 void Renderer::renderTranslucentPrimitives() {
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    translucentDrawn = true;
     // glDepthMask(GL_FALSE);
-    for (unsigned int primitiveID : translucentPrimIDs) {
-
-        if (validatePrimitive(primitiveID) == false) {
-            // removeFromQueue(primitiveID, QueueType::Translucent);
-            continue;
-        }
-
-        Primitive* currPrimitive = &primitiveIDMap.at(primitiveID);
-        bindProgram(currPrimitive->materialID);
-        inspectorEngPtr->applyAllUniformsForPrimitive(currPrimitive->modelID, currPrimitive->meshIdx, currPrimitive->materialID);
-        bindTextures(currPrimitive->materialID);
-        drawMesh(currPrimitive->modelID, currPrimitive->meshIdx);
-    }
+    renderQueue(Translucent);
     // glDepthMask(GL_TRUE);
     glDisable(GL_BLEND);
 }
 
 
 void Renderer::reorderTranslucentPrimitives(glm::mat4 viewMat) {
-    for (unsigned int primitiveID : translucentPrimIDs) {
-    
-        Primitive* currPrimitive = &primitiveIDMap.at(primitiveID);
-        Model* currModel = modelCachePtr->getModel(currPrimitive->modelID);
+    const std::vector<uint32_t>& translucentQueue = primitives.getQueue(Translucent);
+    if (translucentQueue.empty()) return;
+
+    for (uint32_t index : translucentQueue) {
+        Model* currModel = modelCachePtr->getModel(primitives.getModelID(index));
+        if (currModel == nullptr) continue;
         glm::vec4 viewPos = viewMat * glm::vec4(currModel->getPosition(), 1.0f);
-        currPrimitive->depth = viewPos.z;
+        primitives.setDepth(index, viewPos.z);
     }
 
-    std::sort(translucentPrimIDs.begin(), translucentPrimIDs.end(),
-        [this](unsigned int a, unsigned int b) {
-            const Primitive& primitiveA = primitiveIDMap.at(a);
-            const Primitive& primitiveB = primitiveIDMap.at(b);
-
-            return primitiveA.depth < primitiveB.depth;
-        }
-    );
+    primitives.sortQueue(Translucent, [this](uint32_t a, uint32_t b) {
+        return primitives.getDepth(a) < primitives.getDepth(b);
+    });
 }
 
 
-void Renderer::bindTextures(unsigned int materialID) {
-    Material* foundMaterial = materialCachePtr->getMaterial(materialID);
+// Opaque and cutout order doesn't affect the image, so group primitives that share state.
+// Key layout, most significant first: program | texture set | material | mesh, 16 bits each.
+// The narrower fields are hashes, a collision only costs a rebind, never correctness.
+void Renderer::sortByState(QueueType queueType) {
+    const std::vector<uint32_t>& queue = primitives.getQueue(queueType);
+    if (queue.size() < 2) return;
 
-    const auto& textureIDs = foundMaterial->getMaterialTextureIDs();
-    if (textureIDs.empty() == false) {
-        unsigned int texUnit = 0;
-        for (unsigned int textureID : textureIDs) {
-            textureCachePtr->bindTexture(textureID, texUnit);
-            texUnit++;
-        }
+    sortKeys.resize(primitives.size());
+    for (uint32_t index : queue) {
+        sortKeys[index] = makeSortKey(index);
     }
-    else {
-        textureCachePtr->bindDefault(0);
+
+    primitives.sortQueue(queueType, [this](uint32_t a, uint32_t b) {
+        return sortKeys[a] < sortKeys[b];
+    });
+}
+
+
+uint64_t Renderer::makeSortKey(uint32_t index) {
+    if (primitives.isValid(index) == false) return UINT64_MAX; // invalid primitives sink to the end, drawPrimitive skips them
+
+    unsigned int materialID = primitives.getMaterialID(index);
+    Material* material = materialCachePtr->getMaterial(materialID);
+    if (material == nullptr) return UINT64_MAX;
+
+    uint64_t textureSet = 0;
+    for (unsigned int textureID : material->getMaterialTextureIDs()) {
+        textureSet = textureSet * 31 + textureID + 1;
     }
+    uint64_t mesh = (uint64_t)primitives.getModelID(index) * 64 + primitives.getMeshIdx(index);
+
+    return ((uint64_t)(material->getProgramID() & 0xFFFF) << 48)
+         | ((textureSet & 0xFFFF) << 32)
+         | ((uint64_t)(materialID & 0xFFFF) << 16)
+         | (mesh & 0xFFFF);
 }
 
 
-void Renderer::bindProgram(unsigned int materialID) {
-    Material* foundMaterial = materialCachePtr->getMaterial(materialID);  
-    ShaderProgram* program = shaderRegPtr->getProgram(foundMaterial->getProgramID());
-    program->use();
+// validity was settled when the primitive was added or changed, here the IDs are only resolved.
+// the null checks cover things deleted since then (a program removed from the registry, a model
+// mid-reload), they skip the draw without logging since it would repeat every frame.
+void Renderer::drawPrimitive(uint32_t index) {
+    if (primitives.isValid(index) == false) return;
+
+    unsigned int modelID = primitives.getModelID(index);
+    unsigned int meshIdx = primitives.getMeshIdx(index);
+    unsigned int materialID = primitives.getMaterialID(index);
+
+    Model* model = modelCachePtr->getModel(modelID);
+    Material* material = materialCachePtr->getMaterial(materialID);
+    if (model == nullptr || material == nullptr) return;
+    ShaderProgram* program = programFor(*material, model->getMesh(meshIdx), model->getInstanceCount());
+    if (program == nullptr) return;
+
+    stateCache.useProgram(program->gpuID);
+    if (program->isCompiled()) inspectorEngPtr->applyAllUniformsForPrimitive(*program, modelID, materialID);
+    const std::vector<MeshLOD>& lods = model->getMeshLODs(meshIdx);
+    if (lods.empty()) return;
+    unsigned int lod = std::min((unsigned int)primitives.getLOD(index), (unsigned int)lods.size() - 1);
+    UniformHandle lodHandle = program->getLodHandle();
+    if (lodHandle.isValid()) program->setUniform_int(lodHandle, (int)lod);
+    if (program->usesDrawBlock()) {
+        DrawBlockData drawData{ model->getModelMatrix(), (int)lod, {} };
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, singleDrawBuffer);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(DrawBlockData), &drawData);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_BLOCK_BINDING, singleDrawBuffer);
+    }
+    bindTextures(*material);
+    model->drawMesh(meshIdx, &stateCache, lod);
+
+    stats.drawCalls++;
+    if (lod > 0) stats.primitivesReduced++;
+    stats.trianglesDrawn += lods[lod].indexCount / 3 * model->getInstanceCount();
 }
 
 
-void Renderer::drawMesh(unsigned int modelID, unsigned int meshIdx) {
-    Model* foundModel = modelCachePtr->getModel(modelID);
-    foundModel->drawMesh(meshIdx);
+bool Renderer::batchingActive() const {
+    return batchingSupported && (settingsPtr == nullptr || settingsPtr->batchDraws);
 }
 
 
-bool Renderer::validateNextID() {
-    unsigned int numOfChecks = 0;
-    while (primitiveIDMap.contains(nextPrimitiveID) == true) {
-        if (numOfChecks > 1000) return false;
-        
-        nextPrimitiveID++;
-        numOfChecks++;
+// queues the primitive for flushBatches if its program reads DrawBlock and its mesh is in the
+// arena. Instanced models stay on drawPrimitive, a batched draw has room for one instance. So do
+// models with model-scope uniforms besides their matrix, a multi-draw only carries DrawBlock.
+bool Renderer::addToBatch(uint32_t index) {
+    if (primitives.isValid(index) == false) return false;
+
+    unsigned int modelID = primitives.getModelID(index);
+    unsigned int meshIdx = primitives.getMeshIdx(index);
+    unsigned int materialID = primitives.getMaterialID(index);
+    Model* model = modelCachePtr->getModel(modelID);
+    Material* material = materialCachePtr->getMaterial(materialID);
+    if (model == nullptr || material == nullptr || model->getInstanceCount() != 1) return false;
+    for (const Uniform& uniform : uniformRegPtr->readModelUniforms(modelID)) {
+        if (uniform.name != "model") return false; // DrawBlock has the matrix, nothing else
+    }
+    const MeshA* mesh = model->getMesh(meshIdx);
+    if (mesh == nullptr) return false;
+    ShaderProgram* program = programFor(*material, mesh, 1);
+    if (program == nullptr || program->isCompiled() == false || program->usesDrawBlock() == false) return false;
+
+    // a mesh that was never drawn isn't on the GPU yet, drawPrimitive uploads it this frame
+    const MeshArena::Entry* entry = arena.acquire(primitiveKey(primitives.handleAt(index)), *mesh, stateCache);
+    if (entry == nullptr) return false;
+
+    unsigned int lod = std::min((unsigned int)primitives.getLOD(index), (unsigned int)mesh->getLODs().size() - 1);
+    const MeshLOD& range = mesh->getLOD(lod);
+    uint32_t run = 0;
+    if (batchDraws.empty() == false) {
+        run = batchDraws.back().run + (batchDraws.back().materialID == materialID ? 0 : 1);
     }
+    batchDraws.push_back(BatchedDraw{
+        .run = run,
+        .materialID = materialID,
+        .pool = entry->pool,
+        .mesh = mesh,
+        .command = { range.indexCount, 1, entry->firstIndex + range.firstIndex, (GLint)entry->baseVertex, 0 },
+        .drawData = { model->getModelMatrix(), (int)lod, {} },
+        .instance = model->getGPUInstanceData()[0]
+    });
+
+    if (lod > 0) stats.primitivesReduced++;
+    stats.trianglesDrawn += range.indexCount / 3;
     return true;
 }
 
 
-void Renderer::placeInQueue(unsigned int primitiveID, QueueType queueType) {
-    std::vector<unsigned int>* hostQueue;
-    switch (queueType) {
-        case Opaque:      hostQueue = &opaquePrimIDs;      break;
-        case Cutout:      hostQueue = &cutoutPrimIDs;      break;
-        case Translucent: hostQueue = &translucentPrimIDs; break;
-        case Skybox:
-            skyboxPrimID = primitiveID;
-            return;
+// one glMultiDrawElementsIndirect per material and arena pool. The queue is sorted by state, so
+// a material's draws are already together, they're only grouped by pool within it. Every
+// multi-draw gets its own SSBO range, gl_DrawID restarts at 0 each call.
+void Renderer::flushBatches() {
+    if (batchDraws.empty()) return;
+
+    std::stable_sort(batchDraws.begin(), batchDraws.end(), [](const BatchedDraw& a, const BatchedDraw& b) {
+        return a.run != b.run ? a.run < b.run : a.pool < b.pool;
+    });
+
+    // entries per aligned step, the SSBO range offset must be a multiple of storageAlignment
+    size_t alignmentStep = std::lcm(sizeof(DrawBlockData), (size_t)std::max(storageAlignment, 1)) / sizeof(DrawBlockData);
+    struct Group { size_t first, count, dataFirst; };
+    std::vector<Group> groups;
+    batchCommands.clear();
+    batchDrawData.clear();
+    batchInstances.clear();
+    for (size_t i = 0; i < batchDraws.size(); i++) {
+        BatchedDraw& draw = batchDraws[i];
+        if (i == 0 || draw.run != batchDraws[i - 1].run || draw.pool != batchDraws[i - 1].pool) {
+            size_t dataFirst = (batchDrawData.size() + alignmentStep - 1) / alignmentStep * alignmentStep;
+            batchDrawData.resize(dataFirst);
+            groups.push_back(Group{ i, 0, dataFirst });
+        }
+        groups.back().count++;
+        draw.command.baseInstance = (GLuint)batchInstances.size();
+        batchCommands.push_back(draw.command);
+        batchDrawData.push_back(draw.drawData);
+        batchInstances.push_back(draw.instance);
+    }
+
+    uploadStream(GL_DRAW_INDIRECT_BUFFER, indirectBuffer, indirectCapacity, batchCommands.data(), batchCommands.size() * sizeof(DrawElementsIndirectCommand));
+    uploadStream(GL_SHADER_STORAGE_BUFFER, drawBlockBuffer, drawBlockCapacity, batchDrawData.data(), batchDrawData.size() * sizeof(DrawBlockData));
+    uploadStream(GL_ARRAY_BUFFER, instanceStream, instanceStreamCapacity, batchInstances.data(), batchInstances.size() * sizeof(InstanceGPUData));
+
+    for (const Group& group : groups) {
+        const BatchedDraw& first = batchDraws[group.first];
+        Material* material = materialCachePtr->getMaterial(first.materialID);
+        // a pool holds one vertex layout, every mesh in the group asks for the same variant
+        ShaderProgram* program = programFor(*material, first.mesh, 1);
+
+        stateCache.useProgram(program->gpuID);
+        inspectorEngPtr->applySceneUniforms(*program);
+        inspectorEngPtr->applyMaterialUniforms(*program, 0, first.materialID);
+        bindTextures(*material);
+        stateCache.bindVertexArray(arena.getVertexArray(first.pool));
+        if (!first.mesh->getVertexLayout().has(VertexLayout::Color)) glVertexAttrib4fv(VertexLayout::Color, &first.mesh->getBaseColor()[0]);
+
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, DRAW_BLOCK_BINDING, drawBlockBuffer,
+                            (GLintptr)(group.dataFirst * sizeof(DrawBlockData)), (GLsizeiptr)(group.count * sizeof(DrawBlockData)));
+        glMultiDrawElementsIndirect(GL_TRIANGLES, arena.getIndexType(first.pool),
+                                    (const void*)(group.first * sizeof(DrawElementsIndirectCommand)), (GLsizei)group.count, 0);
+        stats.drawCalls++;
+        stats.primitivesBatched += (unsigned int)group.count;
     }
-    hostQueue->push_back(primitiveID);
+    batchDraws.clear();
 }
 
 
-void Renderer::removeFromQueue(unsigned int primitiveIDToDelete, QueueType queueType) {
-    std::vector<unsigned int>* hostQueue;
-    switch (queueType) {
-        case Opaque:      hostQueue = &opaquePrimIDs;      break;
-        case Cutout:      hostQueue = &cutoutPrimIDs;      break;
-        case Translucent: hostQueue = &translucentPrimIDs; break;
-        case Skybox:
-            skyboxPrimID = UINT_MAX;
-            return;
-    }
-    for (auto iter = hostQueue->begin(); iter != hostQueue->end(); ) {
-        if (*iter == primitiveIDToDelete) {
-            hostQueue->erase(iter);
-            return;
-        }
-        else {
-            iter++;
+void Renderer::bindTextures(Material& material) {
+    const auto& textureIDs = material.getMaterialTextureIDs();
+    if (textureIDs.empty() == false) {
+        unsigned int texUnit = 0;
+        for (unsigned int textureID : textureIDs) {
+            if (!stateCache.isTextureBound(texUnit, textureID)) {
+                bool bound = textureCachePtr->bindTexture(textureID, texUnit);
+                // on failure the unit holds the missing texture (or nothing), don't trust it next time
+                stateCache.textureBound(texUnit, bound ? textureID : GLStateCache::UNKNOWN_TEXTURE);
+            }
+            texUnit++;
         }
     }
+    else if (!stateCache.isTextureBound(0, GLStateCache::DEFAULT_TEXTURE)) {
+        textureCachePtr->bindDefault(0);
+        stateCache.textureBound(0, GLStateCache::DEFAULT_TEXTURE);
+    }
 }
 
 
-bool Renderer::validatePrimitive(unsigned int primitiveID) {
-    if (primitiveIDMap.contains(primitiveID) == false) {
-        loggerPtr->addLog(LogLevel::LOG_ERROR, "RENDERER::validatePrimitive", "primitive not found in map with ID " + std::to_string(primitiveID));
+// the material's program, or its variant for this mesh when the program reads any variant macros
+ShaderProgram* Renderer::programFor(Material& material, const MeshA* mesh, unsigned int instanceCount) {
+    ShaderProgram* program = shaderRegPtr->getProgram(material.getProgramID());
+    if (program == nullptr || program->getVariantMask() == 0 || mesh == nullptr) return program;
+    return shaderRegPtr->getVariant(material.getProgramID(), variantFeaturesFor(material, mesh->getVertexLayout(), instanceCount));
+}
+
+
+Renderer::QueueType Renderer::queueTypeFor(unsigned int materialID, bool isSkybox) {
+    if (isSkybox == true) return Skybox;
+
+    Material* material = materialCachePtr->getMaterial(materialID);
+    if (material == nullptr) return Opaque; // never drawn, validatePrimitive marks it invalid
+
+    switch (material->getMaterialType()) {
+        case MaterialType::Cutout:      return Cutout;
+        case MaterialType::Translucent: return Translucent;
+        default:                        return Opaque;
+    }
+}
+
+
+// run when a primitive is added or its material changes, the result is kept in the store
+// so the per-frame loops don't repeat these lookups or their logging.
+bool Renderer::validatePrimitive(uint32_t index) {
+    if (index >= primitives.size()) {
+        loggerPtr->addLog(LogLevel::LOG_ERROR, "RENDERER::validatePrimitive", "primitive index out of range " + std::to_string(index));
         return false;
     }
 
-    Primitive& primitive = primitiveIDMap.at(primitiveID);
+    unsigned int modelID = primitives.getModelID(index);
+    unsigned int meshIdx = primitives.getMeshIdx(index);
+    unsigned int materialID = primitives.getMaterialID(index);
     bool result = true;
     std::string feedback = "";
 
-    Model* foundModel = modelCachePtr->getModel(primitive.modelID);
+    Model* foundModel = modelCachePtr->getModel(modelID);
     if (foundModel == nullptr) {
-        feedback += "\nmodel not found with ID " + std::to_string(primitive.modelID);
+        feedback += "\nmodel not found with ID " + std::to_string(modelID);
         result = false;
     }
-    else if (primitive.meshIdx >= foundModel->getNumberOfMeshes()) {
-        feedback += "\nmesh with Index " + std::to_string(primitive.meshIdx) + " out of bounds for model " + std::to_string(primitive.modelID);
+    else if (meshIdx >= foundModel->getNumberOfMeshes()) {
+        feedback += "\nmesh with Index " + std::to_string(meshIdx) + " out of bounds for model " + std::to_string(modelID);
         result = false;
     }
 
     // no material to be found if matID is max so we always return false in this case. this is intentional
     // so its not an error to report, but we also want to check if other errors previously occured and report those.
-    if (primitive.materialID == std::numeric_limits<unsigned int>::max()) {
-        if (result == false) {
-            if (!feedback.empty()) loggerPtr->addLog(LogLevel::LOG_ERROR, "RENDERER::validatePrimitive()", feedback);
+    if (materialID != std::numeric_limits<unsigned int>::max()) {
+        if (materialCachePtr->getMaterial(materialID) == nullptr) {
+            feedback += "\nmaterial not found with ID: " + std::to_string(materialID);
+            result = false;
         }
-        return false;
     }
-
-    Material* foundMaterial = materialCachePtr->getMaterial(primitive.materialID);
-    if (foundMaterial == nullptr) {
-        feedback += "\nmaterial not found with ID: " + std::to_string(primitive.materialID) + ". Removing materialID from model";
-        result = false;
-    }
-    else if (shaderRegPtr->getProgram(foundMaterial->getProgramID()) == nullptr) {
-        feedback += "\nshader program not found: " + std::to_string(foundMaterial->getProgramID());
+    else {
         result = false;
     }
 
-    if (result == false) {
-        if (!feedback.empty()) loggerPtr->addLog(LogLevel::LOG_ERROR, "RENDERER::validatePrimitive()", feedback);
-    }
+    // the program is deliberately not checked here: materials are loaded before the shader registry,
+    // so a program can legitimately appear after its primitives. drawPrimitive resolves it every frame.
+
+    if (!feedback.empty()) loggerPtr->addLog(LogLevel::LOG_ERROR, "RENDERER::validatePrimitive()", feedback);
+    primitives.setValid(index, result);
     return result;
 }
 
 void Renderer::setMeshMaterial(unsigned int modelID, unsigned int meshID, unsigned int materialID) {
-    for (auto& [primID, primitive] : primitiveIDMap) {
-        if (primitive.modelID == modelID && primitive.meshIdx == meshID) {
-            primitive.materialID = materialID;
-            return;
+    auto modelPair = modelPrimitives.find(modelID);
+    if (modelPair == modelPrimitives.end()) return;
+
+    for (PrimitiveStore::Handle handle : modelPair->second) {
+        uint32_t index = primitives.indexOf(handle);
+        if (index == PrimitiveStore::NO_INDEX || primitives.getMeshIdx(index) != meshID) continue;
+
+        primitives.setMaterialID(index, materialID);
+        if (primitives.getQueueType(index) != Skybox) {
+            primitives.moveToQueue(index, queueTypeFor(materialID, false));
         }
+        validatePrimitive(index);
+        return;
     }
-}
\ No newline at end of file
+}
@@ -1,6 +1,18 @@
 #pragma once
 
+#include "platform/GL.hpp"
 #include <glm/glm.hpp>
+#include <cstdint>
+#include <types.hpp>
+#include <vector>
+#include <unordered_map>
+#include "engine/GLStateCache.hpp"
+#include "engine/Frustum.hpp"
+#include "engine/OcclusionCuller.hpp"
+#include "engine/DrawBlock.hpp"
+#include "PrimitiveStore.hpp"
+#include "MeshArena.hpp"
+#include "InstanceData.hpp"
 
 class Logger;
 class EventDispatcher;
@@ -10,58 +22,116 @@ class TextureCache;
 class ShaderRegistry;
 class UniformRegistry;
 class InspectorEngine;
+class Material;
+class MeshA;
+class ShaderProgram;
+struct AppSettings;
+enum class OcclusionMode : u8;
 
 class Renderer {
 private:
-    enum QueueType {
-        Opaque,
-        Cutout,
-        Translucent,
-        Skybox
-    };
-
-    struct Primitive {
-        unsigned int modelID;
-        unsigned int meshIdx;
-        unsigned int materialID;
-        float        depth;
+    using QueueType = PrimitiveStore::QueueType;
+    using enum PrimitiveStore::QueueType;
 
-        QueueType    queuetype;
+public:
+    // Counters for the last rendered frame, shown in the viewport overlay
+    struct RenderStats {
+        unsigned int uniformCallsIssued  = 0;
+        unsigned int uniformCallsSkipped = 0;
+        unsigned int primitivesDrawn     = 0;
+        unsigned int primitivesCulled    = 0; // outside the camera frustum, see cullPrimitives
+        unsigned int primitivesOccluded  = 0; // in the frustum but hidden, see OcclusionCuller
+        float cullMilliseconds           = 0.0f; // CPU time of cullPrimitives
+        unsigned int primitivesReduced   = 0; // drawn at a level of detail past 0, see selectLODs
+        unsigned int trianglesDrawn      = 0; // instances included
+        unsigned int drawCalls           = 0; // a multi-draw counts once
+        unsigned int primitivesBatched   = 0; // drawn through a multi-draw, see flushBatches
+        GLStateCache::Counters stateChanges;
     };
 
-public:
     Renderer();
-    ~Renderer() = default;
+    ~Renderer();
     bool initialize(
         Logger* _loggerPtr, EventDispatcher* _eventsPtr, ModelCache* _modelCachePtr, 
         MaterialCache* _materialCachePtr, TextureCache* _textureCachePtr, ShaderRegistry* _shaderRegPtr, 
-        UniformRegistry* _uniformRegPtr, InspectorEngine* _inspectorEngPtr
+        UniformRegistry* _uniformRegPtr, InspectorEngine* _inspectorEngPtr, const AppSettings* _settingsPtr
     );
+    // releases the renderer's GL objects, call while the context still exists
+    void shutdown();
 
-    void renderAll(glm::mat4 perspective, glm::mat4 view, glm::vec3 camPos);
+    void renderAll(glm::mat4 perspective, glm::mat4 view, glm::vec3 camPos, float time);
+    // pixel size of the target renderAll draws into, level of detail selection measures against it
+    void setViewportSize(int width, int height);
+    // depth texture of the target renderAll draws into, Hi-Z occlusion culling reduces it
+    void setDepthTexture(GLuint _depthTexture);
     void renderModel();
+    bool isBatchingSupported() const { return batchingSupported; }
     void setMeshMaterial(unsigned int modelID, unsigned int meshID, unsigned int materialID);
+    const RenderStats& getStats() const;
 
 private:
-    unsigned int nextPrimitiveID = 0;
-    std::unordered_map<unsigned int, Primitive> primitiveIDMap;
-    std::vector<unsigned int> opaquePrimIDs;
-    std::vector<unsigned int> cutoutPrimIDs;
-    std::vector<unsigned int> translucentPrimIDs;
-    unsigned int skyboxPrimID = UINT_MAX;
+    PrimitiveStore primitives;
+    std::unordered_map<unsigned int, std::vector<PrimitiveStore::Handle>> modelPrimitives; // [model ID] <-> its primitives
+    RenderStats stats;
+    GLuint sceneUBO = 0; // SceneBlock buffer, see engine/SceneBlock.hpp
+    GLStateCache stateCache;
+    std::vector<uint64_t> sortKeys; // indexed by primitive dense index, reused every frame
+    PackedBounds primitiveBounds;   // world space, same indexing, refilled every frame
+    std::vector<uint8_t> visible;   // same indexing, result of the last cullPrimitives (see VISIBILITY in the .cpp)
+    OcclusionCuller occlusion;
+    OcclusionMode lastOcclusionMode{}; // Off
+    glm::mat4 lastViewProjection = glm::mat4(1.0f);
+    std::vector<OcclusionCuller::QueryBox> queryBoxes; // reused every frame
+    int viewportWidth  = 1;
+    int viewportHeight = 1;
+    GLuint depthTexture = 0;
+    bool translucentDrawn = false; // this frame, occlusion must be recorded before it
+
+    // a primitive queued for a multi-draw, see addToBatch
+    struct BatchedDraw {
+        uint32_t run;        // consecutive draws of one material share a run
+        unsigned int materialID;
+        uint32_t pool;       // MeshArena pool, one multi-draw per run and pool
+        const MeshA* mesh;
+        DrawElementsIndirectCommand command;
+        DrawBlockData drawData;
+        InstanceGPUData instance;
+    };
+    bool batchingSupported = false; // GL 4.6, decided at initialize
+    MeshArena arena;
+    std::vector<BatchedDraw> batchDraws;             // the current queue's, reused
+    std::vector<DrawElementsIndirectCommand> batchCommands;
+    std::vector<DrawBlockData> batchDrawData;        // each multi-draw's entries start SSBO-offset aligned
+    std::vector<InstanceGPUData> batchInstances;
+    GLuint indirectBuffer  = 0;
+    GLuint drawBlockBuffer = 0;  // DrawBlock of the multi-draws
+    GLuint singleDrawBuffer = 0; // DrawBlock of a DrawBlock program's unbatched draw, one entry
+    GLuint instanceStream  = 0;  // batchInstances, every arena pool's instance attributes read it
+    size_t indirectCapacity = 0, drawBlockCapacity = 0, instanceStreamCapacity = 0; // bytes
+    GLint storageAlignment = 256; // GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT
+
+    void updateSceneBlock(const glm::mat4& perspective, const glm::mat4& view, const glm::vec3& camPos, float time);
 
+    void cullPrimitives(const glm::mat4& viewProjection);
+    void cullOccludedPrimitives(OcclusionMode mode);
+    void recordOcclusion(const glm::vec3& camPos);
+    void queryOcclusion(const glm::vec3& camPos);
+    OcclusionMode activeOcclusionMode() const;
+    void selectLODs(const glm::mat4& perspective, const glm::vec3& camPos);
     void renderSkybox();
-    void renderOpaquePrimitives();
-    void renderCutoutPrimitives();
+    void renderQueue(QueueType queueType);
     void renderTranslucentPrimitives();
     void reorderTranslucentPrimitives(glm::mat4 viewMat);
-    void bindTextures(unsigned int materialID);
-    void bindProgram(unsigned int materialID);
-    void drawMesh(unsigned int modelID, unsigned int meshID);
-    bool validateNextID();
-    bool validatePrimitive(unsigned int primitiveID);
-    void placeInQueue(unsigned int primitiveID, QueueType queueType);
-    void removeFromQueue(unsigned int primitiveIDToDelete, QueueType queueType);
+    void sortByState(QueueType queueType);
+    uint64_t makeSortKey(uint32_t index);
+    void drawPrimitive(uint32_t index);
+    bool batchingActive() const;
+    bool addToBatch(uint32_t index);
+    void flushBatches();
+    void bindTextures(Material& material);
+    ShaderProgram* programFor(Material& material, const MeshA* mesh, unsigned int instanceCount);
+    bool validatePrimitive(uint32_t index);
+    QueueType queueTypeFor(unsigned int materialID, bool isSkybox);
 
     //SYSTEM POINTERS
     Logger* loggerPtr                = nullptr;
@@ -72,4 +142,5 @@ private:
     ShaderRegistry* shaderRegPtr     = nullptr;
     UniformRegistry* uniformRegPtr   = nullptr;
     InspectorEngine* inspectorEngPtr = nullptr;
+    const AppSettings* settingsPtr   = nullptr;
 };
\ No newline at end of file
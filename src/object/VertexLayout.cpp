@@ -0,0 +1,180 @@
+#include "VertexLayout.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    uint32_t packSnorm10x3(const glm::vec3& value) {
+        auto quantize = [](float component) {
+            return (uint32_t)std::lround(std::clamp(component, -1.0f, 1.0f) * 511.0f) & 0x3FFu;
+        };
+        return quantize(value.x) | (quantize(value.y) << 10) | (quantize(value.z) << 20);
+    }
+
+    glm::vec3 unpackSnorm10x3(uint32_t packed) {
+        auto expand = [](uint32_t bits) {
+            int32_t signedBits = (int32_t)(bits << 22) >> 22; // sign extend the low 10 bits
+            return std::max((float)signedBits / 511.0f, -1.0f);
+        };
+        return glm::vec3(expand(packed), expand(packed >> 10), expand(packed >> 20));
+    }
+
+    uint16_t packUnorm16(float value) {
+        return (uint16_t)std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f);
+    }
+
+    // which formats each location may use, in the order they are tried by decode
+    bool allowed(VertexLayout::Location location, VertexFormat format) {
+        if (format == VertexFormat::None) return true;
+        switch (location) {
+            case VertexLayout::Position: return format == VertexFormat::Float3;
+            case VertexLayout::Normal:   return format == VertexFormat::Snorm10x3 || format == VertexFormat::Float3;
+            case VertexLayout::UV:       return format == VertexFormat::Unorm16x2 || format == VertexFormat::Float2;
+            default:                     return false;
+        }
+    }
+}
+
+
+uint32_t VertexLayout::formatSize(VertexFormat format) {
+    switch (format) {
+        case VertexFormat::Float3:    return 12;
+        case VertexFormat::Float2:    return 8;
+        case VertexFormat::Snorm10x3: return 4;
+        case VertexFormat::Unorm16x2: return 4;
+        default:                      return 0;
+    }
+}
+
+
+VertexLayout VertexLayout::fromFormats(const std::array<VertexFormat, LocationCount>& formats) {
+    VertexLayout layout;
+    for (size_t location = 0; location < LocationCount; location++) {
+        layout.attributes[location].format = formats[location];
+        layout.attributes[location].offset = layout.stride;
+        layout.stride += formatSize(formats[location]);
+    }
+    return layout;
+}
+
+
+VertexLayout VertexLayout::choose(const Vertex* vertices, size_t count, const MeshProperties& flags) {
+    std::array<VertexFormat, LocationCount> formats{};
+    if (flags.hasPositions) formats[Position] = VertexFormat::Float3;
+    if (flags.hasNormals) formats[Normal] = VertexFormat::Snorm10x3;
+    if (flags.hasUVs) {
+        // tiled uvs outside [0, 1] would be clamped, those meshes keep full floats
+        bool unitRange = std::all_of(vertices, vertices + count, [](const Vertex& vertex) {
+            return vertex.uv.x >= 0.0f && vertex.uv.x <= 1.0f && vertex.uv.y >= 0.0f && vertex.uv.y <= 1.0f;
+        });
+        formats[UV] = unitRange ? VertexFormat::Unorm16x2 : VertexFormat::Float2;
+    }
+    return fromFormats(formats);
+}
+
+
+std::vector<unsigned char> VertexLayout::pack(const Vertex* vertices, size_t count) const {
+    std::vector<unsigned char> packed(count * stride);
+    for (size_t v = 0; v < count; v++) {
+        const Vertex& vertex = vertices[v];
+        unsigned char* out = packed.data() + v * stride;
+
+        if (attributes[Position].format == VertexFormat::Float3) {
+            std::memcpy(out + attributes[Position].offset, &vertex.position, sizeof(glm::vec3));
+        }
+
+        switch (attributes[Normal].format) {
+            case VertexFormat::Snorm10x3: {
+                uint32_t normal = packSnorm10x3(vertex.normal);
+                std::memcpy(out + attributes[Normal].offset, &normal, sizeof(normal));
+                break;
+            }
+            case VertexFormat::Float3:
+                std::memcpy(out + attributes[Normal].offset, &vertex.normal, sizeof(glm::vec3));
+                break;
+            default:
+                break;
+        }
+
+        switch (attributes[UV].format) {
+            case VertexFormat::Unorm16x2: {
+                uint16_t uv[2] = { packUnorm16(vertex.uv.x), packUnorm16(vertex.uv.y) };
+                std::memcpy(out + attributes[UV].offset, uv, sizeof(uv));
+                break;
+            }
+            case VertexFormat::Float2:
+                std::memcpy(out + attributes[UV].offset, &vertex.uv, sizeof(glm::vec2));
+                break;
+            default:
+                break;
+        }
+    }
+    return packed;
+}
+
+
+glm::vec3 VertexLayout::unpackPosition(const unsigned char* vertex) const {
+    glm::vec3 position(0.0f);
+    if (attributes[Position].format == VertexFormat::Float3) {
+        std::memcpy(&position, vertex + attributes[Position].offset, sizeof(glm::vec3));
+    }
+    return position;
+}
+
+
+Vertex VertexLayout::unpack(const unsigned char* vertex) const {
+    Vertex unpacked{};
+    unpacked.position = unpackPosition(vertex);
+
+    switch (attributes[Normal].format) {
+        case VertexFormat::Snorm10x3: {
+            uint32_t normal;
+            std::memcpy(&normal, vertex + attributes[Normal].offset, sizeof(normal));
+            unpacked.normal = unpackSnorm10x3(normal);
+            break;
+        }
+        case VertexFormat::Float3:
+            std::memcpy(&unpacked.normal, vertex + attributes[Normal].offset, sizeof(glm::vec3));
+            break;
+        default:
+            break;
+    }
+
+    switch (attributes[UV].format) {
+        case VertexFormat::Unorm16x2: {
+            uint16_t uv[2];
+            std::memcpy(uv, vertex + attributes[UV].offset, sizeof(uv));
+            unpacked.uv = glm::vec2(uv[0] / 65535.0f, uv[1] / 65535.0f);
+            break;
+        }
+        case VertexFormat::Float2:
+            std::memcpy(&unpacked.uv, vertex + attributes[UV].offset, sizeof(glm::vec2));
+            break;
+        default:
+            break;
+    }
+    return unpacked;
+}
+
+
+uint32_t VertexLayout::encode() const {
+    uint32_t code = 0;
+    for (size_t location = 0; location < LocationCount; location++) {
+        code |= (uint32_t)attributes[location].format << (4 * location);
+    }
+    return code;
+}
+
+
+bool VertexLayout::decode(uint32_t code, VertexLayout& layout) {
+    if (code >> (4 * LocationCount) != 0) return false;
+
+    std::array<VertexFormat, LocationCount> formats{};
+    for (size_t location = 0; location < LocationCount; location++) {
+        formats[location] = (VertexFormat)((code >> (4 * location)) & 0xF);
+        if (!allowed((Location)location, formats[location])) return false;
+    }
+    layout = fromFormats(formats);
+    return true;
+}
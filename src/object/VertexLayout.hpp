@@ -0,0 +1,65 @@
+// DESCRIPTION
+/*
+VertexLayout describes how a mesh's vertices are packed on the GPU, so a mesh only stores the
+attributes it actually has, each in the smallest format that holds it without visible loss:
+
+    location 0  position  Float3                          12 bytes
+    location 1  normal    Snorm10x3 (GL_INT_2_10_10_10_REV) 4 bytes
+    location 2  uv        Unorm16x2 when every uv is in [0, 1], Float2 otherwise   4 or 8 bytes
+    location 3  color     never stored, MeshA sets it as a constant attribute
+
+Attributes are interleaved in location order. The shader side doesn't change: normalized formats
+arrive as floats, a missing attribute reads its constant value, and locations 0-3 keep meaning
+what they meant with the fixed 48 byte Vertex. A fully featured vertex is 20 bytes instead of 48.
+
+Import and MeshOptimizer still work on Vertex, packing happens once the mesh is final
+(MeshA's constructor, MeshDiskCache::store). A layout is fully determined by its formats,
+which is what encode() stores.
+*/
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "Vertex.hpp"
+#include "MeshProperties.hpp"
+
+enum class VertexFormat : uint8_t {
+    None,
+    Float3,
+    Float2,
+    Snorm10x3,
+    Unorm16x2
+};
+
+struct VertexLayout {
+    enum Location : uint8_t {
+        Position,
+        Normal,
+        UV,
+        Color,
+        LocationCount
+    };
+
+    struct Attribute {
+        VertexFormat format = VertexFormat::None;
+        uint32_t offset = 0;
+    };
+
+    std::array<Attribute, LocationCount> attributes;
+    uint32_t stride = 0;
+
+    static VertexLayout fromFormats(const std::array<VertexFormat, LocationCount>& formats);
+    static VertexLayout choose(const Vertex* vertices, size_t count, const MeshProperties& flags);
+    static uint32_t formatSize(VertexFormat format);
+
+    bool has(Location location) const { return attributes[location].format != VertexFormat::None; }
+
+    std::vector<unsigned char> pack(const Vertex* vertices, size_t count) const;
+    Vertex unpack(const unsigned char* vertex) const; // missing attributes come back as Vertex defaults
+    glm::vec3 unpackPosition(const unsigned char* vertex) const;
+
+    uint32_t encode() const;
+    static bool decode(uint32_t code, VertexLayout& layout);
+};
@@ -0,0 +1,247 @@
+#include "InstancePersistence.hpp"
+
+#include <array>
+#include <cstring>
+#include <string>
+
+using json = nlohmann::json;
+
+namespace {
+    struct {
+        const char* count  = "count";
+        const char* stride = "stride";
+        const char* data   = "data";
+    } instanceLabels;
+
+    struct {
+        const char* type          = "type";
+        const char* seed          = "seed";
+        const char* gridCount     = "gridCount";
+        const char* spacing       = "spacing";
+        const char* count         = "count";
+        const char* boxMin        = "boxMin";
+        const char* boxMax        = "boxMax";
+        const char* stratify      = "stratify";
+        const char* radiusStep    = "radiusStep";
+        const char* angleStep     = "angleStep";
+        const char* heightStep    = "heightStep";
+        const char* sourceModelID = "sourceModelID";
+        const char* sourceMeshIdx = "sourceMeshIdx";
+        const char* randomYaw     = "randomYaw";
+        const char* scaleRange    = "scaleRange";
+    } generatorLabels;
+
+    const char* base64Chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    std::array<float, InstancePersistence::FLOATS_PER_INSTANCE> flatten(const InstanceData& instance) {
+        return {
+            instance.pos.x, instance.pos.y, instance.pos.z,
+            instance.rotation.x, instance.rotation.y, instance.rotation.z,
+            instance.scale.x, instance.scale.y, instance.scale.z,
+            instance.custom.r, instance.custom.g, instance.custom.b, instance.custom.a
+        };
+    }
+
+    InstanceData unflatten(const float* v) {
+        InstanceData instance;
+        instance.pos      = glm::vec3(v[0], v[1], v[2]);
+        instance.rotation = glm::vec3(v[3], v[4], v[5]);
+        instance.scale    = glm::vec3(v[6], v[7], v[8]);
+        instance.custom   = glm::vec4(v[9], v[10], v[11], v[12]);
+        return instance;
+    }
+
+    bool hasDefaultTransform(const InstanceData& instance) {
+        InstanceData defaults;
+        return instance.rotation == defaults.rotation && instance.scale == defaults.scale && instance.custom == defaults.custom;
+    }
+
+    std::string encodeBase64(const unsigned char* bytes, size_t size) {
+        std::string out;
+        out.reserve((size + 2) / 3 * 4);
+        for (size_t i = 0; i < size; i += 3) {
+            unsigned int chunk = bytes[i] << 16;
+            if (i + 1 < size) chunk |= bytes[i + 1] << 8;
+            if (i + 2 < size) chunk |= bytes[i + 2];
+
+            out += base64Chars[(chunk >> 18) & 63];
+            out += base64Chars[(chunk >> 12) & 63];
+            out += i + 1 < size ? base64Chars[(chunk >> 6) & 63] : '=';
+            out += i + 2 < size ? base64Chars[chunk & 63] : '=';
+        }
+        return out;
+    }
+
+    bool decodeBase64(const std::string& text, std::vector<unsigned char>& bytes) {
+        if (text.size() % 4 != 0) return false;
+
+        std::array<int, 256> lookup;
+        lookup.fill(-1);
+        for (int i = 0; i < 64; i++) lookup[(unsigned char)base64Chars[i]] = i;
+
+        bytes.clear();
+        bytes.reserve(text.size() / 4 * 3);
+        for (size_t i = 0; i < text.size(); i += 4) {
+            unsigned int chunk = 0;
+            int padding = 0;
+            for (size_t k = 0; k < 4; k++) {
+                char c = text[i + k];
+                if (c == '=' && i + 4 == text.size() && k >= 2) {
+                    padding++;
+                    chunk <<= 6;
+                    continue;
+                }
+                if (padding > 0 || lookup[(unsigned char)c] < 0) return false;
+                chunk = (chunk << 6) | lookup[(unsigned char)c];
+            }
+            bytes.push_back((chunk >> 16) & 0xFF);
+            if (padding < 2) bytes.push_back((chunk >> 8) & 0xFF);
+            if (padding < 1) bytes.push_back(chunk & 0xFF);
+        }
+        return true;
+    }
+}
+
+
+json InstancePersistence::save(const std::vector<InstanceData>& instances) {
+    if (instances.size() <= COMPACT_THRESHOLD) {
+        json list = json::array();
+        for (const InstanceData& instance : instances) {
+            if (hasDefaultTransform(instance)) {
+                list.push_back({ instance.pos.x, instance.pos.y, instance.pos.z });
+            }
+            else {
+                list.push_back(flatten(instance));
+            }
+        }
+        return list;
+    }
+
+    std::vector<float> floats;
+    floats.reserve(instances.size() * FLOATS_PER_INSTANCE);
+    for (const InstanceData& instance : instances) {
+        auto flat = flatten(instance);
+        floats.insert(floats.end(), flat.begin(), flat.end());
+    }
+
+    return json{
+        {instanceLabels.count, instances.size()},
+        {instanceLabels.stride, FLOATS_PER_INSTANCE},
+        {instanceLabels.data, encodeBase64(reinterpret_cast<const unsigned char*>(floats.data()), floats.size() * sizeof(float))}
+    };
+}
+
+
+bool InstancePersistence::load(const json& j, std::vector<InstanceData>& instances) {
+    instances.clear();
+
+    if (j.is_array()) {
+        instances.reserve(j.size());
+        for (const json& entry : j) {
+            if (!entry.is_array()) return false;
+
+            if (entry.size() == 3) {
+                InstanceData instance;
+                instance.pos = glm::vec3(entry.at(0).get<float>(), entry.at(1).get<float>(), entry.at(2).get<float>());
+                instances.push_back(instance);
+            }
+            else if (entry.size() == FLOATS_PER_INSTANCE) {
+                std::array<float, FLOATS_PER_INSTANCE> flat;
+                for (size_t i = 0; i < FLOATS_PER_INSTANCE; i++) flat[i] = entry.at(i).get<float>();
+                instances.push_back(unflatten(flat.data()));
+            }
+            else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    if (!j.is_object() || !j.contains(instanceLabels.data)) return false;
+
+    size_t count = j.value(instanceLabels.count, (size_t)0);
+    size_t stride = j.value(instanceLabels.stride, FLOATS_PER_INSTANCE);
+    if (stride != FLOATS_PER_INSTANCE) return false;
+
+    std::vector<unsigned char> bytes;
+    if (!decodeBase64(j.at(instanceLabels.data).get<std::string>(), bytes)) return false;
+    if (bytes.size() != count * stride * sizeof(float)) return false;
+
+    std::vector<float> floats(count * stride);
+    std::memcpy(floats.data(), bytes.data(), bytes.size());
+
+    instances.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        instances.push_back(unflatten(floats.data() + i * stride));
+    }
+    return true;
+}
+
+
+json InstancePersistence::saveGenerator(const InstanceGeneratorParams& params) {
+    return json{
+        {generatorLabels.type, static_cast<int>(params.type)},
+        {generatorLabels.seed, params.seed},
+        {generatorLabels.gridCount, {params.gridCount.x, params.gridCount.y, params.gridCount.z}},
+        {generatorLabels.spacing, {params.spacing.x, params.spacing.y, params.spacing.z}},
+        {generatorLabels.count, params.count},
+        {generatorLabels.boxMin, {params.boxMin.x, params.boxMin.y, params.boxMin.z}},
+        {generatorLabels.boxMax, {params.boxMax.x, params.boxMax.y, params.boxMax.z}},
+        {generatorLabels.stratify, params.stratify},
+        {generatorLabels.radiusStep, params.radiusStep},
+        {generatorLabels.angleStep, params.angleStep},
+        {generatorLabels.heightStep, params.heightStep},
+        {generatorLabels.sourceModelID, params.sourceModelID},
+        {generatorLabels.sourceMeshIdx, params.sourceMeshIdx},
+        {generatorLabels.randomYaw, params.randomYaw},
+        {generatorLabels.scaleRange, {params.scaleRange.x, params.scaleRange.y}}
+    };
+}
+
+
+bool InstancePersistence::loadGenerator(const json& j, InstanceGeneratorParams& params) {
+    if (!j.is_object()) return false;
+
+    try {
+        InstanceGeneratorParams loaded;
+        int type = j.at(generatorLabels.type).get<int>();
+        if (type < 0 || type > static_cast<int>(InstanceGeneratorType::MeshVertices)) return false;
+        loaded.type = static_cast<InstanceGeneratorType>(type);
+
+        // anything missing keeps its default, so new parameters don't break older saves
+        loaded.seed = j.value(generatorLabels.seed, loaded.seed);
+        if (j.contains(generatorLabels.gridCount)) {
+            const json& v = j.at(generatorLabels.gridCount);
+            loaded.gridCount = glm::uvec3(v.at(0).get<unsigned int>(), v.at(1).get<unsigned int>(), v.at(2).get<unsigned int>());
+        }
+        if (j.contains(generatorLabels.spacing)) {
+            const json& v = j.at(generatorLabels.spacing);
+            loaded.spacing = glm::vec3(v.at(0).get<float>(), v.at(1).get<float>(), v.at(2).get<float>());
+        }
+        loaded.count = j.value(generatorLabels.count, loaded.count);
+        if (j.contains(generatorLabels.boxMin)) {
+            const json& v = j.at(generatorLabels.boxMin);
+            loaded.boxMin = glm::vec3(v.at(0).get<float>(), v.at(1).get<float>(), v.at(2).get<float>());
+        }
+        if (j.contains(generatorLabels.boxMax)) {
+            const json& v = j.at(generatorLabels.boxMax);
+            loaded.boxMax = glm::vec3(v.at(0).get<float>(), v.at(1).get<float>(), v.at(2).get<float>());
+        }
+        loaded.stratify = j.value(generatorLabels.stratify, loaded.stratify);
+        loaded.radiusStep = j.value(generatorLabels.radiusStep, loaded.radiusStep);
+        loaded.angleStep = j.value(generatorLabels.angleStep, loaded.angleStep);
+        loaded.heightStep = j.value(generatorLabels.heightStep, loaded.heightStep);
+        loaded.sourceModelID = j.value(generatorLabels.sourceModelID, loaded.sourceModelID);
+        loaded.sourceMeshIdx = j.value(generatorLabels.sourceMeshIdx, loaded.sourceMeshIdx);
+        loaded.randomYaw = j.value(generatorLabels.randomYaw, loaded.randomYaw);
+        if (j.contains(generatorLabels.scaleRange)) {
+            const json& v = j.at(generatorLabels.scaleRange);
+            loaded.scaleRange = glm::vec2(v.at(0).get<float>(), v.at(1).get<float>());
+        }
+        params = loaded;
+        return true;
+    }
+    catch (const json::exception&) {
+        return false;
+    }
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <vector>
+
+#include "object/InstanceData.hpp"
+#include "object/InstanceGenerator.hpp"
+
+// Instance arrays in the project file. Small arrays stay readable, one entry per instance:
+//     [x, y, z]                              position only, everything else default
+//     [x, y, z, rx, ry, rz, sx, sy, sz, r, g, b, a]
+// Above COMPACT_THRESHOLD instances they are written as one base64 block of little-endian
+// floats, FLOATS_PER_INSTANCE per instance in the order above:
+//     { "count": n, "stride": 13, "data": "..." }
+// load() accepts either form, so older projects (positions only) still open.
+//
+// Generated instances aren't written at all, only the generator parameters (saveGenerator),
+// and are regenerated on load.
+struct InstancePersistence {
+    static constexpr size_t COMPACT_THRESHOLD = 64;
+    static constexpr size_t FLOATS_PER_INSTANCE = 13;
+
+    static nlohmann::json save(const std::vector<InstanceData>& instances);
+    static bool load(const nlohmann::json& j, std::vector<InstanceData>& instances);
+    static nlohmann::json saveGenerator(const InstanceGeneratorParams& params);
+    static bool loadGenerator(const nlohmann::json& j, InstanceGeneratorParams& params);
+};
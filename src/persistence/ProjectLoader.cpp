@@ -10,6 +10,7 @@
 #include "object/MaterialCache.hpp"
 #include <core/ShaderRegistry.hpp>
 #include <persistence/UniformPersistence.hpp>
+#include <persistence/InstancePersistence.hpp>
 
 #include "core/EventTypes.hpp"
 
@@ -44,10 +45,6 @@ namespace {
     };
 }
 
-inline void to_json(json& j, const InstanceData& m) {
-    j = {m.pos.x, m.pos.y, m.pos.z};
-}
-
 inline void to_json(json& j, const ModelEntry& modelData){
     j = {
         {"name", modelData.name},
@@ -57,11 +54,17 @@ inline void to_json(json& j, const ModelEntry& modelData){
         {"isSkybox", modelData.isSkybox},
 
         {"meshMaterialIDs", modelData.meshMaterialIDs},
-        {"instanceData", modelData.instanceData},
+        {"instanceData", InstancePersistence::save(modelData.instanceData)},
         {"position", {modelData.position.x, modelData.position.y, modelData.position.z}},
         {"scale", {modelData.scale.x, modelData.scale.y, modelData.scale.z}},
         {"rotation", {modelData.rotation.x, modelData.rotation.y, modelData.rotation.z}}
     };
+    if (modelData.instanceGenerator.type != InstanceGeneratorType::None) {
+        j["instanceGenerator"] = InstancePersistence::saveGenerator(modelData.instanceGenerator);
+    }
+    if (modelData.lodOverride >= 0) {
+        j["lodOverride"] = modelData.lodOverride;
+    }
 }
 
 inline void to_json(json& j, const MaterialProperties& matProps) {
@@ -86,12 +89,6 @@ inline void to_json(json& j, const MaterialEntry& materialData) {
 }
 
 
-    inline void from_json(const json& j, InstanceData& instData) {
-        instData.pos.x = j.at(0).get<float>();
-        instData.pos.y = j.at(1).get<float>();
-        instData.pos.z = j.at(2).get<float>();
-    }
-
 inline void from_json(const json& j, ModelEntry& modelData) {
     modelData.name = j.at("name").get<std::string>();
     modelData.ID = j.at("ID").get<unsigned int>();
@@ -100,7 +97,12 @@ inline void from_json(const json& j, ModelEntry& modelData) {
     modelData.isSkybox = j.at("isSkybox").get<bool>();
 
     modelData.meshMaterialIDs = j.at("meshMaterialIDs").get<std::vector<unsigned int>>();
-    modelData.instanceData = j.at("instanceData").get<std::vector<InstanceData>>(); // uses InstanceData::from_json
+    if (!InstancePersistence::load(j.at("instanceData"), modelData.instanceData)) {
+        modelData.instanceData.clear(); // Model::loadInstanceData falls back to a single instance
+    }
+    if (j.contains("instanceGenerator")) {
+        InstancePersistence::loadGenerator(j.at("instanceGenerator"), modelData.instanceGenerator);
+    }
 
     auto pos = j.at("position");
     modelData.position = glm::vec3(
@@ -122,6 +124,7 @@ inline void from_json(const json& j, ModelEntry& modelData) {
         rotation.at(1).get<float>(),
         rotation.at(2).get<float>()
     );
+    modelData.lodOverride = j.value("lodOverride", -1);
 }
 
 inline void from_json(const json& j, MaterialProperties& matProps) {
@@ -322,10 +325,14 @@ void ProjectLoader::save(Project& project, ModelCache* modelCachePtr, MaterialCa
             .isSkybox = model->getID() == modelCachePtr->getSkyboxModelID(),
 
             .meshMaterialIDs = model->getAllMaterialIDsPerMesh(),
-            .instanceData = model->getInstanceData(),
+            // generated sets are rebuilt from their parameters on load
+            .instanceData = model->getInstanceGenerator().type == InstanceGeneratorType::None 
+                ? model->getInstanceData() : std::vector<InstanceData>{},
+            .instanceGenerator = model->getInstanceGenerator(),
             .position = model->getPosition(),
             .scale = model->getScale(),
-            .rotation = model->getRotation()
+            .rotation = model->getRotation(),
+            .lodOverride = model->getLODOverride()
         };
         project.modelData.push_back(modelEntry);
     }
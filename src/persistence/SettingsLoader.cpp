@@ -3,6 +3,7 @@
 #include <nlohmann/json.hpp>
 #include <fstream>
 #include <filesystem>
+#include <algorithm>
 #include "application/AppContext.hpp"
 
 using json = nlohmann::json;
@@ -50,6 +51,13 @@ bool SettingsLoader::load(AppSettings& settings) {
 
         // Load graphics
         settings.vsyncEnabled = j.value("vsync", settings.vsyncEnabled);
+        settings.optimizeImportedMeshes = j.value("optimizeImportedMeshes", settings.optimizeImportedMeshes);
+        settings.frustumCulling = j.value("frustumCulling", settings.frustumCulling);
+        int occlusionMode = j.value("occlusionMode", (int)settings.occlusionMode);
+        if (occlusionMode >= 0 && occlusionMode <= (int)OcclusionMode::Queries) settings.occlusionMode = (OcclusionMode)occlusionMode;
+        settings.levelOfDetail = j.value("levelOfDetail", settings.levelOfDetail);
+        settings.lodPixelError = std::clamp(j.value("lodPixelError", settings.lodPixelError), 0.25f, 16.0f);
+        settings.batchDraws = j.value("batchDraws", settings.batchDraws);
 
         settings.settingsFound = true;
     } catch (...) {
@@ -80,6 +88,12 @@ void SettingsLoader::save(const AppSettings& settings) {
     settings.styles.saveStyles(j);
 
     j["vsync"] = settings.vsyncEnabled;
+    j["optimizeImportedMeshes"] = settings.optimizeImportedMeshes;
+    j["frustumCulling"] = settings.frustumCulling;
+    j["occlusionMode"] = (int)settings.occlusionMode;
+    j["levelOfDetail"] = settings.levelOfDetail;
+    j["lodPixelError"] = settings.lodPixelError;
+    j["batchDraws"] = settings.batchDraws;
 
     std::ofstream out(settings.settingsPath);
     out << j.dump(4);
@@ -0,0 +1,87 @@
+#include "platform/DiskCacheFile.hpp"
+
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+
+uint64_t DiskCacheFile::hashBytes(const void* data, size_t size, uint64_t hash) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+
+bool DiskCacheFile::hashFile(const fs::path& path, uint64_t& hash) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    hash = HASH_SEED;
+    std::vector<char> buffer(1 << 16);
+    while (file) {
+        file.read(buffer.data(), buffer.size());
+        hash = hashBytes(buffer.data(), (size_t)file.gcount(), hash);
+    }
+    return true;
+}
+
+
+bool DiskCacheFile::statFile(const fs::path& path, uint64_t& size, int64_t& mtime) {
+    std::error_code error;
+    size = fs::file_size(path, error);
+    if (error) return false;
+    auto writeTime = fs::last_write_time(path, error);
+    if (error) return false;
+    mtime = (int64_t)writeTime.time_since_epoch().count();
+    return true;
+}
+
+
+std::string DiskCacheFile::pathKey(const std::string& sourcePath) {
+    std::error_code error;
+    std::string key = fs::weakly_canonical(sourcePath, error).generic_string();
+    if (error) key = sourcePath;
+    return key;
+}
+
+
+std::string DiskCacheFile::hexName(uint64_t hash) {
+    std::ostringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return name.str();
+}
+
+
+// the temporary name carries the thread, two workers storing the same blob don't share one
+bool DiskCacheFile::writeAtomically(const fs::path& path, const std::function<void(std::ofstream&)>& write) {
+    std::ostringstream tempSuffix;
+    tempSuffix << ".tmp" << std::this_thread::get_id();
+    fs::path tempPath = path;
+    tempPath += tempSuffix.str();
+
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file) return false;
+        write(file);
+        if (!file) {
+            file.close();
+            std::error_code ignored;
+            fs::remove(tempPath, ignored);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    fs::rename(tempPath, path, error);
+    if (error) {
+        fs::remove(tempPath, error);
+        return false;
+    }
+    return true;
+}
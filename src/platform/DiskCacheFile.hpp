@@ -0,0 +1,35 @@
+// DESCRIPTION
+/*
+DiskCacheFile holds the file handling every on-disk cache shares (TextureDiskCache,
+MeshDiskCache, ProgramBinaryCache): naming blobs after a hash, checking a source file's size and
+modification time, hashing its content, and writing a blob so that no reader ever sees half of it.
+
+Nothing here knows a blob format, each cache writes and validates its own.
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+
+struct DiskCacheFile {
+    static constexpr uint64_t HASH_SEED = 14695981039346656037ull;
+
+    // FNV-1a, only has to notice edits, not resist anyone. Chain calls by passing the last result
+    static uint64_t hashBytes(const void* data, size_t size, uint64_t hash = HASH_SEED);
+    static bool hashFile(const std::filesystem::path& path, uint64_t& hash);
+
+    static bool statFile(const std::filesystem::path& path, uint64_t& size, int64_t& mtime);
+
+    // the canonical form of a source path, so two spellings of one file share a blob
+    static std::string pathKey(const std::string& sourcePath);
+    // 16 lowercase hex digits, the way blob names spell hashes
+    static std::string hexName(uint64_t hash);
+
+    // writes through a temporary file next to path, then renames it over path. Returns false and
+    // leaves nothing behind if write leaves the stream failed. Safe to call from several threads
+    static bool writeAtomically(const std::filesystem::path& path, const std::function<void(std::ofstream&)>& write);
+};
@@ -0,0 +1,35 @@
+// DESCRIPTION
+/*
+MappedFile maps a whole file read-only into memory. The pages are filled by the OS on first
+touch, so opening a large file is cheap and only the bytes actually read cost anything.
+
+The mapping lives as long as the MappedFile, anything pointing into data() has to keep it
+alive (MeshA holds a shared_ptr to the one its vertices come from).
+*/
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::filesystem::path& path);
+    void close();
+
+    bool isOpen() const { return mapping != nullptr; }
+    const unsigned char* data() const { return static_cast<const unsigned char*>(mapping); }
+    size_t size() const { return mappedSize; }
+
+private:
+    void* mapping = nullptr;
+    size_t mappedSize = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
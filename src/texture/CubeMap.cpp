@@ -2,7 +2,6 @@
 
 #include "../core/logging/Logger.hpp"
 #include "core/logging/LogSink.hpp"
-#include <stb_image.h>
 
 CubeMap::CubeMap(std::vector<std::string> cubemap_paths) : Texture(cubemap_paths) {
     status = TextureStatus::Ready;
@@ -10,46 +9,58 @@ CubeMap::CubeMap(std::vector<std::string> cubemap_paths) : Texture(cubemap_paths
 
 
 bool CubeMap::bind(unsigned int texUnit) {
+    // still decoding on the TextureCache pool, the caller binds the missing texture meanwhile
+    if (status == TextureStatus::Loading) return false;
+
+    // select the unit first so a first time upload only disturbs the unit being bound
+    glActiveTexture(GL_TEXTURE0 + texUnit);
     loadToGPU();
     if (status != TextureStatus::Loaded) return false;
-    glActiveTexture(GL_TEXTURE0 + texUnit);
     glBindTexture(GL_TEXTURE_CUBE_MAP, gl_ID);
     this->texUnit = texUnit;
     return true;
 }
 
 
-void CubeMap::loadToGPU() {
-    if (status == TextureStatus::Loaded) return;
+bool CubeMap::flipsOnDecode() const {
+    return false;
+}
+
 
-    unsigned char* data;
-    GLenum format;
-    int width, height, channelCnt;
+bool CubeMap::wantsMipmaps() const {
+    return false;
+}
+
+
+void CubeMap::upload(const TextureDecode& decoded) {
+    if (status == TextureStatus::Loaded) return;
+    if (decoded.images.size() != paths.size()) {
+        status = TextureStatus::FileNotFound;
+        return;
+    }
 
     glGenTextures(1, &gl_ID);
     glBindTexture(GL_TEXTURE_CUBE_MAP, gl_ID);
-    stbi_set_flip_vertically_on_load(false);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     
-    for (unsigned int i = 0; i < paths.size(); i++) {
-        data = stbi_load(paths[i].c_str(), &width, &height, &channelCnt, 0);
-        if (data == nullptr) {
-            status = TextureStatus::FileNotFound;
-            return;
-        }
-
-        switch (channelCnt) {
+    for (unsigned int i = 0; i < decoded.images.size(); i++) {
+        const DecodedImage& image = decoded.images[i];
+        GLenum format;
+        switch (image.channels) {
             case 1: format = GL_RED;  break;
             case 3: format = GL_RGB;  break;
             case 4: format = GL_RGBA; break;
             default: 
                 status = TextureStatus::InvalidFormat;
+                glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+                glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
                 return;
         }
 
-        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        stbi_image_free(data);
+        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, image.levelData(0));
         // glGenerateMipmap(GL_TEXTURE_2D);
     }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 
     // Texture Settings:
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
@@ -13,5 +13,7 @@ class CubeMap final : public Texture{
         bool bind(unsigned int texUnit) override;
 
     private:
-        void loadToGPU() override;
+        bool flipsOnDecode() const override;
+        bool wantsMipmaps() const override;
+        void upload(const TextureDecode& decoded) override;
 };
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include "DecodedImage.hpp"
+#include "TextureDiskCache.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stb_image.h>
+
+
+void DecodedImage::setBaseLevel(const unsigned char* pixels, int _width, int _height, int _channels) {
+    width = _width;
+    height = _height;
+    channels = _channels;
+
+    size_t size = (size_t)width * height * channels;
+    texels.assign(pixels, pixels + size);
+    levels.assign(1, Level{ width, height, 0, size });
+}
+
+
+void DecodedImage::generateMips() {
+    if (levels.empty()) return;
+    levels.resize(1);
+    texels.resize(levels[0].size);
+
+    // reserve the whole chain up front, a chain is at most 4/3 of the base level
+    texels.reserve(levels[0].size + levels[0].size / 3 + 64);
+
+    while (levels.back().width > 1 || levels.back().height > 1) {
+        Level source = levels.back();
+        Level level;
+        level.width = std::max(1, source.width / 2);
+        level.height = std::max(1, source.height / 2);
+        level.offset = texels.size();
+        level.size = (size_t)level.width * level.height * channels;
+        texels.resize(texels.size() + level.size);
+
+        const unsigned char* src = texels.data() + source.offset;
+        unsigned char* dst = texels.data() + level.offset;
+        for (int y = 0; y < level.height; y++) {
+            // a dimension already at 1 stays put, the other one still halves
+            int y0 = std::min(y * 2, source.height - 1);
+            int y1 = std::min(y * 2 + 1, source.height - 1);
+            for (int x = 0; x < level.width; x++) {
+                int x0 = std::min(x * 2, source.width - 1);
+                int x1 = std::min(x * 2 + 1, source.width - 1);
+                for (int c = 0; c < channels; c++) {
+                    unsigned int sum = src[((size_t)y0 * source.width + x0) * channels + c]
+                                     + src[((size_t)y0 * source.width + x1) * channels + c]
+                                     + src[((size_t)y1 * source.width + x0) * channels + c]
+                                     + src[((size_t)y1 * source.width + x1) * channels + c];
+                    dst[((size_t)y * level.width + x) * channels + c] = (unsigned char)((sum + 2) / 4);
+                }
+            }
+        }
+        levels.push_back(level);
+    }
+}
+
+
+TextureDecode TextureDecode::decode(const std::vector<std::string>& paths, bool flipVertically, bool withMips, 
+                                    const TextureDiskCache* diskCache) {
+    TextureDecode result;
+    result.images.reserve(paths.size());
+
+    // the per thread flag, the global one would race between pool workers
+    stbi_set_flip_vertically_on_load_thread(flipVertically ? 1 : 0);
+    for (const std::string& path : paths) {
+        DecodedImage image;
+        if (diskCache != nullptr && diskCache->load(path, flipVertically, withMips, image)) {
+            result.images.push_back(std::move(image));
+            continue;
+        }
+
+        int width, height, channels;
+        std::unique_ptr<unsigned char, void(*)(void*)> pixels(stbi_load(path.c_str(), &width, &height, &channels, 0), stbi_image_free);
+        if (pixels == nullptr) {
+            result.status = TextureStatus::FileNotFound;
+            result.images.clear();
+            return result;
+        }
+        if (channels != 1 && channels != 3 && channels != 4) {
+            result.status = TextureStatus::InvalidFormat;
+            result.images.clear();
+            return result;
+        }
+
+        image.setBaseLevel(pixels.get(), width, height, channels);
+        pixels.reset();
+        if (withMips) image.generateMips();
+        if (diskCache != nullptr) diskCache->store(path, flipVertically, withMips, image);
+        result.images.push_back(std::move(image));
+    }
+
+    result.status = TextureStatus::Loaded;
+    return result;
+}
+
+
+size_t TextureDecode::byteSize() const {
+    size_t total = 0;
+    for (const DecodedImage& image : images) total += image.byteSize();
+    return total;
+}
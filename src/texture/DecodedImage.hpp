@@ -0,0 +1,41 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "TextureStatus.hpp"
+
+class TextureDiskCache;
+
+// texels for one image, every mip level back to back starting with the full size one
+struct DecodedImage {
+    struct Level {
+        int width = 0;
+        int height = 0;
+        size_t offset = 0; // into texels
+        size_t size = 0;
+    };
+
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    std::vector<unsigned char> texels;
+    std::vector<Level> levels;
+
+    size_t byteSize() const { return texels.size(); }
+    const unsigned char* levelData(size_t level) const { return texels.data() + levels[level].offset; }
+    void setBaseLevel(const unsigned char* pixels, int width, int height, int channels);
+    void generateMips(); // box filtered down to 1x1, replaces glGenerateMipmap
+};
+
+// Decoding touches no GL and no shared state, it is safe to run on any thread.
+// status is Loaded on success, otherwise the error to put on the texture.
+struct TextureDecode {
+    TextureStatus status = TextureStatus::Ready;
+    std::vector<DecodedImage> images; // one per path
+
+    // diskCache is checked before decoding and filled after, nullptr decodes every time
+    static TextureDecode decode(const std::vector<std::string>& paths, bool flipVertically, bool withMips, 
+                                const TextureDiskCache* diskCache = nullptr);
+    size_t byteSize() const;
+};
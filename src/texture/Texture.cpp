@@ -60,6 +60,21 @@ void Texture::setName(std::string name) {
 }
 
 
+void Texture::loadToGPU() {
+    if (status == TextureStatus::Loaded) return;
+    finishLoad(TextureDecode::decode(paths, flipsOnDecode(), wantsMipmaps()));
+}
+
+
+void Texture::finishLoad(const TextureDecode& decoded) {
+    if (decoded.status != TextureStatus::Loaded) {
+        status = decoded.status;
+        return;
+    }
+    upload(decoded);
+}
+
+
 void Texture::unloadFromGPU() {
     if (status == TextureStatus::Ready) return;
     glDeleteTextures(1, &gl_ID);
@@ -6,6 +6,7 @@
 #include <vector>
 #include <limits> 
 #include "TextureStatus.hpp"
+#include "DecodedImage.hpp"
 
 class Logger;
 
@@ -34,6 +35,12 @@ protected:
     TextureStatus status;
     unsigned int texUnit = std::numeric_limits<unsigned int>::max();
     
-    virtual void loadToGPU() = 0;
+    void loadToGPU();                           // decode and upload on the calling thread
+    void finishLoad(const TextureDecode& decoded); // GL thread, uploads a decode made elsewhere
+    virtual bool flipsOnDecode() const = 0;
+    virtual bool wantsMipmaps() const = 0;
+    virtual void upload(const TextureDecode& decoded) = 0;
     void unloadFromGPU();  
+
+    friend class TextureCache;
 };
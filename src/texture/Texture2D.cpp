@@ -1,7 +1,6 @@
 #include "Texture2D.hpp"
 #include "../core/logging/Logger.hpp"
 #include "../core/logging/LogSink.hpp"
-#include <stb_image.h>
 
 #include <iostream> //TEMPADD
 
@@ -11,31 +10,36 @@ Texture2D::Texture2D(std::string texture_path) : Texture(texture_path) {
 
 
 bool Texture2D::bind(unsigned int texUnit) {
+    // still decoding on the TextureCache pool, the caller binds the missing texture meanwhile
+    if (status == TextureStatus::Loading) return false;
+
+    // select the unit first so a first time upload only disturbs the unit being bound
+    glActiveTexture(GL_TEXTURE0 + texUnit);
     loadToGPU();
     if (status != TextureStatus::Loaded) return false;
 
-    glActiveTexture(GL_TEXTURE0 + texUnit);
     glBindTexture(GL_TEXTURE_2D, gl_ID);
     this->texUnit = texUnit;
     return true;
 }
 
 
-void Texture2D::loadToGPU() {
-    if (status == TextureStatus::Loaded) return;
+bool Texture2D::flipsOnDecode() const {
+    return true;
+}
 
-    stbi_set_flip_vertically_on_load(true);
-    unsigned char* data;
-    GLenum format;
-    int width, height, channelCnt;
-    data = stbi_load(paths[0].c_str(), &width, &height, &channelCnt, 0);
-    if (data == nullptr) {
-        status = TextureStatus::FileNotFound;
-        
-        return;
-    }
 
-    switch (channelCnt) {
+bool Texture2D::wantsMipmaps() const {
+    return true;
+}
+
+
+void Texture2D::upload(const TextureDecode& decoded) {
+    if (status == TextureStatus::Loaded || decoded.images.empty()) return;
+
+    const DecodedImage& image = decoded.images[0];
+    GLenum format;
+    switch (image.channels) {
         case 1: format = GL_RED;  break;
         case 3: format = GL_RGB;  break;
         case 4: format = GL_RGBA; break;
@@ -46,8 +50,20 @@ void Texture2D::loadToGPU() {
 
     glGenTextures(1, &gl_ID);
     glBindTexture(GL_TEXTURE_2D, gl_ID);
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
+    // rows of odd width RGB levels aren't 4 byte aligned
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (size_t level = 0; level < image.levels.size(); level++) {
+        const DecodedImage::Level& levelInfo = image.levels[level];
+        glTexImage2D(GL_TEXTURE_2D, (GLint)level, format, levelInfo.width, levelInfo.height, 0, format, GL_UNSIGNED_BYTE, image.levelData(level));
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    // the mip chain comes built from the decode (and the disk cache), only generate it if it didn't
+    if (image.levels.size() > 1) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)image.levels.size() - 1);
+    }
+    else {
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
 
     // Texture Settings:
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -57,6 +73,4 @@ void Texture2D::loadToGPU() {
 
     glBindTexture(GL_TEXTURE_2D, 0); //unbind
     status = TextureStatus::Loaded;
-
-    return;
 }
\ No newline at end of file
@@ -5,21 +5,42 @@
 #include "TextureStatus.hpp"
 
 
-bool TextureCache::initialize(Logger* _loggerPtr) {
+bool TextureCache::initialize(Logger* _loggerPtr, const std::filesystem::path& diskCacheDir) {
     
     loggerPtr = _loggerPtr;
+    if (!diskCacheDir.empty() && !diskCache.initialize(diskCacheDir)) {
+        loggerPtr->addLog(LogLevel::WARNING, "TEXTURECACHE | initialize()", "could not create texture cache directory, decoding every time: " + diskCacheDir.string());
+    }
     std::vector<std::string> missingTexturePaths(6, "../assets/textures/missingTexture.png");
 
     missingTexture2D = std::make_unique<Texture2D>(Texture2D(missingTexturePaths[0]));
     missingCubemap = std::make_unique<CubeMap>(CubeMap(missingTexturePaths));
+
+    // decoding is mostly disk and inflate, a couple of threads keep up without starving the rest
+    decodePool = std::make_unique<ThreadPool>(2);
     
     return true;
 }
 
 
+void TextureCache::shutdown() {
+    if (decodePool != nullptr) {
+        decodePool->shutdown();
+        decodePool.reset();
+    }
+    std::lock_guard<std::mutex> lock(finishedMutex);
+    finishedDecodes.clear();
+}
+
+
 TextureCache::TextureCache() {}
 
 
+TextureCache::~TextureCache() {
+    shutdown();
+}
+
+
 unsigned int TextureCache::createTexture2D(std::filesystem::path texture2D_path) {
     unsigned int newTextureID;
 
@@ -38,6 +59,7 @@ unsigned int TextureCache::createTexture2D(std::filesystem::path texture2D_path)
         textureIDMap.emplace(newTextureID, textureInstancePtr);
         texturePathMap.emplace(texture2D_path.string(), textureInstancePtr);
         assignName(newTextureID, texture2D_path.filename().string());
+        requestDecode(*textureInstancePtr);
         nextTextureID++;
     }
     return newTextureID;
@@ -61,6 +83,7 @@ unsigned int TextureCache::createCubeMap(std::vector<std::filesystem::path> text
     auto textureInstancePtr = std::make_shared<TextureInstance>(std::make_unique<CubeMap>(paths_str), 1, newTextureID);
     textureIDMap.emplace(newTextureID, textureInstancePtr);
     assignName(newTextureID, "cubemap");
+    requestDecode(*textureInstancePtr);
     nextTextureID++;
     
     return newTextureID;
@@ -75,31 +98,41 @@ void TextureCache::deleteTexture(unsigned int textureID) {
     }
 
     if ((--foundTextureInstance->refCount) == 0) {
-        if (foundTextureInstance->texture->paths[1].empty()) {
-        texturePathMap.erase(foundTextureInstance->texture->paths[0]);
+        // only single path textures are shared by path, cubemaps never enter texturePathMap
+        if (foundTextureInstance->texture->paths.size() == 1) {
+            texturePathMap.erase(foundTextureInstance->texture->paths[0]);
         }
         textureIDMap.erase(textureID);
     }
 }
 
 
-void TextureCache::bindTexture(unsigned int textureID, unsigned int texUnit) {
+bool TextureCache::bindTexture(unsigned int textureID, unsigned int texUnit) {
     TextureInstance* foundTextureInstance = getTextureInstance(textureID);
     if (foundTextureInstance == nullptr) {
         loggerPtr->addLog(LogLevel::LOG_ERROR, "TEXTURECACHE | bindTexture()", " textureInstanceID out of bounds: ", std::to_string(textureID));
-        return;
+        return false;
     }
 
     if (texUnit > 31) {
         loggerPtr->addLog(LogLevel::LOG_ERROR, "TEXTURECACHE | bindTexture()", " texUnit must be 0-31");
-        return;
+        return false;
     }
 
     Texture* foundTexture = foundTextureInstance->texture.get();
     // Silently fail because texture is in error state
     if (foundTexture->getStatus() == TextureStatus::FileNotFound || foundTexture->getStatus() == TextureStatus::InvalidFormat) {
         bindDefault(texUnit);
-        return;
+        return false;
+    }
+
+    // not decoded yet (or unloaded since), decode in the background and stand in until it's uploaded
+    if (foundTexture->getStatus() == TextureStatus::Ready && decodePool != nullptr) {
+        requestDecode(*foundTextureInstance);
+    }
+    if (foundTexture->getStatus() == TextureStatus::Loading) {
+        bindDefault(texUnit);
+        return false;
     }
 
     if (foundTexture->bind(texUnit) == false) {
@@ -114,7 +147,9 @@ void TextureCache::bindTexture(unsigned int textureID, unsigned int texUnit) {
                 break;
         }
         bindDefault(texUnit);
+        return false;
     }
+    return true;
 }
 
 
@@ -123,6 +158,71 @@ void TextureCache::bindDefault(unsigned int texUnit) {
 }
 
 
+void TextureCache::requestDecode(TextureInstance& instance) {
+    if (decodePool == nullptr) return; // not initialized, bind() decodes synchronously instead
+
+    Texture* texture = instance.texture.get();
+    texture->status = TextureStatus::Loading;
+    instance.decodeTicket = nextDecodeTicket++;
+
+    // the job only gets copies, the texture may be deleted before it finishes
+    bool queued = decodePool->submit(
+        [this, textureID = instance.ID, ticket = instance.decodeTicket, paths = texture->paths, 
+         flip = texture->flipsOnDecode(), mips = texture->wantsMipmaps()]() {
+            TextureDecode decoded = TextureDecode::decode(paths, flip, mips, &diskCache);
+            std::lock_guard<std::mutex> lock(finishedMutex);
+            finishedDecodes.push_back(FinishedDecode{ textureID, ticket, std::move(decoded) });
+        }
+    );
+    if (!queued) texture->status = TextureStatus::Ready;
+}
+
+
+void TextureCache::processUploads(size_t byteBudget) {
+    size_t uploadedBytes = 0;
+    while (true) {
+        FinishedDecode finished;
+        {
+            std::lock_guard<std::mutex> lock(finishedMutex);
+            if (finishedDecodes.empty()) return;
+            // always let one through so a texture bigger than the budget still makes it
+            if (uploadedBytes > 0 && uploadedBytes + finishedDecodes.front().decoded.byteSize() > byteBudget) return;
+            finished = std::move(finishedDecodes.front());
+            finishedDecodes.pop_front();
+        }
+
+        TextureInstance* instance = getTextureInstance(finished.textureID);
+        if (instance == nullptr || instance->decodeTicket != finished.ticket) continue; // deleted or re-requested since
+
+        Texture* texture = instance->texture.get();
+        texture->finishLoad(finished.decoded);
+        switch (texture->getStatus()) {
+            case TextureStatus::FileNotFound:
+                loggerPtr->addLog(LogLevel::LOG_ERROR, "TEXTURECACHE | processUploads()", " texture path(s) could not be found: " + texture->getName());
+                break;
+            case TextureStatus::InvalidFormat:
+                loggerPtr->addLog(LogLevel::LOG_ERROR, "TEXTURECACHE | processUploads()", " unsupported channel count: " + texture->getName());
+                break;
+            default:
+                break;
+        }
+        uploadedBytes += finished.decoded.byteSize();
+    }
+}
+
+
+size_t TextureCache::getPendingDecodeCount() {
+    size_t pending = decodePool != nullptr ? decodePool->getPendingCount() : 0;
+    std::lock_guard<std::mutex> lock(finishedMutex);
+    return pending + finishedDecodes.size();
+}
+
+
+const TextureDiskCache& TextureCache::getDiskCache() const {
+    return diskCache;
+}
+
+
 TextureCache::TextureInstance* TextureCache::getTextureInstance(unsigned int textureID) {
     auto iter = textureIDMap.find(textureID);
     if (iter == textureIDMap.end()) {
@@ -6,11 +6,16 @@
 #include <string>
 #include <unordered_set>
 #include <filesystem>
+#include <mutex>
+#include <deque>
 
 #include "texture/Texture.hpp"
 #include "texture/TextureType.hpp"
 #include "texture/Texture2D.hpp"
 #include "texture/CubeMap.hpp"
+#include "texture/DecodedImage.hpp"
+#include "texture/TextureDiskCache.hpp"
+#include "engine/ThreadPool.hpp"
 
 class Logger;
 
@@ -22,17 +27,33 @@ private:
         std::unique_ptr<Texture> texture;
         unsigned int refCount;
         unsigned int ID;
+        uint64_t decodeTicket = 0; // matches a finished decode to the request that is still wanted
+    };
+
+    struct FinishedDecode {
+        unsigned int textureID;
+        uint64_t ticket;
+        TextureDecode decoded;
     };
 
 public:
-    bool initialize(Logger *_loggerPtr);
+    // decoded bytes uploaded per processUploads call, at least one texture always goes through
+    static constexpr size_t UPLOAD_BUDGET_BYTES = 32 * 1024 * 1024;
+
+    bool initialize(Logger *_loggerPtr, const std::filesystem::path& diskCacheDir = {}); // empty dir disables the disk cache
+    void shutdown();
     TextureCache();
-    ~TextureCache() = default;
+    ~TextureCache();
+
+    // call once per frame on the GL thread, uploads textures whose decode finished
+    void processUploads(size_t byteBudget = UPLOAD_BUDGET_BYTES);
+    size_t getPendingDecodeCount();
+    const TextureDiskCache& getDiskCache() const;
 
     unsigned int createTexture2D(std::filesystem::path texture2D_path);
     unsigned int createCubeMap(std::vector<std::filesystem::path> texture_paths);
     void deleteTexture(unsigned int ID);
-    void bindTexture(unsigned int ID, unsigned int texUnit);
+    bool bindTexture(unsigned int ID, unsigned int texUnit); // false if the missing texture was bound instead
     void bindDefault(unsigned int texUnit);
 
     std::vector<std::filesystem::path> getTexturePaths(unsigned int textureID);
@@ -48,7 +69,14 @@ private:
     std::unordered_set<std::string> allTextureNames;
     // std::unordered_map<unsigned int, std::unique_ptr<TextureInstance>> textureInstanceIDMap;
 
+    uint64_t nextDecodeTicket = 1;
+    std::mutex finishedMutex;
+    std::deque<FinishedDecode> finishedDecodes; // filled by pool workers, drained by processUploads
+    TextureDiskCache diskCache;
+    std::unique_ptr<ThreadPool> decodePool;     // declared after what its jobs touch, so it stops first
+
     TextureInstance* getTextureInstance(unsigned int TextureInstanceID);
+    void requestDecode(TextureInstance& instance);
     bool assignName(unsigned int textureID, std::string);
     bool validateNextID();
 
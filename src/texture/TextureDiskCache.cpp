@@ -0,0 +1,160 @@
+#include "TextureDiskCache.hpp"
+#include "DecodedImage.hpp"
+#include "platform/DiskCacheFile.hpp"
+#include "platform/MappedFile.hpp"
+
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr char BLOB_MAGIC[4] = { 'P', 'T', 'X', 'C' };
+    constexpr uint32_t BLOB_VERSION = 1;
+    constexpr uint32_t FLAG_FLIPPED = 1;
+    constexpr uint32_t FLAG_MIPS    = 2;
+    constexpr uint32_t MAX_LEVELS   = 32;
+
+    struct BlobHeader {
+        char magic[4];
+        uint32_t version;
+        uint64_t sourceSize;
+        int64_t sourceMtime;
+        uint64_t contentHash;
+        uint32_t flags;
+        int32_t width;
+        int32_t height;
+        int32_t channels;
+        uint32_t levelCount;
+        uint32_t padding;
+    };
+
+    struct BlobLevel {
+        int32_t width;
+        int32_t height;
+        uint64_t size;
+    };
+}
+
+
+bool TextureDiskCache::initialize(const fs::path& cacheDir) {
+    std::error_code error;
+    fs::create_directories(cacheDir, error);
+    if (error) {
+        directory.clear();
+        return false;
+    }
+    directory = cacheDir;
+    return true;
+}
+
+
+bool TextureDiskCache::isEnabled() const {
+    return !directory.empty();
+}
+
+
+fs::path TextureDiskCache::blobPath(const std::string& sourcePath, bool flipped, bool withMips) const {
+    std::string key = DiskCacheFile::pathKey(sourcePath);
+    key += flipped ? "|flip" : "|noflip";
+    key += withMips ? "|mips" : "|base";
+    return directory / (DiskCacheFile::hexName(DiskCacheFile::hashBytes(key.data(), key.size())) + ".tex");
+}
+
+
+bool TextureDiskCache::load(const std::string& sourcePath, bool flipped, bool withMips, DecodedImage& image) const {
+    if (!isEnabled()) return false;
+
+    uint64_t sourceSize;
+    int64_t sourceMtime;
+    if (!DiskCacheFile::statFile(sourcePath, sourceSize, sourceMtime)) return false;
+
+    MappedFile blob;
+    if (!blob.open(blobPath(sourcePath, flipped, withMips)) || blob.size() < sizeof(BlobHeader)) {
+        misses++;
+        return false;
+    }
+
+    BlobHeader header;
+    std::memcpy(&header, blob.data(), sizeof(header));
+    uint32_t expectedFlags = (flipped ? FLAG_FLIPPED : 0) | (withMips ? FLAG_MIPS : 0);
+    if (std::memcmp(header.magic, BLOB_MAGIC, 4) != 0 || header.version != BLOB_VERSION 
+        || header.flags != expectedFlags || header.levelCount == 0 || header.levelCount > MAX_LEVELS
+        || header.sourceSize != sourceSize
+        || blob.size() < sizeof(BlobHeader) + header.levelCount * sizeof(BlobLevel)) {
+        misses++;
+        return false;
+    }
+
+    if (header.sourceMtime != sourceMtime) {
+        uint64_t contentHash;
+        if (!DiskCacheFile::hashFile(sourcePath, contentHash) || contentHash != header.contentHash) {
+            misses++;
+            return false;
+        }
+    }
+
+    std::vector<BlobLevel> blobLevels(header.levelCount);
+    std::memcpy(blobLevels.data(), blob.data() + sizeof(BlobHeader), blobLevels.size() * sizeof(BlobLevel));
+    size_t texelsOffset = sizeof(BlobHeader) + blobLevels.size() * sizeof(BlobLevel);
+
+    if (header.width <= 0 || header.height <= 0
+        || (header.channels != 1 && header.channels != 3 && header.channels != 4)) {
+        misses++;
+        return false;
+    }
+
+    DecodedImage loaded;
+    loaded.width = header.width;
+    loaded.height = header.height;
+    loaded.channels = header.channels;
+    uint64_t offset = 0;
+    for (size_t i = 0; i < blobLevels.size(); i++) {
+        // every level is uploaded as width * height * channels texels, so a level claiming
+        // anything else would have glTexImage2D read past what was copied out
+        const BlobLevel& blobLevel = blobLevels[i];
+        int32_t levelWidth = std::max(1, header.width >> i);
+        int32_t levelHeight = std::max(1, header.height >> i);
+        if (blobLevel.width != levelWidth || blobLevel.height != levelHeight
+            || blobLevel.size != (uint64_t)levelWidth * levelHeight * header.channels
+            || blobLevel.size > blob.size() - texelsOffset - offset) {
+            misses++;
+            return false;
+        }
+        loaded.levels.push_back(DecodedImage::Level{ blobLevel.width, blobLevel.height, (size_t)offset, (size_t)blobLevel.size });
+        offset += blobLevel.size;
+    }
+    // the upload reads from DecodedImage, which owns its texels, so they're copied out of the mapping
+    loaded.texels.assign(blob.data() + texelsOffset, blob.data() + texelsOffset + offset);
+
+    image = std::move(loaded);
+    hits++;
+    return true;
+}
+
+
+bool TextureDiskCache::store(const std::string& sourcePath, bool flipped, bool withMips, const DecodedImage& image) const {
+    if (!isEnabled() || image.levels.empty()) return false;
+
+    BlobHeader header{};
+    std::memcpy(header.magic, BLOB_MAGIC, 4);
+    header.version = BLOB_VERSION;
+    if (!DiskCacheFile::statFile(sourcePath, header.sourceSize, header.sourceMtime)) return false;
+    if (!DiskCacheFile::hashFile(sourcePath, header.contentHash)) return false;
+    header.flags = (flipped ? FLAG_FLIPPED : 0) | (withMips ? FLAG_MIPS : 0);
+    header.width = image.width;
+    header.height = image.height;
+    header.channels = image.channels;
+    header.levelCount = (uint32_t)image.levels.size();
+
+    return DiskCacheFile::writeAtomically(blobPath(sourcePath, flipped, withMips), [&](std::ofstream& blob) {
+        blob.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (const DecodedImage::Level& level : image.levels) {
+            BlobLevel blobLevel{ level.width, level.height, (uint64_t)level.size };
+            blob.write(reinterpret_cast<const char*>(&blobLevel), sizeof(blobLevel));
+        }
+        blob.write(reinterpret_cast<const char*>(image.texels.data()), image.texels.size());
+    });
+}
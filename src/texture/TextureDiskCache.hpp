@@ -0,0 +1,42 @@
+// DESCRIPTION
+/*
+TextureDiskCache keeps decoded (and mipmapped) texels next to the project, so reopening a
+project uploads straight from these blobs instead of running stb_image again.
+
+One blob per source image, named after a hash of the source path and the decode options.
+Each blob records the source's size, modification time and a content hash. A blob is used
+when size and mtime still match. If only the mtime moved (a checkout, a copy) the source is
+hashed and the blob is kept as long as the content is unchanged. Anything else is a miss
+and the fresh decode overwrites the blob.
+
+load/store only read the directory set at initialize, so pool workers call them concurrently.
+Blobs are written through DiskCacheFile::writeAtomically, a reader never sees half a blob,
+and read through MappedFile like MeshDiskCache's.
+*/
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+struct DecodedImage;
+
+class TextureDiskCache {
+public:
+    bool initialize(const std::filesystem::path& cacheDir);
+    bool isEnabled() const;
+
+    bool load(const std::string& sourcePath, bool flipped, bool withMips, DecodedImage& image) const;
+    bool store(const std::string& sourcePath, bool flipped, bool withMips, const DecodedImage& image) const;
+
+    unsigned int getHits() const { return hits; }
+    unsigned int getMisses() const { return misses; }
+
+private:
+    std::filesystem::path directory;
+    mutable std::atomic<unsigned int> hits = 0;
+    mutable std::atomic<unsigned int> misses = 0;
+
+    std::filesystem::path blobPath(const std::string& sourcePath, bool flipped, bool withMips) const;
+};
@@ -1,8 +1,9 @@
 #pragma once
 
 enum class TextureStatus {
-    Ready,
+    Ready,          // nothing decoded yet
+    Loading,        // decode queued or running on the TextureCache pool, the missing texture stands in
     Loaded,
     FileNotFound,
     InvalidFormat
-};
\ No newline at end of file
+};
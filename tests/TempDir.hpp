@@ -0,0 +1,33 @@
+#pragma once
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+
+// Scratch directory under the system temp dir for tests that touch files. It starts empty and is
+// removed again with the fixture, so a failed run doesn't leak into the next one. The path is
+// canonical, code under test that compares canonical paths sees the same one.
+struct TempDir {
+    std::filesystem::path root;
+
+    explicit TempDir(const std::string& name)
+        : root(std::filesystem::weakly_canonical(std::filesystem::temp_directory_path()) / name) {
+        std::filesystem::remove_all(root);
+        std::filesystem::create_directories(root);
+    }
+    ~TempDir() {
+        std::error_code ignored;
+        std::filesystem::remove_all(root, ignored);
+    }
+
+    TempDir(const TempDir&) = delete;
+    TempDir& operator=(const TempDir&) = delete;
+};
+
+// writes contents as the whole file, creating missing parent directories
+inline void writeFile(const std::filesystem::path& path, const std::string& contents) {
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << contents;
+}
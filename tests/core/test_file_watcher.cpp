@@ -0,0 +1,128 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <filesystem>
+#include <string>
+
+#include "core/FileWatcher.hpp"
+#include "TempDir.hpp"
+
+namespace fs = std::filesystem;
+
+TEST_CASE("FileWatcher: polling reports a burst of writes once, after it settles", "[core][filewatcher]") {
+    TempDir temp("sandbox_filewatcher_poll");
+    const fs::path& dir = temp.root;
+    writeFile(dir / "a.frag", "void main() {}");
+
+    FileWatcher watcher(FileWatcher::Backend::Polling);
+    REQUIRE(watcher.getBackend() == FileWatcher::Backend::Polling);
+    REQUIRE(watcher.watchDirectory(dir));
+
+    auto t0 = FileWatcher::Clock::now();
+    REQUIRE(watcher.poll(t0).empty()); // existing files aren't changes
+
+    writeFile(dir / "a.frag", "void main() { }");
+    writeFile(dir / "a.frag", "void main() {  }");
+    auto t1 = t0 + FileWatcher::POLL_INTERVAL;
+    REQUIRE(watcher.poll(t1).empty());
+    REQUIRE(watcher.poll(t1 + FileWatcher::DEBOUNCE).empty()); // no scan since, may still be writing
+
+    auto changed = watcher.poll(t1 + FileWatcher::POLL_INTERVAL);
+    REQUIRE(changed.size() == 1);
+    REQUIRE(changed[0] == dir / "a.frag");
+    REQUIRE(watcher.poll(t1 + 2 * FileWatcher::POLL_INTERVAL).empty());
+
+    // new files count, files outside the watch don't
+    writeFile(dir / "b.vert", "void main() {}");
+    auto t2 = t1 + 3 * FileWatcher::POLL_INTERVAL;
+    watcher.poll(t2);
+    changed = watcher.poll(t2 + FileWatcher::POLL_INTERVAL);
+    REQUIRE(changed.size() == 1);
+    REQUIRE(changed[0] == dir / "b.vert");
+}
+
+TEST_CASE("FileWatcher: single files ignore their neighbours", "[core][filewatcher]") {
+    TempDir temp("sandbox_filewatcher_file");
+    const fs::path& dir = temp.root;
+    writeFile(dir / "watched.glsl", "x");
+    writeFile(dir / "other.glsl", "x");
+
+    FileWatcher::Backend backend = GENERATE(FileWatcher::Backend::Native, FileWatcher::Backend::Polling);
+    FileWatcher watcher(backend);
+    REQUIRE(watcher.watchFile(dir / "watched.glsl"));
+
+    auto t0 = FileWatcher::Clock::now();
+    watcher.poll(t0);
+    writeFile(dir / "other.glsl", "xx");
+    writeFile(dir / "watched.glsl", "xx");
+
+    auto t1 = t0 + FileWatcher::POLL_INTERVAL;
+    watcher.poll(t1);
+    auto changed = watcher.poll(t1 + FileWatcher::POLL_INTERVAL);
+    REQUIRE(changed.size() == 1);
+    REQUIRE(changed[0] == dir / "watched.glsl");
+}
+
+#ifdef __linux__
+TEST_CASE("FileWatcher: inotify debounces a save through a temp file", "[core][filewatcher]") {
+    TempDir temp("sandbox_filewatcher_native");
+    const fs::path& dir = temp.root;
+    writeFile(dir / "a.frag", "void main() {}");
+
+    FileWatcher watcher;
+    REQUIRE(watcher.getBackend() == FileWatcher::Backend::Native);
+    REQUIRE(watcher.watchDirectory(dir));
+
+    // what many editors do: write elsewhere, rename over the original
+    writeFile(dir / "a.frag.tmp", "void main() { }");
+    fs::rename(dir / "a.frag.tmp", dir / "a.frag");
+    writeFile(dir / "a.frag", "void main() {  }");
+
+    auto t0 = FileWatcher::Clock::now();
+    REQUIRE(watcher.poll(t0).empty());
+    auto changed = watcher.poll(t0 + FileWatcher::DEBOUNCE);
+    REQUIRE(changed.size() == 2); // the temp file is in the watched directory too
+    REQUIRE(changed[0] == dir / "a.frag");
+    REQUIRE(changed[1] == dir / "a.frag.tmp");
+    REQUIRE(watcher.poll(t0 + 2 * FileWatcher::DEBOUNCE).empty());
+}
+#endif
+
+TEST_CASE("FileWatcher: stamps tell files apart by size and existence", "[core][filewatcher]") {
+    TempDir temp("sandbox_filewatcher_stamp");
+    const fs::path& dir = temp.root;
+    REQUIRE(FileWatcher::stampOf(dir / "missing").exists == false);
+
+    writeFile(dir / "a", "1");
+    FileWatcher::Stamp first = FileWatcher::stampOf(dir / "a");
+    REQUIRE(first.exists);
+    REQUIRE(first.size == 1);
+    REQUIRE(first == FileWatcher::stampOf(dir / "a"));
+    writeFile(dir / "a", "12");
+    REQUIRE(first != FileWatcher::stampOf(dir / "a"));
+}
+
+TEST_CASE("FileWatcher: watching a file again keeps its change, unwatched files go quiet", "[core][filewatcher]") {
+    TempDir temp("sandbox_filewatcher_unwatch");
+    const fs::path& dir = temp.root;
+    writeFile(dir / "a.glsl", "x");
+    writeFile(dir / "b.glsl", "x");
+
+    FileWatcher::Backend backend = GENERATE(FileWatcher::Backend::Native, FileWatcher::Backend::Polling);
+    FileWatcher watcher(backend);
+    REQUIRE(watcher.watchFile(dir / "a.glsl"));
+    REQUIRE(watcher.watchFile(dir / "b.glsl"));
+
+    auto t0 = FileWatcher::Clock::now();
+    watcher.poll(t0);
+    writeFile(dir / "a.glsl", "xx");
+    REQUIRE(watcher.watchFile(dir / "a.glsl")); // before any poll saw the write
+    watcher.unwatchFile(dir / "b.glsl");
+    writeFile(dir / "b.glsl", "xx");
+
+    auto t1 = t0 + FileWatcher::POLL_INTERVAL;
+    watcher.poll(t1);
+    auto changed = watcher.poll(t1 + FileWatcher::POLL_INTERVAL);
+    REQUIRE(changed.size() == 1);
+    REQUIRE(changed[0] == dir / "a.glsl");
+    REQUIRE(watcher.poll(t1 + 3 * FileWatcher::POLL_INTERVAL).empty());
+}
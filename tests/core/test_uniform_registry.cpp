@@ -0,0 +1,111 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <string>
+
+#include "core/UniformRegistry.hpp"
+#include "core/logging/Logger.hpp"
+#include "application/Project.hpp"
+
+static bool initTestLogger(Logger& logger){
+    std::string testAppName = "PrimsTSS_Test";
+    std::string testProjectName = "UniformRegistry_Tests";
+    return logger.initialize(testAppName, testProjectName);
+}
+
+static Uniform makeFloatUniform(const std::string& name, float value) {
+    Uniform uniform;
+    uniform.name = name;
+    uniform.type = UniformType::Float;
+    uniform.value = value;
+    return uniform;
+}
+
+TEST_CASE("UniformRegistry: views are empty for unknown scopes", "[uniform][registry]") {
+    Logger logger;
+    Project project;
+    REQUIRE(initTestLogger(logger));
+
+    UniformRegistry reg;
+    REQUIRE(reg.initialize(&logger, &project));
+
+    REQUIRE(reg.readSceneUniforms().empty());
+    REQUIRE(reg.readModelUniforms(4).empty());
+    REQUIRE(reg.readMaterialUniforms(7).empty());
+}
+
+TEST_CASE("UniformRegistry: material view reads project storage in place", "[uniform][registry]") {
+    Logger logger;
+    Project project;
+    REQUIRE(initTestLogger(logger));
+
+    UniformRegistry reg;
+    REQUIRE(reg.initialize(&logger, &project));
+
+    reg.registerMaterialUniform(1, makeFloatUniform("uAlpha", 0.5f));
+    reg.registerMaterialUniform(1, makeFloatUniform("uBeta", 2.0f));
+    reg.registerMaterialUniform(2, makeFloatUniform("uAlpha", 9.0f));
+
+    const UniformView view = reg.readMaterialUniforms(1);
+    REQUIRE(view.size() == 2);
+    for (const Uniform& uniform : view) {
+        REQUIRE(uniform.materialID == 1);
+        REQUIRE(&uniform == &project.uniforms.at(uniform.ID));
+    }
+
+    // re-registering by name overwrites the value without adding a new entry
+    reg.registerMaterialUniform(1, makeFloatUniform("uAlpha", 3.0f));
+    REQUIRE(reg.readMaterialUniforms(1).size() == 2);
+    REQUIRE(std::get<float>(reg.tryReadMaterialUniform(1, "uAlpha")->value) == 3.0f);
+}
+
+TEST_CASE("UniformRegistry: erasing keeps views in sync", "[uniform][registry]") {
+    Logger logger;
+    Project project;
+    REQUIRE(initTestLogger(logger));
+
+    UniformRegistry reg;
+    REQUIRE(reg.initialize(&logger, &project));
+
+    reg.registerMaterialUniform(1, makeFloatUniform("uAlpha", 0.5f));
+    reg.registerMaterialUniform(1, makeFloatUniform("uBeta", 2.0f));
+    reg.registerSceneUniform(makeFloatUniform("uTime", 1.0f));
+
+    reg.eraseMaterialUniform(1, "uAlpha");
+    const UniformView view = reg.readMaterialUniforms(1);
+    REQUIRE(view.size() == 1);
+    REQUIRE(view.begin()->name == "uBeta");
+    REQUIRE(reg.getMaterialUniformsSize(1) == 1);
+
+    reg.eraseMaterial(1);
+    REQUIRE(reg.readMaterialUniforms(1).empty());
+    REQUIRE(reg.readSceneUniforms().size() == 1);
+    REQUIRE(project.uniforms.size() == 1);
+}
+
+TEST_CASE("UniformRegistry: generation only moves when the value changes", "[uniform][registry]") {
+    Logger logger;
+    Project project;
+    REQUIRE(initTestLogger(logger));
+
+    UniformRegistry reg;
+    REQUIRE(reg.initialize(&logger, &project));
+
+    reg.registerSceneUniform(makeFloatUniform("uTime", 1.0f));
+    const Uniform* stored = &project.uniforms.at(reg.readSceneUniforms().begin()->ID);
+    REQUIRE(stored->generation == 1);
+
+    reg.registerSceneUniform(makeFloatUniform("uTime", 1.0f));
+    REQUIRE(stored->generation == 1);
+
+    reg.registerSceneUniform(makeFloatUniform("uTime", 2.0f));
+    REQUIRE(stored->generation == 2);
+
+    Uniform moved = *stored;
+    moved.hasLocation = false;
+    REQUIRE(reg.updateUniform(moved.ID, moved));
+    REQUIRE(stored->generation == 2);
+
+    moved.value = 5.0f;
+    REQUIRE(reg.updateUniform(moved.ID, moved));
+    REQUIRE(stored->generation == 3);
+}
@@ -0,0 +1,90 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "engine/DepthPyramid.hpp"
+
+// camera at the origin looking down -z, same projection as the viewport
+static glm::mat4 makeViewProjection() {
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    return projection * view;
+}
+
+// window depth of a point straight ahead at distance
+static float windowDepth(const glm::mat4& viewProjection, float distance) {
+    glm::vec4 clip = viewProjection * glm::vec4(0.0f, 0.0f, -distance, 1.0f);
+    return clip.z / clip.w * 0.5f + 0.5f;
+}
+
+TEST_CASE("DepthPyramid: boxes behind a wall are occluded, in front of it they are not", "[engine][culling]") {
+    glm::mat4 viewProjection = makeViewProjection();
+    const int size = 64;
+    DepthPyramid pyramid;
+    pyramid.build(size, size, std::vector<float>(size * size, windowDepth(viewProjection, 10.0f)), viewProjection, glm::ivec2(size));
+
+    REQUIRE(pyramid.getWidth() == size);
+    REQUIRE(pyramid.isOccluded(glm::vec3(0.0f, 0.0f, -30.0f), glm::vec3(1.0f)));
+    REQUIRE(pyramid.isOccluded(glm::vec3(0.0f, 0.0f, -30.0f), glm::vec3(8.0f))); // large, tested on a coarse level
+    REQUIRE_FALSE(pyramid.isOccluded(glm::vec3(0.0f, 0.0f, -5.0f), glm::vec3(1.0f)));
+    REQUIRE_FALSE(pyramid.isOccluded(glm::vec3(0.0f, 0.0f, -10.0f), glm::vec3(1.0f))); // reaches through the wall
+}
+
+TEST_CASE("DepthPyramid: a hole in the wall keeps what's behind it visible", "[engine][culling]") {
+    glm::mat4 viewProjection = makeViewProjection();
+    const int width = 37, height = 29; // odd sizes, the last row and column carry the leftover texels
+    std::vector<float> depths(width * height, windowDepth(viewProjection, 10.0f));
+    depths[(height - 1) * width + (width - 1)] = 1.0f; // top right corner drew nothing
+
+    DepthPyramid pyramid;
+    pyramid.build(width, height, depths, viewProjection, glm::ivec2(width, height));
+
+    // a box whose projection covers the top right corner
+    glm::vec3 corner(20.0f, 20.0f, -40.0f);
+    REQUIRE_FALSE(pyramid.isOccluded(corner, glm::vec3(8.0f)));
+    REQUIRE_FALSE(pyramid.isOccluded(glm::vec3(0.0f, 0.0f, -40.0f), glm::vec3(30.0f))); // covers everything, hole included
+    REQUIRE(pyramid.isOccluded(glm::vec3(-5.0f, -5.0f, -40.0f), glm::vec3(1.0f)));
+}
+
+TEST_CASE("DepthPyramid: boxes are tested against the texel their pixels were reduced into", "[engine][culling]") {
+    glm::mat4 viewProjection = makeViewProjection();
+    // a 1001 px viewport halves to 500, 250, 125: texel 100 holds pixels 800-807, while 800 / 1001 * 125 scales to 99
+    const int viewport = 1001, size = 125, holeTexel = 100;
+    std::vector<float> depths(size * size, windowDepth(viewProjection, 10.0f));
+    for (int y = 0; y < size; y++) {
+        depths[y * size + holeTexel] = 1.0f; // nothing drawn in that column
+    }
+
+    DepthPyramid pyramid;
+    pyramid.build(size, size, depths, viewProjection, glm::ivec2(viewport));
+
+    // a sliver inside pixel 800, well behind the wall
+    const float distance = 40.0f;
+    auto worldX = [&](float pixel) {
+        float ndc = pixel / viewport * 2.0f - 1.0f;
+        return ndc * distance / viewProjection[0][0];
+    };
+    glm::vec3 center(worldX(800.5f), 0.0f, -distance);
+    glm::vec3 extent(worldX(800.7f) - center.x, 0.01f, 0.01f);
+    REQUIRE_FALSE(pyramid.isOccluded(center, extent));
+
+    // pixel 792 is in texel 99 both ways, behind the wall
+    REQUIRE(pyramid.isOccluded(glm::vec3(worldX(792.5f), 0.0f, -distance), glm::vec3(0.2f * extent.x, 0.01f, 0.01f)));
+}
+
+TEST_CASE("DepthPyramid: boxes behind the camera, off screen or without a pyramid are visible", "[engine][culling]") {
+    glm::mat4 viewProjection = makeViewProjection();
+    DepthPyramid pyramid;
+    REQUIRE(pyramid.isEmpty());
+    REQUIRE_FALSE(pyramid.isOccluded(glm::vec3(0.0f, 0.0f, -30.0f), glm::vec3(1.0f)));
+
+    const int size = 16;
+    pyramid.build(size, size, std::vector<float>(size * size, 0.0f), viewProjection, glm::ivec2(size)); // everything at the near plane
+    REQUIRE_FALSE(pyramid.isOccluded(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f)));  // around the camera
+    REQUIRE_FALSE(pyramid.isOccluded(glm::vec3(0.0f, 0.0f, 10.0f), glm::vec3(1.0f))); // behind it
+    REQUIRE_FALSE(pyramid.isOccluded(glm::vec3(500.0f, 0.0f, -30.0f), glm::vec3(1.0f)));
+    REQUIRE(pyramid.isOccluded(glm::vec3(0.0f, 0.0f, -30.0f), glm::vec3(1.0f)));
+
+    pyramid.clear();
+    REQUIRE(pyramid.isEmpty());
+}
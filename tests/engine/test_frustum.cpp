@@ -0,0 +1,65 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "engine/Frustum.hpp"
+#include "object/MeshBounds.hpp"
+
+// camera at the origin looking down -z, same projection as the viewport
+static Frustum makeFrustum() {
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    return Frustum::fromViewProjection(projection * view);
+}
+
+TEST_CASE("Frustum: boxes in front are kept, behind, beside and beyond far are culled", "[engine][culling]") {
+    Frustum frustum = makeFrustum();
+    glm::vec3 unit(0.5f);
+
+    REQUIRE(frustum.intersects(glm::vec3(0.0f, 0.0f, -10.0f), unit));
+    REQUIRE_FALSE(frustum.intersects(glm::vec3(0.0f, 0.0f, 10.0f), unit));
+    REQUIRE_FALSE(frustum.intersects(glm::vec3(50.0f, 0.0f, -10.0f), unit));
+    REQUIRE_FALSE(frustum.intersects(glm::vec3(0.0f, 0.0f, -200.0f), unit));
+    // straddling the left plane counts as visible
+    REQUIRE(frustum.intersects(glm::vec3(-8.0f, 0.0f, -10.0f), glm::vec3(4.0f)));
+}
+
+TEST_CASE("Frustum: packed test agrees with the single box test", "[engine][culling]") {
+    Frustum frustum = makeFrustum();
+    PackedBounds bounds;
+    bounds.resize(64);
+    size_t expected = 0;
+    for (size_t i = 0; i < bounds.size(); i++) {
+        glm::vec3 center((float)i - 32.0f, (float)(i % 7) - 3.0f, -(float)(i % 13) * 10.0f + 5.0f);
+        glm::vec3 extent(0.25f * (float)(i % 5));
+        bounds.set(i, center, extent);
+        expected += frustum.intersects(center, extent) ? 1 : 0;
+    }
+
+    std::vector<uint8_t> visible;
+    size_t visibleCount = frustum.cullBoxes(bounds, visible);
+    REQUIRE(visibleCount == expected);
+    REQUIRE(visible.size() == bounds.size());
+    for (size_t i = 0; i < bounds.size(); i++) {
+        glm::vec3 center(bounds.centerX[i], bounds.centerY[i], bounds.centerZ[i]);
+        glm::vec3 extent(bounds.extentX[i], bounds.extentY[i], bounds.extentZ[i]);
+        REQUIRE((visible[i] == 1) == frustum.intersects(center, extent));
+    }
+}
+
+TEST_CASE("MeshBounds: transformed boxes contain every transformed corner", "[engine][culling]") {
+    MeshBounds bounds{ glm::vec3(-1.0f, 0.0f, 2.0f), glm::vec3(3.0f, 1.0f, 4.0f) };
+    glm::mat3 linear = glm::mat3(glm::rotate(glm::mat4(1.0f), glm::radians(30.0f), glm::vec3(0.0f, 1.0f, 0.0f))) * 2.0f;
+    glm::vec3 translation(5.0f, -1.0f, 0.0f);
+    MeshBounds moved = bounds.transformed(linear, translation);
+
+    for (int corner = 0; corner < 8; corner++) {
+        glm::vec3 p((corner & 1) ? bounds.max.x : bounds.min.x, (corner & 2) ? bounds.max.y : bounds.min.y, (corner & 4) ? bounds.max.z : bounds.min.z);
+        glm::vec3 q = linear * p + translation;
+        for (int c = 0; c < 3; c++) {
+            REQUIRE(q[c] >= moved.min[c] - 1e-4f);
+            REQUIRE(q[c] <= moved.max[c] + 1e-4f);
+        }
+    }
+    REQUIRE(MeshBounds().transformed(linear, translation).isEmpty());
+}
@@ -0,0 +1,110 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "engine/ProgramBinaryCache.hpp"
+#include "TempDir.hpp"
+
+namespace fs = std::filesystem;
+
+struct ProgramCacheFixture : TempDir {
+    ProgramBinaryCache cache;
+
+    ProgramCacheFixture() : TempDir("sandbox_program_cache_test") {
+        cache.initialize(root);
+    }
+};
+
+TEST_CASE_METHOD(ProgramCacheFixture, "ProgramBinaryCache: a stored binary loads back with its format", "[engine][programcache]") {
+    uint64_t key = ProgramBinaryCache::keyFor("void main() {}", "out vec4 c; void main() {}", "vendor|renderer|4.6|");
+    const std::vector<unsigned char> binary = { 1, 2, 3, 4, 5 };
+
+    uint32_t format = 0;
+    std::vector<unsigned char> loaded;
+    REQUIRE_FALSE(cache.load(7, key, format, loaded));
+    REQUIRE(cache.getMisses() == 1);
+
+    REQUIRE(cache.store(7, key, 0x8E21, binary.data(), binary.size()));
+    REQUIRE(cache.load(7, key, format, loaded));
+    REQUIRE(format == 0x8E21);
+    REQUIRE(loaded == binary);
+    REQUIRE(cache.getHits() == 1);
+}
+
+TEST_CASE("ProgramBinaryCache: keys change with every source and the driver", "[engine][programcache]") {
+    uint64_t key = ProgramBinaryCache::keyFor("a", "b", "driver");
+    REQUIRE(key == ProgramBinaryCache::keyFor("a", "b", "driver"));
+    REQUIRE(key != ProgramBinaryCache::keyFor("a ", "b", "driver"));
+    REQUIRE(key != ProgramBinaryCache::keyFor("a", "b ", "driver"));
+    REQUIRE(key != ProgramBinaryCache::keyFor("a", "b", "other driver"));
+    REQUIRE(ProgramBinaryCache::keyFor("ab", "c", "d") != ProgramBinaryCache::keyFor("a", "bc", "d"));
+}
+
+TEST_CASE_METHOD(ProgramCacheFixture, "ProgramBinaryCache: truncated blobs are misses", "[engine][programcache]") {
+    const std::vector<unsigned char> binary(64, 7);
+    REQUIRE(cache.store(7, 42, 1, binary.data(), binary.size()));
+
+    for (const fs::directory_entry& entry : fs::directory_iterator(root)) {
+        fs::resize_file(entry.path(), fs::file_size(entry.path()) - 1);
+    }
+
+    uint32_t format = 0;
+    std::vector<unsigned char> loaded;
+    REQUIRE_FALSE(cache.load(7, 42, format, loaded));
+    REQUIRE(loaded.empty());
+}
+
+TEST_CASE("ProgramBinaryCache: disabled without a directory", "[engine][programcache]") {
+    ProgramBinaryCache cache;
+    REQUIRE_FALSE(cache.isEnabled());
+    const unsigned char byte = 0;
+    REQUIRE_FALSE(cache.store(1, 1, 1, &byte, 1));
+}
+
+TEST_CASE_METHOD(ProgramCacheFixture, "ProgramBinaryCache: a new binary replaces the old one of its slot", "[engine][programcache]") {
+    uint64_t slot = ProgramBinaryCache::slotFor("a.vert", "a.frag", 0);
+    REQUIRE(slot != ProgramBinaryCache::slotFor("a.vert", "a.frag", 1));
+    REQUIRE(slot != ProgramBinaryCache::slotFor("b.vert", "a.frag", 0));
+
+    const std::vector<unsigned char> binary(16, 3);
+    REQUIRE(cache.store(slot, 1, 1, binary.data(), binary.size()));
+    REQUIRE(cache.store(slot + 1, 2, 1, binary.data(), binary.size()));
+    cache.storeInBackground(slot, 3, 1, binary);
+    cache.waitIdle();
+
+    uint32_t format = 0;
+    std::vector<unsigned char> loaded;
+    REQUIRE_FALSE(cache.load(slot, 1, format, loaded));
+    REQUIRE(cache.load(slot, 3, format, loaded));
+    REQUIRE(cache.load(slot + 1, 2, format, loaded));
+
+    size_t blobs = 0;
+    for (const fs::directory_entry& entry : fs::directory_iterator(root)) blobs += entry.path().extension() == ".program";
+    REQUIRE(blobs == 2);
+}
+
+TEST_CASE_METHOD(ProgramCacheFixture, "ProgramBinaryCache: the least recently used blobs go past the size limit", "[engine][programcache]") {
+    REQUIRE(cache.initialize(root, 3200));
+    const std::vector<unsigned char> binary(1000, 1);
+    auto past = fs::file_time_type::clock::now() - std::chrono::hours(1);
+    for (uint64_t slot = 1; slot <= 3; slot++) {
+        REQUIRE(cache.store(slot, slot, 1, binary.data(), binary.size()));
+    }
+    for (const fs::directory_entry& entry : fs::directory_iterator(root)) {
+        uint64_t slot = std::stoull(entry.path().filename().string().substr(0, 16), nullptr, 16);
+        fs::last_write_time(entry.path(), past + std::chrono::seconds(slot));
+    }
+
+    uint32_t format = 0;
+    std::vector<unsigned char> loaded;
+    REQUIRE(cache.load(1, 1, format, loaded)); // the oldest, now the most recently used
+
+    REQUIRE(cache.store(4, 4, 1, binary.data(), binary.size()));
+    REQUIRE(cache.load(1, 1, format, loaded));
+    REQUIRE_FALSE(cache.load(2, 2, format, loaded));
+    REQUIRE(cache.load(3, 3, format, loaded));
+    REQUIRE(cache.load(4, 4, format, loaded));
+}
@@ -0,0 +1,125 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <filesystem>
+#include <string>
+
+#include "engine/ShaderPreprocessor.hpp"
+#include "TempDir.hpp"
+
+namespace fs = std::filesystem;
+
+struct PreprocessorFixture : TempDir {
+    ShaderPreprocessor preprocessor;
+
+    PreprocessorFixture() : TempDir("sandbox_preprocessor_test") {}
+};
+
+TEST_CASE_METHOD(PreprocessorFixture, "ShaderPreprocessor: includes are pasted with #line markers", "[engine][preprocessor]") {
+    writeFile(root / "a.vert", "#version 330 core\n#include \"lib/common.glsl\"\nvoid main() {}\n");
+    writeFile(root / "lib/common.glsl", "float half(float x) { return x * 0.5; }\n");
+
+    ShaderPreprocessor::Source source;
+    REQUIRE(preprocessor.resolve(root / "a.vert", source));
+    REQUIRE(source.error.empty());
+    REQUIRE(source.code ==
+        "#version 330 core\n"
+        "#line 1 1\n"
+        "float half(float x) { return x * 0.5; }\n"
+        "#line 3 0\n"
+        "void main() {}\n");
+    REQUIRE(source.files.size() == 2);
+    REQUIRE(source.files[0] == (root / "a.vert").string());
+    REQUIRE(source.files[1] == (root / "lib/common.glsl").string());
+    REQUIRE(ShaderPreprocessor::describeFiles(source) == "0: a.vert, 1: common.glsl");
+}
+
+TEST_CASE_METHOD(PreprocessorFixture, "ShaderPreprocessor: #pragma once pastes a file once", "[engine][preprocessor]") {
+    writeFile(root / "a.frag", "#include \"x.glsl\"\n#include \"y.glsl\"\n#include \"x.glsl\"\n");
+    writeFile(root / "x.glsl", "#pragma once\nX\n");
+    writeFile(root / "y.glsl", "#include \"x.glsl\"\nY\n");
+
+    ShaderPreprocessor::Source source;
+    REQUIRE(preprocessor.resolve(root / "a.frag", source));
+    REQUIRE(source.code.find("X\n") == source.code.rfind("X\n"));
+    REQUIRE(source.code.find("Y\n") != std::string::npos);
+    REQUIRE(source.files.size() == 3);
+}
+
+TEST_CASE_METHOD(PreprocessorFixture, "ShaderPreprocessor: cycles and missing files fail", "[engine][preprocessor]") {
+    writeFile(root / "a.vert", "#include \"b.glsl\"\n");
+    writeFile(root / "b.glsl", "#include \"a.vert\"\n");
+
+    ShaderPreprocessor::Source source;
+    REQUIRE_FALSE(preprocessor.resolve(root / "a.vert", source));
+    REQUIRE(source.error.find("include cycle") != std::string::npos);
+
+    writeFile(root / "c.vert", "#include \"missing.glsl\"\n");
+    REQUIRE_FALSE(preprocessor.resolve(root / "c.vert", source));
+    REQUIRE(source.error.find("missing.glsl") != std::string::npos);
+    REQUIRE(source.files.back() == (root / "missing.glsl").string()); // still listed, creating it should reload
+}
+
+TEST_CASE_METHOD(PreprocessorFixture, "ShaderPreprocessor: edited files are parsed again", "[engine][preprocessor]") {
+    writeFile(root / "a.vert", "#include \"b.glsl\"\n");
+    writeFile(root / "b.glsl", "old\n");
+
+    ShaderPreprocessor::Source source;
+    REQUIRE(preprocessor.resolve(root / "a.vert", source));
+    REQUIRE(source.code.find("old") != std::string::npos);
+
+    writeFile(root / "b.glsl", "newer\n"); // the size changes even if the mtime doesn't
+    REQUIRE(preprocessor.resolve(root / "a.vert", source));
+    REQUIRE(source.code.find("newer") != std::string::npos);
+    REQUIRE(source.code.find("old") == std::string::npos);
+}
+
+TEST_CASE_METHOD(PreprocessorFixture, "ShaderPreprocessor: includes in comments and #if 0 are left alone", "[engine][preprocessor]") {
+    writeFile(root / "a.frag",
+        "// #include \"missing.glsl\"\n"
+        "/*\n"
+        "#include \"missing.glsl\"\n"
+        "*/\n"
+        "#if 0\n"
+        "#ifdef X\n"
+        "#endif\n"
+        "#include \"missing.glsl\"\n"
+        "#else\n"
+        "#include \"b.glsl\"\n"
+        "#endif\n");
+    writeFile(root / "b.glsl", "B\n");
+
+    ShaderPreprocessor::Source source;
+    REQUIRE(preprocessor.resolve(root / "a.frag", source));
+    REQUIRE(source.files.size() == 2);
+    REQUIRE(source.code.find("B\n") != std::string::npos);
+}
+
+TEST_CASE_METHOD(PreprocessorFixture, "ShaderPreprocessor: a cloned preset brings its includes", "[engine][preprocessor]") {
+    for (const char* preset : { "3d.vert", "tex.vert", "instance.vert", "tex.frag" }) {
+        fs::path clone = root / (std::string("1_") + preset);
+        std::string error;
+        REQUIRE(ShaderPreprocessor::copyWithIncludes(fs::path(SANDBOX_SHADERS_DIR) / preset, clone, error));
+        REQUIRE(error.empty());
+
+        ShaderPreprocessor::Source source;
+        REQUIRE(preprocessor.resolve(clone, source));
+        REQUIRE(source.code.find("#include") == std::string::npos);
+    }
+    REQUIRE(fs::exists(root / "transform.glsl"));
+}
+
+TEST_CASE_METHOD(PreprocessorFixture, "ShaderPreprocessor: cloning keeps the destination's includes", "[engine][preprocessor]") {
+    writeFile(root / "src/a.vert", "#include \"lib/b.glsl\"\n");
+    writeFile(root / "src/lib/b.glsl", "preset\n");
+    writeFile(root / "dest/lib/b.glsl", "edited\n");
+
+    std::string error;
+    REQUIRE(ShaderPreprocessor::copyWithIncludes(root / "src/a.vert", root / "dest/a_1.vert", error));
+    ShaderPreprocessor::Source source;
+    REQUIRE(preprocessor.resolve(root / "dest/a_1.vert", source));
+    REQUIRE(source.code.find("edited") != std::string::npos);
+
+    writeFile(root / "src/broken.vert", "#include \"missing.glsl\"\n");
+    REQUIRE_FALSE(ShaderPreprocessor::copyWithIncludes(root / "src/broken.vert", root / "dest/broken_1.vert", error));
+    REQUIRE(fs::exists(root / "dest/broken_1.vert"));
+}
@@ -0,0 +1,36 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <string>
+
+#include "engine/ShaderVariant.hpp"
+
+TEST_CASE("ShaderVariant: only macros the source mentions count", "[engine][variant]") {
+    std::string source = "#ifdef VARIANT_CUTOUT\ndiscard;\n#endif\nvec4 t[VARIANT_TEXTURE_COUNT];\n";
+    uint32_t used = ShaderVariant::featuresUsedBy(source);
+    REQUIRE(used == (ShaderVariant::CUTOUT | ShaderVariant::TEXTURE_COUNT));
+    REQUIRE(ShaderVariant::featuresUsedBy("void main() {}") == 0);
+}
+
+TEST_CASE("ShaderVariant: defines follow the features", "[engine][variant]") {
+    uint32_t used = ShaderVariant::CUTOUT | ShaderVariant::NORMALS | ShaderVariant::TEXTURE_COUNT;
+    uint32_t features = ShaderVariant::withTextureCount(ShaderVariant::CUTOUT | ShaderVariant::UVS, 2);
+
+    REQUIRE(ShaderVariant::definesFor(features, used) == "#define VARIANT_CUTOUT\n#define VARIANT_TEXTURE_COUNT 2\n");
+    REQUIRE(ShaderVariant::definesFor(0, used) == "#define VARIANT_TEXTURE_COUNT 0\n");
+    REQUIRE(ShaderVariant::definesFor(features, 0).empty());
+    REQUIRE(ShaderVariant::withTextureCount(0, 100) >> ShaderVariant::TEXTURE_COUNT_SHIFT == 15);
+}
+
+TEST_CASE("ShaderVariant: defines go after #version and keep line numbers", "[engine][variant]") {
+    std::string source = "#version 330 core\nvoid main() {}\n";
+    ShaderVariant::insertDefines(source, "#define VARIANT_CUTOUT\n");
+    REQUIRE(source == "#version 330 core\n#define VARIANT_CUTOUT\n#line 2 0\nvoid main() {}\n");
+
+    std::string noVersion = "void main() {}\n";
+    ShaderVariant::insertDefines(noVersion, "#define A\n");
+    REQUIRE(noVersion == "#define A\n#line 1 0\nvoid main() {}\n");
+
+    std::string unchanged = "#version 330 core\n";
+    ShaderVariant::insertDefines(unchanged, "");
+    REQUIRE(unchanged == "#version 330 core\n");
+}
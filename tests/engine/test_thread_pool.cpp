@@ -0,0 +1,69 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+#include "engine/ThreadPool.hpp"
+
+TEST_CASE("ThreadPool: runs every submitted job", "[threadpool]") {
+    ThreadPool pool(4);
+    REQUIRE(pool.getThreadCount() == 4);
+
+    std::atomic<int> sum = 0;
+    for (int i = 1; i <= 1000; i++) {
+        REQUIRE(pool.submit([&sum, i]() { sum += i; }));
+    }
+    pool.waitIdle();
+
+    REQUIRE(sum == 500500);
+    REQUIRE(pool.getPendingCount() == 0);
+}
+
+TEST_CASE("ThreadPool: shutdown drops queued jobs and refuses new ones", "[threadpool]") {
+    ThreadPool pool(1);
+    std::atomic<bool> started = false;
+    std::atomic<bool> release = false;
+    std::atomic<int> ran = 0;
+
+    pool.submit([&]() {
+        started = true;
+        while (!release) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ran++;
+    });
+    for (int i = 0; i < 10; i++) pool.submit([&ran]() { ran++; });
+    while (!started) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    std::thread releaser([&release]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        release = true;
+    });
+    pool.shutdown(); // waits for the running job only
+    releaser.join();
+
+    REQUIRE(ran == 1);
+    REQUIRE_FALSE(pool.submit([]() {}));
+}
+
+TEST_CASE("ThreadPool: parallelFor runs every index once", "[threadpool]") {
+    std::vector<std::atomic<int>> visits(10000);
+    ThreadPool::parallelFor(visits.size(), 8, [&visits](size_t i) { visits[i]++; });
+    for (const std::atomic<int>& count : visits) REQUIRE(count == 1);
+
+    int calls = 0;
+    ThreadPool::parallelFor(0, 8, [&calls](size_t) { calls++; });
+    ThreadPool::parallelFor(5, 1, [&calls](size_t) { calls++; }); // on the calling thread only
+    REQUIRE(calls == 5);
+}
+
+TEST_CASE("ThreadPool: parallelFor hands a worker's exception to the caller", "[threadpool]") {
+    REQUIRE_THROWS_WITH(ThreadPool::parallelFor(1000, 8, [](size_t i) {
+        if (i == 10) throw std::runtime_error("mesh 10 is broken");
+    }), "mesh 10 is broken");
+
+    // the shared pool is still fine afterwards
+    std::atomic<int> sum = 0;
+    ThreadPool::parallelFor(100, 8, [&sum](size_t i) { sum += (int)i; });
+    REQUIRE(sum == 4950);
+}
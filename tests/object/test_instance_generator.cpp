@@ -0,0 +1,88 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include "object/InstanceGenerator.hpp"
+
+TEST_CASE("InstanceGenerator: grid is centred and sized by gridCount", "[instance][generator]") {
+    InstanceGeneratorParams params;
+    params.type = InstanceGeneratorType::Grid;
+    params.gridCount = glm::uvec3(3, 1, 2);
+    params.spacing = glm::vec3(2.0f);
+
+    std::vector<InstanceData> instances = InstanceGenerator::generate(params);
+    REQUIRE(instances.size() == 6);
+    REQUIRE(instances[0].pos == glm::vec3(-2.0f, 0.0f, -1.0f));
+    REQUIRE(instances[5].pos == glm::vec3(2.0f, 0.0f, 1.0f));
+}
+
+TEST_CASE("InstanceGenerator: scatter stays inside the box and is deterministic", "[instance][generator]") {
+    InstanceGeneratorParams params;
+    params.type = InstanceGeneratorType::Scatter;
+    params.count = 20000; // large enough to be split across threads
+    params.boxMin = glm::vec3(-5.0f, 0.0f, -5.0f);
+    params.boxMax = glm::vec3(5.0f, 2.0f, 5.0f);
+
+    std::vector<InstanceData> first = InstanceGenerator::generate(params);
+    std::vector<InstanceData> second = InstanceGenerator::generate(params);
+    REQUIRE(first.size() == params.count);
+
+    bool inside = true;
+    bool identical = true;
+    for (size_t i = 0; i < first.size(); i++) {
+        inside &= glm::all(glm::greaterThanEqual(first[i].pos, params.boxMin)) && glm::all(glm::lessThanEqual(first[i].pos, params.boxMax));
+        identical &= first[i].pos == second[i].pos;
+    }
+    REQUIRE(inside);
+    REQUIRE(identical);
+
+    params.seed = 2;
+    REQUIRE(InstanceGenerator::generate(params)[0].pos != first[0].pos);
+}
+
+TEST_CASE("InstanceGenerator: stratified scatter spreads a partial grid over the box", "[instance][generator]") {
+    InstanceGeneratorParams params;
+    params.type = InstanceGeneratorType::Scatter;
+    params.count = 10; // 3x3x3 cells, most left empty
+    params.boxMin = glm::vec3(0.0f);
+    params.boxMax = glm::vec3(3.0f);
+
+    std::vector<InstanceData> instances = InstanceGenerator::generate(params);
+    bool reachesTopLayer = false;
+    for (const InstanceData& instance : instances) {
+        reachesTopLayer |= instance.pos.z >= 2.0f;
+    }
+    REQUIRE(reachesTopLayer);
+}
+
+TEST_CASE("InstanceGenerator: spiral and mesh vertices", "[instance][generator]") {
+    InstanceGeneratorParams spiral;
+    spiral.type = InstanceGeneratorType::Spiral;
+    spiral.count = 4;
+    spiral.radiusStep = 1.0f;
+    spiral.angleStep = 0.0f;
+    std::vector<InstanceData> spiralInstances = InstanceGenerator::generate(spiral);
+    REQUIRE(spiralInstances.size() == 4);
+    REQUIRE(spiralInstances[3].pos == glm::vec3(3.0f, 0.0f, 0.0f));
+
+    InstanceGeneratorParams fromMesh;
+    fromMesh.type = InstanceGeneratorType::MeshVertices;
+    std::vector<glm::vec3> vertices = { glm::vec3(1.0f), glm::vec3(2.0f) };
+    REQUIRE(InstanceGenerator::generate(fromMesh).empty());
+    std::vector<InstanceData> meshInstances = InstanceGenerator::generate(fromMesh, &vertices);
+    REQUIRE(meshInstances.size() == 2);
+    REQUIRE(meshInstances[1].pos == glm::vec3(2.0f));
+}
+
+TEST_CASE("InstanceGenerator: scale range and yaw are applied", "[instance][generator]") {
+    InstanceGeneratorParams params;
+    params.type = InstanceGeneratorType::Spiral;
+    params.count = 100;
+    params.randomYaw = 90.0f;
+    params.scaleRange = glm::vec2(0.5f, 2.0f);
+
+    bool inRange = true;
+    for (const InstanceData& instance : InstanceGenerator::generate(params)) {
+        inRange &= instance.scale.x >= 0.5f && instance.scale.x <= 2.0f;
+        inRange &= instance.rotation.y >= 0.0f && instance.rotation.y <= 90.0f;
+    }
+    REQUIRE(inRange);
+}
@@ -0,0 +1,109 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+
+#include "object/MeshDiskCache.hpp"
+#include "TempDir.hpp"
+
+namespace fs = std::filesystem;
+
+static std::vector<ImportedMesh> makeMeshes() {
+    std::vector<ImportedMesh> meshes(2);
+
+    meshes[0].vertices.resize(3);
+    for (int i = 0; i < 3; i++) {
+        meshes[0].vertices[i].position = glm::vec3((float)i, 1.0f, 2.0f);
+        meshes[0].vertices[i].uv = glm::vec2(0.5f, (float)i);
+    }
+    meshes[0].indices = { 0, 1, 2 };
+    meshes[0].flags = MeshProperties{ true, false, true };
+
+    // odd sizes so the second mesh's arrays need padding to stay aligned
+    meshes[1].vertices.resize(5);
+    meshes[1].vertices[4].normal = glm::vec3(0.0f, 0.0f, 1.0f);
+    meshes[1].indices = { 0, 1, 2, 2, 3, 4, 4, 0, 1 };
+    meshes[1].flags = MeshProperties{ true, true, false };
+    meshes[1].lods = { MeshLOD{ 0, 6, 0.0f }, MeshLOD{ 6, 3, 0.25f } }; // a reduced level after the full one
+    return meshes;
+}
+
+struct MeshCacheFixture : TempDir {
+    fs::path source = root / "source.obj";
+    MeshDiskCache cache;
+    static constexpr uint64_t FLAGS = 3;
+
+    MeshCacheFixture() : TempDir("sandbox_mesh_cache_test") {
+        writeFile(source, std::string(64, 'a'));
+        cache.initialize(root / "cache");
+    }
+};
+
+TEST_CASE_METHOD(MeshCacheFixture, "MeshDiskCache: stored meshes map back unchanged", "[object][cache]") {
+    std::vector<ImportedMesh> meshes = makeMeshes();
+    MeshDiskCache::CachedModel cached;
+    REQUIRE_FALSE(cache.load(source.string(), FLAGS, cached));
+    REQUIRE(cache.store(source.string(), FLAGS, meshes));
+
+    REQUIRE(cache.load(source.string(), FLAGS, cached));
+    REQUIRE(cache.getHits() == 1);
+    REQUIRE(cached.file != nullptr);
+    REQUIRE(cached.meshes.size() == meshes.size());
+    for (size_t i = 0; i < meshes.size(); i++) {
+        const MeshDiskCache::CachedMesh& mesh = cached.meshes[i];
+        REQUIRE(mesh.vertexCount == meshes[i].vertices.size());
+        REQUIRE(mesh.indexCount == meshes[i].indices.size());
+        REQUIRE(reinterpret_cast<uintptr_t>(mesh.vertices) % alignof(float) == 0);
+        VertexLayout expected = VertexLayout::choose(meshes[i].vertices.data(), meshes[i].vertices.size(), meshes[i].flags);
+        REQUIRE(mesh.layout.encode() == expected.encode());
+        std::vector<unsigned char> packed = expected.pack(meshes[i].vertices.data(), meshes[i].vertices.size());
+        REQUIRE(std::memcmp(mesh.vertices, packed.data(), packed.size()) == 0);
+        // small meshes come back 16-bit, same as MeshA would upload them
+        REQUIRE(mesh.shortIndices);
+        const uint16_t* indices = static_cast<const uint16_t*>(mesh.indices);
+        REQUIRE(std::equal(indices, indices + mesh.indexCount, meshes[i].indices.begin()));
+        REQUIRE(mesh.flags.hasPositions == meshes[i].flags.hasPositions);
+        REQUIRE(mesh.flags.hasNormals == meshes[i].flags.hasNormals);
+        REQUIRE(mesh.flags.hasUVs == meshes[i].flags.hasUVs);
+        MeshBounds bounds = MeshBounds::fromVertices(meshes[i].vertices.data(), meshes[i].vertices.size());
+        REQUIRE(mesh.bounds.min == bounds.min);
+        REQUIRE(mesh.bounds.max == bounds.max);
+    }
+
+    // a mesh without levels comes back with the full mesh as its only one
+    REQUIRE(cached.meshes[0].lods.size() == 1);
+    REQUIRE(cached.meshes[0].lods[0].indexCount == meshes[0].indices.size());
+    REQUIRE(cached.meshes[1].lods.size() == 2);
+    REQUIRE(cached.meshes[1].lods[1].firstIndex == 6);
+    REQUIRE(cached.meshes[1].lods[1].indexCount == 3);
+    REQUIRE(cached.meshes[1].lods[1].error == 0.25f);
+
+    // other import flags mean other meshes
+    REQUIRE_FALSE(cache.load(source.string(), FLAGS + 1, cached));
+}
+
+TEST_CASE_METHOD(MeshCacheFixture, "MeshDiskCache: edited sources are a miss, touched ones a hit", "[object][cache]") {
+    REQUIRE(cache.store(source.string(), FLAGS, makeMeshes()));
+    auto later = fs::last_write_time(source) + std::chrono::seconds(5);
+
+    writeFile(source, std::string(64, 'a'));
+    fs::last_write_time(source, later);
+    MeshDiskCache::CachedModel cached;
+    REQUIRE(cache.load(source.string(), FLAGS, cached));
+
+    writeFile(source, std::string(64, 'b'));
+    fs::last_write_time(source, later + std::chrono::seconds(5));
+    REQUIRE_FALSE(cache.load(source.string(), FLAGS, cached));
+}
+
+TEST_CASE_METHOD(MeshCacheFixture, "MeshDiskCache: truncated blobs are rejected", "[object][cache]") {
+    REQUIRE(cache.store(source.string(), FLAGS, makeMeshes()));
+
+    for (const fs::directory_entry& entry : fs::directory_iterator(root / "cache")) {
+        fs::resize_file(entry.path(), fs::file_size(entry.path()) - 8);
+    }
+    MeshDiskCache::CachedModel cached;
+    REQUIRE_FALSE(cache.load(source.string(), FLAGS, cached));
+}
@@ -0,0 +1,114 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <algorithm>
+#include <array>
+#include <random>
+
+#include "object/MeshOptimizer.hpp"
+
+// n x n quad grid, unwelded like an OBJ import: every triangle has its own three vertices
+static ImportedMesh makeUnweldedGrid(unsigned int n) {
+    ImportedMesh mesh;
+    mesh.flags = MeshProperties{ true, false, false };
+    auto corner = [n](unsigned int x, unsigned int y) {
+        Vertex vertex{};
+        vertex.position = glm::vec3((float)x / n, (float)y / n, 0.0f);
+        return vertex;
+    };
+    for (unsigned int y = 0; y < n; y++) {
+        for (unsigned int x = 0; x < n; x++) {
+            const Vertex quad[6] = {
+                corner(x, y), corner(x + 1, y), corner(x + 1, y + 1),
+                corner(x, y), corner(x + 1, y + 1), corner(x, y + 1)
+            };
+            for (const Vertex& vertex : quad) {
+                mesh.indices.push_back((unsigned int)mesh.vertices.size());
+                mesh.vertices.push_back(vertex);
+            }
+        }
+    }
+    return mesh;
+}
+
+// every triangle as its three positions, rotated to start at the smallest, so order and rotation don't matter
+static std::vector<std::array<float, 9>> triangleSet(const ImportedMesh& mesh) {
+    std::vector<std::array<float, 9>> triangles;
+    for (size_t t = 0; t < mesh.indices.size() / 3; t++) {
+        std::array<glm::vec3, 3> corners;
+        for (int c = 0; c < 3; c++) corners[c] = mesh.vertices[mesh.indices[3 * t + c]].position;
+        auto less = [](const glm::vec3& a, const glm::vec3& b) {
+            return std::tie(a.x, a.y, a.z) < std::tie(b.x, b.y, b.z);
+        };
+        std::rotate(corners.begin(), std::min_element(corners.begin(), corners.end(), less), corners.end());
+        std::array<float, 9> flat;
+        for (int c = 0; c < 3; c++) {
+            flat[3 * c + 0] = corners[c].x;
+            flat[3 * c + 1] = corners[c].y;
+            flat[3 * c + 2] = corners[c].z;
+        }
+        triangles.push_back(flat);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+TEST_CASE("MeshOptimizer: welding merges identical vertices only", "[object][mesh]") {
+    ImportedMesh mesh = makeUnweldedGrid(8);
+    auto before = triangleSet(mesh);
+
+    size_t removed = MeshOptimizer::weldVertices(mesh);
+    REQUIRE(mesh.vertices.size() == 9 * 9);
+    REQUIRE(removed == 8 * 8 * 6 - 9 * 9);
+    REQUIRE(triangleSet(mesh) == before);
+}
+
+TEST_CASE("MeshOptimizer: cache order beats a shuffled order and keeps every triangle", "[object][mesh]") {
+    ImportedMesh mesh = makeUnweldedGrid(32);
+    MeshOptimizer::weldVertices(mesh);
+
+    // shuffle whole triangles so the input has no locality at all
+    std::vector<std::array<unsigned int, 3>> triangles(mesh.indices.size() / 3);
+    for (size_t t = 0; t < triangles.size(); t++) {
+        triangles[t] = { mesh.indices[3 * t], mesh.indices[3 * t + 1], mesh.indices[3 * t + 2] };
+    }
+    std::shuffle(triangles.begin(), triangles.end(), std::mt19937(7));
+    for (size_t t = 0; t < triangles.size(); t++) {
+        for (int c = 0; c < 3; c++) mesh.indices[3 * t + c] = triangles[t][c];
+    }
+    auto before = triangleSet(mesh);
+    float shuffledRatio = MeshOptimizer::averageCacheMissRatio(mesh.indices, mesh.vertices.size());
+
+    std::vector<size_t> hardBoundaries;
+    MeshOptimizer::optimizeVertexCache(mesh.indices, mesh.vertices.size(), &hardBoundaries);
+    float optimizedRatio = MeshOptimizer::averageCacheMissRatio(mesh.indices, mesh.vertices.size());
+
+    REQUIRE(triangleSet(mesh) == before);
+    REQUIRE(optimizedRatio < shuffledRatio * 0.5f);
+    REQUIRE(optimizedRatio < 1.0f);
+
+    // overdraw order moves clusters around but never loses or flips a triangle
+    MeshOptimizer::optimizeOverdraw(mesh.indices, mesh.vertices, hardBoundaries);
+    REQUIRE(triangleSet(mesh) == before);
+}
+
+TEST_CASE("MeshOptimizer: vertex fetch order follows first use and drops unused vertices", "[object][mesh]") {
+    ImportedMesh mesh;
+    mesh.vertices.resize(5);
+    for (int i = 0; i < 5; i++) mesh.vertices[i].position = glm::vec3((float)i);
+    mesh.indices = { 3, 1, 4, 4, 1, 0 }; // vertex 2 is never used
+
+    MeshOptimizer::optimizeVertexFetch(mesh);
+    REQUIRE(mesh.vertices.size() == 4);
+    REQUIRE(mesh.indices == std::vector<unsigned int>{ 0, 1, 2, 2, 1, 3 });
+    REQUIRE(mesh.vertices[0].position.x == 3.0f);
+    REQUIRE(mesh.vertices[3].position.x == 0.0f);
+}
+
+TEST_CASE("MeshOptimizer: 16-bit indices below 65536 vertices", "[object][mesh]") {
+    REQUIRE(MeshOptimizer::useShortIndices(65535));
+    REQUIRE_FALSE(MeshOptimizer::useShortIndices(65536));
+
+    std::vector<unsigned int> indices = { 0, 65534, 7 };
+    std::vector<uint16_t> narrowed = MeshOptimizer::narrowIndices(indices.data(), indices.size());
+    REQUIRE(narrowed == std::vector<uint16_t>{ 0, 65534, 7 });
+}
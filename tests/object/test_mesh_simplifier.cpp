@@ -0,0 +1,114 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <cfloat>
+#include <cmath>
+#include <set>
+
+#include "object/MeshSimplifier.hpp"
+
+// welded n x n quad grid on [0,1]^2, z from height(x, y)
+template <typename Height>
+static ImportedMesh makeGrid(unsigned int n, Height height) {
+    ImportedMesh mesh;
+    mesh.flags = MeshProperties{ true, false, false };
+    for (unsigned int y = 0; y <= n; y++) {
+        for (unsigned int x = 0; x <= n; x++) {
+            Vertex vertex{};
+            float u = (float)x / n, v = (float)y / n;
+            vertex.position = glm::vec3(u, v, height(u, v));
+            mesh.vertices.push_back(vertex);
+        }
+    }
+    for (unsigned int y = 0; y < n; y++) {
+        for (unsigned int x = 0; x < n; x++) {
+            unsigned int a = y * (n + 1) + x, b = a + 1, c = a + n + 2, d = a + n + 1;
+            mesh.indices.insert(mesh.indices.end(), { a, b, c, a, c, d });
+        }
+    }
+    return mesh;
+}
+
+static bool onBorder(const Vertex& vertex) {
+    return vertex.position.x == 0.0f || vertex.position.x == 1.0f || vertex.position.y == 0.0f || vertex.position.y == 1.0f;
+}
+
+TEST_CASE("MeshSimplifier: a flat grid reduces without error and keeps its border", "[object][mesh]") {
+    ImportedMesh mesh = makeGrid(32, [](float, float) { return 0.0f; });
+    float error = -1.0f;
+    std::vector<unsigned int> reduced = MeshSimplifier::simplify(mesh.vertices, mesh.indices, mesh.indices.size() / 2, &error);
+
+    REQUIRE(reduced.size() % 3 == 0);
+    REQUIRE(reduced.size() <= mesh.indices.size() / 2 + 6);
+    REQUIRE(reduced.size() >= mesh.indices.size() / 4);
+    REQUIRE(error == Catch::Approx(0.0f).margin(1e-6));
+
+    std::set<unsigned int> used(reduced.begin(), reduced.end());
+    REQUIRE(*used.rbegin() < mesh.vertices.size());
+    for (unsigned int v = 0; v < mesh.vertices.size(); v++) {
+        if (onBorder(mesh.vertices[v])) REQUIRE(used.count(v) == 1);
+    }
+
+    // no triangle turned over, they all still face +z
+    for (size_t i = 0; i < reduced.size(); i += 3) {
+        glm::vec3 a = mesh.vertices[reduced[i]].position;
+        glm::vec3 b = mesh.vertices[reduced[i + 1]].position;
+        glm::vec3 c = mesh.vertices[reduced[i + 2]].position;
+        REQUIRE(glm::cross(b - a, c - a).z > 0.0f);
+    }
+}
+
+TEST_CASE("MeshSimplifier: small or untriangulated meshes keep a single level", "[object][mesh]") {
+    ImportedMesh small = makeGrid(4, [](float, float) { return 0.0f; });
+    MeshSimplifier::generateLODs(small, false);
+    REQUIRE(small.lods.size() == 1);
+    REQUIRE(small.lods[0].indexCount == small.indices.size());
+
+    ImportedMesh lines = makeGrid(32, [](float, float) { return 0.0f; });
+    lines.indices.pop_back();
+    MeshSimplifier::generateLODs(lines, false);
+    REQUIRE(lines.lods.size() == 1);
+}
+
+TEST_CASE("MeshSimplifier: LOD chain shrinks with growing error", "[object][mesh]") {
+    ImportedMesh mesh = makeGrid(48, [](float u, float v) { return 0.05f * std::sin(6.0f * u) * std::cos(5.0f * v); });
+    size_t fullIndexCount = mesh.indices.size();
+    MeshSimplifier::generateLODs(mesh, true);
+
+    REQUIRE(mesh.lods.size() >= 3);
+    REQUIRE(mesh.lods.size() <= MAX_MESH_LODS);
+    REQUIRE(mesh.lods[0].firstIndex == 0);
+    REQUIRE(mesh.lods[0].indexCount == fullIndexCount);
+    REQUIRE(mesh.lods[0].error == 0.0f);
+    for (size_t level = 1; level < mesh.lods.size(); level++) {
+        const MeshLOD& lod = mesh.lods[level];
+        REQUIRE(lod.indexCount % 3 == 0);
+        REQUIRE(lod.indexCount < mesh.lods[level - 1].indexCount);
+        REQUIRE(lod.error >= mesh.lods[level - 1].error);
+        REQUIRE((size_t)lod.firstIndex + lod.indexCount <= mesh.indices.size());
+    }
+    for (unsigned int index : mesh.indices) REQUIRE(index < mesh.vertices.size());
+    REQUIRE(mesh.lods.back().error > 0.0f);
+    REQUIRE(mesh.lods.back().error < 0.1f);
+}
+
+TEST_CASE("LODSelector: picks by projected error with hysteresis", "[object][mesh]") {
+    std::vector<MeshLOD> lods = { { 0, 96, 0.0f }, { 96, 48, 0.01f }, { 144, 24, 0.04f } };
+
+    // 0.01 units at 50 px/unit is half a pixel, 0.04 is two
+    REQUIRE(LODSelector::select(lods, 50.0f, 1.0f, 0) == 1);
+    // far away, everything is sub-pixel
+    REQUIRE(LODSelector::select(lods, 10.0f, 1.0f, 0) == 2);
+    // up close only the full mesh fits the budget
+    REQUIRE(LODSelector::select(lods, 1000.0f, 1.0f, 2) == 0);
+    REQUIRE(LODSelector::select(lods, FLT_MAX, 1.0f, 1) == 0);
+
+    // just past the threshold either way stays put, level 2 projects to 1.1 px and 0.8 px
+    REQUIRE(LODSelector::select(lods, 27.5f, 1.0f, 2) == 2);
+    REQUIRE(LODSelector::select(lods, 20.0f, 1.0f, 1) == 1);
+    // and moves once clear of the band
+    REQUIRE(LODSelector::select(lods, 35.0f, 1.0f, 2) == 1);
+    REQUIRE(LODSelector::select(lods, 18.0f, 1.0f, 1) == 2);
+
+    REQUIRE(LODSelector::select({ { 0, 96, 0.0f } }, 10.0f, 1.0f, 3) == 0);
+    REQUIRE(LODSelector::select(lods, 10.0f, 1.0f, 9) == 2);
+}
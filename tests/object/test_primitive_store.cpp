@@ -0,0 +1,98 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <algorithm>
+
+#include "object/PrimitiveStore.hpp"
+
+// every queue entry must point back at a primitive that thinks it lives there
+static bool queuesConsistent(const PrimitiveStore& store) {
+    uint32_t total = 0;
+    for (int q = 0; q < PrimitiveStore::QueueCount; q++) {
+        PrimitiveStore::QueueType queue = (PrimitiveStore::QueueType)q;
+        for (uint32_t index : store.getQueue(queue)) {
+            if (index >= store.size() || store.getQueueType(index) != queue) return false;
+        }
+        total += (uint32_t)store.getQueue(queue).size();
+    }
+    return total == store.size();
+}
+
+TEST_CASE("PrimitiveStore: add places primitives in their queue", "[primitive][store]") {
+    PrimitiveStore store;
+    PrimitiveStore::Handle a = store.add(1, 0, 10, PrimitiveStore::Opaque);
+    PrimitiveStore::Handle b = store.add(1, 1, 11, PrimitiveStore::Translucent);
+
+    REQUIRE(store.size() == 2);
+    REQUIRE(store.contains(a));
+    REQUIRE(store.contains(b));
+    REQUIRE(store.getMaterialID(store.indexOf(b)) == 11);
+    REQUIRE(store.getQueue(PrimitiveStore::Opaque).size() == 1);
+    REQUIRE(store.getQueue(PrimitiveStore::Translucent).size() == 1);
+    REQUIRE_FALSE(store.isValid(store.indexOf(a)));
+    REQUIRE(queuesConsistent(store));
+}
+
+TEST_CASE("PrimitiveStore: remove keeps the other handles valid", "[primitive][store]") {
+    PrimitiveStore store;
+    PrimitiveStore::Handle a = store.add(1, 0, 10, PrimitiveStore::Opaque);
+    PrimitiveStore::Handle b = store.add(2, 0, 20, PrimitiveStore::Opaque);
+    PrimitiveStore::Handle c = store.add(3, 0, 30, PrimitiveStore::Cutout);
+    store.setLOD(store.indexOf(c), 2);
+
+    REQUIRE(store.remove(a));
+    REQUIRE(store.size() == 2);
+    REQUIRE_FALSE(store.contains(a));
+
+    // c was moved into a's dense index, its handle still finds it
+    REQUIRE(store.getModelID(store.indexOf(b)) == 2);
+    REQUIRE(store.getModelID(store.indexOf(c)) == 3);
+    REQUIRE(store.getLOD(store.indexOf(c)) == 2);
+    REQUIRE(queuesConsistent(store));
+
+    REQUIRE_FALSE(store.remove(a));
+}
+
+TEST_CASE("PrimitiveStore: stale handles are rejected after slot reuse", "[primitive][store]") {
+    PrimitiveStore store;
+    PrimitiveStore::Handle a = store.add(1, 0, 10, PrimitiveStore::Opaque);
+    store.remove(a);
+    PrimitiveStore::Handle reused = store.add(5, 0, 50, PrimitiveStore::Opaque);
+
+    REQUIRE(reused.slot == a.slot);
+    REQUIRE_FALSE(store.contains(a));
+    REQUIRE(store.indexOf(a) == PrimitiveStore::NO_INDEX);
+    REQUIRE(store.contains(reused));
+    REQUIRE_FALSE(store.contains(PrimitiveStore::Handle{}));
+}
+
+TEST_CASE("PrimitiveStore: moveToQueue and sortQueue keep positions in sync", "[primitive][store]") {
+    PrimitiveStore store;
+    std::vector<PrimitiveStore::Handle> handles;
+    for (unsigned int i = 0; i < 5; i++) {
+        handles.push_back(store.add(i, 0, 0, PrimitiveStore::Translucent));
+        store.setDepth(store.indexOf(handles.back()), -(float)i);
+    }
+
+    store.moveToQueue(store.indexOf(handles[2]), PrimitiveStore::Opaque);
+    REQUIRE(store.getQueue(PrimitiveStore::Translucent).size() == 4);
+    REQUIRE(store.getQueue(PrimitiveStore::Opaque).size() == 1);
+
+    store.sortQueue(PrimitiveStore::Translucent, [&store](uint32_t a, uint32_t b) {
+        return store.getDepth(a) < store.getDepth(b);
+    });
+    const std::vector<uint32_t>& sorted = store.getQueue(PrimitiveStore::Translucent);
+    REQUIRE(std::is_sorted(sorted.begin(), sorted.end(), [&store](uint32_t a, uint32_t b) {
+        return store.getDepth(a) < store.getDepth(b);
+    }));
+
+    // removing after a sort must patch the right queue entry
+    store.remove(handles[0]);
+    store.remove(handles[4]);
+    REQUIRE(store.size() == 3);
+    REQUIRE(queuesConsistent(store));
+    REQUIRE(store.getModelID(store.indexOf(handles[3])) == 3);
+
+    store.clear();
+    REQUIRE(store.size() == 0);
+    REQUIRE(store.getQueue(PrimitiveStore::Opaque).empty());
+}
@@ -0,0 +1,66 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <cmath>
+
+#include "object/VertexLayout.hpp"
+
+static Vertex makeVertex(glm::vec3 position, glm::vec3 normal, glm::vec2 uv) {
+    Vertex vertex{};
+    vertex.position = position;
+    vertex.normal = normal;
+    vertex.uv = uv;
+    return vertex;
+}
+
+TEST_CASE("VertexLayout: only present attributes take space", "[object][mesh]") {
+    Vertex vertex = makeVertex(glm::vec3(1.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec2(0.5f));
+
+    VertexLayout full = VertexLayout::choose(&vertex, 1, MeshProperties{ true, true, true });
+    REQUIRE(full.stride == 20);
+    REQUIRE(full.attributes[VertexLayout::Normal].format == VertexFormat::Snorm10x3);
+    REQUIRE(full.attributes[VertexLayout::UV].format == VertexFormat::Unorm16x2);
+    REQUIRE(full.attributes[VertexLayout::UV].offset == 16);
+    REQUIRE_FALSE(full.has(VertexLayout::Color));
+
+    VertexLayout positionsOnly = VertexLayout::choose(&vertex, 1, MeshProperties{ true, false, false });
+    REQUIRE(positionsOnly.stride == 12);
+
+    // tiled uvs would be clamped by unorm16
+    Vertex tiled = makeVertex(glm::vec3(0.0f), glm::vec3(0.0f), glm::vec2(3.0f, -1.0f));
+    VertexLayout tiledLayout = VertexLayout::choose(&tiled, 1, MeshProperties{ true, false, true });
+    REQUIRE(tiledLayout.attributes[VertexLayout::UV].format == VertexFormat::Float2);
+    REQUIRE(tiledLayout.stride == 20);
+}
+
+TEST_CASE("VertexLayout: packed vertices unpack within quantization error", "[object][mesh]") {
+    std::vector<Vertex> vertices = {
+        makeVertex(glm::vec3(1.5f, -2.0f, 3.25f), glm::normalize(glm::vec3(1.0f, -2.0f, 0.5f)), glm::vec2(0.0f, 1.0f)),
+        makeVertex(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec2(0.123f, 0.987f)),
+    };
+    VertexLayout layout = VertexLayout::choose(vertices.data(), vertices.size(), MeshProperties{ true, true, true });
+    std::vector<unsigned char> packed = layout.pack(vertices.data(), vertices.size());
+    REQUIRE(packed.size() == vertices.size() * layout.stride);
+
+    for (size_t i = 0; i < vertices.size(); i++) {
+        Vertex unpacked = layout.unpack(packed.data() + i * layout.stride);
+        REQUIRE(unpacked.position == vertices[i].position);
+        REQUIRE(layout.unpackPosition(packed.data() + i * layout.stride) == vertices[i].position);
+        for (int c = 0; c < 3; c++) REQUIRE(std::abs(unpacked.normal[c] - vertices[i].normal[c]) <= 1.0f / 511.0f);
+        for (int c = 0; c < 2; c++) REQUIRE(std::abs(unpacked.uv[c] - vertices[i].uv[c]) <= 1.0f / 65535.0f);
+    }
+}
+
+TEST_CASE("VertexLayout: encoded layouts decode to the same layout", "[object][mesh]") {
+    VertexLayout layout = VertexLayout::fromFormats({ VertexFormat::Float3, VertexFormat::Snorm10x3, VertexFormat::Float2, VertexFormat::None });
+    VertexLayout decoded;
+    REQUIRE(VertexLayout::decode(layout.encode(), decoded));
+    REQUIRE(decoded.stride == layout.stride);
+    for (size_t location = 0; location < VertexLayout::LocationCount; location++) {
+        REQUIRE(decoded.attributes[location].format == layout.attributes[location].format);
+        REQUIRE(decoded.attributes[location].offset == layout.attributes[location].offset);
+    }
+
+    // a uv format at the position location, or stray high bits, is a corrupt blob
+    REQUIRE_FALSE(VertexLayout::decode((uint32_t)VertexFormat::Unorm16x2, decoded));
+    REQUIRE_FALSE(VertexLayout::decode(layout.encode() | 0x10000u, decoded));
+}
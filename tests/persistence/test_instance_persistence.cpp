@@ -0,0 +1,95 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include "persistence/InstancePersistence.hpp"
+
+static InstanceData makeInstance(float i) {
+    InstanceData instance;
+    instance.pos      = glm::vec3(i, -i, 0.5f * i);
+    instance.rotation = glm::vec3(0.0f, 10.0f * i, 0.0f);
+    instance.scale    = glm::vec3(1.0f + i);
+    instance.custom   = glm::vec4(0.25f, 0.5f, 0.75f, 1.0f);
+    return instance;
+}
+
+TEST_CASE("InstancePersistence: legacy position arrays still load", "[instance][persistence]") {
+    nlohmann::json j = nlohmann::json::parse("[[1, 2, 3], [4, 5, 6]]");
+    std::vector<InstanceData> instances;
+
+    REQUIRE(InstancePersistence::load(j, instances));
+    REQUIRE(instances.size() == 2);
+    REQUIRE(instances[1].pos == glm::vec3(4.0f, 5.0f, 6.0f));
+    REQUIRE(instances[1].scale == glm::vec3(1.0f));
+    REQUIRE(instances[1].custom == glm::vec4(1.0f));
+}
+
+TEST_CASE("InstancePersistence: small arrays round trip as readable json", "[instance][persistence]") {
+    std::vector<InstanceData> saved = { InstanceData{}, makeInstance(2.0f) };
+    saved[0].pos = glm::vec3(7.0f, 0.0f, 0.0f);
+
+    nlohmann::json j = InstancePersistence::save(saved);
+    REQUIRE(j.is_array());
+    REQUIRE(j[0].size() == 3);
+    REQUIRE(j[1].size() == InstancePersistence::FLOATS_PER_INSTANCE);
+
+    std::vector<InstanceData> loaded;
+    REQUIRE(InstancePersistence::load(j, loaded));
+    REQUIRE(loaded.size() == 2);
+    REQUIRE(loaded[0].pos == saved[0].pos);
+    REQUIRE(loaded[1].rotation == saved[1].rotation);
+    REQUIRE(loaded[1].custom == saved[1].custom);
+}
+
+TEST_CASE("InstancePersistence: large arrays round trip through the compact form", "[instance][persistence]") {
+    std::vector<InstanceData> saved;
+    for (int i = 0; i < 1001; i++) saved.push_back(makeInstance((float)i));
+
+    nlohmann::json j = InstancePersistence::save(saved);
+    REQUIRE(j.is_object());
+    REQUIRE(j.dump().size() < saved.size() * InstancePersistence::FLOATS_PER_INSTANCE * 6);
+
+    std::vector<InstanceData> loaded;
+    REQUIRE(InstancePersistence::load(j, loaded));
+    REQUIRE(loaded.size() == saved.size());
+    for (size_t i = 0; i < saved.size(); i++) {
+        REQUIRE(loaded[i].pos == saved[i].pos);
+        REQUIRE(loaded[i].rotation == saved[i].rotation);
+        REQUIRE(loaded[i].scale == saved[i].scale);
+        REQUIRE(loaded[i].custom == saved[i].custom);
+    }
+}
+
+TEST_CASE("InstancePersistence: malformed data is rejected", "[instance][persistence]") {
+    std::vector<InstanceData> loaded;
+    REQUIRE_FALSE(InstancePersistence::load(nlohmann::json::parse("[[1, 2]]"), loaded));
+    REQUIRE_FALSE(InstancePersistence::load(nlohmann::json::parse(R"({"count": 2, "stride": 13, "data": "AAAA"})"), loaded));
+    REQUIRE_FALSE(InstancePersistence::load(nlohmann::json::parse(R"({"count": 1, "stride": 13, "data": "!!!!"})"), loaded));
+}
+
+TEST_CASE("InstanceData: default instance packs to an identity basis", "[instance]") {
+    InstanceGPUData packed = packInstance(InstanceData{});
+    REQUIRE(packed.basis == glm::mat3(1.0f));
+
+    InstanceData scaled;
+    scaled.scale = glm::vec3(2.0f, 3.0f, 4.0f);
+    packed = packInstance(scaled);
+    REQUIRE(packed.basis[1] == glm::vec3(0.0f, 3.0f, 0.0f));
+}
+
+TEST_CASE("InstancePersistence: generator parameters round trip", "[instance][persistence]") {
+    InstanceGeneratorParams saved;
+    saved.type = InstanceGeneratorType::Scatter;
+    saved.count = 100000;
+    saved.seed = 42;
+    saved.boxMax = glm::vec3(50.0f, 1.0f, 50.0f);
+    saved.scaleRange = glm::vec2(0.5f, 1.5f);
+
+    InstanceGeneratorParams loaded;
+    REQUIRE(InstancePersistence::loadGenerator(InstancePersistence::saveGenerator(saved), loaded));
+    REQUIRE(loaded.type == saved.type);
+    REQUIRE(loaded.count == saved.count);
+    REQUIRE(loaded.seed == saved.seed);
+    REQUIRE(loaded.boxMax == saved.boxMax);
+    REQUIRE(loaded.scaleRange == saved.scaleRange);
+
+    REQUIRE_FALSE(InstancePersistence::loadGenerator(nlohmann::json::parse(R"({"type": 99})"), loaded));
+}
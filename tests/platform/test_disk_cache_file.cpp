@@ -0,0 +1,52 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "platform/DiskCacheFile.hpp"
+#include "TempDir.hpp"
+
+namespace fs = std::filesystem;
+
+struct DiskCacheFileFixture : TempDir {
+    DiskCacheFileFixture() : TempDir("sandbox_disk_cache_file_test") {}
+};
+
+TEST_CASE_METHOD(DiskCacheFileFixture, "DiskCacheFile: an atomic write replaces the file, a failed one leaves it alone", "[platform][diskcache]") {
+    fs::path path = root / "blob.bin";
+    REQUIRE(DiskCacheFile::writeAtomically(path, [](std::ofstream& file) { file << "first"; }));
+    REQUIRE(DiskCacheFile::writeAtomically(path, [](std::ofstream& file) { file << "second"; }));
+
+    REQUIRE_FALSE(DiskCacheFile::writeAtomically(path, [](std::ofstream& file) {
+        file << "half";
+        file.setstate(std::ios::failbit);
+    }));
+
+    std::ifstream in(path);
+    std::string contents;
+    in >> contents;
+    REQUIRE(contents == "second");
+
+    int files = 0;
+    for ([[maybe_unused]] const fs::directory_entry& entry : fs::directory_iterator(root)) files++;
+    REQUIRE(files == 1); // no temporary left behind
+}
+
+TEST_CASE_METHOD(DiskCacheFileFixture, "DiskCacheFile: a file hashes like its bytes, stat sees its size", "[platform][diskcache]") {
+    const std::string text = "some shader source";
+    fs::path path = root / "source.txt";
+    writeFile(path, text);
+
+    uint64_t hash = 0;
+    REQUIRE(DiskCacheFile::hashFile(path, hash));
+    REQUIRE(hash == DiskCacheFile::hashBytes(text.data(), text.size()));
+
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    REQUIRE(DiskCacheFile::statFile(path, size, mtime));
+    REQUIRE(size == text.size());
+    REQUIRE_FALSE(DiskCacheFile::statFile(root / "missing.txt", size, mtime));
+
+    REQUIRE(DiskCacheFile::hexName(0xabcull) == "0000000000000abc");
+}
@@ -0,0 +1,61 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <filesystem>
+#include <fstream>
+
+#include "texture/DecodedImage.hpp"
+
+// 2x1 binary PPM, red then blue
+static std::string writeTestImage(const std::string& name) {
+    std::filesystem::path path = std::filesystem::temp_directory_path() / name;
+    std::ofstream out(path, std::ios::binary);
+    out << "P6\n2 1\n255\n";
+    const unsigned char pixels[] = { 255, 0, 0,   0, 0, 255 };
+    out.write(reinterpret_cast<const char*>(pixels), sizeof(pixels));
+    return path.string();
+}
+
+TEST_CASE("TextureDecode: decodes every path", "[texture][decode]") {
+    std::string path = writeTestImage("sandbox_decode_test.ppm");
+
+    TextureDecode decoded = TextureDecode::decode({ path, path }, false, false);
+    REQUIRE(decoded.status == TextureStatus::Loaded);
+    REQUIRE(decoded.images.size() == 2);
+    REQUIRE(decoded.images[0].width == 2);
+    REQUIRE(decoded.images[0].height == 1);
+    REQUIRE(decoded.images[0].channels == 3);
+    REQUIRE(decoded.byteSize() == 12);
+    REQUIRE(decoded.images[0].texels[0] == 255);
+    REQUIRE(decoded.images[0].texels[5] == 255);
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("TextureDecode: a missing file fails the whole set", "[texture][decode]") {
+    std::string path = writeTestImage("sandbox_decode_test_missing.ppm");
+
+    TextureDecode decoded = TextureDecode::decode({ path, "does/not/exist.png" }, true, true);
+    REQUIRE(decoded.status == TextureStatus::FileNotFound);
+    REQUIRE(decoded.images.empty());
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("DecodedImage: mip chain halves down to 1x1", "[texture][decode]") {
+    // 4x2 single channel, left half 0, right half 200
+    const unsigned char pixels[] = { 0, 0, 200, 200,
+                                     0, 0, 200, 200 };
+    DecodedImage image;
+    image.setBaseLevel(pixels, 4, 2, 1);
+    image.generateMips();
+
+    REQUIRE(image.levels.size() == 3);
+    REQUIRE(image.levels[1].width == 2);
+    REQUIRE(image.levels[1].height == 1);
+    REQUIRE(image.levels[2].width == 1);
+    REQUIRE(image.levels[2].height == 1);
+    REQUIRE(image.levelData(1)[0] == 0);
+    REQUIRE(image.levelData(1)[1] == 200);
+    REQUIRE(image.levelData(2)[0] == 100);
+    REQUIRE(image.byteSize() == 8 + 2 + 1);
+}
@@ -0,0 +1,93 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+#include "texture/DecodedImage.hpp"
+#include "texture/TextureDiskCache.hpp"
+#include "TempDir.hpp"
+
+namespace fs = std::filesystem;
+
+static void writePPM(const fs::path& path, unsigned char red) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << "P6\n2 2\n255\n";
+    for (int i = 0; i < 4; i++) {
+        const unsigned char pixel[] = { red, 10, 20 };
+        out.write(reinterpret_cast<const char*>(pixel), sizeof(pixel));
+    }
+}
+
+struct DiskCacheFixture : TempDir {
+    fs::path source = root / "source.ppm";
+    TextureDiskCache cache;
+
+    DiskCacheFixture() : TempDir("sandbox_texture_cache_test") {
+        writePPM(source, 100);
+        cache.initialize(root / "cache");
+    }
+};
+
+TEST_CASE_METHOD(DiskCacheFixture, "TextureDiskCache: second decode is served from the cache", "[texture][cache]") {
+    TextureDecode first = TextureDecode::decode({ source.string() }, true, true, &cache);
+    REQUIRE(first.status == TextureStatus::Loaded);
+    REQUIRE(cache.getHits() == 0);
+
+    TextureDecode second = TextureDecode::decode({ source.string() }, true, true, &cache);
+    REQUIRE(second.status == TextureStatus::Loaded);
+    REQUIRE(cache.getHits() == 1);
+    REQUIRE(second.images[0].levels.size() == first.images[0].levels.size());
+    REQUIRE(second.images[0].texels == first.images[0].texels);
+
+    // different decode options are a different entry
+    DecodedImage image;
+    REQUIRE_FALSE(cache.load(source.string(), false, true, image));
+}
+
+TEST_CASE_METHOD(DiskCacheFixture, "TextureDiskCache: edited sources are a miss, touched ones a hit", "[texture][cache]") {
+    TextureDecode::decode({ source.string() }, true, true, &cache);
+    auto later = fs::last_write_time(source) + std::chrono::seconds(5);
+
+    // same bytes, new mtime: the content hash keeps the entry
+    writePPM(source, 100);
+    fs::last_write_time(source, later);
+    DecodedImage image;
+    REQUIRE(cache.load(source.string(), true, true, image));
+
+    // same size, different bytes: stale
+    writePPM(source, 101);
+    fs::last_write_time(source, later + std::chrono::seconds(5));
+    REQUIRE_FALSE(cache.load(source.string(), true, true, image));
+
+    TextureDecode redecoded = TextureDecode::decode({ source.string() }, true, true, &cache);
+    REQUIRE(redecoded.images[0].texels[0] == 101);
+    REQUIRE(cache.load(source.string(), true, true, image));
+}
+
+TEST_CASE_METHOD(DiskCacheFixture, "TextureDiskCache: a truncated blob is a miss", "[texture][cache]") {
+    TextureDecode::decode({ source.string() }, true, true, &cache);
+    DecodedImage image;
+    REQUIRE(cache.load(source.string(), true, true, image));
+
+    fs::path blob = fs::directory_iterator(root / "cache")->path();
+    fs::resize_file(blob, fs::file_size(blob) - 1);
+    REQUIRE_FALSE(cache.load(source.string(), true, true, image));
+}
+
+TEST_CASE_METHOD(DiskCacheFixture, "TextureDiskCache: a level smaller than its texels is a miss", "[texture][cache]") {
+    TextureDecode::decode({ source.string() }, true, true, &cache);
+    DecodedImage image;
+    REQUIRE(cache.load(source.string(), true, true, image));
+    REQUIRE(image.levels.size() > 1);
+
+    // 56 byte header, then 16 bytes per level with the size at +8: level 1 claims 1 byte instead of 3
+    fs::path blob = fs::directory_iterator(root / "cache")->path();
+    {
+        std::fstream file(blob, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(56 + 16 + 8);
+        const uint64_t size = 1;
+        file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    }
+    REQUIRE_FALSE(cache.load(source.string(), true, true, image));
+}